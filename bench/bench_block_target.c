@@ -0,0 +1,276 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Random READ/WRITE 16 against the synthetic block target with injected faults, retrying what the sense says to */
+
+#include "scsicmd.h"
+#include "scsi_transport.h"
+#include "sense_action.h"
+#include "scsi_stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+
+#define NUM_BLOCKS (1024*1024)
+#define BLOCK_SIZE 512
+#define MAX_BLOCKS 8
+#define MAX_RETRIES 3
+
+typedef struct io_t {
+	uint64_t lba;
+	unsigned num_blocks;
+	bool write;
+	unsigned retries;
+} io_t;
+
+static uint64_t actions[SENSE_ACTION_DEVICE_DEAD + 1];
+static uint64_t task_set_full;
+static uint64_t retries;
+static uint64_t failed;
+static uint64_t rng = 88172645463325252ULL;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t random64(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng;
+}
+
+static void io_prepare(scsi_cmd_t *cmd, int dev, io_t *io, bool new_io)
+{
+	unsigned char cdb[16];
+	int cdb_len;
+
+	if (new_io) {
+		io->num_blocks = 1 + random64() % MAX_BLOCKS;
+		io->lba = random64() % (NUM_BLOCKS - io->num_blocks);
+		io->write = random64() & 1;
+		io->retries = 0;
+	}
+
+	if (io->write)
+		cdb_len = cdb_write_16(cdb, false, false, false, io->lba, io->num_blocks);
+	else
+		cdb_len = cdb_read_16(cdb, false, false, false, io->lba, io->num_blocks);
+	scsi_cmd_init(cmd, dev, cdb, cdb_len, io->write ? SCSI_DIR_TO_DEV : SCSI_DIR_FROM_DEV, cmd->buf, io->num_blocks * BLOCK_SIZE);
+	cmd->priv = io;
+}
+
+/* Returns true if the command should be resubmitted as is */
+static bool io_check(scsi_cmd_t *cmd)
+{
+	io_t *io = cmd->priv;
+	sense_info_t info;
+	sense_decision_t decision;
+
+	if (cmd->status == 0x28) {
+		task_set_full++;
+		return true;
+	}
+	if (cmd->sense_len == 0)
+		return false;
+	if (!scsi_parse_sense(cmd->sense, cmd->sense_len, &info)) {
+		failed++;
+		return false;
+	}
+
+	decision = sense_info_classify(&info);
+	actions[decision.action]++;
+	if ((decision.action == SENSE_ACTION_RETRY || decision.action == SENSE_ACTION_RETRY_BACKOFF) && io->retries < MAX_RETRIES) {
+		io->retries++;
+		retries++;
+		return true;
+	}
+	if (decision.action != SENSE_ACTION_INFORMATIONAL)
+		failed++;
+	return false;
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-q queue_depth] [-t target_queue_depth] [-d devices] [-n num_cmds] [-l latency_us] [-j jitter_us] [-e] "
+	        "[-m medium_error_every_blocks] [-u unit_attention_after_cmds] [-s] [-p]\n", name);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	scsi_block_config_t config;
+	unsigned queue_depth = 64;
+	unsigned num_devs = 4;
+	unsigned long num_cmds = 1000000;
+	unsigned long medium_error_every = 0;
+	unsigned long unit_attention_after = 0;
+	uint64_t submitted = 0, completed = 0;
+	bool with_stats = false, prometheus = false;
+	scsi_stats_t *stats = NULL;
+	scsi_transport_t *t;
+	scsi_cmd_t *cmds;
+	io_t *ios;
+	unsigned char *bufs;
+	double start, elapsed;
+	unsigned i;
+	int opt;
+
+	memset(&config, 0, sizeof(config));
+	config.num_blocks = NUM_BLOCKS;
+	config.block_size = BLOCK_SIZE;
+	config.max_transfer_length = MAX_BLOCKS;
+	config.vendor = "LIBSCSI";
+	config.model = "BLOCK TARGET";
+	config.revision = "0001";
+	config.seed = 1;
+
+	while ((opt = getopt(argc, argv, "q:t:d:n:l:j:em:u:sp")) != -1) {
+		switch (opt) {
+			case 'q': queue_depth = strtoul(optarg, NULL, 0); break;
+			case 't': config.queue_depth = strtoul(optarg, NULL, 0); break;
+			case 'd': num_devs = strtoul(optarg, NULL, 0); break;
+			case 'n': num_cmds = strtoul(optarg, NULL, 0); break;
+			case 'l': config.read_latency.latency_us = config.write_latency.latency_us = strtoul(optarg, NULL, 0); break;
+			case 'j': config.read_latency.jitter_us = config.write_latency.jitter_us = strtoul(optarg, NULL, 0); break;
+			case 'e': config.read_latency.dist = config.write_latency.dist = SCSI_LATENCY_EXPONENTIAL; break;
+			case 'm': medium_error_every = strtoul(optarg, NULL, 0); break;
+			case 'u': unit_attention_after = strtoul(optarg, NULL, 0); break;
+			case 's': with_stats = true; break;
+			case 'p': with_stats = prometheus = true; break;
+			default: return usage(argv[0]);
+		}
+	}
+	if (queue_depth == 0 || num_devs == 0)
+		return usage(argv[0]);
+
+	t = scsi_transport_block_create(&config);
+	if (!t) {
+		fprintf(stderr, "Failed to create the block target\n");
+		return 1;
+	}
+
+	if (with_stats) {
+		stats = scsi_stats_create(num_devs, 1);
+		if (!stats || scsi_transport_attach_stats(t, stats) < 0) {
+			fprintf(stderr, "Failed to attach stats\n");
+			return 1;
+		}
+	}
+
+	for (i = 0; i < num_devs; i++) {
+		char name[32];
+		int dev;
+
+		snprintf(name, sizeof(name), "BENCH%04u", i);
+		dev = scsi_transport_open(t, name);
+		if (dev < 0) {
+			fprintf(stderr, "Failed to open device %u: %s\n", i, strerror(-dev));
+			return 1;
+		}
+
+		if (medium_error_every) {
+			/* UNRECOVERED READ ERROR on a sprinkling of single blocks, every hit clears one */
+			scsi_block_fault_t fault = { .type = SCSI_FAULT_LBA_RANGE, .sense_key = SENSE_KEY_MEDIUM_ERROR, .asc = 0x11, .ascq = 0x00,
+			                             .num_blocks = 1, .times = 1 };
+			for (fault.lba = medium_error_every / 2; fault.lba < NUM_BLOCKS; fault.lba += medium_error_every)
+				scsi_transport_block_inject(t, dev, &fault);
+		}
+		if (unit_attention_after) {
+			/* POWER ON, RESET, OR BUS DEVICE RESET OCCURRED once */
+			scsi_block_fault_t fault = { .type = SCSI_FAULT_AFTER_CMDS, .sense_key = SENSE_KEY_UNIT_ATTENTION, .asc = 0x29, .ascq = 0x00,
+			                             .cmd_count = unit_attention_after, .times = 1 };
+			scsi_transport_block_inject(t, dev, &fault);
+		}
+	}
+
+	cmds = calloc(queue_depth, sizeof(*cmds));
+	ios = calloc(queue_depth, sizeof(*ios));
+	bufs = calloc(queue_depth, MAX_BLOCKS * BLOCK_SIZE);
+
+	start = now();
+	for (i = 0; i < queue_depth && submitted < num_cmds; i++, submitted++) {
+		cmds[i].buf = bufs + (size_t)i * MAX_BLOCKS * BLOCK_SIZE;
+		io_prepare(&cmds[i], i % num_devs, &ios[i], true);
+		scsi_transport_submit(t, &cmds[i]);
+	}
+
+	while (completed < submitted) {
+		scsi_cmd_t *done[64];
+		unsigned num_done;
+
+		if (scsi_transport_poll(t, -1) < 0)
+			break;
+
+		while ((num_done = scsi_transport_complete(t, done, 64)) > 0) {
+			for (i = 0; i < num_done; i++) {
+				scsi_cmd_t *cmd = done[i];
+
+				if (io_check(cmd)) {
+					io_prepare(cmd, cmd->dev, cmd->priv, false);
+					scsi_transport_submit(t, cmd);
+					continue;
+				}
+
+				completed++;
+				if (submitted < num_cmds) {
+					io_prepare(cmd, cmd->dev, cmd->priv, true);
+					scsi_transport_submit(t, cmd);
+					submitted++;
+				}
+			}
+		}
+	}
+	elapsed = now() - start;
+
+	printf("%" PRIu64 " commands, %u devices, queue depth %u: %.0f IOPS\n", completed, num_devs, queue_depth, completed / elapsed);
+	printf("retries %" PRIu64 ", failed %" PRIu64 ", task set full %" PRIu64 "\n", retries, failed, task_set_full);
+	for (i = 0; i <= SENSE_ACTION_DEVICE_DEAD; i++)
+		if (actions[i])
+			printf("  %s: %" PRIu64 "\n", sense_action_name(i), actions[i]);
+
+	if (stats) {
+		scsi_stats_snapshot_t *snap = scsi_stats_snapshot(stats);
+
+		for (i = 0; i < CDB_KIND_NUM; i++) {
+			const scsi_stats_hist_t *hist = &snap->kinds[i].latency;
+			if (hist->count == 0)
+				continue;
+			printf("%s: %" PRIu64 " commands, latency us p50 %.1f p99 %.1f p99.9 %.1f max %.1f\n", cdb_kind_name(i), hist->count,
+			       scsi_stats_hist_percentile(hist, 50) / 1e3, scsi_stats_hist_percentile(hist, 99) / 1e3,
+			       scsi_stats_hist_percentile(hist, 99.9) / 1e3, hist->max_ns / 1e3);
+		}
+		if (prometheus)
+			scsi_stats_write_prometheus(snap, NULL, stdout);
+
+		free(snap);
+		scsi_stats_destroy(stats);
+	}
+
+	scsi_transport_destroy(t);
+	free(cmds);
+	free(ios);
+	free(bufs);
+	return 0;
+}
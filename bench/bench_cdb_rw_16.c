@@ -0,0 +1,145 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsicmd.h"
+#include "cdb_template.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_CDBS 4096
+#define NUM_ROUNDS 2000
+
+static unsigned char cdbs[NUM_CDBS][16];
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned checksum(void)
+{
+	unsigned sum = 0;
+	unsigned i;
+
+	for (i = 0; i < NUM_CDBS; i++)
+		sum += cdbs[i][8] + cdbs[i][12];
+	return sum;
+}
+
+static void report(const char *name, double elapsed, unsigned sum)
+{
+	const double num = (double)NUM_CDBS * NUM_ROUNDS;
+	printf("%-24s %8.2f ns/cdb %8.2f M cdbs/s (checksum %u)\n", name, elapsed * 1e9 / num, num / elapsed / 1e6, sum);
+}
+
+static void bench_scalar(uint64_t stride)
+{
+	uint64_t lba = 0;
+	unsigned round, i;
+	double start = now();
+
+	for (round = 0; round < NUM_ROUNDS; round++) {
+		for (i = 0; i < NUM_CDBS; i++, lba += stride)
+			cdb_read_16(cdbs[i], false, false, false, lba, 256);
+	}
+
+	report("cdb_read_16", now() - start, checksum());
+}
+
+static void bench_range(uint64_t stride)
+{
+	uint64_t lba = 0;
+	unsigned round;
+	double start = now();
+
+	for (round = 0; round < NUM_ROUNDS; round++, lba += stride * NUM_CDBS)
+		cdb_read_16_range(cdbs[0], false, false, false, lba, 256, NUM_CDBS, stride);
+
+	report("cdb_read_16_range", now() - start, checksum());
+}
+
+static CDB_TEMPLATE_POOL(pool, NUM_CDBS);
+
+static void bench_template(uint64_t stride)
+{
+	cdb_template_t proto;
+	uint64_t lba = 0;
+	unsigned round, i, sum = 0;
+	double start;
+
+	cdb_template_read_16(&proto, false, false, false);
+	cdb_template_pool_init(pool, NUM_CDBS, &proto);
+
+	start = now();
+	for (round = 0; round < NUM_ROUNDS; round++) {
+		for (i = 0; i < NUM_CDBS; i++, lba += stride)
+			cdb_template_patch(&pool[i], lba, 256);
+	}
+	for (i = 0; i < NUM_CDBS; i++)
+		sum += pool[i].cdb[8] + pool[i].cdb[12];
+
+	report("cdb_template_patch", now() - start, sum);
+}
+
+static void verify_template(cdb_template_t *tmpl, const unsigned char *cdb, int len, uint64_t lba, uint32_t transfer_length_blocks)
+{
+	if (cdb_template_patch(tmpl, lba, transfer_length_blocks) != len || memcmp(tmpl->cdb, cdb, len) != 0) {
+		fprintf(stderr, "Template CDB differs from the CDB builder\n");
+		exit(1);
+	}
+}
+
+static void verify(uint64_t stride)
+{
+	unsigned char cdb[16];
+	unsigned i;
+
+	cdb_read_16_range(cdbs[0], true, false, true, 1000, 8, NUM_CDBS, stride);
+	for (i = 0; i < NUM_CDBS; i++) {
+		cdb_read_16(cdb, true, false, true, 1000 + i * stride, 8);
+		if (memcmp(cdb, cdbs[i], sizeof(cdb)) != 0) {
+			fprintf(stderr, "CDB %u differs between the scalar and range builders\n", i);
+			exit(1);
+		}
+	}
+
+	cdb_template_read_10(&pool[0], true);
+	verify_template(&pool[0], cdb, cdb_read_10(cdb, true, 0x12345678, 0x1234), 0x12345678, 0x1234);
+	cdb_template_write_10(&pool[0], false);
+	verify_template(&pool[0], cdb, cdb_write_10(cdb, false, 0x87654321, 8), 0x87654321, 8);
+	cdb_template_read_16(&pool[0], false, true, true);
+	verify_template(&pool[0], cdb, cdb_read_16(cdb, false, true, true, 0x123456789ABCULL, 0x10000), 0x123456789ABCULL, 0x10000);
+	cdb_template_write_16(&pool[0], true, true, false);
+	verify_template(&pool[0], cdb, cdb_write_16(cdb, true, true, false, 1, 1), 1, 1);
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t stride = argc > 1 ? strtoull(argv[1], NULL, 0) : 256;
+
+	verify(stride);
+
+	printf("READ 16 %u CDBs x %u rounds, stride %llu\n", NUM_CDBS, NUM_ROUNDS, (unsigned long long)stride);
+	bench_scalar(stride);
+	bench_range(stride);
+	bench_template(stride);
+	return 0;
+}
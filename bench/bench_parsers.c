@@ -0,0 +1,721 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Time every parser on the rows of collect_raw_data captures, typically afl/testcase.
+ *
+ * The captures are loaded once and every parser runs over the rows it applies to. The warm time loops over them with
+ * everything in the cache and is the fastest of several runs, the least disturbed by the rest of the machine. The cold
+ * time is a single pass after the cache was flushed by writing a buffer twice the size of the last level cache (up to
+ * 256MB) and is the median of several runs. The results can be saved as a JSON baseline and
+ * later runs compared against it, a slowdown above the threshold is a regression and the exit code is 2.
+ */
+
+#include "scsicmd.h"
+#include "ata.h"
+#include "cdb_decode.h"
+#include "hex_decode.h"
+#include "parse_log_sense.h"
+#include "parse_mode_sense.h"
+#include "parse_read_defect_data.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define WARM_RUNS 7
+#define COLD_RUNS 31
+#define MAX_EVICT_LEN (256*1024*1024)
+#define MAX_BENCH_NAME 64
+
+typedef struct row_t {
+	uint8_t *cdb;
+	uint8_t *sense;
+	uint8_t *data;
+	unsigned cdb_len;
+	unsigned sense_len;
+	unsigned data_len;
+	cdb_decoded_t decoded;
+	bool decoded_valid;
+	uint8_t asc;
+	uint8_t ascq;
+} row_t;
+
+typedef struct bench_t {
+	const char *name;
+	bool (*select)(const row_t *row);
+	unsigned long (*run)(const row_t *row);
+	unsigned (*bytes)(const row_t *row);
+} bench_t;
+
+typedef struct result_t {
+	char name[MAX_BENCH_NAME];
+	unsigned rows;
+	double bytes_per_op;
+	double warm_ns;
+	double cold_ns;
+	double warm_bytes_per_sec;
+} result_t;
+
+static row_t *rows;
+static unsigned num_rows;
+static volatile unsigned long sink;
+static unsigned char *evict_buf;
+static size_t evict_len;
+static double min_run_sec = 0.02;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Loading */
+
+static bool add_row(const char *line, size_t len)
+{
+	const char *end = line + len;
+	const char *fields[4];
+	size_t field_len[4];
+	long decoded[3];
+	unsigned char *buf, *pos;
+	row_t *row;
+	unsigned i;
+
+	for (i = 0; i < 4; i++) {
+		const char *comma = line && i < 3 ? memchr(line, ',', end - line) : NULL;
+
+		fields[i] = line;
+		field_len[i] = line ? (size_t)((comma ? comma : end) - line) : 0;
+		line = comma ? comma + 1 : NULL;
+	}
+	if (!fields[3])
+		return false;
+
+	buf = malloc(len / 2 + 3);
+	if (!buf)
+		return false;
+	for (i = 0, pos = buf; i < 3; i++) {
+		decoded[i] = hex_decode(fields[i+1], field_len[i+1], pos);
+		if (decoded[i] < 0) {
+			free(buf);
+			return false;
+		}
+		pos += decoded[i];
+	}
+	if (decoded[0] == 0) {
+		free(buf);
+		return false;
+	}
+
+	if ((num_rows & (num_rows - 1)) == 0) {
+		row_t *new_rows = realloc(rows, (num_rows ? num_rows * 2 : 64) * sizeof(*rows));
+		if (!new_rows) {
+			free(buf);
+			return false;
+		}
+		rows = new_rows;
+	}
+
+	row = &rows[num_rows++];
+	memset(row, 0, sizeof(*row));
+	row->cdb = buf;
+	row->cdb_len = decoded[0];
+	row->sense = buf + decoded[0];
+	row->sense_len = decoded[1];
+	row->data = row->sense + decoded[1];
+	row->data_len = decoded[2];
+	row->decoded_valid = cdb_decode(row->cdb, row->cdb_len, &row->decoded);
+	if (row->sense_len) {
+		sense_info_t info;
+		if (scsi_parse_sense(row->sense, row->sense_len, &info)) {
+			row->asc = info.asc;
+			row->ascq = info.ascq;
+		}
+	}
+	return true;
+}
+
+static void load_file(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t len;
+
+	if (!f) {
+		fprintf(stderr, "Failed to open '%s': %m\n", filename);
+		return;
+	}
+
+	while ((len = getline(&line, &line_size, f)) > 0) {
+		while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+			len--;
+		if (len > 0)
+			add_row(line, len);
+	}
+
+	free(line);
+	fclose(f);
+}
+
+static void load_path(const char *path)
+{
+	struct stat st;
+	struct dirent **entries;
+	int num_entries, i;
+
+	if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode)) {
+		load_file(path);
+		return;
+	}
+
+	/* Sorted so that the rows are always in the same order */
+	num_entries = scandir(path, &entries, NULL, alphasort);
+	if (num_entries < 0) {
+		fprintf(stderr, "Failed to read directory '%s': %m\n", path);
+		return;
+	}
+	for (i = 0; i < num_entries; i++) {
+		char filename[4096];
+
+		if (entries[i]->d_name[0] != '.') {
+			snprintf(filename, sizeof(filename), "%s/%s", path, entries[i]->d_name);
+			load_file(filename);
+		}
+		free(entries[i]);
+	}
+	free(entries);
+}
+
+/* A SMART READ DATA page for when the captures have none, there are rarely ATA disks in them */
+static void add_synthetic_smart_row(void)
+{
+	static uint8_t data[512];
+	static uint8_t cdb[12];
+	row_t *row;
+	unsigned i;
+
+	if ((num_rows & (num_rows - 1)) == 0) {
+		row_t *new_rows = realloc(rows, (num_rows ? num_rows * 2 : 64) * sizeof(*rows));
+		if (!new_rows)
+			return;
+		rows = new_rows;
+	}
+
+	data[0] = 0x10;
+	for (i = 0; i < 30; i++) {
+		uint8_t *attr = data + 2 + 12*i;
+		attr[0] = i + 1;
+		attr[1] = 0x33;
+		attr[3] = 100;
+		attr[4] = 90;
+		attr[5] = i * 7;
+		attr[6] = i;
+	}
+	data[511] = ata_calc_checksum(data);
+
+	row = &rows[num_rows++];
+	memset(row, 0, sizeof(*row));
+	row->cdb_len = cdb_ata_smart_read_data(cdb);
+	row->cdb = cdb;
+	row->data = data;
+	row->data_len = sizeof(data);
+	row->decoded_valid = cdb_decode(row->cdb, row->cdb_len, &row->decoded);
+}
+
+/* The parsers */
+
+static bool is_response(const row_t *row, cdb_kind_e kind)
+{
+	return row->decoded_valid && row->decoded.kind == kind && row->sense_len == 0;
+}
+
+static unsigned data_bytes(const row_t *row)
+{
+	return row->data_len;
+}
+
+static unsigned sense_bytes(const row_t *row)
+{
+	return row->sense_len;
+}
+
+static bool select_sense(const row_t *row)
+{
+	return row->sense_len > 0;
+}
+
+static unsigned long run_sense(const row_t *row)
+{
+	sense_info_t info;
+
+	if (!scsi_parse_sense(row->sense, row->sense_len, &info))
+		return 0;
+	return info.sense_key + info.asc;
+}
+
+static unsigned long run_asc_num_to_name(const row_t *row)
+{
+	return (unsigned long)asc_num_to_name(row->asc, row->ascq);
+}
+
+static bool select_inquiry(const row_t *row)
+{
+	return is_response(row, CDB_KIND_INQUIRY) && !(row->decoded.flags & CDB_FLAG_EVPD);
+}
+
+static unsigned long run_inquiry(const row_t *row)
+{
+	int device_type;
+	scsi_vendor_t vendor;
+	scsi_model_t model;
+	scsi_fw_revision_t rev;
+	scsi_serial_t serial;
+
+	if (!parse_inquiry(row->data, row->data_len, &device_type, vendor, model, rev, serial))
+		return 0;
+	return device_type + vendor[0];
+}
+
+static bool select_read_capacity_16(const row_t *row)
+{
+	return is_response(row, CDB_KIND_READ_CAPACITY_16);
+}
+
+static unsigned long run_read_capacity_16(const row_t *row)
+{
+	uint64_t max_lba;
+	uint32_t block_size;
+	bool prot_enable, thin_provisioning_enabled, thin_provisioning_zero;
+	unsigned p_type, p_i_exponent, logical_blocks_per_physical_block_exponent, lowest_aligned_lba;
+
+	if (!parse_read_capacity_16(row->data, row->data_len, &max_lba, &block_size, &prot_enable,
+		&p_type, &p_i_exponent, &logical_blocks_per_physical_block_exponent,
+		&thin_provisioning_enabled, &thin_provisioning_zero, &lowest_aligned_lba))
+		return 0;
+	return max_lba + block_size;
+}
+
+static bool select_log_sense(const row_t *row)
+{
+	return is_response(row, CDB_KIND_LOG_SENSE) && row->data_len >= LOG_SENSE_MIN_LEN;
+}
+
+static unsigned long run_log_sense_params(const row_t *row)
+{
+	unsigned long sum = 0;
+	uint8_t *param;
+
+	for_all_log_sense_params(row->data, row->data_len, param)
+		sum += log_sense_param_code(param);
+	return sum;
+}
+
+/* Look up every parameter of the page by its code, as an exporter of all the fields does */
+static unsigned long run_log_sense_find_linear(const row_t *row)
+{
+	unsigned long sum = 0;
+	uint8_t *param, *found;
+
+	for_all_log_sense_params(row->data, row->data_len, param) {
+		for_all_log_sense_params(row->data, row->data_len, found) {
+			if (log_sense_param_code(found) == log_sense_param_code(param)) {
+				sum += log_sense_param_len(found);
+				break;
+			}
+		}
+	}
+	return sum;
+}
+
+static unsigned long run_log_sense_index(const row_t *row)
+{
+	log_sense_index_entry_t entries[(65535 + LOG_SENSE_MIN_LEN) / LOG_SENSE_MIN_PARAM_LEN];
+	log_sense_index_t idx;
+	unsigned long sum = 0;
+	uint8_t *param;
+
+	log_sense_index_init(&idx, entries, sizeof(entries) / sizeof(entries[0]));
+	if (!log_sense_index_build(&idx, row->data, row->data_len))
+		return 0;
+	for_all_log_sense_params(row->data, row->data_len, param)
+		sum += log_sense_param_len(log_sense_index_find(&idx, log_sense_param_code(param)));
+	return sum;
+}
+
+static bool select_mode_sense_10(const row_t *row)
+{
+	return is_response(row, CDB_KIND_MODE_SENSE_10) && row->data_len >= MODE_SENSE_10_MIN_LEN &&
+	       row->data_len >= mode_sense_10_expected_length(row->data);
+}
+
+static unsigned long run_mode_sense_10_pages(const row_t *row)
+{
+	unsigned long sum = 0;
+	unsigned remaining_len;
+	uint8_t *page;
+
+	for_all_mode_sense_10_pages(row->data, row->data_len, page, remaining_len)
+		sum += mode_sense_data_page_code(page) + remaining_len;
+	return sum;
+}
+
+/* The walk of parse_scsi over a defect list */
+static unsigned long defect_list_walk(address_desc_format_e fmt, uint8_t *data, unsigned len)
+{
+	const unsigned fmt_len = read_defect_data_fmt_len(fmt);
+	unsigned long sum = 0;
+
+	if (fmt_len == 0)
+		return 0;
+
+	for (; len >= fmt_len; data += fmt_len, len -= fmt_len) {
+		switch (fmt) {
+			case ADDRESS_FORMAT_SHORT: sum += get_uint32(data, 0); break;
+			case ADDRESS_FORMAT_LONG: sum += get_uint64(data, 0); break;
+			case ADDRESS_FORMAT_INDEX_OFFSET: sum += format_address_byte_from_index_bytes(data); break;
+			case ADDRESS_FORMAT_PHYSICAL: sum += format_address_physical_sector(data); break;
+			default: sum += get_uint32(data, 0); break;
+		}
+	}
+	return sum;
+}
+
+static bool select_read_defect_data_10(const row_t *row)
+{
+	return is_response(row, CDB_KIND_READ_DEFECT_DATA_10) && read_defect_data_10_is_valid(row->data, row->data_len);
+}
+
+static unsigned long run_read_defect_data_10(const row_t *row)
+{
+	uint8_t *list = read_defect_data_10_data(row->data);
+	return defect_list_walk(read_defect_data_10_list_format(row->data), list,
+		safe_len(row->data, row->data_len, list, read_defect_data_10_len(row->data)));
+}
+
+static bool select_read_defect_data_12(const row_t *row)
+{
+	return is_response(row, CDB_KIND_READ_DEFECT_DATA_12) && read_defect_data_12_is_valid(row->data, row->data_len);
+}
+
+static unsigned long run_read_defect_data_12(const row_t *row)
+{
+	uint8_t *list = read_defect_data_12_data(row->data);
+	return defect_list_walk(read_defect_data_12_list_format(row->data), list,
+		safe_len(row->data, row->data_len, list, read_defect_data_12_len(row->data)));
+}
+
+static bool select_ata_smart_read_data(const row_t *row)
+{
+	return row->decoded_valid && row->sense_len == 0 && row->data_len >= 512 &&
+	       (row->decoded.kind == CDB_KIND_ATA_PASSTHROUGH_12 || row->decoded.kind == CDB_KIND_ATA_PASSTHROUGH_16) &&
+	       row->decoded.ata.command == 0xB0 && (row->decoded.ata.feature & 0xFF) == 0xD0;
+}
+
+static unsigned long run_ata_smart_read_data(const row_t *row)
+{
+	ata_smart_attr_t attrs[MAX_SMART_ATTRS];
+	const int num_attrs = ata_parse_ata_smart_read_data(row->data, attrs, MAX_SMART_ATTRS);
+	return num_attrs > 0 ? num_attrs + attrs[0].raw : 0;
+}
+
+static const bench_t benches[] = {
+	{"scsi_parse_sense", select_sense, run_sense, sense_bytes},
+	{"asc_num_to_name", select_sense, run_asc_num_to_name, sense_bytes},
+	{"parse_inquiry", select_inquiry, run_inquiry, data_bytes},
+	{"parse_read_capacity_16", select_read_capacity_16, run_read_capacity_16, data_bytes},
+	{"for_all_log_sense_params", select_log_sense, run_log_sense_params, data_bytes},
+	{"log_sense_find_linear", select_log_sense, run_log_sense_find_linear, data_bytes},
+	{"log_sense_index_find", select_log_sense, run_log_sense_index, data_bytes},
+	{"for_all_mode_sense_10_pages", select_mode_sense_10, run_mode_sense_10_pages, data_bytes},
+	{"read_defect_data_10_list", select_read_defect_data_10, run_read_defect_data_10, data_bytes},
+	{"read_defect_data_12_list", select_read_defect_data_12, run_read_defect_data_12, data_bytes},
+	{"ata_parse_ata_smart_read_data", select_ata_smart_read_data, run_ata_smart_read_data, data_bytes},
+};
+#define NUM_BENCHES (sizeof(benches)/sizeof(benches[0]))
+
+/* Timing */
+
+static int cmp_double(const void *a, const void *b)
+{
+	const double da = *(const double *)a;
+	const double db = *(const double *)b;
+	return da < db ? -1 : da > db;
+}
+
+static double median(double *vals, unsigned num)
+{
+	qsort(vals, num, sizeof(*vals), cmp_double);
+	return vals[num / 2];
+}
+
+static double minimum(const double *vals, unsigned num)
+{
+	double min = vals[0];
+	unsigned i;
+
+	for (i = 1; i < num; i++)
+		if (vals[i] < min)
+			min = vals[i];
+	return min;
+}
+
+static void evict_cache(void)
+{
+	size_t i;
+
+	for (i = 0; i < evict_len; i += 64)
+		evict_buf[i]++;
+}
+
+static double time_passes(const bench_t *b, const row_t **selected, unsigned num_selected, unsigned long passes)
+{
+	unsigned long sum = 0;
+	unsigned long pass;
+	unsigned i;
+	double start = now();
+
+	for (pass = 0; pass < passes; pass++)
+		for (i = 0; i < num_selected; i++)
+			sum += b->run(selected[i]);
+
+	sink += sum;
+	return now() - start;
+}
+
+static bool run_bench(const bench_t *b, result_t *res)
+{
+	const row_t **selected = malloc(num_rows * sizeof(*selected));
+	double warm[WARM_RUNS], cold[COLD_RUNS];
+	unsigned long passes;
+	unsigned long bytes = 0;
+	unsigned num_selected = 0;
+	unsigned i;
+
+	if (!selected)
+		return false;
+
+	for (i = 0; i < num_rows; i++) {
+		if (b->select(&rows[i])) {
+			selected[num_selected++] = &rows[i];
+			bytes += b->bytes(&rows[i]);
+		}
+	}
+	if (num_selected == 0) {
+		free(selected);
+		return false;
+	}
+
+	/* Enough passes to run for the minimum time, to not measure the clock */
+	for (passes = 1; time_passes(b, selected, num_selected, passes) < min_run_sec; passes *= 2)
+		;
+
+	for (i = 0; i < WARM_RUNS; i++)
+		warm[i] = time_passes(b, selected, num_selected, passes) * 1e9 / ((double)passes * num_selected);
+
+	for (i = 0; i < COLD_RUNS; i++) {
+		evict_cache();
+		cold[i] = time_passes(b, selected, num_selected, 1) * 1e9 / num_selected;
+	}
+
+	snprintf(res->name, sizeof(res->name), "%s", b->name);
+	res->rows = num_selected;
+	res->bytes_per_op = (double)bytes / num_selected;
+	res->warm_ns = minimum(warm, WARM_RUNS);
+	res->cold_ns = median(cold, COLD_RUNS);
+	res->warm_bytes_per_sec = res->bytes_per_op * 1e9 / res->warm_ns;
+	free(selected);
+	return true;
+}
+
+/* Baseline */
+
+#define BASELINE_LINE_FMT "    {\"name\": \"%s\", \"rows\": %u, \"bytes_per_op\": %.1f, \"warm_ns\": %.2f, \"cold_ns\": %.2f, \"warm_bytes_per_sec\": %.0f}"
+#define BASELINE_SCAN_FMT " {\"name\": \"%63[^\"]\", \"rows\": %u, \"bytes_per_op\": %lf, \"warm_ns\": %lf, \"cold_ns\": %lf, \"warm_bytes_per_sec\": %lf}"
+
+static bool write_baseline(const char *filename, const result_t *results, unsigned num_results)
+{
+	FILE *f = fopen(filename, "w");
+	unsigned i;
+
+	if (!f) {
+		fprintf(stderr, "Failed to create '%s': %m\n", filename);
+		return false;
+	}
+
+	fprintf(f, "{\n  \"benchmarks\": [\n");
+	for (i = 0; i < num_results; i++) {
+		fprintf(f, BASELINE_LINE_FMT, results[i].name, results[i].rows, results[i].bytes_per_op, results[i].warm_ns,
+		        results[i].cold_ns, results[i].warm_bytes_per_sec);
+		fprintf(f, "%s\n", i + 1 < num_results ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+	return fclose(f) == 0;
+}
+
+/* Reads back what write_baseline() wrote, one benchmark per line */
+static int read_baseline(const char *filename, result_t *results, unsigned max_results)
+{
+	FILE *f = fopen(filename, "r");
+	char line[512];
+	int num_results = 0;
+
+	if (!f) {
+		fprintf(stderr, "Failed to open '%s': %m\n", filename);
+		return -1;
+	}
+
+	while (num_results < (int)max_results && fgets(line, sizeof(line), f)) {
+		result_t *res = &results[num_results];
+
+		if (sscanf(line, BASELINE_SCAN_FMT, res->name, &res->rows, &res->bytes_per_op, &res->warm_ns, &res->cold_ns,
+		           &res->warm_bytes_per_sec) == 6)
+			num_results++;
+	}
+
+	fclose(f);
+	return num_results;
+}
+
+static double change_pct(double base, double cur)
+{
+	return base > 0 ? (cur - base) * 100 / base : 0;
+}
+
+static unsigned compare_baseline(const result_t *base, unsigned num_base, const result_t *results, unsigned num_results,
+                                 double warm_threshold, double cold_threshold)
+{
+	unsigned regressions = 0;
+	unsigned i, j;
+
+	printf("\n%-32s %10s %10s %8s %10s %10s %8s\n", "vs baseline", "warm base", "warm now", "change", "cold base",
+	       "cold now", "change");
+	for (i = 0; i < num_results; i++) {
+		const result_t *cur = &results[i];
+
+		for (j = 0; j < num_base && strcmp(base[j].name, cur->name) != 0; j++)
+			;
+		if (j == num_base) {
+			printf("%-32s not in the baseline\n", cur->name);
+			continue;
+		}
+
+		const double warm_change = change_pct(base[j].warm_ns, cur->warm_ns);
+		const double cold_change = change_pct(base[j].cold_ns, cur->cold_ns);
+		const bool regressed = warm_change > warm_threshold || cold_change > cold_threshold;
+
+		printf("%-32s %10.2f %10.2f %+7.1f%% %10.2f %10.2f %+7.1f%%%s\n", cur->name, base[j].warm_ns, cur->warm_ns,
+		       warm_change, base[j].cold_ns, cur->cold_ns, cold_change, regressed ? "  REGRESSION" : "");
+		if (base[j].rows != cur->rows)
+			printf("%-32s the baseline had %u rows, now %u\n", "", base[j].rows, cur->rows);
+		regressions += regressed;
+	}
+	return regressions;
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-o baseline.json] [-c baseline.json] [-t warm_pct] [-T cold_pct] [-m min_ms] capture_or_dir...\n", name);
+	fprintf(stderr, "  -o  write the results as a baseline\n");
+	fprintf(stderr, "  -c  compare with a baseline, exit code 2 on a regression\n");
+	fprintf(stderr, "  -t  warm slowdown that is a regression, default 10%%\n");
+	fprintf(stderr, "  -T  cold slowdown that is a regression, default 25%%\n");
+	fprintf(stderr, "  -m  minimum time of a warm run, default 20ms\n");
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	const char *out_file = NULL;
+	const char *compare_file = NULL;
+	double warm_threshold = 10, cold_threshold = 25;
+	result_t results[NUM_BENCHES];
+	result_t base[NUM_BENCHES * 2];
+	unsigned num_results = 0;
+	long cache_size;
+	unsigned i;
+	bool synthetic_smart = true;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:c:t:T:m:")) != -1) {
+		switch (opt) {
+			case 'o': out_file = optarg; break;
+			case 'c': compare_file = optarg; break;
+			case 't': warm_threshold = strtod(optarg, NULL); break;
+			case 'T': cold_threshold = strtod(optarg, NULL); break;
+			case 'm': min_run_sec = strtod(optarg, NULL) / 1000; break;
+			default: return usage(argv[0]);
+		}
+	}
+	if (optind >= argc)
+		return usage(argv[0]);
+
+	for (; optind < argc; optind++)
+		load_path(argv[optind]);
+	for (i = 0; i < num_rows; i++)
+		if (select_ata_smart_read_data(&rows[i]))
+			synthetic_smart = false;
+	if (synthetic_smart)
+		add_synthetic_smart_row();
+
+	cache_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	if (cache_size <= 0)
+		cache_size = 32*1024*1024;
+	evict_len = cache_size * 2 < MAX_EVICT_LEN ? cache_size * 2 : MAX_EVICT_LEN;
+	evict_buf = calloc(1, evict_len);
+	if (!evict_buf) {
+		fprintf(stderr, "Failed to allocate the cache eviction buffer\n");
+		return 1;
+	}
+
+	printf("%u rows loaded%s, evicting %ld KB for the cold runs\n\n", num_rows,
+	       synthetic_smart ? " and a synthetic SMART READ DATA" : "", (long)evict_len / 1024);
+	printf("%-32s %6s %10s %10s %12s\n", "parser", "rows", "warm ns/op", "cold ns/op", "warm MB/s");
+	for (i = 0; i < NUM_BENCHES; i++) {
+		result_t *res = &results[num_results];
+
+		if (!run_bench(&benches[i], res)) {
+			printf("%-32s no rows\n", benches[i].name);
+			continue;
+		}
+		printf("%-32s %6u %10.2f %10.2f %12.1f\n", res->name, res->rows, res->warm_ns, res->cold_ns,
+		       res->warm_bytes_per_sec / 1e6);
+		num_results++;
+	}
+
+	if (out_file && !write_baseline(out_file, results, num_results))
+		return 1;
+
+	if (compare_file) {
+		int num_base = read_baseline(compare_file, base, sizeof(base)/sizeof(base[0]));
+		unsigned regressions;
+
+		if (num_base < 0)
+			return 1;
+		regressions = compare_baseline(base, num_base, results, num_results, warm_threshold, cold_threshold);
+		if (regressions) {
+			printf("\n%u regressions above %.0f%% warm or %.0f%% cold\n", regressions, warm_threshold, cold_threshold);
+			return 2;
+		}
+	}
+
+	return 0;
+}
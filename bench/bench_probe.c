@@ -0,0 +1,127 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Probe a fleet of synthetic block devices one command at a time, then concurrently, and compare to a single device */
+
+#include "scsi_probe.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static scsi_transport_t *block_create(void *ctx)
+{
+	return scsi_transport_block_create(ctx);
+}
+
+static double probe(scsi_probe_config_t *config, const char * const *names, unsigned num_devs, unsigned *num_cmds)
+{
+	scsi_probe_snapshot_t *snapshots = calloc(num_devs, sizeof(*snapshots));
+	double start, elapsed;
+	unsigned i;
+
+	start = now();
+	scsi_probe_run(config, names, num_devs, snapshots);
+	elapsed = now() - start;
+
+	*num_cmds = 0;
+	for (i = 0; i < num_devs; i++) {
+		if (snapshots[i].error || !snapshots[i].capacity_valid)
+			fprintf(stderr, "%s: probe failed\n", names[i]);
+		*num_cmds += snapshots[i].num_responses;
+		scsi_probe_snapshot_free(&snapshots[i]);
+	}
+	free(snapshots);
+	return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	scsi_block_config_t block;
+	scsi_probe_config_t config;
+	unsigned num_devs = 256;
+	unsigned num_threads = 4;
+	char (*names)[32];
+	const char **name_ptrs;
+	double serial, single, fleet;
+	unsigned serial_cmds, single_cmds, fleet_cmds;
+	unsigned i;
+	int opt;
+
+	memset(&block, 0, sizeof(block));
+	block.num_blocks = 1024*1024;
+	block.block_size = 512;
+	block.vendor = "LIBSCSI";
+	block.model = "PROBE TARGET";
+	block.revision = "0001";
+	block.other_latency.latency_us = 200;
+	block.other_latency.jitter_us = 100;
+
+	while ((opt = getopt(argc, argv, "d:t:l:j:")) != -1) {
+		switch (opt) {
+			case 'd': num_devs = strtoul(optarg, NULL, 0); break;
+			case 't': num_threads = strtoul(optarg, NULL, 0); break;
+			case 'l': block.other_latency.latency_us = strtoul(optarg, NULL, 0); break;
+			case 'j': block.other_latency.jitter_us = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "Usage: %s [-d devices] [-t threads] [-l latency_us] [-j jitter_us]\n", argv[0]);
+				return 1;
+		}
+	}
+	if (num_devs == 0)
+		return 1;
+
+	names = calloc(num_devs, sizeof(*names));
+	name_ptrs = calloc(num_devs, sizeof(*name_ptrs));
+	for (i = 0; i < num_devs; i++) {
+		snprintf(names[i], sizeof(names[i]), "PROBE%05u", i);
+		name_ptrs[i] = names[i];
+	}
+
+	memset(&config, 0, sizeof(config));
+	config.transport_create = block_create;
+	config.transport_ctx = &block;
+
+	/* The way collect_raw_data works, one command at a time on one device at a time */
+	config.num_threads = 1;
+	config.max_devs_per_thread = 1;
+	config.max_cmds_per_dev = 1;
+	serial = probe(&config, name_ptrs, num_devs, &serial_cmds);
+
+	config.num_threads = num_threads;
+	config.max_devs_per_thread = 0;
+	config.max_cmds_per_dev = 0;
+	single = probe(&config, name_ptrs, 1, &single_cmds);
+	fleet = probe(&config, name_ptrs, num_devs, &fleet_cmds);
+
+	printf("%u devices, %u commands each, latency %u+%u us\n", num_devs, single_cmds, block.other_latency.latency_us, block.other_latency.jitter_us);
+	printf("serial:        %8.3f s\n", serial);
+	printf("single device: %8.3f s\n", single);
+	printf("fleet:         %8.3f s (%u threads, %.1fx faster than serial)\n", fleet, num_threads, serial / fleet);
+
+	free(names);
+	free(name_ptrs);
+	return serial_cmds == fleet_cmds ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Replay the commands of collect_raw_data captures against the replay transport and parse every response */
+
+#include "scsicmd.h"
+#include "scsi_transport.h"
+#include "cdb_decode.h"
+#include "sense_action.h"
+#include "parse_log_sense.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define MAX_CDBS 4096
+#define BUF_LEN (64*1024)
+
+typedef struct bench_cdb_t {
+	int dev;
+	unsigned char cdb[16];
+	unsigned cdb_len;
+} bench_cdb_t;
+
+static bench_cdb_t cdbs[MAX_CDBS];
+static unsigned num_cdbs;
+static unsigned long parsed_items;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Collect the CDB column of the capture, the replay target has the answers for exactly these */
+static void load_cdbs(int dev, const char *filename)
+{
+	char line[256*1024];
+	FILE *f = fopen(filename, "r");
+
+	if (!f)
+		return;
+
+	while (num_cdbs < MAX_CDBS && fgets(line, sizeof(line), f)) {
+		char *p = strchr(line, ',');
+		unsigned len = 0;
+		unsigned val;
+		int n;
+
+		if (!p)
+			continue;
+		for (p++; len < 16 && *p != ',' && sscanf(p, " %2x%n", &val, &n) == 1; p += n)
+			cdbs[num_cdbs].cdb[len++] = val;
+		if (len == 0 || *p != ',')
+			continue;
+		cdbs[num_cdbs].dev = dev;
+		cdbs[num_cdbs].cdb_len = len;
+		num_cdbs++;
+	}
+
+	fclose(f);
+}
+
+static void parse_response(scsi_cmd_t *cmd)
+{
+	cdb_decoded_t decoded;
+
+	cdb_decode(cmd->cdb, cmd->cdb_len, &decoded);
+
+	if (cmd->sense_len) {
+		sense_info_t info;
+		if (scsi_parse_sense(cmd->sense, cmd->sense_len, &info))
+			parsed_items += sense_info_classify(&info).action;
+		return;
+	}
+
+	switch (decoded.kind) {
+		case CDB_KIND_INQUIRY:
+			if (!(decoded.flags & CDB_FLAG_EVPD)) {
+				int device_type;
+				scsi_vendor_t vendor;
+				scsi_model_t model;
+				scsi_fw_revision_t rev;
+				scsi_serial_t serial;
+				parsed_items += parse_inquiry(cmd->buf, cmd->data_len, &device_type, vendor, model, rev, serial);
+			}
+			break;
+		case CDB_KIND_READ_CAPACITY_16: {
+			uint64_t max_lba;
+			uint32_t block_size;
+			parsed_items += parse_read_capacity_16_simple(cmd->buf, cmd->data_len, &max_lba, &block_size);
+			break;
+		}
+		case CDB_KIND_LOG_SENSE:
+			if (log_sense_is_valid(cmd->buf, cmd->data_len)) {
+				uint8_t *param;
+				for_all_log_sense_params(cmd->buf, cmd->data_len, param)
+					parsed_items++;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-q queue_depth] [-n num_cmds] [-l latency_us] [-j jitter_us] capture.csv...\n", name);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned queue_depth = 32;
+	unsigned long num_cmds = 1000000;
+	scsi_latency_t latency;
+	unsigned long submitted = 0, completed = 0;
+	scsi_transport_t *t;
+	scsi_cmd_t *cmds;
+	unsigned char *bufs;
+	double start, elapsed;
+	unsigned i;
+	int opt;
+
+	memset(&latency, 0, sizeof(latency));
+
+	while ((opt = getopt(argc, argv, "q:n:l:j:")) != -1) {
+		switch (opt) {
+			case 'q': queue_depth = strtoul(optarg, NULL, 0); break;
+			case 'n': num_cmds = strtoul(optarg, NULL, 0); break;
+			case 'l': latency.latency_us = strtoul(optarg, NULL, 0); break;
+			case 'j': latency.jitter_us = strtoul(optarg, NULL, 0); break;
+			default: return usage(argv[0]);
+		}
+	}
+	if (optind >= argc || queue_depth == 0)
+		return usage(argv[0]);
+
+	t = scsi_transport_replay_create(&latency, 1);
+	for (; optind < argc; optind++) {
+		int dev = scsi_transport_open(t, argv[optind]);
+		if (dev < 0) {
+			fprintf(stderr, "Failed to load capture '%s': %s\n", argv[optind], strerror(-dev));
+			continue;
+		}
+		load_cdbs(dev, argv[optind]);
+	}
+	if (num_cdbs == 0) {
+		fprintf(stderr, "No commands in the captures\n");
+		return 1;
+	}
+
+	cmds = calloc(queue_depth, sizeof(*cmds));
+	bufs = malloc((size_t)queue_depth * BUF_LEN);
+
+	start = now();
+	for (i = 0; i < queue_depth && submitted < num_cmds; i++, submitted++) {
+		const bench_cdb_t *c = &cdbs[submitted % num_cdbs];
+		scsi_cmd_init(&cmds[i], c->dev, c->cdb, c->cdb_len, SCSI_DIR_FROM_DEV, bufs + (size_t)i * BUF_LEN, BUF_LEN);
+		scsi_transport_submit(t, &cmds[i]);
+	}
+
+	while (completed < num_cmds) {
+		scsi_cmd_t *done[64];
+		unsigned num_done;
+
+		if (scsi_transport_poll(t, -1) < 0)
+			break;
+
+		while ((num_done = scsi_transport_complete(t, done, 64)) > 0) {
+			for (i = 0; i < num_done; i++) {
+				parse_response(done[i]);
+				completed++;
+
+				/* Reuse the command slot for the next CDB */
+				if (submitted < num_cmds) {
+					const bench_cdb_t *c = &cdbs[submitted % num_cdbs];
+					scsi_cmd_init(done[i], c->dev, c->cdb, c->cdb_len, SCSI_DIR_FROM_DEV, done[i]->buf, BUF_LEN);
+					scsi_transport_submit(t, done[i]);
+					submitted++;
+				}
+			}
+		}
+	}
+	elapsed = now() - start;
+
+	printf("%lu commands, %u distinct, queue depth %u: %.0f commands/s (%lu items parsed)\n",
+	       completed, num_cdbs, queue_depth, completed / elapsed, parsed_items);
+
+	scsi_transport_destroy(t);
+	free(cmds);
+	free(bufs);
+	return 0;
+}
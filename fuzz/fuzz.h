@@ -0,0 +1,34 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_FUZZ_H
+#define LIBSCSICMD_FUZZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The fuzz targets take the raw response of a device, the targets that cover several formats take a selector byte
+ * before it. They produce no output, a bug shows up as a sanitizer report or a crash.
+ *
+ * The parsers take non-const buffers but never write to them, the input is passed to them as is so that the
+ * sanitizers see reads beyond its exact size.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Keeps the results of the parsers alive so that the compiler can't drop the reads */
+extern volatile unsigned long fuzz_sink;
+
+#endif
@@ -0,0 +1,109 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "ata.h"
+#include "ata_parse.h"
+#include "ata_smart.h"
+
+#include <string.h>
+
+#define FUZZ_ATA_SMART_DATA 0
+#define FUZZ_ATA_SMART_THRESH 1
+#define FUZZ_ATA_IDENTIFY 2
+#define FUZZ_ATA_FIX_CHECKSUM 0x80
+
+#define ATA_DATA_LEN 512
+
+static void fuzz_ata_smart_data(const unsigned char *buf)
+{
+	ata_smart_attr_t attrs[MAX_SMART_ATTRS];
+	const smart_table_t *table = smart_table_for_disk(NULL, NULL, NULL);
+	int num_attrs = ata_parse_ata_smart_read_data(buf, attrs, MAX_SMART_ATTRS);
+	int min_temp, max_temp, minutes;
+	int i;
+
+	if (num_attrs < 0)
+		return;
+
+	for (i = 0; i < num_attrs; i++) {
+		const smart_attr_t *attr = smart_attr_for_id(table, attrs[i].id);
+		fuzz_sink += attrs[i].raw + (attr ? attr->type : 0);
+	}
+
+	fuzz_sink += ata_smart_get_temperature(attrs, num_attrs, table, &min_temp, &max_temp);
+	fuzz_sink += ata_smart_get_power_on_hours(attrs, num_attrs, table, &minutes);
+	fuzz_sink += ata_smart_get_num_reallocations(attrs, num_attrs, table);
+	fuzz_sink += ata_smart_get_num_pending_reallocations(attrs, num_attrs, table);
+	fuzz_sink += ata_smart_get_num_crc_errors(attrs, num_attrs, table);
+}
+
+static void fuzz_ata_smart_thresh(const unsigned char *buf)
+{
+	ata_smart_thresh_t thresholds[MAX_SMART_ATTRS];
+	int num_attrs = ata_parse_ata_smart_read_thresh(buf, thresholds, MAX_SMART_ATTRS);
+	int i;
+
+	for (i = 0; i < num_attrs; i++)
+		fuzz_sink += thresholds[i].id + thresholds[i].threshold;
+}
+
+static void fuzz_ata_identify(const unsigned char *buf)
+{
+	/* ata_get_string writes two characters per word and a terminating null */
+	char model[2*(46-27+1)+1];
+	char serial[2*(19-10+1)+1];
+	char fw_rev[2*(26-23+1)+1];
+	const smart_table_t *table;
+
+	ata_get_ata_identify_model(buf, model);
+	ata_get_ata_identify_serial_number(buf, serial);
+	ata_get_ata_identify_fw_rev(buf, fw_rev);
+
+	table = smart_table_for_disk(NULL, model, fw_rev);
+	fuzz_sink += (unsigned long)table + serial[0];
+	fuzz_sink += ata_get_ata_identify_smart_enabled(buf) + ata_get_ata_identify_sense_data_supported(buf);
+	fuzz_sink += ata_get_ata_identify_extended_num_user_addressable_sectors(buf);
+	fuzz_sink += ata_checksum_verify(buf);
+}
+
+/* The first byte selects the buffer type and FUZZ_ATA_FIX_CHECKSUM in it sets a valid checksum so that the fuzzer
+ * doesn't need to find it, the rest is the 512 bytes of the ATA data.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	unsigned char buf[ATA_DATA_LEN];
+
+	if (size != 1 + ATA_DATA_LEN)
+		return 0;
+
+	memcpy(buf, input + 1, ATA_DATA_LEN);
+	if (input[0] & FUZZ_ATA_FIX_CHECKSUM)
+		buf[ATA_DATA_LEN-1] = ata_calc_checksum(buf);
+
+	switch (input[0] & ~FUZZ_ATA_FIX_CHECKSUM) {
+		case FUZZ_ATA_SMART_DATA:
+			fuzz_ata_smart_data(buf);
+			break;
+		case FUZZ_ATA_SMART_THRESH:
+			fuzz_ata_smart_thresh(buf);
+			break;
+		case FUZZ_ATA_IDENTIFY:
+			fuzz_ata_identify(buf);
+			break;
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "parse_read_defect_data.h"
+
+static void fuzz_defect_list(address_desc_format_e fmt, uint8_t *data, unsigned len)
+{
+	const unsigned fmt_len = read_defect_data_fmt_len(fmt);
+
+	if (fmt_len == 0)
+		return;
+
+	for (; len >= fmt_len; data += fmt_len, len -= fmt_len) {
+		switch (fmt) {
+			case ADDRESS_FORMAT_SHORT:
+				fuzz_sink += format_address_short_lba(data);
+				break;
+			case ADDRESS_FORMAT_LONG:
+				fuzz_sink += format_address_long_lba(data);
+				break;
+			case ADDRESS_FORMAT_INDEX_OFFSET:
+				fuzz_sink += format_address_byte_from_index_cylinder(data) + format_address_byte_from_index_head(data) +
+					format_address_byte_from_index_bytes(data);
+				break;
+			case ADDRESS_FORMAT_PHYSICAL:
+				fuzz_sink += format_address_physical_cylinder(data) + format_address_physical_head(data) +
+					format_address_physical_sector(data);
+				break;
+			case ADDRESS_FORMAT_VENDOR:
+				fuzz_sink += get_uint32(data, 0);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+static void fuzz_read_defect_data_10(uint8_t *data, unsigned data_len)
+{
+	if (!read_defect_data_10_hdr_is_valid(data, data_len))
+		return;
+
+	fuzz_sink += read_defect_data_10_is_plist_valid(data) + read_defect_data_10_is_glist_valid(data);
+	fuzz_sink += (unsigned long)read_defect_data_format_to_str(read_defect_data_10_list_format(data));
+
+	if (read_defect_data_10_is_valid(data, data_len))
+		fuzz_defect_list(read_defect_data_10_list_format(data), read_defect_data_10_data(data),
+				safe_len(data, data_len, read_defect_data_10_data(data), read_defect_data_10_len(data)));
+}
+
+static void fuzz_read_defect_data_12(uint8_t *data, unsigned data_len)
+{
+	if (!read_defect_data_12_hdr_is_valid(data, data_len))
+		return;
+
+	fuzz_sink += read_defect_data_12_is_plist_valid(data) + read_defect_data_12_is_glist_valid(data);
+	fuzz_sink += (unsigned long)read_defect_data_format_to_str(read_defect_data_12_list_format(data));
+
+	if (read_defect_data_12_is_valid(data, data_len))
+		fuzz_defect_list(read_defect_data_12_list_format(data), read_defect_data_12_data(data),
+				safe_len(data, data_len, read_defect_data_12_data(data), read_defect_data_12_len(data)));
+}
+
+/* The first byte selects the command, 0 for READ DEFECT DATA 10 and 1 for READ DEFECT DATA 12 */
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	if (size < 1)
+		return 0;
+
+	if (input[0] & 1)
+		fuzz_read_defect_data_12((uint8_t *)input + 1, size - 1);
+	else
+		fuzz_read_defect_data_10((uint8_t *)input + 1, size - 1);
+	return 0;
+}
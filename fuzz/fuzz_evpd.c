@@ -0,0 +1,86 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "parse_extended_inquiry.h"
+
+static void fuzz_simple_inquiry(uint8_t *data, unsigned data_len)
+{
+	int device_type;
+	scsi_vendor_t vendor;
+	scsi_model_t model;
+	scsi_fw_revision_t rev;
+	scsi_serial_t serial;
+
+	if (parse_inquiry(data, data_len, &device_type, vendor, model, rev, serial))
+		fuzz_sink += device_type + vendor[0] + model[0] + rev[0] + serial[0];
+}
+
+static void fuzz_evpd_block_limits(uint8_t *data, unsigned len)
+{
+	fuzz_sink += evpd_block_limits_wsnz(data) + evpd_block_limits_max_compare_and_write_len(data) +
+		evpd_block_limits_opt_transfer_length_granularity(data) + evpd_block_limits_max_transfer_length(data) +
+		evpd_block_limits_opt_transfer_length(data);
+
+	if (len < EVPD_BLOCK_LIMITS_LEN)
+		return;
+
+	fuzz_sink += evpd_block_limits_max_prefetch_length(data) + evpd_block_limits_max_unmap_lba_count(data) +
+		evpd_block_limits_max_unmap_block_descriptor_count(data) + evpd_block_limits_opt_unmap_granularity(data) +
+		evpd_block_limits_max_write_same_length(data);
+	if (evpd_block_limits_unmap_granularity_alignment_valid(data))
+		fuzz_sink += evpd_block_limits_unmap_granularity_alignment(data);
+}
+
+static void fuzz_extended_inquiry(uint8_t *data, unsigned data_len)
+{
+	uint8_t *page_data;
+
+	if (!evpd_is_valid(data, data_len))
+		return;
+
+	fuzz_sink += evpd_peripheral_qualifier(data) + evpd_peripheral_device_type(data);
+	page_data = evpd_page_data(data);
+
+	if (evpd_is_ascii_page(evpd_page_code(data)) && data_len >= EVPD_MIN_LEN + 2) {
+		unsigned ascii_len = safe_len(data, data_len, evpd_ascii_data(page_data), evpd_ascii_len(page_data));
+
+		if (ascii_len)
+			fuzz_sink += evpd_ascii_data(page_data)[ascii_len-1];
+		if (evpd_ascii_post_data_len(page_data, data_len) > 0)
+			fuzz_sink += evpd_ascii_post_data(page_data)[0];
+	} else if (evpd_page_code(data) == EVPD_BLOCK_LIMITS) {
+		const unsigned page_len = evpd_page_len(data) + EVPD_MIN_LEN;
+		const unsigned len = page_len < data_len ? page_len : data_len;
+
+		if (len >= EVPD_BLOCK_LIMITS_SHORT_LEN)
+			fuzz_evpd_block_limits(data, len);
+	}
+}
+
+/* The first byte is the EVPD bit of the INQUIRY, 0 for the standard inquiry data and 1 for a VPD page */
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	if (size < 1)
+		return 0;
+
+	if (input[0] & 1)
+		fuzz_extended_inquiry((uint8_t *)input + 1, size - 1);
+	else
+		fuzz_simple_inquiry((uint8_t *)input + 1, size - 1);
+	return 0;
+}
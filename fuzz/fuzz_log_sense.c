@@ -0,0 +1,146 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "parse_log_sense.h"
+
+static void fuzz_log_sense_param(uint8_t *param)
+{
+	uint8_t *param_data = log_sense_param_data(param);
+	unsigned param_len = log_sense_param_len(param);
+	unsigned i;
+
+	fuzz_sink += log_sense_param_code(param) + log_sense_param_tmc(param);
+
+	switch (log_sense_param_fmt(param)) {
+		case LOG_PARAM_FMT_COUNTER_STOP:
+		case LOG_PARAM_FMT_COUNTER_ROLLOVER:
+			if (param_len <= 8) {
+				uint64_t val = 0;
+				for (i = 0; i < param_len; i++)
+					val = (val << 8) | param_data[i];
+				fuzz_sink += val;
+			}
+			break;
+		case LOG_PARAM_FMT_ASCII:
+			for (i = 0; i < param_len; i++)
+				fuzz_sink += param_data[i];
+			break;
+	}
+}
+
+static void fuzz_log_sense_typed(uint8_t *data, unsigned data_len)
+{
+	log_page_error_counter_t error_counter;
+	log_page_non_medium_error_t non_medium;
+	log_page_temperature_t temperature;
+	log_page_start_stop_cycle_t start_stop;
+	log_page_self_test_results_t self_test;
+	log_page_solid_state_media_t solid_state;
+	log_background_scan_medium_t medium[4];
+	log_page_background_scan_t background_scan = {.medium = medium, .max_medium = 4};
+	log_page_protocol_port_t protocol;
+	log_page_general_statistics_t stats;
+
+	if (log_sense_page_error_counter(data, data_len, &error_counter))
+		fuzz_sink += error_counter.valid + error_counter.counter[LOG_ERROR_COUNTER_UNCORRECTED];
+	if (log_sense_page_non_medium_error(data, data_len, &non_medium))
+		fuzz_sink += non_medium.count;
+	if (log_sense_page_temperature(data, data_len, &temperature))
+		fuzz_sink += temperature.temperature;
+	if (log_sense_page_start_stop_cycle(data, data_len, &start_stop))
+		fuzz_sink += start_stop.accumulated_cycles + start_stop.manufacture_year[0];
+	if (log_sense_page_self_test_results(data, data_len, &self_test) && self_test.num_results)
+		fuzz_sink += self_test.results[self_test.num_results-1].first_failure_lba;
+	if (log_sense_page_solid_state_media(data, data_len, &solid_state))
+		fuzz_sink += solid_state.percentage_used;
+	if (log_sense_page_background_scan(data, data_len, &background_scan) && background_scan.num_medium)
+		fuzz_sink += medium[background_scan.num_medium-1].lba;
+	if (log_sense_page_protocol_port(data, data_len, &protocol) && protocol.num_ports)
+		fuzz_sink += protocol.ports[protocol.num_ports-1].num_phys_decoded;
+	if (log_sense_page_general_statistics(data, data_len, &stats))
+		fuzz_sink += stats.read_commands;
+}
+
+/* A small index to also go through the truncation */
+static void fuzz_log_sense_index(uint8_t *data, unsigned data_len)
+{
+	log_sense_index_entry_t entries[16];
+	const log_sense_index_entry_t *entry;
+	log_sense_index_t idx;
+	log_counter_delta_t deltas[8];
+	uint64_t val;
+	int i, num_deltas;
+
+	log_sense_index_init(&idx, entries, sizeof(entries) / sizeof(entries[0]));
+	if (!log_sense_index_build(&idx, data, data_len))
+		return;
+
+	for_all_log_sense_index_entries(&idx, entry) {
+		uint8_t *param = log_sense_index_find(&idx, entry->param_code);
+
+		if (!param || log_sense_param_code(param) != entry->param_code)
+			__builtin_trap();
+		if (log_sense_index_counter(&idx, entry->param_code, &val))
+			fuzz_sink += val;
+	}
+
+	/* Deltas of the page against itself */
+	num_deltas = log_sense_counter_deltas(&idx, data, data_len, 60, deltas, sizeof(deltas) / sizeof(deltas[0]));
+	for (i = 0; i < num_deltas; i++)
+		fuzz_sink += deltas[i].status + deltas[i].delta;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	uint8_t *data = (uint8_t *)input;
+	unsigned data_len = size;
+	uint8_t asc, ascq, temperature;
+	uint8_t *param;
+
+	if (!log_sense_is_valid(data, data_len))
+		return 0;
+
+	fuzz_log_sense_index(data, data_len);
+
+	fuzz_sink += log_sense_data_saved(data);
+
+	if (log_sense_page_code(data) == 0) {
+		uint8_t supported_page, supported_subpage;
+
+		if (!log_sense_subpage_format(data)) {
+			for_all_log_sense_pg_0_supported_pages(data, data_len, supported_page) {
+				fuzz_sink += supported_page;
+			}
+		} else if (log_sense_subpage_code(data) == 0xFF) {
+			for_all_log_sense_pg_0_supported_subpages(data, data_len, supported_page, supported_subpage) {
+				fuzz_sink += supported_page + supported_subpage;
+			}
+		}
+		return 0;
+	}
+
+	for_all_log_sense_params(data, data_len, param) {
+		fuzz_log_sense_param(param);
+	}
+
+	if (log_sense_page_informational_exceptions(data, data_len, &asc, &ascq, &temperature))
+		fuzz_sink += asc + ascq + temperature;
+	fuzz_log_sense_typed(data, data_len);
+
+	return 0;
+}
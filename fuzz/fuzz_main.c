@@ -0,0 +1,99 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Runs a fuzz target over input files and directories of them when it isn't linked with libFuzzer, to reproduce a
+ * crash or to check the seeds with a plain compiler. Every input is in a buffer of its exact size like libFuzzer does.
+ */
+
+#include "fuzz.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+volatile unsigned long fuzz_sink;
+
+static unsigned long num_inputs;
+
+static void run_file(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	struct stat st;
+	uint8_t *buf;
+
+	if (!f || fstat(fileno(f), &st) < 0) {
+		fprintf(stderr, "Failed to open '%s'\n", filename);
+		if (f)
+			fclose(f);
+		return;
+	}
+
+	buf = malloc(st.st_size ? st.st_size : 1);
+	if (buf && fread(buf, 1, st.st_size, f) == (size_t)st.st_size) {
+		LLVMFuzzerTestOneInput(buf, st.st_size);
+		num_inputs++;
+	} else {
+		fprintf(stderr, "Failed to read '%s'\n", filename);
+	}
+
+	free(buf);
+	fclose(f);
+}
+
+static void run_path(const char *path)
+{
+	struct stat st;
+	struct dirent *entry;
+	DIR *dir;
+
+	if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode)) {
+		run_file(path);
+		return;
+	}
+
+	dir = opendir(path);
+	if (!dir) {
+		fprintf(stderr, "Failed to open directory '%s'\n", path);
+		return;
+	}
+	while ((entry = readdir(dir)) != NULL) {
+		char filename[4096];
+
+		if (entry->d_name[0] == '.')
+			continue;
+		snprintf(filename, sizeof(filename), "%s/%s", path, entry->d_name);
+		run_file(filename);
+	}
+	closedir(dir);
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s input_or_dir...\n", argv[0]);
+		return 1;
+	}
+
+	for (i = 1; i < argc; i++)
+		run_path(argv[i]);
+
+	printf("%lu inputs\n", num_inputs);
+	return 0;
+}
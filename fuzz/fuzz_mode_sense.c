@@ -0,0 +1,93 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "parse_mode_sense.h"
+
+static void fuzz_mode_sense_block_descriptor(uint8_t *data, unsigned data_len)
+{
+	if (data_len != BLOCK_DESCRIPTOR_LENGTH)
+		return;
+	fuzz_sink += block_descriptor_density_code(data) + block_descriptor_num_blocks(data) + block_descriptor_block_length(data);
+}
+
+static void fuzz_mode_sense_page(uint8_t *page, unsigned remaining_len)
+{
+	uint8_t *param = mode_sense_data_param(page);
+	unsigned param_len = safe_len(page, remaining_len, param, mode_sense_data_param_len(page));
+
+	fuzz_sink += mode_sense_data_page_code(page) + mode_sense_data_parameter_saveable(page);
+	if (mode_sense_data_subpage_format(page))
+		fuzz_sink += mode_sense_data_subpage_code(page);
+	if (param_len)
+		fuzz_sink += param[0] + param[param_len-1];
+}
+
+static void fuzz_mode_sense_6(uint8_t *data, unsigned data_len)
+{
+	unsigned remaining_len;
+	uint8_t *page;
+
+	if (data_len < MODE_SENSE_6_MIN_LEN)
+		return;
+
+	fuzz_sink += mode_sense_6_medium_type(data) + mode_sense_6_device_specific_param(data);
+	if (data_len < mode_sense_6_expected_length(data) || !mode_sense_6_is_valid_header(data, data_len))
+		return;
+
+	if (mode_sense_6_block_descriptor_length(data) > 0)
+		fuzz_mode_sense_block_descriptor(mode_sense_6_block_descriptor_data(data),
+				safe_len(data, data_len, mode_sense_6_block_descriptor_data(data), mode_sense_6_block_descriptor_length(data)));
+
+	for_all_mode_sense_6_pages(data, data_len, page, remaining_len) {
+		fuzz_mode_sense_page(page, remaining_len);
+	}
+}
+
+static void fuzz_mode_sense_10(uint8_t *data, unsigned data_len)
+{
+	unsigned remaining_len;
+	uint8_t *page;
+
+	if (data_len < MODE_SENSE_10_MIN_LEN)
+		return;
+
+	fuzz_sink += mode_sense_10_medium_type(data) + mode_sense_10_device_specific_param(data) + mode_sense_10_long_lba(data);
+	if (data_len < mode_sense_10_expected_length(data) || !mode_sense_10_is_valid_header(data, data_len))
+		return;
+
+	if (mode_sense_10_block_descriptor_length(data) > 0)
+		fuzz_mode_sense_block_descriptor(mode_sense_10_block_descriptor_data(data),
+				safe_len(data, data_len, mode_sense_10_block_descriptor_data(data), mode_sense_10_block_descriptor_length(data)));
+
+	for_all_mode_sense_10_pages(data, data_len, page, remaining_len) {
+		fuzz_mode_sense_page(page, remaining_len);
+	}
+}
+
+/* The first byte selects the command, 0 for MODE SENSE 6 and 1 for MODE SENSE 10 */
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	if (size < 1)
+		return 0;
+
+	if (input[0] & 1)
+		fuzz_mode_sense_10((uint8_t *)input + 1, size - 1);
+	else
+		fuzz_mode_sense_6((uint8_t *)input + 1, size - 1);
+	return 0;
+}
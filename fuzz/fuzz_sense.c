@@ -0,0 +1,188 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "ata.h"
+#include "parse_sense.h"
+#include "sense_action.h"
+
+static void fuzz_sense_descriptor(unsigned char *desc)
+{
+	uint64_t u64;
+	uint32_t u32;
+	uint16_t u16;
+	uint8_t u8;
+	bool b1, b2, b3;
+	unsigned len;
+	unsigned char *p;
+	sense_desc_osd_object_t obj;
+	ata_status_t ata;
+	sense_desc_progress_t progress;
+	sense_desc_forwarded_t fwd;
+	sense_desc_direct_access_t da;
+
+	switch (sense_desc_type(desc)) {
+	case SENSE_DESC_INFORMATION:
+		if (sense_desc_information(desc, &u64, &b1))
+			fuzz_sink += u64 + b1;
+		break;
+	case SENSE_DESC_CMD_SPECIFIC:
+		if (sense_desc_cmd_specific(desc, &u64))
+			fuzz_sink += u64;
+		break;
+	case SENSE_DESC_SENSE_KEY_SPECIFIC:
+		p = sense_desc_sense_key_specific(desc);
+		if (p)
+			fuzz_sink += p[0] + p[1] + p[2];
+		break;
+	case SENSE_DESC_FRU:
+		if (sense_desc_fru(desc, &u8))
+			fuzz_sink += u8;
+		break;
+	case SENSE_DESC_STREAM_COMMANDS:
+		if (sense_desc_stream_commands(desc, &b1, &b2, &b3))
+			fuzz_sink += b1 + b2 + b3;
+		break;
+	case SENSE_DESC_BLOCK_COMMANDS:
+		if (sense_desc_block_commands(desc, &b1))
+			fuzz_sink += b1;
+		break;
+	case SENSE_DESC_OSD_OBJECT_IDENTIFICATION:
+		if (sense_desc_osd_object_identification(desc, &obj))
+			fuzz_sink += obj.partition_id + obj.object_id;
+		break;
+	case SENSE_DESC_OSD_RESPONSE_INTEGRITY_CHECK:
+		p = sense_desc_osd_response_integrity_check(desc);
+		if (p)
+			fuzz_sink += p[0] + p[SENSE_DESC_OSD_INTEGRITY_CHECK_LEN-1];
+		break;
+	case SENSE_DESC_OSD_ATTRIBUTE_IDENTIFICATION:
+		for_all_sense_desc_osd_attributes(desc, p) {
+			fuzz_sink += sense_desc_osd_attribute_page(p) + sense_desc_osd_attribute_number(p);
+		}
+		break;
+	case SENSE_DESC_ATA_STATUS_RETURN:
+		if (sense_desc_ata_status(desc, &ata))
+			fuzz_sink += ata.lba + ata.status;
+		break;
+	case SENSE_DESC_PROGRESS_INDICATION:
+		if (sense_desc_progress_indication(desc, &progress))
+			fuzz_sink += progress.progress;
+		break;
+	case SENSE_DESC_USER_DATA_SEGMENT_REFERRAL:
+		fuzz_sink += sense_desc_user_data_segment_referral_not_all_r(desc);
+		for_all_sense_desc_referral_segments(desc, p) {
+			unsigned char *tpg;
+
+			fuzz_sink += sense_desc_referral_segment_first_lba(p) + sense_desc_referral_segment_last_lba(p);
+			for_all_sense_desc_referral_tpgs(p, tpg) {
+				fuzz_sink += sense_desc_referral_tpg_access_state(tpg) + sense_desc_referral_tpg_id(tpg);
+			}
+		}
+		break;
+	case SENSE_DESC_FORWARDED_SENSE_DATA:
+		if (sense_desc_forwarded_sense_data(desc, &fwd)) {
+			sense_info_t info;
+			if (scsi_parse_sense(fwd.sense, fwd.sense_len, &info))
+				fuzz_sink += info.sense_key;
+		}
+		break;
+	case SENSE_DESC_DIRECT_ACCESS_BLOCK_DEVICE:
+		if (sense_desc_direct_access_block_device(desc, &da))
+			fuzz_sink += da.information + da.cmd_specific + (da.sense_key_specific ? da.sense_key_specific[2] : 0);
+		break;
+	case SENSE_DESC_DEVICE_DESIGNATION:
+		p = sense_desc_device_designation(desc, &len);
+		if (p && len)
+			fuzz_sink += p[len-1];
+		break;
+	case SENSE_DESC_MICROCODE_ACTIVATION:
+		if (sense_desc_microcode_activation(desc, &u16))
+			fuzz_sink += u16;
+		break;
+	case SENSE_DESC_VENDOR_UNIQUE_ERROR:
+		if (sense_desc_vendor_unique_error(desc, &u32))
+			fuzz_sink += u32;
+		break;
+	}
+}
+
+static void fuzz_sense_view(unsigned char *sense, int sense_len)
+{
+	sense_view_t view;
+	unsigned char *desc;
+	unsigned char *sks;
+	uint64_t u64;
+	uint32_t u32;
+	uint16_t u16;
+	uint8_t u8;
+	ata_status_t ata;
+	sense_desc_progress_t progress;
+
+	if (!sense_view_init(&view, sense, sense_len))
+		return;
+
+	fuzz_sink += sense_view_key(&view) + sense_view_asc(&view) + sense_view_ascq(&view);
+	if (sense_view_information(&view, &u64))
+		fuzz_sink += u64;
+	if (sense_view_cmd_specific(&view, &u64))
+		fuzz_sink += u64;
+	if (sense_view_fru(&view, &u8))
+		fuzz_sink += u8;
+	if (sense_view_vendor_unique_error(&view, &u32))
+		fuzz_sink += u32;
+	if (sense_view_ata_status(&view, &ata))
+		fuzz_sink += ata.lba;
+	if (sense_view_progress(&view, &u16))
+		fuzz_sink += u16;
+	if (sense_view_progress_indication(&view, &progress))
+		fuzz_sink += progress.progress;
+	fuzz_sink += sense_view_incorrect_len_indicator(&view);
+	sks = sense_view_sense_key_specific(&view);
+	if (sks)
+		fuzz_sink += sks[0] + sks[1] + sks[2];
+
+	for_all_sense_descriptors(&view, desc) {
+		fuzz_sense_descriptor(desc);
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	unsigned char *sense = (unsigned char *)data;
+	sense_info_t info;
+	ata_status_t ata;
+	char buf[64];
+
+	/* The sense buffer of a command is at most 252 bytes */
+	if (size > 255)
+		return 0;
+
+	if (scsi_parse_sense(sense, size, &info)) {
+		sense_decision_t decision = sense_info_classify(&info);
+		fuzz_sink += decision.action + decision.delay_ms;
+		fuzz_sink += (unsigned long)asc_num_to_name_r(info.asc, info.ascq, buf, sizeof(buf));
+		fuzz_sink += (unsigned long)sense_key_to_name(info.sense_key);
+	}
+
+	fuzz_sense_view(sense, size);
+
+	if (ata_status_from_scsi_sense(sense, size, &ata))
+		fuzz_sink += ata.status + ata.error;
+
+	return 0;
+}
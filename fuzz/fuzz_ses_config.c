@@ -0,0 +1,89 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "fuzz.h"
+#include "scsicmd.h"
+#include "parse_receive_diagnostics.h"
+
+static void fuzz_ses_enclosure(uint8_t *data, unsigned data_len)
+{
+	char name[16];
+	uint8_t *vendor_info = ses_config_enclosure_descriptor_vendor_info(data);
+	unsigned vendor_len = safe_len(data, data_len, vendor_info, ses_config_enclosure_descriptor_vendor_len(data));
+
+	fuzz_sink += ses_config_enclosure_descriptor_process_identifier(data) +
+		ses_config_enclosure_descriptor_num_processes(data) +
+		ses_config_enclosure_descriptor_subenclosure_identifier(data) +
+		ses_config_enclosure_descriptor_num_type_descriptors(data) +
+		ses_config_enclosure_descriptor_logical_identifier(data);
+
+	ses_config_enclosure_descriptor_vendor_identifier(data, name, sizeof(name));
+	fuzz_sink += name[0];
+	ses_config_enclosure_descriptor_product_identifier(data, name, sizeof(name));
+	fuzz_sink += name[0];
+	ses_config_enclosure_descriptor_revision_level(data, name, sizeof(name));
+	fuzz_sink += name[0];
+
+	if (vendor_len)
+		fuzz_sink += vendor_info[vendor_len-1];
+}
+
+static void fuzz_ses_config(uint8_t *data, unsigned data_len)
+{
+	unsigned parsed_len = ses_config_sub_enclosure(data) - data;
+	unsigned num_enclosures;
+
+	if (!ses_config_is_valid(data, data_len))
+		return;
+
+	fuzz_sink += ses_config_generation(data);
+
+	for (num_enclosures = ses_config_num_sub_enclosures(data); num_enclosures > 0 && parsed_len < data_len; num_enclosures--) {
+		uint8_t *desc = data + parsed_len;
+
+		if (!ses_config_enclosure_descriptor_is_valid(desc, data_len - parsed_len))
+			break;
+		fuzz_ses_enclosure(desc, data_len - parsed_len);
+		parsed_len += ses_config_enclosure_descriptor_len(desc) + 4;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+	uint8_t *data = (uint8_t *)input;
+	unsigned data_len = size;
+
+	if (!recv_diag_is_valid(data, data_len))
+		return 0;
+
+	fuzz_sink += recv_diag_get_page_code_specific(data);
+
+	switch (recv_diag_get_page_code(data)) {
+		case 0:
+			{
+				uint8_t *pages = recv_diag_data(data);
+				unsigned len = safe_len(data, data_len, pages, recv_diag_get_len(data));
+
+				for (; len > 0; len--, pages++)
+					fuzz_sink += pages[0];
+			}
+			break;
+		case 1:
+			fuzz_ses_config(data, data_len);
+			break;
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Convert the CSV captures of the AFL corpus into binary seeds for the fuzz targets.
+
+Every capture line is split into the raw sense and data buffers and written as a seed of the fuzz target that parses
+it, with the selector byte for the targets that take one. The seed is named by its sha1 so that duplicates collapse.
+
+Usage: make_seeds.py [corpus_dir_or_file...] output_dir
+
+Without an input the corpus is afl/testcase.
+"""
+
+import io
+import sys
+import os
+import csv
+import hashlib
+import binascii
+
+ATA_PASSTHROUGH = (0x85, 0xa1)
+ATA_IDENTIFY = 0xec
+ATA_SMART = 0xb0
+ATA_SMART_READ_DATA = 0xd0
+ATA_SMART_READ_THRESH = 0xd1
+
+def decode_hex(field):
+    field = field.replace(' ', '')
+    if len(field) % 2 != 0:
+        return None
+    try:
+        return bytearray(binascii.unhexlify(field))
+    except (TypeError, ValueError):
+        return None
+
+def ata_command(cdb):
+    if cdb[0] == 0x85 and len(cdb) >= 16:
+        return cdb[14], cdb[4]
+    if cdb[0] == 0xa1 and len(cdb) >= 12:
+        return cdb[9], cdb[3]
+    return None, None
+
+def targets_for(cdb, sense, data):
+    """Yields (target, seed) for the buffers of one capture line"""
+    if sense:
+        yield 'sense', sense
+        return
+    if not data:
+        return
+
+    op = cdb[0]
+    if op == 0x4d:
+        yield 'log_sense', data
+    elif op == 0x1a:
+        yield 'mode_sense', bytearray([0]) + data
+    elif op == 0x5a:
+        yield 'mode_sense', bytearray([1]) + data
+    elif op == 0x12 and len(cdb) >= 6:
+        yield 'evpd', bytearray([cdb[1] & 1]) + data
+    elif op == 0x37:
+        yield 'defect_data', bytearray([0]) + data
+    elif op == 0xb7:
+        yield 'defect_data', bytearray([1]) + data
+    elif op == 0x1c:
+        yield 'ses_config', data
+    elif op in ATA_PASSTHROUGH and len(data) == 512:
+        command, feature = ata_command(cdb)
+        if command == ATA_IDENTIFY:
+            yield 'ata', bytearray([2]) + data
+        elif command == ATA_SMART and feature == ATA_SMART_READ_DATA:
+            yield 'ata', bytearray([0]) + data
+        elif command == ATA_SMART and feature == ATA_SMART_READ_THRESH:
+            yield 'ata', bytearray([1]) + data
+
+def parse_file(filename):
+    # The corpus has lines that AFL mutated into arbitrary bytes, they are dropped by the hex decoding
+    with io.open(filename, encoding='latin-1', newline='') as f:
+        for line in csv.reader(f):
+            if len(line) < 3 or line[0] != '':
+                continue
+            cdb = decode_hex(line[1])
+            sense = decode_hex(line[2])
+            data = decode_hex(line[3]) if len(line) > 3 else bytearray()
+            if not cdb or sense is None or data is None:
+                continue
+            for target, seed in targets_for(cdb, sense, data):
+                yield target, seed
+
+def list_files(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for name in sorted(os.listdir(path)):
+                filename = os.path.join(path, name)
+                if os.path.isfile(filename) and not name.endswith('.py'):
+                    yield filename
+        else:
+            yield path
+
+def main(argv):
+    if len(argv) < 2:
+        argv.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'afl', 'testcase'))
+    inputs = argv[:-1]
+    output_dir = argv[-1]
+
+    counts = {}
+    for filename in list_files(inputs):
+        for target, seed in parse_file(filename):
+            target_dir = os.path.join(output_dir, target)
+            if not os.path.isdir(target_dir):
+                os.makedirs(target_dir)
+            seed_name = os.path.join(target_dir, hashlib.sha1(seed).hexdigest())
+            if os.path.exists(seed_name):
+                continue
+            with open(seed_name, 'wb') as f:
+                f.write(seed)
+            counts[target] = counts.get(target, 0) + 1
+
+    for target in sorted(counts.keys()):
+        print('%s: %d seeds' % (target, counts[target]))
+    return 0
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+    sys.exit(main(sys.argv[1:]))
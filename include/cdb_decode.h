@@ -0,0 +1,109 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_CDB_DECODE_H
+#define LIBSCSICMD_CDB_DECODE_H
+
+#include "scsicmd.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The CDBs that can be decoded, name and opcode */
+#define CDB_KIND_LIST \
+	X(TEST_UNIT_READY,          0x00) \
+	X(INQUIRY,                  0x12) \
+	X(MODE_SENSE_6,             0x1A) \
+	X(RECEIVE_DIAGNOSTICS,      0x1C) \
+	X(SEND_DIAGNOSTICS,         0x1D) \
+	X(READ_CAPACITY_10,         0x25) \
+	X(READ_10,                  0x28) \
+	X(WRITE_10,                 0x2A) \
+	X(READ_DEFECT_DATA_10,      0x37) \
+	X(UNMAP,                    0x42) \
+	X(LOG_SENSE,                0x4D) \
+	X(MODE_SENSE_10,            0x5A) \
+	X(ATA_PASSTHROUGH_16,       0x85) \
+	X(READ_16,                  0x88) \
+	X(WRITE_16,                 0x8A) \
+	X(WRITE_SAME_16,            0x93) \
+	X(READ_CAPACITY_16,         0x9E) \
+	X(ATA_PASSTHROUGH_12,       0xA1) \
+	X(READ_DEFECT_DATA_12,      0xB7)
+
+#undef X
+#define X(name, opcode) CDB_KIND_ ## name,
+typedef enum cdb_kind_e {
+	CDB_KIND_UNKNOWN,
+	CDB_KIND_LIST
+} cdb_kind_e;
+#undef X
+
+/* Number of kinds including CDB_KIND_UNKNOWN, to size arrays indexed by kind */
+#define X(name, opcode) + 1
+enum { CDB_KIND_NUM = 1 CDB_KIND_LIST };
+#undef X
+
+const char *cdb_kind_name(cdb_kind_e kind);
+
+/** The kind of a CDB by its opcode alone, without looking at the rest of the CDB. */
+cdb_kind_e cdb_opcode_kind(uint8_t opcode);
+
+/* Flag bits in cdb_decoded_t.flags, which ones are meaningful depends on the kind */
+#define CDB_FLAG_EVPD      (1<<0) // INQUIRY
+#define CDB_FLAG_PCV       (1<<0) // RECEIVE DIAGNOSTICS
+#define CDB_FLAG_ANCHOR    (1<<0) // UNMAP
+#define CDB_FLAG_NDOB      (1<<0) // WRITE SAME 16
+#define CDB_FLAG_FUA_NV    (1<<1) // READ/WRITE 16
+#define CDB_FLAG_FUA       (1<<3) // READ/WRITE 10/16
+#define CDB_FLAG_DBD       (1<<3) // MODE SENSE 6/10
+#define CDB_FLAG_UNMAP     (1<<3) // WRITE SAME 16
+#define CDB_FLAG_GLIST     (1<<3) // READ DEFECT DATA 10/12
+#define CDB_FLAG_DPO       (1<<4) // READ/WRITE 16
+#define CDB_FLAG_LLBAA     (1<<4) // MODE SENSE 10
+#define CDB_FLAG_PLIST     (1<<4) // READ DEFECT DATA 10/12
+#define CDB_FLAG_WS_ANCHOR (1<<4) // WRITE SAME 16
+
+typedef struct cdb_ata_taskfile_t {
+	uint8_t protocol; // passthrough_protocol_e
+	bool extend;
+	uint8_t flags_2; // OFF_LINE, CK_COND, T_TYPE, T_DIR, BYTE_BLOCK and T_LENGTH as in ata_passthrough_flags_2()
+	uint16_t feature;
+	uint16_t sector_count;
+	uint64_t lba; // 28-bit with the top bits from the device field or 48-bit when extend is set
+	uint8_t device;
+	uint8_t command;
+} cdb_ata_taskfile_t;
+
+typedef struct cdb_decoded_t {
+	uint8_t opcode;
+	uint8_t kind; // cdb_kind_e
+	uint8_t cdb_len;
+	uint8_t flags; // CDB_FLAG_*
+	uint64_t lba;
+	uint32_t transfer_len; // Blocks for READ/WRITE/WRITE SAME, the allocation or parameter list length for the rest
+	uint8_t page_code;
+	uint8_t subpage_code;
+	uint8_t page_control; // page_control_e for LOG SENSE and MODE SENSE, self_test_code_e for SEND DIAGNOSTICS
+	uint8_t format; // address_desc_format_e for READ DEFECT DATA
+	cdb_ata_taskfile_t ata;
+} cdb_decoded_t;
+
+/** Decode a CDB into its fields. Returns false if the opcode is not one of CDB_KIND_LIST or the CDB is shorter than
+ * the command requires, the opcode and kind are always filled.
+ */
+bool cdb_decode(const unsigned char *cdb, unsigned cdb_len, cdb_decoded_t *out);
+
+#endif
@@ -0,0 +1,87 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_CDB_TEMPLATE_H
+#define LIBSCSICMD_CDB_TEMPLATE_H
+
+#include "scsicmd.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+#define CDB_TEMPLATE_CACHE_LINE 64
+
+/* A READ/WRITE CDB that is encoded once and then only has its LBA and transfer length patched for every command.
+ *
+ * The template is padded to 32 bytes and aligned to it so that a template never straddles a cache line, a pool
+ * declared with CDB_TEMPLATE_POOL() holds two templates in every cache line.
+ */
+typedef struct cdb_template_t {
+	unsigned char cdb[16];
+	uint8_t cdb_len;
+	uint8_t lba_offset;
+	uint8_t len_offset;
+	bool long_lba; // 8 byte LBA and 4 byte transfer length, otherwise 4 byte LBA and 2 byte transfer length
+} __attribute__((aligned(32))) cdb_template_t;
+
+/** Declare a cache line aligned pool of count templates. */
+#define CDB_TEMPLATE_POOL(name, count) cdb_template_t name[count] __attribute__((aligned(CDB_TEMPLATE_CACHE_LINE)))
+
+/* Build a template with the semantics of the matching cdb_* function, the LBA and transfer length are left at zero.
+ * All return the CDB length.
+ */
+int cdb_template_read_10(cdb_template_t *tmpl, bool fua);
+int cdb_template_write_10(cdb_template_t *tmpl, bool fua);
+int cdb_template_read_16(cdb_template_t *tmpl, bool fua, bool fua_nv, bool dpo);
+int cdb_template_write_16(cdb_template_t *tmpl, bool dpo, bool fua, bool fua_nv);
+
+/** Copy the template proto into all count entries of the pool. */
+void cdb_template_pool_init(cdb_template_t *pool, unsigned count, const cdb_template_t *proto);
+
+/** Patch the LBA into the template, for a 10 byte CDB the LBA is truncated to 32 bits as cdb_read_10() does. */
+static inline void cdb_template_set_lba(cdb_template_t *tmpl, uint64_t lba)
+{
+	if (tmpl->long_lba) {
+		const uint64_t val = htobe64(lba);
+		memcpy(tmpl->cdb + tmpl->lba_offset, &val, sizeof(val));
+	} else {
+		const uint32_t val = htobe32(lba);
+		memcpy(tmpl->cdb + tmpl->lba_offset, &val, sizeof(val));
+	}
+}
+
+/** Patch the transfer length into the template, for a 10 byte CDB the length is truncated to 16 bits. */
+static inline void cdb_template_set_length(cdb_template_t *tmpl, uint32_t transfer_length_blocks)
+{
+	if (tmpl->long_lba) {
+		const uint32_t val = htobe32(transfer_length_blocks);
+		memcpy(tmpl->cdb + tmpl->len_offset, &val, sizeof(val));
+	} else {
+		const uint16_t val = htobe16(transfer_length_blocks);
+		memcpy(tmpl->cdb + tmpl->len_offset, &val, sizeof(val));
+	}
+}
+
+/** Patch both the LBA and the transfer length, returns the CDB length to submit tmpl->cdb with. */
+static inline int cdb_template_patch(cdb_template_t *tmpl, uint64_t lba, uint32_t transfer_length_blocks)
+{
+	cdb_template_set_lba(tmpl, lba);
+	cdb_template_set_length(tmpl, transfer_length_blocks);
+	return tmpl->cdb_len;
+}
+
+#endif
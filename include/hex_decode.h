@@ -0,0 +1,47 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_HEX_DECODE_H
+#define LIBSCSICMD_HEX_DECODE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Decoder of the hex fields of a collect_raw_data capture, "12 00 00 00 60 00".
+ *
+ * Every byte is two adjacent hex digits, upper or lower case, with any amount of white space (isspace() in the C
+ * locale) between the bytes and around them. Runs of the exact "xx xx xx" form are decoded with SIMD on x86 where the
+ * CPU has it, everything else goes through the scalar code with the same result.
+ */
+
+typedef enum hex_decode_impl_e {
+	HEX_DECODE_SCALAR = 0,
+	HEX_DECODE_SSSE3 = 1,
+	HEX_DECODE_AVX2 = 2,
+	HEX_DECODE_BEST = 3, // The best one the CPU supports
+} hex_decode_impl_e;
+
+/** Decode len chars of str into out, which must have room for len/2 bytes. Returns the number of bytes or -1 on a
+ * char that isn't hex or white space or on a byte that doesn't have two digits.
+ */
+long hex_decode(const char *str, size_t len, unsigned char *out);
+
+/** hex_decode() with a given implementation, for tests and benchmarks. Returns -2 if the CPU doesn't support it. */
+long hex_decode_impl(hex_decode_impl_e impl, const char *str, size_t len, unsigned char *out);
+bool hex_decode_impl_supported(hex_decode_impl_e impl);
+const char *hex_decode_impl_name(hex_decode_impl_e impl);
+
+#endif
@@ -17,7 +17,9 @@
 #ifndef LIBSCSICMD_EXTENDED_INQUIRY_H
 #define LIBSCSICMD_EXTENDED_INQUIRY_H
 
+#include "scsicmd_utils.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 #define EVPD_MIN_LEN 4
 
@@ -69,7 +71,8 @@ static inline uint8_t *evpd_ascii_post_data(uint8_t *evpd_body)
 
 static inline unsigned evpd_ascii_post_data_len(uint8_t *evpd_body, unsigned full_data_len)
 {
-	return full_data_len - EVPD_MIN_LEN - 2 - evpd_ascii_len(evpd_body);
+	const unsigned ascii_end = EVPD_MIN_LEN + 2 + evpd_ascii_len(evpd_body);
+	return full_data_len > ascii_end ? full_data_len - ascii_end : 0;
 }
 
 static inline bool evpd_is_valid(uint8_t *data, unsigned data_len)
@@ -83,4 +86,71 @@ static inline bool evpd_is_valid(uint8_t *data, unsigned data_len)
 	return true;
 }
 
+/* Block Limits VPD page, the accessors take the full page data as returned by the device. Older devices return
+ * only the first 16 bytes, the unmap and write same fields are valid only with EVPD_BLOCK_LIMITS_LEN bytes.
+ */
+#define EVPD_BLOCK_LIMITS 0xB0
+#define EVPD_BLOCK_LIMITS_SHORT_LEN 16
+#define EVPD_BLOCK_LIMITS_LEN 44
+
+static inline bool evpd_block_limits_wsnz(uint8_t *data)
+{
+	return data[4] & 1;
+}
+
+static inline uint8_t evpd_block_limits_max_compare_and_write_len(uint8_t *data)
+{
+	return data[5];
+}
+
+static inline uint16_t evpd_block_limits_opt_transfer_length_granularity(uint8_t *data)
+{
+	return get_uint16(data, 6);
+}
+
+static inline uint32_t evpd_block_limits_max_transfer_length(uint8_t *data)
+{
+	return get_uint32(data, 8);
+}
+
+static inline uint32_t evpd_block_limits_opt_transfer_length(uint8_t *data)
+{
+	return get_uint32(data, 12);
+}
+
+static inline uint32_t evpd_block_limits_max_prefetch_length(uint8_t *data)
+{
+	return get_uint32(data, 16);
+}
+
+static inline uint32_t evpd_block_limits_max_unmap_lba_count(uint8_t *data)
+{
+	return get_uint32(data, 20);
+}
+
+static inline uint32_t evpd_block_limits_max_unmap_block_descriptor_count(uint8_t *data)
+{
+	return get_uint32(data, 24);
+}
+
+static inline uint32_t evpd_block_limits_opt_unmap_granularity(uint8_t *data)
+{
+	return get_uint32(data, 28);
+}
+
+static inline bool evpd_block_limits_unmap_granularity_alignment_valid(uint8_t *data)
+{
+	return data[32] & 0x80;
+}
+
+static inline uint32_t evpd_block_limits_unmap_granularity_alignment(uint8_t *data)
+{
+	return get_uint32(data, 32) & 0x7FFFFFFF;
+}
+
+static inline uint64_t evpd_block_limits_max_write_same_length(uint8_t *data)
+{
+	return get_uint64(data, 36);
+}
+
 #endif
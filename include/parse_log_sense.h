@@ -20,6 +20,7 @@
 #include "scsicmd_utils.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* Log Sense Header decode */
 
@@ -85,10 +86,10 @@ static inline bool log_sense_is_valid(uint8_t *data, unsigned data_len)
 #define LOG_PARAM_TMC_NOT_EQUAL 2
 #define LOG_PARAM_TMC_GREATER 3
 
-#define LOG_PARAM_FMT_COUNTER_STOP 0
+#define LOG_PARAM_FMT_COUNTER_STOP 0 // Bounded data counter, stops at its maximum value
 #define LOG_PARAM_FMT_ASCII 1
-#define LOG_PARAM_FMT_COUNTER_ROLLOVER 2
-#define LOG_PARAM_FMT_BINARY 2
+#define LOG_PARAM_FMT_COUNTER_ROLLOVER 2 // Unbounded data counter, wraps to zero at its maximum value
+#define LOG_PARAM_FMT_BINARY 3
 
 static inline uint16_t log_sense_param_code(uint8_t *param)
 {
@@ -145,12 +146,339 @@ static inline bool log_sense_param_is_valid(uint8_t *data, unsigned data_len, ui
 
 #define for_all_log_sense_pg_0_supported_pages(data, data_len, supported_page) \
 	uint8_t *__tmp; \
-	for (__tmp = log_sense_data(data), supported_page = __tmp[0]; __tmp < log_sense_data_end(data, data_len); __tmp++, supported_page = __tmp[0])
+	for (__tmp = log_sense_data(data); __tmp < log_sense_data_end(data, data_len) && (supported_page = __tmp[0], 1); __tmp++)
 
 #define for_all_log_sense_pg_0_supported_subpages(data, data_len, supported_page, supported_subpage) \
 	uint8_t *__tmp; \
-	for (__tmp = log_sense_data(data), supported_page = __tmp[0], supported_subpage = __tmp[1]; __tmp + 1 < log_sense_data_end(data, data_len); __tmp+=2, supported_page = __tmp[0], supported_subpage = __tmp[1])
+	for (__tmp = log_sense_data(data); __tmp + 1 < log_sense_data_end(data, data_len) && (supported_page = __tmp[0], supported_subpage = __tmp[1], 1); __tmp+=2)
+
+/** Value of a counter parameter of 1 to 8 bytes, returns false for an empty or longer parameter. */
+static inline bool log_sense_param_counter(uint8_t *param, uint64_t *val)
+{
+	uint8_t *data = log_sense_param_data(param);
+	unsigned len = log_sense_param_len(param);
+	uint64_t v = 0;
+
+	if (len == 0 || len > 8)
+		return false;
+	for (; len > 0; len--, data++)
+		v = (v << 8) | data[0];
+	*val = v;
+	return true;
+}
 
 bool log_sense_page_informational_exceptions(uint8_t *page, unsigned page_len, uint8_t *asc, uint8_t *ascq, uint8_t *temperature);
 
+/* Index of the parameters of a log page by parameter code.
+ *
+ * The page is validated and walked once when building, lookups are then a binary search over the entries that
+ * returns the parameter in place, to be used with the log_sense_param_* accessors. The entries are provided by the
+ * caller, a page has at most (65535 / LOG_SENSE_MIN_PARAM_LEN) parameters but most have a few tens. Devices return
+ * the parameters in ascending order of their code, the entries are sorted only if they are not. When a code repeats
+ * the first parameter with it is found. Parameters beyond max_entries are not indexed and are not found, truncated
+ * tells that it happened. An index kept for log_sense_counter_deltas() should be sized for the whole page.
+ */
+typedef struct log_sense_index_entry_t {
+	uint16_t param_code;
+	uint8_t flags;
+	uint8_t len;
+	uint32_t offset; // Of the parameter header from the start of the page
+} log_sense_index_entry_t;
+
+typedef struct log_sense_index_t {
+	uint8_t *page;
+	log_sense_index_entry_t *entries;
+	unsigned max_entries;
+	unsigned num_entries;
+	bool truncated; // The page had more than max_entries parameters, the rest are not indexed
+} log_sense_index_t;
+
+static inline void log_sense_index_init(log_sense_index_t *idx, log_sense_index_entry_t *entries, unsigned max_entries)
+{
+	idx->page = NULL;
+	idx->entries = entries;
+	idx->max_entries = max_entries;
+	idx->num_entries = 0;
+	idx->truncated = false;
+}
+
+/** Index the parameters of the page, returns false if the page is not valid. The page must outlive the index. */
+bool log_sense_index_build(log_sense_index_t *idx, uint8_t *page, unsigned page_len);
+
+/** Returns the entry of the parameter code or NULL if it's not in the page. */
+const log_sense_index_entry_t *log_sense_index_find_entry(const log_sense_index_t *idx, uint16_t param_code);
+
+static inline uint8_t *log_sense_index_param(const log_sense_index_t *idx, const log_sense_index_entry_t *entry)
+{
+	return idx->page + entry->offset;
+}
+
+/** Returns the parameter (its header) of the parameter code or NULL if it's not in the page. */
+static inline uint8_t *log_sense_index_find(const log_sense_index_t *idx, uint16_t param_code)
+{
+	const log_sense_index_entry_t *entry = log_sense_index_find_entry(idx, param_code);
+	return entry ? log_sense_index_param(idx, entry) : NULL;
+}
+
+/** Value of a counter parameter, returns false if it's not in the page or is not a counter of 1 to 8 bytes. */
+static inline bool log_sense_index_counter(const log_sense_index_t *idx, uint16_t param_code, uint64_t *val)
+{
+	uint8_t *param = log_sense_index_find(idx, param_code);
+	return param && log_sense_param_counter(param, val);
+}
+
+#define for_all_log_sense_index_entries(idx, entry) \
+	for (entry = (idx)->entries; entry < (idx)->entries + (idx)->num_entries; entry++)
+
+/* Deltas of the counters between two snapshots of the same log page.
+ *
+ * Only counter parameters (LOG_PARAM_FMT_COUNTER_STOP and LOG_PARAM_FMT_COUNTER_ROLLOVER) of 1 to 8 bytes are
+ * compared, the width of the counter is the length of its parameter. A parameter is matched by its code to the
+ * previous snapshot which is given as an index so that it can be kept from the previous poll.
+ */
+typedef enum log_delta_status_e {
+	LOG_DELTA_OK,         // cur - prev
+	LOG_DELTA_NEW,        // No counter with this code in the previous snapshot, the delta is 0
+	LOG_DELTA_ROLLOVER,   // A rollover counter wrapped at its width, the delta is modulo the width
+	LOG_DELTA_SATURATED,  // A counter-stop counter is at its maximum, the delta is a lower bound
+	LOG_DELTA_RESET,      // The counter was reset (LOG SELECT, power cycle of an unsaved counter or a new width), the delta is cur
+	LOG_DELTA_DISABLED,   // Updates of the counter are disabled (DU), the delta is 0
+	LOG_DELTA_UNKNOWN,    // Not found in the previous snapshot but its index is truncated, the delta is 0
+} log_delta_status_e;
+
+typedef struct log_counter_delta_t {
+	uint16_t param_code;
+	uint8_t status; // log_delta_status_e
+	uint8_t flags; // Parameter flags of the current snapshot
+	uint64_t value; // Current value
+	uint64_t delta;
+	double rate; // delta per second, 0 if the elapsed time is not positive
+} log_counter_delta_t;
+
+/** Compute the deltas of the counters of cur against the indexed previous snapshot of the same page.
+ *
+ * A counter-stop counter that went down was reset. A rollover counter that went down wrapped, unless target save is
+ * disabled (TSD) for it and it then more likely lost its value in a power cycle and is taken as reset. A counter that
+ * changed width is taken as reset as well. When the index of prev is truncated a counter that is not found in it
+ * may still have been in the previous snapshot, it is LOG_DELTA_UNKNOWN and not LOG_DELTA_NEW.
+ *
+ * The deltas are written in the order of the parameters of cur, there are at most
+ * log_sense_data_len(cur) / LOG_SENSE_MIN_PARAM_LEN of them. Returns the number of deltas or -1 if cur is not valid
+ * or is not the page of prev. Counters beyond max_deltas are dropped.
+ */
+int log_sense_counter_deltas(const log_sense_index_t *prev, uint8_t *cur, unsigned cur_len, double elapsed_sec,
+                             log_counter_delta_t *deltas, unsigned max_deltas);
+
+/* Typed decoders of the standard log pages.
+ *
+ * Each decoder validates the page header and fills its struct in a single pass over the parameters, a field is only
+ * set if its bit is set in the valid mask of the struct. The bit of a parameter is LOG_PARAM_BIT() of its code.
+ * A parameter that is too short for its field is ignored. They return false if the page is not valid or is not the
+ * expected page.
+ */
+#define LOG_PARAM_BIT(param_code) (1u << (param_code))
+
+/* Write (0x02), Read (0x03) and Verify (0x05) Error Counter pages */
+#define LOG_PAGE_WRITE_ERROR_COUNTER 0x02
+#define LOG_PAGE_READ_ERROR_COUNTER 0x03
+#define LOG_PAGE_VERIFY_ERROR_COUNTER 0x05
+
+#define LOG_ERROR_COUNTER_CORRECTED_NO_DELAY 0x0000
+#define LOG_ERROR_COUNTER_CORRECTED_DELAY 0x0001
+#define LOG_ERROR_COUNTER_TOTAL_REWRITES 0x0002 // Rereads for read and verify
+#define LOG_ERROR_COUNTER_TOTAL_CORRECTED 0x0003
+#define LOG_ERROR_COUNTER_CORRECTION_ALGORITHM 0x0004
+#define LOG_ERROR_COUNTER_BYTES_PROCESSED 0x0005
+#define LOG_ERROR_COUNTER_UNCORRECTED 0x0006
+#define LOG_ERROR_COUNTER_NUM_PARAMS 7
+
+typedef struct log_page_error_counter_t {
+	uint32_t valid;
+	uint64_t counter[LOG_ERROR_COUNTER_NUM_PARAMS]; // Indexed by the parameter code
+} log_page_error_counter_t;
+
+/** Decode any of the three error counter pages, the page code is in the first byte of the page. */
+bool log_sense_page_error_counter(uint8_t *page, unsigned page_len, log_page_error_counter_t *out);
+
+/* Non-Medium Error page (0x06) */
+#define LOG_PAGE_NON_MEDIUM_ERROR 0x06
+#define LOG_NON_MEDIUM_ERROR_COUNT 0x0000
+
+typedef struct log_page_non_medium_error_t {
+	uint32_t valid;
+	uint64_t count;
+} log_page_non_medium_error_t;
+
+bool log_sense_page_non_medium_error(uint8_t *page, unsigned page_len, log_page_non_medium_error_t *out);
+
+/* Temperature page (0x0D), a temperature of 0xFF means it is not available and is not marked valid */
+#define LOG_PAGE_TEMPERATURE 0x0D
+#define LOG_TEMPERATURE_CURRENT 0x0000
+#define LOG_TEMPERATURE_REFERENCE 0x0001
+#define LOG_TEMPERATURE_INVALID 0xFF
+
+typedef struct log_page_temperature_t {
+	uint32_t valid;
+	uint8_t temperature; // Celsius
+	uint8_t reference_temperature; // Celsius, the maximum for continuous operation
+} log_page_temperature_t;
+
+bool log_sense_page_temperature(uint8_t *page, unsigned page_len, log_page_temperature_t *out);
+
+/* Start-Stop Cycle Counter page (0x0E) */
+#define LOG_PAGE_START_STOP_CYCLE 0x0E
+#define LOG_START_STOP_MANUFACTURE_DATE 0x0001
+#define LOG_START_STOP_ACCOUNTING_DATE 0x0002
+#define LOG_START_STOP_SPECIFIED_CYCLES 0x0003
+#define LOG_START_STOP_ACCUMULATED_CYCLES 0x0004
+#define LOG_START_STOP_SPECIFIED_LOAD_UNLOAD 0x0005
+#define LOG_START_STOP_ACCUMULATED_LOAD_UNLOAD 0x0006
+
+typedef struct log_page_start_stop_cycle_t {
+	uint32_t valid;
+	char manufacture_year[5]; // ASCII, null terminated
+	char manufacture_week[3];
+	char accounting_year[5];
+	char accounting_week[3];
+	uint32_t specified_cycles; // Over the lifetime of the device
+	uint32_t accumulated_cycles;
+	uint32_t specified_load_unload;
+	uint32_t accumulated_load_unload;
+} log_page_start_stop_cycle_t;
+
+bool log_sense_page_start_stop_cycle(uint8_t *page, unsigned page_len, log_page_start_stop_cycle_t *out);
+
+/* Self-Test Results page (0x10), parameters 1 to 20 with the most recent test first */
+#define LOG_PAGE_SELF_TEST_RESULTS 0x10
+#define LOG_SELF_TEST_MAX_RESULTS 20
+#define LOG_SELF_TEST_PARAM_LEN 0x10
+
+typedef struct log_self_test_result_t {
+	uint16_t param_code;
+	uint8_t self_test_code;
+	uint8_t result; // 0 completed without error, 0xF in progress
+	uint8_t number;
+	uint16_t power_on_hours;
+	uint64_t first_failure_lba;
+	uint8_t sense_key;
+	uint8_t asc;
+	uint8_t ascq;
+} log_self_test_result_t;
+
+typedef struct log_page_self_test_results_t {
+	unsigned num_results; // Results in the page order, unused entries of the device are included
+	log_self_test_result_t results[LOG_SELF_TEST_MAX_RESULTS];
+} log_page_self_test_results_t;
+
+bool log_sense_page_self_test_results(uint8_t *page, unsigned page_len, log_page_self_test_results_t *out);
+
+/* Solid State Media page (0x11) */
+#define LOG_PAGE_SOLID_STATE_MEDIA 0x11
+#define LOG_SOLID_STATE_PERCENTAGE_USED 0x0001
+
+typedef struct log_page_solid_state_media_t {
+	uint32_t valid;
+	uint8_t percentage_used; // Of the endurance, can be over 100
+} log_page_solid_state_media_t;
+
+bool log_sense_page_solid_state_media(uint8_t *page, unsigned page_len, log_page_solid_state_media_t *out);
+
+/* Background Scan Results page (0x15), the status parameter and up to 2048 medium scan parameters */
+#define LOG_PAGE_BACKGROUND_SCAN 0x15
+#define LOG_BACKGROUND_SCAN_STATUS 0x0000
+#define LOG_BACKGROUND_SCAN_STATUS_LEN 0x0C
+#define LOG_BACKGROUND_SCAN_MEDIUM_LEN 0x14
+
+typedef struct log_background_scan_medium_t {
+	uint16_t param_code;
+	uint32_t power_on_minutes;
+	uint8_t reassign_status;
+	uint8_t sense_key;
+	uint8_t asc;
+	uint8_t ascq;
+	uint64_t lba;
+} log_background_scan_medium_t;
+
+/** The medium scan array is provided by the caller in medium and max_medium, num_medium is the number filled and
+ * medium_truncated is set if there were more than max_medium of them.
+ */
+typedef struct log_page_background_scan_t {
+	uint32_t valid;
+	uint32_t power_on_minutes;
+	uint8_t status;
+	uint16_t num_scans;
+	uint16_t progress; // In units of 1/65536
+	uint16_t num_medium_scans;
+	log_background_scan_medium_t *medium;
+	unsigned max_medium;
+	unsigned num_medium;
+	bool medium_truncated;
+} log_page_background_scan_t;
+
+bool log_sense_page_background_scan(uint8_t *page, unsigned page_len, log_page_background_scan_t *out);
+
+/* Protocol Specific Port page (0x18) for SAS, a parameter per relative target port with its phys */
+#define LOG_PAGE_PROTOCOL_PORT 0x18
+#define LOG_PROTOCOL_MAX_PORTS 4
+#define LOG_PROTOCOL_MAX_PHYS 4
+#define LOG_PROTOCOL_PORT_HDR_LEN 4
+#define LOG_PROTOCOL_PHY_MIN_LEN 48
+#define LOG_PROTOCOL_ID_SAS 6
+
+typedef struct log_protocol_phy_t {
+	uint8_t phy_id;
+	uint8_t attached_device_type;
+	uint8_t attached_reason;
+	uint8_t reason;
+	uint8_t negotiated_link_rate;
+	uint64_t sas_address;
+	uint64_t attached_sas_address;
+	uint8_t attached_phy_id;
+	uint32_t invalid_dword_count;
+	uint32_t running_disparity_error_count;
+	uint32_t loss_of_dword_sync_count;
+	uint32_t phy_reset_problem_count;
+} log_protocol_phy_t;
+
+typedef struct log_protocol_port_t {
+	uint16_t port_id; // The parameter code, the relative target port identifier
+	uint8_t protocol_id;
+	uint8_t generation;
+	uint8_t num_phys; // As reported, only LOG_PROTOCOL_MAX_PHYS of them are in phys
+	uint8_t num_phys_decoded;
+	log_protocol_phy_t phys[LOG_PROTOCOL_MAX_PHYS];
+} log_protocol_port_t;
+
+typedef struct log_page_protocol_port_t {
+	unsigned num_ports;
+	log_protocol_port_t ports[LOG_PROTOCOL_MAX_PORTS];
+} log_page_protocol_port_t;
+
+/** Only SAS ports are decoded, others are skipped. */
+bool log_sense_page_protocol_port(uint8_t *page, unsigned page_len, log_page_protocol_port_t *out);
+
+/* General Statistics and Performance page (0x19 subpage 0) */
+#define LOG_PAGE_GENERAL_STATISTICS 0x19
+#define LOG_GENERAL_STATISTICS_ACCESS 0x0001
+#define LOG_GENERAL_STATISTICS_IDLE_TIME 0x0002
+#define LOG_GENERAL_STATISTICS_TIME_INTERVAL 0x0003
+#define LOG_GENERAL_STATISTICS_ACCESS_LEN 0x40
+
+typedef struct log_page_general_statistics_t {
+	uint32_t valid;
+	uint64_t read_commands;
+	uint64_t write_commands;
+	uint64_t blocks_received;
+	uint64_t blocks_transmitted;
+	uint64_t read_processing_intervals;
+	uint64_t write_processing_intervals;
+	uint64_t weighted_commands;
+	uint64_t weighted_processing;
+	uint64_t idle_time_intervals;
+	uint32_t time_interval_exponent; // An interval is time_interval_integer * 10^-exponent seconds
+	uint32_t time_interval_integer;
+} log_page_general_statistics_t;
+
+bool log_sense_page_general_statistics(uint8_t *page, unsigned page_len, log_page_general_statistics_t *out);
+
 #endif
@@ -18,6 +18,7 @@
 #define LIBSCSICMD_MODE_SENSE_H
 
 #include "scsicmd_utils.h"
+#include <stddef.h>
 
 /* Mode parameter header for the MODE SENSE 6 */
 #define MODE_SENSE_6_MIN_LEN 4u
@@ -59,7 +60,11 @@ static inline unsigned mode_sense_6_expected_length(uint8_t *data)
 
 static inline unsigned mode_sense_6_mode_data_len(uint8_t *data)
 {
-	return mode_sense_6_expected_length(data) - MODE_SENSE_6_MIN_LEN - mode_sense_6_block_descriptor_length(data);
+	const unsigned header_len = MODE_SENSE_6_MIN_LEN + mode_sense_6_block_descriptor_length(data);
+
+	if (mode_sense_6_expected_length(data) < header_len)
+		return 0;
+	return mode_sense_6_expected_length(data) - header_len;
 }
 
 static inline bool mode_sense_6_is_valid_header(uint8_t *data, unsigned data_len)
@@ -73,7 +78,7 @@ static inline bool mode_sense_6_is_valid_header(uint8_t *data, unsigned data_len
 	{
 		return false;
 	}
-	if (mode_sense_6_data_len(data) < mode_sense_6_block_descriptor_length(data))
+	if (mode_sense_6_expected_length(data) < MODE_SENSE_6_MIN_LEN + mode_sense_6_block_descriptor_length(data))
 		return false;
 	return true;
 }
@@ -127,7 +132,11 @@ static inline unsigned mode_sense_10_expected_length(uint8_t *data)
 
 static inline unsigned mode_sense_10_mode_data_len(uint8_t *data)
 {
-	return mode_sense_10_expected_length(data) - MODE_SENSE_10_MIN_LEN - mode_sense_10_block_descriptor_length(data);
+	const unsigned header_len = MODE_SENSE_10_MIN_LEN + mode_sense_10_block_descriptor_length(data);
+
+	if (mode_sense_10_expected_length(data) < header_len)
+		return 0;
+	return mode_sense_10_expected_length(data) - header_len;
 }
 
 static inline bool mode_sense_10_is_valid_header(uint8_t *data, unsigned data_len)
@@ -141,6 +150,8 @@ static inline bool mode_sense_10_is_valid_header(uint8_t *data, unsigned data_le
 	{
 		return false;
 	}
+	if (mode_sense_10_expected_length(data) < MODE_SENSE_10_MIN_LEN + mode_sense_10_block_descriptor_length(data))
+		return false;
 	return true;
 }
 
@@ -187,7 +198,7 @@ static inline uint8_t mode_sense_data_subpage_code(uint8_t *data)
 
 static inline unsigned mode_sense_data_page_len(uint8_t *data)
 {
-	return mode_sense_data_subpage_format(data) ? 3 + (unsigned)(get_uint16(data, 2)) : 2 + (unsigned)(data[1]);
+	return mode_sense_data_subpage_format(data) ? 4 + (unsigned)(get_uint16(data, 2)) : 2 + (unsigned)(data[1]);
 }
 
 static inline unsigned mode_sense_data_param_len(uint8_t *data)
@@ -215,9 +226,9 @@ static inline bool mode_sense_data_param_is_valid(uint8_t *data, unsigned data_l
 
 
 #define for_all_mode_sense_pages(data, data_len, mode_data, mode_data_len, page, remaining_len) \
-	for (remaining_len = mode_data - data + safe_len(data, data_len, mode_data, mode_data_len), page = mode_data; \
+	for (remaining_len = safe_len(data, data_len, mode_data, mode_data_len), page = mode_data; \
 		 remaining_len >= 3 && mode_sense_data_param_is_valid(page, remaining_len); \
-		 remaining_len += mode_sense_data_param_len(page), page += mode_sense_data_page_len(page))
+		 remaining_len -= mode_sense_data_page_len(page), page += mode_sense_data_page_len(page))
 
 #define for_all_mode_sense_6_pages(data, data_len, page, remaining_len) \
 	for_all_mode_sense_pages(data, data_len, mode_sense_6_mode_data(data), mode_sense_6_mode_data_len(data), page, remaining_len)
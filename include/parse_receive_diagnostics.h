@@ -115,7 +115,7 @@ static inline bool ses_config_enclosure_descriptor_is_valid(uint8_t *data, unsig
 		return false;
 	if (ses_config_enclosure_descriptor_len(data) < 36 ||
 			ses_config_enclosure_descriptor_len(data) > 252 ||
-			ses_config_enclosure_descriptor_len(data) > data_len)
+			ses_config_enclosure_descriptor_len(data) + 4u > data_len)
 	{
 		return false;
 	}
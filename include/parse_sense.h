@@ -0,0 +1,394 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_PARSE_SENSE_H
+#define LIBSCSICMD_PARSE_SENSE_H
+
+#include "scsicmd.h"
+#include "scsicmd_utils.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Zero-copy view over a raw sense buffer, nothing is decoded until a field is asked for */
+
+#define SENSE_FIXED_MIN_LEN 18
+#define SENSE_DESCRIPTOR_MIN_LEN 8
+
+typedef struct sense_view_t {
+	unsigned char *sense;
+	unsigned sense_len; // For descriptor format this is limited to the additional sense length
+	bool is_fixed;
+	bool is_current;
+} sense_view_t;
+
+/** Check the response code and the minimal length of the sense buffer and setup the view over it.
+ * is_fixed and is_current are set whenever the response code is known, even if the buffer is too short.
+ */
+bool sense_view_init(sense_view_t *view, unsigned char *sense, int sense_len);
+
+static inline uint8_t sense_view_key(const sense_view_t *view)
+{
+	return view->is_fixed ? view->sense[2] & 0xF : view->sense[1] & 0xF;
+}
+
+static inline uint8_t sense_view_asc(const sense_view_t *view)
+{
+	return view->is_fixed ? view->sense[12] : view->sense[2];
+}
+
+static inline uint8_t sense_view_ascq(const sense_view_t *view)
+{
+	return view->is_fixed ? view->sense[13] : view->sense[3];
+}
+
+/* Sense descriptors iteration, only descriptor format sense has them */
+#define SENSE_DESC_MIN_LEN 2
+
+#define SENSE_DESC_INFORMATION 0x00
+#define SENSE_DESC_CMD_SPECIFIC 0x01
+#define SENSE_DESC_SENSE_KEY_SPECIFIC 0x02
+#define SENSE_DESC_FRU 0x03
+#define SENSE_DESC_STREAM_COMMANDS 0x04
+#define SENSE_DESC_BLOCK_COMMANDS 0x05
+#define SENSE_DESC_OSD_OBJECT_IDENTIFICATION 0x06
+#define SENSE_DESC_OSD_RESPONSE_INTEGRITY_CHECK 0x07
+#define SENSE_DESC_OSD_ATTRIBUTE_IDENTIFICATION 0x08
+#define SENSE_DESC_ATA_STATUS_RETURN 0x09
+#define SENSE_DESC_PROGRESS_INDICATION 0x0A
+#define SENSE_DESC_USER_DATA_SEGMENT_REFERRAL 0x0B
+#define SENSE_DESC_FORWARDED_SENSE_DATA 0x0C
+#define SENSE_DESC_DIRECT_ACCESS_BLOCK_DEVICE 0x0D
+#define SENSE_DESC_DEVICE_DESIGNATION 0x0E
+#define SENSE_DESC_MICROCODE_ACTIVATION 0x0F
+#define SENSE_DESC_VENDOR_UNIQUE_ERROR 0x80
+
+static inline uint8_t sense_desc_type(unsigned char *desc)
+{
+	return desc[0];
+}
+
+static inline unsigned sense_desc_len(unsigned char *desc)
+{
+	return desc[1];
+}
+
+static inline unsigned char *sense_view_descriptors(const sense_view_t *view)
+{
+	return view->sense + SENSE_DESCRIPTOR_MIN_LEN;
+}
+
+static inline bool sense_desc_is_valid(const sense_view_t *view, unsigned char *desc)
+{
+	if (view->is_fixed)
+		return false;
+
+	const unsigned desc_offset = desc - view->sense;
+	if (desc_offset + SENSE_DESC_MIN_LEN > view->sense_len)
+		return false;
+	if (desc_offset + SENSE_DESC_MIN_LEN + sense_desc_len(desc) > view->sense_len)
+		return false;
+	return true;
+}
+
+#define for_all_sense_descriptors(view, desc) \
+	for (desc = sense_view_descriptors(view); \
+		 sense_desc_is_valid(view, desc); \
+		 desc = desc + SENSE_DESC_MIN_LEN + sense_desc_len(desc))
+
+/** Find the first sense descriptor of the given type, returns NULL if not found or for fixed format sense. */
+unsigned char *sense_view_descriptor(const sense_view_t *view, uint8_t desc_type);
+
+/* Decoders of the individual sense descriptors, they return false if the descriptor has an unexpected length */
+static inline bool sense_desc_information(unsigned char *desc, uint64_t *information, bool *valid)
+{
+	if (desc[1] != 0x0A)
+		return false;
+	*valid = desc[2] & 0x80;
+	*information = get_uint64(desc, 4);
+	return true;
+}
+
+static inline bool sense_desc_cmd_specific(unsigned char *desc, uint64_t *cmd_specific)
+{
+	if (desc[1] != 0x0A)
+		return false;
+	*cmd_specific = get_uint64(desc, 4);
+	return true;
+}
+
+static inline unsigned char *sense_desc_sense_key_specific(unsigned char *desc)
+{
+	if (desc[1] != 0x06)
+		return NULL;
+	return desc + 4;
+}
+
+static inline bool sense_desc_fru(unsigned char *desc, uint8_t *fru_code)
+{
+	if (desc[1] != 0x02)
+		return false;
+	*fru_code = desc[3];
+	return true;
+}
+
+static inline bool sense_desc_stream_commands(unsigned char *desc, bool *filemark, bool *eom, bool *ili)
+{
+	if (desc[1] != 0x02)
+		return false;
+	*filemark = desc[3] & 0x80;
+	*eom = desc[3] & 0x40;
+	*ili = desc[3] & 0x20;
+	return true;
+}
+
+static inline bool sense_desc_block_commands(unsigned char *desc, bool *ili)
+{
+	if (desc[1] != 0x02)
+		return false;
+	*ili = desc[3] & 0x20;
+	return true;
+}
+
+typedef struct sense_desc_osd_object_t {
+	uint32_t not_initiated_functions;
+	uint32_t completed_functions;
+	uint64_t partition_id;
+	uint64_t object_id;
+} sense_desc_osd_object_t;
+
+static inline bool sense_desc_osd_object_identification(unsigned char *desc, sense_desc_osd_object_t *obj)
+{
+	if (desc[1] != 0x1E)
+		return false;
+	obj->not_initiated_functions = get_uint32(desc, 8);
+	obj->completed_functions = get_uint32(desc, 12);
+	obj->partition_id = get_uint64(desc, 16);
+	obj->object_id = get_uint64(desc, 24);
+	return true;
+}
+
+#define SENSE_DESC_OSD_INTEGRITY_CHECK_LEN 32
+
+/** Returns the 32 bytes of the OSD response integrity check value. */
+static inline unsigned char *sense_desc_osd_response_integrity_check(unsigned char *desc)
+{
+	if (desc[1] != 0x22)
+		return NULL;
+	return desc + 4;
+}
+
+/* OSD attribute identification has a list of 8 byte attribute entries */
+#define SENSE_DESC_OSD_ATTRIBUTE_LEN 8
+
+static inline uint32_t sense_desc_osd_attribute_page(unsigned char *attr)
+{
+	return get_uint32(attr, 0);
+}
+
+static inline uint32_t sense_desc_osd_attribute_number(unsigned char *attr)
+{
+	return get_uint32(attr, 4);
+}
+
+#define for_all_sense_desc_osd_attributes(desc, attr) \
+	for (attr = desc + 4; \
+		 attr + SENSE_DESC_OSD_ATTRIBUTE_LEN <= desc + SENSE_DESC_MIN_LEN + sense_desc_len(desc); \
+		 attr += SENSE_DESC_OSD_ATTRIBUTE_LEN)
+
+bool sense_desc_ata_status(unsigned char *desc, ata_status_t *status);
+
+typedef struct sense_desc_progress_t {
+	uint8_t sense_key;
+	uint8_t asc;
+	uint8_t ascq;
+	uint16_t progress; // In units of 1/65536
+} sense_desc_progress_t;
+
+static inline bool sense_desc_progress_indication(unsigned char *desc, sense_desc_progress_t *progress)
+{
+	if (desc[1] != 0x06)
+		return false;
+	progress->sense_key = desc[2] & 0xF;
+	progress->asc = desc[3];
+	progress->ascq = desc[4];
+	progress->progress = get_uint16(desc, 6);
+	return true;
+}
+
+/* User data segment referral has a list of segments, each with a list of target port groups */
+static inline bool sense_desc_user_data_segment_referral_not_all_r(unsigned char *desc)
+{
+	return desc[2] & 1;
+}
+
+#define SENSE_DESC_REFERRAL_SEGMENT_MIN_LEN 20
+#define SENSE_DESC_REFERRAL_TPG_LEN 4
+
+static inline uint8_t sense_desc_referral_segment_num_tpg(unsigned char *segment)
+{
+	return segment[3];
+}
+
+static inline uint64_t sense_desc_referral_segment_first_lba(unsigned char *segment)
+{
+	return get_uint64(segment, 4);
+}
+
+static inline uint64_t sense_desc_referral_segment_last_lba(unsigned char *segment)
+{
+	return get_uint64(segment, 12);
+}
+
+static inline unsigned sense_desc_referral_segment_len(unsigned char *segment)
+{
+	return SENSE_DESC_REFERRAL_SEGMENT_MIN_LEN + SENSE_DESC_REFERRAL_TPG_LEN * sense_desc_referral_segment_num_tpg(segment);
+}
+
+static inline bool sense_desc_referral_segment_is_valid(unsigned char *desc, unsigned char *segment)
+{
+	unsigned char *desc_end = desc + SENSE_DESC_MIN_LEN + sense_desc_len(desc);
+
+	if (segment + SENSE_DESC_REFERRAL_SEGMENT_MIN_LEN > desc_end)
+		return false;
+	if (segment + sense_desc_referral_segment_len(segment) > desc_end)
+		return false;
+	return true;
+}
+
+static inline uint8_t sense_desc_referral_tpg_access_state(unsigned char *tpg)
+{
+	return tpg[0] & 0xF;
+}
+
+static inline uint16_t sense_desc_referral_tpg_id(unsigned char *tpg)
+{
+	return get_uint16(tpg, 2);
+}
+
+#define for_all_sense_desc_referral_segments(desc, segment) \
+	for (segment = desc + 4; \
+		 sense_desc_referral_segment_is_valid(desc, segment); \
+		 segment += sense_desc_referral_segment_len(segment))
+
+#define for_all_sense_desc_referral_tpgs(segment, tpg) \
+	for (tpg = segment + SENSE_DESC_REFERRAL_SEGMENT_MIN_LEN; \
+		 tpg < segment + sense_desc_referral_segment_len(segment); \
+		 tpg += SENSE_DESC_REFERRAL_TPG_LEN)
+
+typedef struct sense_desc_forwarded_t {
+	bool fsdt; // Forwarded sense data truncated
+	uint8_t sense_data_source;
+	uint8_t status;
+	unsigned char *sense;
+	unsigned sense_len;
+} sense_desc_forwarded_t;
+
+static inline bool sense_desc_forwarded_sense_data(unsigned char *desc, sense_desc_forwarded_t *fwd)
+{
+	if (desc[1] < 2)
+		return false;
+	fwd->fsdt = desc[2] & 0x80;
+	fwd->sense_data_source = desc[2] & 0xF;
+	fwd->status = desc[3];
+	fwd->sense = desc + 4;
+	fwd->sense_len = desc[1] - 2;
+	return true;
+}
+
+typedef struct sense_desc_direct_access_t {
+	bool information_valid;
+	bool ili;
+	unsigned char *sense_key_specific; // NULL when the SKSV bit is not set
+	uint8_t fru_code;
+	uint64_t information;
+	uint64_t cmd_specific;
+} sense_desc_direct_access_t;
+
+static inline bool sense_desc_direct_access_block_device(unsigned char *desc, sense_desc_direct_access_t *da)
+{
+	if (desc[1] != 0x1E)
+		return false;
+	da->information_valid = desc[2] & 0x80;
+	da->ili = desc[2] & 0x20;
+	da->sense_key_specific = (desc[4] & 0x80) ? desc + 4 : NULL;
+	da->fru_code = desc[7];
+	da->information = get_uint64(desc, 8);
+	da->cmd_specific = get_uint64(desc, 16);
+	return true;
+}
+
+/** Returns the designation descriptor (in the format of the device identification VPD page) and its length. */
+static inline unsigned char *sense_desc_device_designation(unsigned char *desc, unsigned *designation_len)
+{
+	if (desc[1] < 2)
+		return NULL;
+	*designation_len = desc[1] - 2;
+	return desc + 4;
+}
+
+static inline bool sense_desc_microcode_activation(unsigned char *desc, uint16_t *activation_time)
+{
+	if (desc[1] != 0x06)
+		return false;
+	*activation_time = get_uint16(desc, 6);
+	return true;
+}
+
+static inline bool sense_desc_vendor_unique_error(unsigned char *desc, uint32_t *error)
+{
+	if (desc[1] != 0x02)
+		return false;
+	*error = get_uint16(desc, 2);
+	return true;
+}
+
+/* Field accessors, each returns whether the field exists in the sense data */
+bool sense_view_information(const sense_view_t *view, uint64_t *information);
+bool sense_view_cmd_specific(const sense_view_t *view, uint64_t *cmd_specific);
+bool sense_view_fru(const sense_view_t *view, uint8_t *fru_code);
+bool sense_view_incorrect_len_indicator(const sense_view_t *view);
+bool sense_view_vendor_unique_error(const sense_view_t *view, uint32_t *error);
+bool sense_view_ata_status(const sense_view_t *view, ata_status_t *status);
+
+/** Return the three sense key specific bytes if they exist and are marked valid (SKSV), NULL otherwise. */
+unsigned char *sense_view_sense_key_specific(const sense_view_t *view);
+
+/** The progress indication of a NOT READY or NO SENSE in units of 1/65536, returns false if there is none. */
+static inline bool sense_view_progress(const sense_view_t *view, uint16_t *progress)
+{
+	const uint8_t sense_key = sense_view_key(view);
+	unsigned char *sks;
+
+	if (sense_key != SENSE_KEY_NOT_READY && sense_key != SENSE_KEY_NO_SENSE)
+		return false;
+
+	sks = sense_view_sense_key_specific(view);
+	if (!sks)
+		return false;
+
+	*progress = get_uint16(sks, 1);
+	return true;
+}
+
+/** The progress of another operation reported with a progress indication descriptor, returns false if there is none. */
+static inline bool sense_view_progress_indication(const sense_view_t *view, sense_desc_progress_t *progress)
+{
+	unsigned char *desc = sense_view_descriptor(view, SENSE_DESC_PROGRESS_INDICATION);
+	return desc && sense_desc_progress_indication(desc, progress);
+}
+
+#endif
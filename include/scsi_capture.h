@@ -0,0 +1,111 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_CAPTURE_H
+#define LIBSCSICMD_SCSI_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Binary capture of SCSI commands and their responses, the compact form of the collect_raw_data CSV.
+ *
+ * All the fields are big endian like in SCSI. The file is a header, the records and, once the writer is closed, a
+ * table of device names, an index and a trailer:
+ *
+ *   header:  "SCSICAP\0", u16 version, u16 header length, u32 reserved
+ *   record:  u32 record length, u16 device, u8 cdb length, u8 sense length, u32 data length, u8 status,
+ *            u8 host status, u16 driver status, u64 start time in ns since the epoch, u32 duration in us,
+ *            u32 reserved, then the cdb, sense and data bytes and zero padding to a multiple of 8 bytes
+ *   devices: per device u16 name length and the name, zero padding to a multiple of 8 bytes
+ *   index:   per record u64 key and u64 record offset, sorted by key and then offset, the key is
+ *            opcode << 56 | page << 40 | subpage << 32 | device << 16
+ *   trailer: "SCSICIDX", u64 devices offset, u64 index offset, u32 number of devices, u32 number of index entries
+ *
+ * A capture that was cut short has no trailer, its records can still be read in order but lookups scan them all.
+ */
+
+#define SCSI_CAPTURE_VERSION 1
+#define SCSI_CAPTURE_NO_PAGE 0xFFFF // Index page of commands without a page code
+#define SCSI_CAPTURE_ANY -1
+
+typedef struct scsi_capture_record_t {
+	uint16_t dev;
+	uint8_t status;
+	uint8_t host_status;
+	uint16_t driver_status;
+	uint64_t start_ns;
+	uint32_t duration_us;
+	uint8_t cdb_len;
+	uint8_t sense_len;
+	uint32_t data_len;
+	/* Point into the mapped file when read, the pages are private so writing to them doesn't change the file */
+	unsigned char *cdb;
+	unsigned char *sense;
+	unsigned char *data;
+} scsi_capture_record_t;
+
+/** Index page and subpage of a CDB: the page code of INQUIRY with EVPD, LOG SENSE, MODE SENSE and RECEIVE
+ * DIAGNOSTICS with PCV, SCSI_CAPTURE_NO_PAGE for everything else. The subpage is zero where there is none.
+ */
+void scsi_capture_cdb_key(const unsigned char *cdb, unsigned cdb_len, uint16_t *page, uint8_t *subpage);
+
+/* Writer */
+typedef struct scsi_capture_writer_t scsi_capture_writer_t;
+
+/** Create or truncate the file, returns NULL with errno set on failure. */
+scsi_capture_writer_t *scsi_capture_writer_create(const char *filename);
+/** Add a device, returns its number for the records or -errno. */
+int scsi_capture_writer_add_dev(scsi_capture_writer_t *w, const char *name);
+int scsi_capture_write(scsi_capture_writer_t *w, const scsi_capture_record_t *rec);
+/** Write the devices, index and trailer and free the writer, returns 0 or -errno. */
+int scsi_capture_writer_close(scsi_capture_writer_t *w);
+
+/* Reader */
+typedef struct scsi_capture_t scsi_capture_t;
+
+/** Map a capture, returns NULL with errno set on failure, EINVAL if it's not a capture of a known version. */
+scsi_capture_t *scsi_capture_open(const char *filename);
+void scsi_capture_close(scsi_capture_t *c);
+
+/** False when the capture was cut short, lookups then scan and the device names are unknown. */
+bool scsi_capture_has_index(const scsi_capture_t *c);
+unsigned scsi_capture_num_devs(const scsi_capture_t *c);
+/** Name of the device, NULL if unknown. */
+const char *scsi_capture_dev_name(const scsi_capture_t *c, unsigned dev);
+
+/* Fields to match, SCSI_CAPTURE_ANY matches everything */
+typedef struct scsi_capture_query_t {
+	int opcode;
+	int page;
+	int subpage;
+	int dev;
+} scsi_capture_query_t;
+
+typedef struct scsi_capture_iter_t {
+	scsi_capture_query_t query;
+	bool use_index;
+	uint64_t pos; // Index entry or record offset
+	uint64_t end;
+} scsi_capture_iter_t;
+
+/** Start iterating over the records that match the query, NULL is all of them. With a query on the opcode and an index
+ * the matching records come grouped by page, subpage and device and in file order within a group, otherwise in file
+ * order.
+ */
+void scsi_capture_iter_init(const scsi_capture_t *c, scsi_capture_iter_t *it, const scsi_capture_query_t *query);
+bool scsi_capture_iter_next(const scsi_capture_t *c, scsi_capture_iter_t *it, scsi_capture_record_t *rec);
+
+#endif
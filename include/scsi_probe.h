@@ -0,0 +1,109 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_PROBE_H
+#define LIBSCSICMD_SCSI_PROBE_H
+
+#include "scsicmd.h"
+#include "scsi_transport.h"
+
+/* Inventory probe of many devices at once.
+ *
+ * Every device gets a graph of commands where the response of one command decides the next ones, e.g. the supported
+ * log pages list decides which log pages are read. Independent commands of a device are in flight together and the
+ * devices are spread over worker threads that each drive their own transport, an idle worker steals devices that
+ * were not started yet from the others. A sweep takes about as long as the slowest device.
+ */
+
+/* Groups of commands to send, the standard INQUIRY is always sent */
+#define SCSI_PROBE_CAPACITY    (1<<0) // READ CAPACITY 10 and 16
+#define SCSI_PROBE_EVPD        (1<<1) // Supported VPD pages and every page listed
+#define SCSI_PROBE_LOG_SENSE   (1<<2) // Supported log pages and subpages and every one listed
+#define SCSI_PROBE_MODE_SENSE  (1<<3) // All current mode pages with MODE SENSE 10 and 6
+#define SCSI_PROBE_DIAGNOSTICS (1<<4) // Supported diagnostic pages and every page listed
+#define SCSI_PROBE_DEFECTS     (1<<5) // Size of the grown defect list
+#define SCSI_PROBE_ATA         (1<<6) // ATA IDENTIFY, CHECK POWER MODE and SMART for devices behind a SAT
+#define SCSI_PROBE_ALL         0x7F
+
+/* A command sent to the device and its response */
+typedef struct scsi_probe_response_t {
+	unsigned char cdb[SCSI_CMD_MAX_CDB_LEN];
+	uint8_t cdb_len;
+	uint8_t status;
+	uint8_t sense_len;
+	int error; // -errno when the command didn't reach the device
+	unsigned char sense[SCSI_CMD_MAX_SENSE_LEN];
+	unsigned data_len;
+	unsigned char *data;
+} scsi_probe_response_t;
+
+typedef struct scsi_probe_snapshot_t {
+	const char *name;
+	int error; // -errno if the device couldn't be opened, -ECANCELED if no worker could probe it
+
+	bool inquiry_valid;
+	int device_type;
+	scsi_vendor_t vendor;
+	scsi_model_t model;
+	scsi_fw_revision_t rev;
+	scsi_serial_t serial;
+	bool is_ata;
+
+	bool capacity_valid;
+	uint64_t max_lba;
+	uint32_t block_size;
+
+	bool ie_valid; // From the informational exceptions log page
+	uint8_t ie_asc;
+	uint8_t ie_ascq;
+	uint8_t temperature;
+
+	bool grown_defects_valid;
+	uint32_t grown_defects;
+
+	/* Every command in the order of the probe graph, the same for every run regardless of the completion order */
+	scsi_probe_response_t *responses;
+	unsigned num_responses;
+} scsi_probe_snapshot_t;
+
+typedef struct scsi_probe_config_t {
+	unsigned num_threads; // Zero is one thread
+	unsigned max_devs_per_thread; // Devices a worker probes together, zero is 64
+	unsigned max_cmds_per_dev; // Commands in flight to one device, zero is 4
+	unsigned steps; // SCSI_PROBE_* bits, zero is SCSI_PROBE_ALL
+
+	/** Called by each worker thread to make its own transport, device names are opened on it. At most
+	 * max_devs_per_thread of them are open at the same time.
+	 */
+	scsi_transport_t *(*transport_create)(void *ctx);
+	void *transport_ctx;
+
+	/* Optional, every worker transport is attached to it. Device handles are per worker transport and a worker closes
+	 * a device once it is probed, its handle then goes to the next device, so the per device stats are by handle and
+	 * not by name.
+	 */
+	struct scsi_stats_t *stats;
+} scsi_probe_config_t;
+
+/** Probe the named devices, snapshots[i] gets the result of names[i] and must be freed with
+ * scsi_probe_snapshot_free(). Returns 0 or -errno if the run couldn't start.
+ */
+int scsi_probe_run(const scsi_probe_config_t *config, const char * const *names, unsigned num_names,
+                   scsi_probe_snapshot_t *snapshots);
+
+void scsi_probe_snapshot_free(scsi_probe_snapshot_t *snapshot);
+
+#endif
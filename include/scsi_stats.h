@@ -0,0 +1,100 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_STATS_H
+#define LIBSCSICMD_SCSI_STATS_H
+
+#include "scsi_transport.h"
+#include "cdb_decode.h"
+#include <stdio.h>
+
+/* Latency histograms and outcome counters of the commands that go through a transport.
+ *
+ * Every transport attached to the stats writes to its own shard with plain relaxed stores, a transport is driven by
+ * one thread at a time so there is no contention and no atomic read-modify-write. A snapshot sums all the shards and
+ * can be taken at any time from any thread.
+ *
+ * Latencies are in nanoseconds in log buckets: values below 2^SCSI_STATS_SUB_BITS have a bucket each and every power
+ * of two above is split into 2^SCSI_STATS_SUB_BITS buckets, a relative error of at most 12.5%. The last bucket also
+ * takes everything longer than about 17 seconds.
+ */
+
+#define SCSI_STATS_SUB_BITS 3
+#define SCSI_STATS_NUM_BUCKETS 256
+
+typedef struct scsi_stats_hist_t {
+	uint64_t count;
+	uint64_t sum_ns;
+	uint64_t max_ns;
+	uint64_t buckets[SCSI_STATS_NUM_BUCKETS];
+} scsi_stats_hist_t;
+
+/* Counters of a device or of a command kind */
+typedef struct scsi_stats_class_t {
+	scsi_stats_hist_t latency;
+	uint64_t errors; // The command didn't reach the device
+	uint64_t check_conditions;
+	uint64_t bytes;
+} scsi_stats_class_t;
+
+typedef struct scsi_stats_outcome_t {
+	uint64_t commands;
+	uint64_t errors;
+	uint64_t status[32]; // By status >> 1, the SCSI status codes are all even
+	uint64_t sense_keys[16]; // From scsi_parse_sense() of every CHECK CONDITION
+	uint64_t sense_unparsed;
+	uint64_t host_status[32]; // Host status values of 31 and above are in the last entry
+	uint64_t driver_status[16]; // By the low nibble of the driver status
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+} scsi_stats_outcome_t;
+
+typedef struct scsi_stats_snapshot_t {
+	scsi_stats_outcome_t total;
+	scsi_stats_class_t kinds[CDB_KIND_NUM]; // By cdb_opcode_kind()
+	unsigned num_devs;
+	scsi_stats_class_t devs[]; // By device handle
+} scsi_stats_snapshot_t;
+
+typedef struct scsi_stats_t scsi_stats_t;
+
+/** Stats for device handles up to max_devs (commands to higher ones only count in the totals and kinds) and up to
+ * max_transports attached transports.
+ */
+scsi_stats_t *scsi_stats_create(unsigned max_devs, unsigned max_transports);
+void scsi_stats_destroy(scsi_stats_t *stats);
+
+/** Count the commands of the transport from now on. Returns 0 or -ENOSPC if max_transports are already attached.
+ * The stats must outlive the transport.
+ */
+int scsi_transport_attach_stats(scsi_transport_t *t, scsi_stats_t *stats);
+
+/** Sum of all the transports, free() it when done. Returns NULL on allocation failure. */
+scsi_stats_snapshot_t *scsi_stats_snapshot(scsi_stats_t *stats);
+
+/** Upper bound of the bucket that holds the given percentile (0-100) of the samples, 0 if there are none. */
+uint64_t scsi_stats_hist_percentile(const scsi_stats_hist_t *hist, double percentile);
+
+/** Write the snapshot in the Prometheus text exposition format. Devices are labelled by dev_names when given,
+ * otherwise by their handle. Only kinds and devices that had commands are written.
+ */
+void scsi_stats_write_prometheus(const scsi_stats_snapshot_t *snap, const char * const *dev_names, FILE *f);
+
+/* For the transport layer */
+uint64_t scsi_stats_now_ns(void);
+void scsi_stats_record(scsi_stats_snapshot_t *shard, const scsi_cmd_t *cmd, uint64_t now_ns);
+
+#endif
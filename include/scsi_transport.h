@@ -0,0 +1,227 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_TRANSPORT_H
+#define LIBSCSICMD_SCSI_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Asynchronous transport for SCSI commands.
+ *
+ * The caller owns the scsi_cmd_t, fills the request part and submits it. The command belongs to the transport until
+ * it is returned by scsi_transport_complete(), the transport fills the response part before that. Many commands can
+ * be in flight on the same device and across devices, scsi_transport_poll() waits for any of them to finish.
+ */
+
+#define SCSI_CMD_MAX_CDB_LEN 16
+#define SCSI_CMD_MAX_SENSE_LEN 128
+
+#define SCSI_STATUS_GOOD 0x00
+#define SCSI_STATUS_CHECK_CONDITION 0x02
+#define SCSI_STATUS_BUSY 0x08
+#define SCSI_STATUS_TASK_SET_FULL 0x28
+
+typedef enum scsi_dir_e {
+	SCSI_DIR_NONE = 0,
+	SCSI_DIR_FROM_DEV = 1,
+	SCSI_DIR_TO_DEV = 2,
+} scsi_dir_e;
+
+typedef struct scsi_cmd_t {
+	/* Request, filled by the caller */
+	int dev; // Device handle from scsi_transport_open()
+	unsigned char cdb[SCSI_CMD_MAX_CDB_LEN];
+	uint8_t cdb_len;
+	uint8_t dir; // scsi_dir_e
+	unsigned timeout_ms;
+	unsigned char *buf;
+	unsigned buf_len;
+	void *priv; // Left untouched for the caller
+
+	/* Response, filled by the transport */
+	int error; // 0 or -errno when the command didn't reach the device
+	uint8_t status;
+	uint8_t host_status;
+	uint16_t driver_status;
+	uint8_t sense_len;
+	unsigned data_len; // Bytes actually transferred
+	unsigned char sense[SCSI_CMD_MAX_SENSE_LEN];
+
+	/* Private to the transport */
+	uint32_t tag;
+	uint64_t submit_ns; // Only kept when stats are attached
+	struct scsi_cmd_t *next;
+} scsi_cmd_t;
+
+typedef struct scsi_transport_t scsi_transport_t;
+
+typedef enum scsi_latency_dist_e {
+	SCSI_LATENCY_UNIFORM = 0, // latency_us plus a uniform random jitter of up to jitter_us
+	SCSI_LATENCY_EXPONENTIAL = 1, // latency_us plus an exponential random jitter with a mean of jitter_us
+} scsi_latency_dist_e;
+
+/* Latency of a simulated target. On top of the distribution tail_permille of the commands take tail_us longer to
+ * model the slow outliers of real devices.
+ */
+typedef struct scsi_latency_t {
+	uint32_t latency_us;
+	uint32_t jitter_us;
+	uint8_t dist; // scsi_latency_dist_e
+	uint16_t tail_permille;
+	uint32_t tail_us;
+} scsi_latency_t;
+
+typedef struct scsi_transport_ops_t {
+	/** Open a device by name, returns a device handle or -errno. */
+	int (*open)(scsi_transport_t *t, const char *name);
+	/** Queue a command, returns 0 or -errno. -EAGAIN means the device queue is full and a completion is needed first. */
+	int (*submit)(scsi_transport_t *t, scsi_cmd_t *cmd);
+	/** Wait up to timeout_ms (-1 is forever) for commands to finish and pass them to scsi_transport_done().
+	 * Returns the number of commands that finished or -errno.
+	 */
+	int (*poll)(scsi_transport_t *t, int timeout_ms);
+	/** Close a device that has no commands in flight, its handle may be given again by a later open. */
+	void (*close)(scsi_transport_t *t, int dev);
+	void (*destroy)(scsi_transport_t *t);
+	/** Optional, see scsi_transport_dev_buffer(). */
+	unsigned char *(*dev_buffer)(scsi_transport_t *t, int dev, unsigned *len);
+} scsi_transport_ops_t;
+
+/* Every backend embeds this as the first member of its own state */
+struct scsi_transport_t {
+	const scsi_transport_ops_t *ops;
+	struct scsi_stats_snapshot_t *stats; // Shard of scsi_transport_attach_stats(), NULL when not counting
+	unsigned in_flight;
+	scsi_cmd_t *done_head;
+	scsi_cmd_t *done_tail;
+};
+
+static inline int scsi_transport_open(scsi_transport_t *t, const char *name)
+{
+	return t->ops->open(t, name);
+}
+
+int scsi_transport_submit(scsi_transport_t *t, scsi_cmd_t *cmd);
+
+static inline int scsi_transport_poll(scsi_transport_t *t, int timeout_ms)
+{
+	return t->ops->poll(t, timeout_ms);
+}
+
+static inline void scsi_transport_close(scsi_transport_t *t, int dev)
+{
+	t->ops->close(t, dev);
+}
+
+/** Return up to max finished commands without waiting, in the order they finished. */
+unsigned scsi_transport_complete(scsi_transport_t *t, scsi_cmd_t **cmds, unsigned max);
+
+static inline void scsi_transport_destroy(scsi_transport_t *t)
+{
+	t->ops->destroy(t);
+}
+
+static inline unsigned scsi_transport_in_flight(scsi_transport_t *t)
+{
+	return t->in_flight;
+}
+
+/** Buffer of the device that the data is transferred into in place, NULL if the backend has none for it. A command with
+ * this exact buffer and buf_len up to len skips the copy between the kernel and the caller, the parsers can run on it
+ * directly once the command completes. Only one command may use it at a time, a second one gets -EBUSY.
+ */
+static inline unsigned char *scsi_transport_dev_buffer(scsi_transport_t *t, int dev, unsigned *len)
+{
+	return t->ops->dev_buffer ? t->ops->dev_buffer(t, dev, len) : NULL;
+}
+
+/** Prepare a command from a CDB built with one of the cdb_* functions. */
+void scsi_cmd_init(scsi_cmd_t *cmd, int dev, const unsigned char *cdb, unsigned cdb_len, scsi_dir_e dir,
+                   unsigned char *buf, unsigned buf_len);
+
+/* For backends */
+void scsi_transport_init(scsi_transport_t *t, const scsi_transport_ops_t *ops);
+/** Hand a finished command back, with its response filled, to be returned by scsi_transport_complete(). */
+void scsi_transport_done(scsi_transport_t *t, scsi_cmd_t *cmd);
+
+/* Backends */
+
+/** Linux sg driver (/dev/sg*) with the v3 asynchronous write/read interface and a single epoll across all the devices.
+ * max_devs limits the number of devices that are open at the same time.
+ */
+scsi_transport_t *scsi_transport_sg_create(unsigned max_devs);
+
+/** As scsi_transport_sg_create() with the reserved buffer of every opened device resized to reserved_size and mapped
+ * with SG_FLAG_MMAP_IO, it is returned by scsi_transport_dev_buffer(). The driver caps the reserved size, by default
+ * to the max_sectors of the host, a device that can't get one keeps working with the caller buffers.
+ */
+scsi_transport_t *scsi_transport_sg_create_mmap(unsigned max_devs, unsigned reserved_size);
+
+/** Simulated target that replays a collect_raw_data capture, every opened name is a capture file that becomes a device.
+ * A CDB is answered with the sense and data recorded for the same CDB bytes, a CDB recorded several times is answered
+ * with each recording in turn and a CDB not in the capture gets ILLEGAL REQUEST. latency may be NULL for none and the
+ * seed makes the jitter repeatable.
+ */
+scsi_transport_t *scsi_transport_replay_create(const scsi_latency_t *latency, uint64_t seed);
+
+/* Synthetic in-memory block device */
+typedef struct scsi_block_config_t {
+	uint64_t num_blocks;
+	uint32_t block_size;
+	unsigned queue_depth; // Commands beyond it get TASK SET FULL, zero is unlimited
+	uint32_t max_transfer_length; // Reported in the Block Limits VPD page and enforced, zero is unlimited
+	uint32_t opt_transfer_length;
+	bool store_data; // Keep the written data, otherwise reads return zeros and writes are dropped
+	scsi_latency_t read_latency;
+	scsi_latency_t write_latency;
+	scsi_latency_t other_latency;
+	const char *vendor;
+	const char *model;
+	const char *revision;
+	uint64_t seed;
+} scsi_block_config_t;
+
+typedef enum scsi_block_fault_e {
+	SCSI_FAULT_LBA_RANGE = 0, // READ and WRITE commands that touch [lba, lba + num_blocks) fail with the sense
+	SCSI_FAULT_AFTER_CMDS = 1, // The command that comes after cmd_count commands to the device fails with the sense
+} scsi_block_fault_e;
+
+typedef struct scsi_block_fault_t {
+	uint8_t type; // scsi_block_fault_e
+	uint8_t sense_key;
+	uint8_t asc;
+	uint8_t ascq;
+	uint64_t lba;
+	uint64_t num_blocks;
+	uint64_t cmd_count;
+	unsigned times; // How many commands get the fault before it is removed, zero is forever
+} scsi_block_fault_t;
+
+/** Simulated block device target, every opened name is a new device with the configuration given here and the name as
+ * its unit serial number. It implements TEST UNIT READY, INQUIRY with the supported pages, unit serial number and
+ * block limits VPD pages, READ CAPACITY 10/16, READ/WRITE 10/16 and LOG SENSE and MODE SENSE 6/10 with synthetic
+ * pages. Everything else gets ILLEGAL REQUEST.
+ */
+scsi_transport_t *scsi_transport_block_create(const scsi_block_config_t *config);
+
+/** Add a fault to a device of a block transport, returns 0 or -errno. LBA range faults of a device may not overlap,
+ * -EEXIST is returned for one that does.
+ */
+int scsi_transport_block_inject(scsi_transport_t *t, int dev, const scsi_block_fault_t *fault);
+
+#endif
@@ -43,6 +43,14 @@ enum sense_key_e {
 const char *sense_key_to_name(enum sense_key_e sense_key);
 const char *asc_num_to_name(uint8_t asc, uint8_t ascq);
 
+/** Buffer size that is large enough for any name returned by asc_num_to_name_r(). */
+#define ASC_NUM_NAME_MAX_LEN 64
+
+/** Reentrant version of asc_num_to_name(), it does no allocation and is safe to call from multiple threads.
+ * The returned pointer is either a constant string or buf when the name needs to be formatted.
+ */
+const char *asc_num_to_name_r(uint8_t asc, uint8_t ascq, char *buf, unsigned buf_len);
+
 int cdb_tur(unsigned char *cdb);
 
 #define SCSI_DEVICE_TYPE_LIST \
@@ -166,6 +174,38 @@ typedef struct sense_info_t {
 } sense_info_t;
 bool scsi_parse_sense(unsigned char *sense, int sense_len, sense_info_t *info);
 
+/* batch sense parser, decodes only the common fields of many sense buffers at once */
+typedef struct sense_buf_t {
+        unsigned char *sense;
+        int sense_len;
+} sense_buf_t;
+
+/* Number of 64-bit words needed for a bitmap of num entries */
+#define SENSE_BATCH_WORDS(num) (((num) + 63) / 64)
+
+/** Structure-of-arrays result of scsi_parse_sense_batch(), all arrays are provided by the caller.
+ * The per-entry arrays need num entries and the bitmaps need SENSE_BATCH_WORDS(num) words.
+ * Entries that are not set in the valid bitmap have all their fields zeroed. The information field is only filled
+ * when it is set in information_valid, with the same value scsi_parse_sense() reports.
+ */
+typedef struct sense_batch_t {
+        uint8_t *sense_key;
+        uint8_t *asc;
+        uint8_t *ascq;
+        uint64_t *information;
+        uint64_t *valid;
+        uint64_t *is_fixed;
+        uint64_t *is_current;
+        uint64_t *information_valid;
+} sense_batch_t;
+
+static inline bool sense_batch_bit(const uint64_t *bitmap, unsigned idx)
+{
+        return bitmap[idx / 64] & (1ULL << (idx % 64));
+}
+
+void scsi_parse_sense_batch(const sense_buf_t *bufs, unsigned num, sense_batch_t *out);
+
 /* inquiry */
 
 /** Build a CDB from the inquiry command.
@@ -198,11 +238,102 @@ static inline bool parse_read_capacity_16_simple(unsigned char *buf, unsigned bu
 }
 
 /* read & write */
+
+/* READ 10 and WRITE 10 take only the low 32 bits of the lba, use cdb_rw_plan() to pick the right CDB size */
 int cdb_read_10(unsigned char *cdb, bool fua, uint64_t lba, uint16_t transfer_length_blocks);
 int cdb_write_10(unsigned char *cdb, bool fua, uint64_t lba, uint16_t transfer_length_blocks);
 int cdb_read_16(unsigned char *cdb, bool fua, bool fua_nv, bool dpo, uint64_t lba, uint32_t transfer_length_blocks);
 int cdb_write_16(unsigned char *cdb, bool dpo, bool fua, bool fua_nv, uint64_t lba, uint32_t transfer_length_blocks);
 
+/** Build count READ 16 / WRITE 16 CDBs into a contiguous array of 16 byte CDBs.
+ * Command i reads transfer_length_blocks blocks from start_lba + i*stride, a stride equal to the transfer length
+ * covers a contiguous range. Returns the number of CDBs built.
+ */
+int cdb_read_16_range(unsigned char *cdbs, bool fua, bool fua_nv, bool dpo, uint64_t start_lba,
+                      uint32_t transfer_length_blocks, unsigned count, uint64_t stride);
+int cdb_write_16_range(unsigned char *cdbs, bool dpo, bool fua, bool fua_nv, uint64_t start_lba,
+                       uint32_t transfer_length_blocks, unsigned count, uint64_t stride);
+
+/* Transfer limits of a device, normally taken from the Block Limits VPD page (0xB0). Lengths are in logical blocks
+ * and zero means there is no limit reported.
+ */
+typedef struct cdb_rw_limits_t {
+	uint32_t max_transfer_length;
+	uint32_t opt_transfer_length;
+	bool no_rw_16; // The device doesn't support READ 16 / WRITE 16
+} cdb_rw_limits_t;
+
+typedef struct cdb_rw_cmd_t {
+	unsigned char cdb[16];
+	int cdb_len;
+	uint64_t lba;
+	uint32_t transfer_length_blocks;
+	uint64_t buf_offset; // Offset in bytes of this command's data in the whole transfer
+} cdb_rw_cmd_t;
+
+/** Plan the READ or WRITE of byte_len bytes starting at lba into the fewest commands.
+ *
+ * Commands are split at the maximum transfer length and, when the device reports one, at multiples of the
+ * optimal transfer length so that all but the first and last command are aligned to it. Every command uses
+ * READ/WRITE 10 when its LBA range and length fit and READ/WRITE 16 otherwise.
+ *
+ * Returns the number of commands needed, only the first max_cmds of them are written to cmds so a return value
+ * larger than max_cmds means cmds was too small. Returns -1 if byte_len is not a whole number of blocks or the
+ * range can't be addressed.
+ */
+int cdb_rw_plan(cdb_rw_cmd_t *cmds, unsigned max_cmds, bool write, bool fua, uint64_t lba, uint64_t byte_len,
+                uint32_t block_size, const cdb_rw_limits_t *limits);
+
+/* unmap & write same */
+int cdb_unmap(unsigned char *cdb, bool anchor, uint8_t group, uint16_t param_len);
+int cdb_write_same_16(unsigned char *cdb, bool anchor, bool unmap, bool ndob, uint64_t lba, uint32_t num_blocks);
+
+#define UNMAP_HEADER_LEN 8
+#define UNMAP_DESC_LEN 16
+#define UNMAP_DESC_MAX_BLOCKS 0xFFFFFFFFULL
+#define UNMAP_MAX_DESCS ((0xFFFF - UNMAP_HEADER_LEN) / UNMAP_DESC_LEN)
+
+typedef struct unmap_extent_t {
+	uint64_t lba;
+	uint64_t num_blocks;
+} unmap_extent_t;
+
+/* UNMAP limits of a device, normally taken from the Block Limits VPD page (0xB0). Zero means no limit and a
+ * granularity of zero or one means every block can be unmapped on its own.
+ */
+typedef struct unmap_limits_t {
+	uint32_t max_lba_count;
+	uint32_t max_descriptor_count;
+	uint32_t granularity;
+	uint32_t granularity_alignment;
+} unmap_limits_t;
+
+/** Sort the extents in place, merge the overlapping and adjacent ones and, if the limits have a granularity, trim
+ * every extent to whole unmap granules. Extents that end up empty are removed, returns the new number of extents.
+ */
+unsigned unmap_extents_normalize(unmap_extent_t *extents, unsigned num, const unmap_limits_t *limits);
+
+typedef struct unmap_cursor_t {
+	const unmap_extent_t *extents;
+	unsigned num;
+	unsigned idx;
+	uint64_t done_blocks; // Blocks of extents[idx] that were already packed
+} unmap_cursor_t;
+
+static inline void unmap_cursor_init(unmap_cursor_t *cursor, const unmap_extent_t *extents, unsigned num)
+{
+	cursor->extents = extents;
+	cursor->num = num;
+	cursor->idx = 0;
+	cursor->done_blocks = 0;
+}
+
+/** Pack the next UNMAP parameter list from the cursor into buf, as many descriptors as the limits and buf_len allow.
+ * The extents should be normalized first. Returns the parameter list length to pass to cdb_unmap() or 0 when all the
+ * extents were packed.
+ */
+unsigned unmap_param_list_next(unmap_cursor_t *cursor, const unmap_limits_t *limits, unsigned char *buf, unsigned buf_len);
+
 /* log sense */
 int cdb_log_sense(unsigned char *cdb, uint8_t page_code, uint8_t subpage_code, uint16_t alloc_len);
 
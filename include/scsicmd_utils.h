@@ -59,7 +59,7 @@ static inline unsigned safe_len(uint8_t *start, unsigned len, uint8_t *subbuf, u
 	if (start_offset < 0 || (unsigned)start_offset > len)
 		return 0;
 
-	if (subbuf_len + start_offset > len)
+	if (subbuf_len > len - start_offset)
 		return len - start_offset;
 	else
 		return subbuf_len;
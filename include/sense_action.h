@@ -0,0 +1,54 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SENSE_ACTION_H
+#define LIBSCSICMD_SENSE_ACTION_H
+
+#include "scsicmd.h"
+#include <stdint.h>
+
+/* What to do with a command that ended with a CHECK CONDITION, see structs/sense-action.txt */
+#define SENSE_ACTION_LIST \
+	X(INFORMATIONAL) \
+	X(RETRY) \
+	X(RETRY_BACKOFF) \
+	X(FAIL) \
+	X(FAILOVER) \
+	X(DEVICE_DEAD)
+
+#undef X
+#define X(name) SENSE_ACTION_ ## name,
+typedef enum sense_action_e {
+	SENSE_ACTION_LIST
+} sense_action_e;
+#undef X
+
+typedef struct sense_decision_t {
+	uint8_t action; // sense_action_e
+	uint16_t delay_ms; // Suggested delay before the action
+} sense_decision_t;
+
+const char *sense_action_name(sense_action_e action);
+
+/** Classify the sense key and ASC/ASCQ into the action to take, this is a table lookup with no branches. */
+sense_decision_t sense_classify(uint8_t sense_key, uint8_t asc, uint8_t ascq);
+
+static inline sense_decision_t sense_info_classify(const sense_info_t *info)
+{
+	return sense_classify(info->sense_key, info->asc, info->ascq);
+}
+
+#endif
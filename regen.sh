@@ -7,3 +7,12 @@ git add src/smartdb/smartdb_gen.c
 
 structs/ata_struct_2_h.py structs/ata_identify.yaml > include/ata_parse.h
 git add include/ata_parse.h
+
+structs/asc-num-to-list < structs/asc-num.txt > include/asc_num_list.h
+git add include/asc_num_list.h
+
+structs/asc-num-to-list --table < structs/asc-num.txt > src/asc_num_table.h
+git add src/asc_num_table.h
+
+structs/sense-action-to-table structs/sense-action.txt structs/asc-num.txt > src/sense_action_table.h
+git add src/sense_action_table.h
@@ -0,0 +1,1163 @@
+/* Generated file, do not edit */
+#ifndef LIBSCSICMD_ASC_NUM_TABLE_H
+#define LIBSCSICMD_ASC_NUM_TABLE_H
+
+#include <stdint.h>
+
+#define ASC_NUM_NONE 0xFFFF
+
+typedef struct asc_num_row {
+	uint16_t first;
+	uint8_t max_ascq;
+	uint16_t keyed;
+} asc_num_row_t;
+
+static const char asc_num_names[25519] =
+	"NO ADDITIONAL SENSE INFORMATION\0"
+	"FILEMARK DETECTED\0"
+	"END-OF-PARTITION/MEDIUM DETECTED\0"
+	"SETMARK DETECTED\0"
+	"BEGINNING-OF-PARTITION/MEDIUM DETECTED\0"
+	"END-OF-DATA DETECTED\0"
+	"I/O PROCESS TERMINATED\0"
+	"PROGRAMMABLE EARLY WARNING DETECTED\0"
+	"AUDIO PLAY OPERATION IN PROGRESS\0"
+	"AUDIO PLAY OPERATION PAUSED\0"
+	"AUDIO PLAY OPERATION SUCCESSFULLY COMPLETED\0"
+	"AUDIO PLAY OPERATION STOPPED DUE TO ERROR\0"
+	"NO CURRENT AUDIO STATUS TO RETURN\0"
+	"OPERATION IN PROGRESS\0"
+	"CLEANING REQUESTED\0"
+	"ERASE OPERATION IN PROGRESS\0"
+	"LOCATE OPERATION IN PROGRESS\0"
+	"REWIND OPERATION IN PROGRESS\0"
+	"SET CAPACITY OPERATION IN PROGRESS\0"
+	"VERIFY OPERATION IN PROGRESS\0"
+	"ATA PASS THROUGH INFORMATION AVAILABLE\0"
+	"CONFLICTING SA CREATION REQUEST\0"
+	"LOGICAL UNIT TRANSITIONING TO ANOTHER POWER CONDITION\0"
+	"EXTENDED COPY INFORMATION AVAILABLE\0"
+	"ATOMIC COMMAND ABORTED DUE TO ACA\0"
+	"NO INDEX/SECTOR SIGNAL\0"
+	"NO SEEK COMPLETE\0"
+	"PERIPHERAL DEVICE WRITE FAULT\0"
+	"NO WRITE CURRENT\0"
+	"EXCESSIVE WRITE ERRORS\0"
+	"LOGICAL UNIT NOT READY, CAUSE NOT REPORTABLE\0"
+	"LOGICAL UNIT IS IN PROCESS OF BECOMING READY\0"
+	"LOGICAL UNIT NOT READY, INITIALIZING COMMAND REQUIRED\0"
+	"LOGICAL UNIT NOT READY, MANUAL INTERVENTION REQUIRED\0"
+	"LOGICAL UNIT NOT READY, FORMAT IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, REBUILD IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, RECALCULATION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, OPERATION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, LONG WRITE IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, SELF-TEST IN PROGRESS\0"
+	"LOGICAL UNIT NOT ACCESSIBLE, ASYMMETRIC ACCESS STATE TRANSITION\0"
+	"LOGICAL UNIT NOT ACCESSIBLE, TARGET PORT IN STANDBY STATE\0"
+	"LOGICAL UNIT NOT ACCESSIBLE, TARGET PORT IN UNAVAILABLE STATE\0"
+	"LOGICAL UNIT NOT READY, STRUCTURE CHECK REQUIRED\0"
+	"LOGICAL UNIT NOT READY, SECURITY SESSION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, AUXILIARY MEMORY NOT ACCESSIBLE\0"
+	"LOGICAL UNIT NOT READY, NOTIFY (ENABLE SPINUP) REQUIRED\0"
+	"LOGICAL UNIT NOT READY, OFFLINE\0"
+	"LOGICAL UNIT NOT READY, SA CREATION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, SPACE ALLOCATION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, ROBOTICS DISABLED\0"
+	"LOGICAL UNIT NOT READY, CONFIGURATION REQUIRED\0"
+	"LOGICAL UNIT NOT READY, CALIBRATION REQUIRED\0"
+	"LOGICAL UNIT NOT READY, A DOOR IS OPEN\0"
+	"LOGICAL UNIT NOT READY, OPERATING IN SEQUENTIAL MODE\0"
+	"LOGICAL UNIT NOT READY, START STOP UNIT COMMAND IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, SANITIZE IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, ADDITIONAL POWER USE NOT YET GRANTED\0"
+	"LOGICAL UNIT NOT READY, CONFIGURATION IN PROGRESS\0"
+	"LOGICAL UNIT NOT READY, MICROCODE ACTIVATION REQUIRED\0"
+	"LOGICAL UNIT NOT READY, MICROCODE DOWNLOAD REQUIRED\0"
+	"LOGICAL UNIT NOT READY, LOGICAL UNIT RESET REQUIRED\0"
+	"LOGICAL UNIT NOT READY, HARD RESET REQUIRED\0"
+	"LOGICAL UNIT NOT READY, POWER CYCLE REQUIRED\0"
+	"LOGICAL UNIT DOES NOT RESPOND TO SELECTION\0"
+	"NO REFERENCE POSITION FOUND\0"
+	"MULTIPLE PERIPHERAL DEVICES SELECTED\0"
+	"LOGICAL UNIT COMMUNICATION FAILURE\0"
+	"LOGICAL UNIT COMMUNICATION TIME-OUT\0"
+	"LOGICAL UNIT COMMUNICATION PARITY ERROR\0"
+	"LOGICAL UNIT COMMUNICATION CRC ERROR (ULTRA-DMA/32)\0"
+	"UNREACHABLE COPY TARGET\0"
+	"TRACK FOLLOWING ERROR\0"
+	"TRACKING SERVO FAILURE\0"
+	"FOCUS SERVO FAILURE\0"
+	"SPINDLE SERVO FAILURE\0"
+	"HEAD SELECT FAULT\0"
+	"VIBRATION INDUCED TRACKING ERROR\0"
+	"ERROR LOG OVERFLOW\0"
+	"WARNING\0"
+	"WARNING - SPECIFIED TEMPERATURE EXCEEDED\0"
+	"WARNING - ENCLOSURE DEGRADED\0"
+	"WARNING - BACKGROUND SELF-TEST FAILED\0"
+	"WARNING - BACKGROUND PRE-SCAN DETECTED MEDIUM ERROR\0"
+	"WARNING - BACKGROUND MEDIUM SCAN DETECTED MEDIUM ERROR\0"
+	"WARNING - NON-VOLATILE CACHE NOW VOLATILE\0"
+	"WARNING - DEGRADED POWER TO NON-VOLATILE CACHE\0"
+	"WARNING - POWER LOSS EXPECTED\0"
+	"WARNING - DEVICE STATISTICS NOTIFICATION ACTIVE\0"
+	"WARNING - HIGH CRITICAL TEMPERATURE LIMIT EXCEEDED\0"
+	"WARNING - LOW CRITICAL TEMPERATURE LIMIT EXCEEDED\0"
+	"WARNING - HIGH OPERATING TEMPERATURE LIMIT EXCEEDED\0"
+	"WARNING - LOW OPERATING TEMPERATURE LIMIT EXCEEDED\0"
+	"WARNING - HIGH CRITICAL HUMIDITY LIMIT EXCEEDED\0"
+	"WARNING - LOW CRITICAL HUMIDITY LIMIT EXCEEDED\0"
+	"WARNING - HIGH OPERATING HUMIDITY LIMIT EXCEEDED\0"
+	"WARNING - LOW OPERATING HUMIDITY LIMIT EXCEEDED\0"
+	"WRITE ERROR\0"
+	"WRITE ERROR - RECOVERED WITH AUTO REALLOCATION\0"
+	"WRITE ERROR - AUTO REALLOCATION FAILED\0"
+	"WRITE ERROR - RECOMMEND REASSIGNMENT\0"
+	"COMPRESSION CHECK MISCOMPARE ERROR\0"
+	"DATA EXPANSION OCCURRED DURING COMPRESSION\0"
+	"BLOCK NOT COMPRESSIBLE\0"
+	"WRITE ERROR - RECOVERY NEEDED\0"
+	"WRITE ERROR - RECOVERY FAILED\0"
+	"WRITE ERROR - LOSS OF STREAMING\0"
+	"WRITE ERROR - PADDING BLOCKS ADDED\0"
+	"AUXILIARY MEMORY WRITE ERROR\0"
+	"WRITE ERROR - UNEXPECTED UNSOLICITED DATA\0"
+	"WRITE ERROR - NOT ENOUGH UNSOLICITED DATA\0"
+	"MULTIPLE WRITE ERRORS\0"
+	"DEFECTS IN ERROR WINDOW\0"
+	"INCOMPLETE MULTIPLE ATOMIC WRITE OPERATIONS\0"
+	"ERROR DETECTED BY THIRD PARTY TEMPORARY INITIATOR\0"
+	"THIRD PARTY DEVICE FAILURE\0"
+	"COPY TARGET DEVICE NOT REACHABLE\0"
+	"INCORRECT COPY TARGET DEVICE TYPE\0"
+	"COPY TARGET DEVICE DATA UNDERRUN\0"
+	"COPY TARGET DEVICE DATA OVERRUN\0"
+	"INVALID INFORMATION UNIT\0"
+	"INFORMATION UNIT TOO SHORT\0"
+	"INFORMATION UNIT TOO LONG\0"
+	"INVALID FIELD IN COMMAND INFORMATION UNIT\0"
+	"ID CRC OR ECC ERROR\0"
+	"LOGICAL BLOCK GUARD CHECK FAILED\0"
+	"LOGICAL BLOCK APPLICATION TAG CHECK FAILED\0"
+	"LOGICAL BLOCK REFERENCE TAG CHECK FAILED\0"
+	"LOGICAL BLOCK PROTECTION ERROR ON RECOVER BUFFERED DATA\0"
+	"LOGICAL BLOCK PROTECTION METHOD ERROR\0"
+	"UNRECOVERED READ ERROR\0"
+	"READ RETRIES EXHAUSTED\0"
+	"ERROR TOO LONG TO CORRECT\0"
+	"MULTIPLE READ ERRORS\0"
+	"UNRECOVERED READ ERROR - AUTO REALLOCATE FAILED\0"
+	"L-EC UNCORRECTABLE ERROR\0"
+	"CIRC UNRECOVERED ERROR\0"
+	"DATA RE-SYNCHRONIZATION ERROR\0"
+	"INCOMPLETE BLOCK READ\0"
+	"NO GAP FOUND\0"
+	"MISCORRECTED ERROR\0"
+	"UNRECOVERED READ ERROR - RECOMMEND REASSIGNMENT\0"
+	"UNRECOVERED READ ERROR - RECOMMEND REWRITE THE DATA\0"
+	"DE-COMPRESSION CRC ERROR\0"
+	"CANNOT DECOMPRESS USING DECLARED ALGORITHM\0"
+	"ERROR READING UPC/EAN NUMBER\0"
+	"ERROR READING ISRC NUMBER\0"
+	"READ ERROR - LOSS OF STREAMING\0"
+	"AUXILIARY MEMORY READ ERROR\0"
+	"READ ERROR - FAILED RETRANSMISSION REQUEST\0"
+	"READ ERROR - LBA MARKED BAD BY APPLICATION CLIENT\0"
+	"WRITE AFTER SANITIZE REQUIRED\0"
+	"ADDRESS MARK NOT FOUND FOR ID FIELD\0"
+	"ADDRESS MARK NOT FOUND FOR DATA FIELD\0"
+	"RECORDED ENTITY NOT FOUND\0"
+	"RECORD NOT FOUND\0"
+	"FILEMARK OR SETMARK NOT FOUND\0"
+	"END-OF-DATA NOT FOUND\0"
+	"BLOCK SEQUENCE ERROR\0"
+	"RECORD NOT FOUND - RECOMMEND REASSIGNMENT\0"
+	"RECORD NOT FOUND - DATA AUTO-REALLOCATED\0"
+	"LOCATE OPERATION FAILURE\0"
+	"RANDOM POSITIONING ERROR\0"
+	"MECHANICAL POSITIONING ERROR\0"
+	"POSITIONING ERROR DETECTED BY READ OF MEDIUM\0"
+	"DATA SYNCHRONIZATION MARK ERROR\0"
+	"DATA SYNC ERROR - DATA REWRITTEN\0"
+	"DATA SYNC ERROR - RECOMMEND REWRITE\0"
+	"DATA SYNC ERROR - DATA AUTO-REALLOCATED\0"
+	"DATA SYNC ERROR - RECOMMEND REASSIGNMENT\0"
+	"RECOVERED DATA WITH NO ERROR CORRECTION APPLIED\0"
+	"RECOVERED DATA WITH RETRIES\0"
+	"RECOVERED DATA WITH POSITIVE HEAD OFFSET\0"
+	"RECOVERED DATA WITH NEGATIVE HEAD OFFSET\0"
+	"RECOVERED DATA WITH RETRIES AND/OR CIRC APPLIED\0"
+	"RECOVERED DATA USING PREVIOUS SECTOR ID\0"
+	"RECOVERED DATA WITHOUT ECC - DATA AUTO-REALLOCATED\0"
+	"RECOVERED DATA WITHOUT ECC - RECOMMEND REASSIGNMENT\0"
+	"RECOVERED DATA WITHOUT ECC - RECOMMEND REWRITE\0"
+	"RECOVERED DATA WITHOUT ECC - DATA REWRITTEN\0"
+	"RECOVERED DATA WITH ERROR CORRECTION APPLIED\0"
+	"RECOVERED DATA WITH ERROR CORR. & RETRIES APPLIED\0"
+	"RECOVERED DATA - DATA AUTO-REALLOCATED\0"
+	"RECOVERED DATA WITH CIRC\0"
+	"RECOVERED DATA WITH L-EC\0"
+	"RECOVERED DATA - RECOMMEND REASSIGNMENT\0"
+	"RECOVERED DATA - RECOMMEND REWRITE\0"
+	"RECOVERED DATA WITH ECC - DATA REWRITTEN\0"
+	"RECOVERED DATA WITH LINKING\0"
+	"DEFECT LIST ERROR\0"
+	"DEFECT LIST NOT AVAILABLE\0"
+	"DEFECT LIST ERROR IN PRIMARY LIST\0"
+	"DEFECT LIST ERROR IN GROWN LIST\0"
+	"PARAMETER LIST LENGTH ERROR\0"
+	"SYNCHRONOUS DATA TRANSFER ERROR\0"
+	"DEFECT LIST NOT FOUND\0"
+	"PRIMARY DEFECT LIST NOT FOUND\0"
+	"GROWN DEFECT LIST NOT FOUND\0"
+	"MISCOMPARE DURING VERIFY OPERATION\0"
+	"MISCOMPARE VERIFY OF UNMAPPED LBA\0"
+	"RECOVERED ID WITH ECC CORRECTION\0"
+	"PARTIAL DEFECT LIST TRANSFER\0"
+	"INVALID COMMAND OPERATION CODE\0"
+	"ACCESS DENIED - INITIATOR PENDING-ENROLLED\0"
+	"ACCESS DENIED - NO ACCESS RIGHTS\0"
+	"ACCESS DENIED - INVALID MGMT ID KEY\0"
+	"ILLEGAL COMMAND WHILE IN WRITE CAPABLE STATE\0"
+	"Obsolete\0"
+	"ILLEGAL COMMAND WHILE IN EXPLICIT ADDRESS MODE\0"
+	"ILLEGAL COMMAND WHILE IN IMPLICIT ADDRESS MODE\0"
+	"ACCESS DENIED - ENROLLMENT CONFLICT\0"
+	"ACCESS DENIED - INVALID LU IDENTIFIER\0"
+	"ACCESS DENIED - INVALID PROXY TOKEN\0"
+	"ACCESS DENIED - ACL LUN CONFLICT\0"
+	"ILLEGAL COMMAND WHEN NOT IN APPEND-ONLY MODE\0"
+	"LOGICAL BLOCK ADDRESS OUT OF RANGE\0"
+	"INVALID ELEMENT ADDRESS\0"
+	"INVALID ADDRESS FOR WRITE\0"
+	"INVALID WRITE CROSSING LAYER JUMP\0"
+	"UNALIGNED WRITE COMMAND\0"
+	"WRITE BOUNDARY VIOLATION\0"
+	"ATTEMPT TO READ INVALID DATA\0"
+	"READ BOUNDARY VIOLATION\0"
+	"ILLEGAL FUNCTION (USE 20 00, 24 00, OR 26 00)\0"
+	"INVALID TOKEN OPERATION, CAUSE NOT REPORTABLE\0"
+	"INVALID TOKEN OPERATION, UNSUPPORTED TOKEN TYPE\0"
+	"INVALID TOKEN OPERATION, REMOTE TOKEN USAGE NOT SUPPORTED\0"
+	"INVALID TOKEN OPERATION, REMOTE ROD TOKEN CREATION NOT SUPPORTED\0"
+	"INVALID TOKEN OPERATION, TOKEN UNKNOWN\0"
+	"INVALID TOKEN OPERATION, TOKEN CORRUPT\0"
+	"INVALID TOKEN OPERATION, TOKEN REVOKED\0"
+	"INVALID TOKEN OPERATION, TOKEN EXPIRED\0"
+	"INVALID TOKEN OPERATION, TOKEN CANCELLED\0"
+	"INVALID TOKEN OPERATION, TOKEN DELETED\0"
+	"INVALID TOKEN OPERATION, INVALID TOKEN LENGTH\0"
+	"INVALID FIELD IN CDB\0"
+	"CDB DECRYPTION ERROR\0"
+	"SECURITY AUDIT VALUE FROZEN\0"
+	"SECURITY WORKING KEY FROZEN\0"
+	"NONCE NOT UNIQUE\0"
+	"NONCE TIMESTAMP OUT OF RANGE\0"
+	"INVALID XCDB\0"
+	"LOGICAL UNIT NOT SUPPORTED\0"
+	"INVALID FIELD IN PARAMETER LIST\0"
+	"PARAMETER NOT SUPPORTED\0"
+	"PARAMETER VALUE INVALID\0"
+	"THRESHOLD PARAMETERS NOT SUPPORTED\0"
+	"INVALID RELEASE OF PERSISTENT RESERVATION\0"
+	"DATA DECRYPTION ERROR\0"
+	"TOO MANY TARGET DESCRIPTORS\0"
+	"UNSUPPORTED TARGET DESCRIPTOR TYPE CODE\0"
+	"TOO MANY SEGMENT DESCRIPTORS\0"
+	"UNSUPPORTED SEGMENT DESCRIPTOR TYPE CODE\0"
+	"UNEXPECTED INEXACT SEGMENT\0"
+	"INLINE DATA LENGTH EXCEEDED\0"
+	"INVALID OPERATION FOR COPY SOURCE OR DESTINATION\0"
+	"COPY SEGMENT GRANULARITY VIOLATION\0"
+	"INVALID PARAMETER WHILE PORT IS ENABLED\0"
+	"INVALID DATA-OUT BUFFER INTEGRITY CHECK VALUE\0"
+	"DATA DECRYPTION KEY FAIL LIMIT REACHED\0"
+	"INCOMPLETE KEY-ASSOCIATED DATA SET\0"
+	"VENDOR SPECIFIC KEY REFERENCE NOT FOUND\0"
+	"APPLICATION TAG MODE PAGE IS INVALID\0"
+	"WRITE PROTECTED\0"
+	"HARDWARE WRITE PROTECTED\0"
+	"LOGICAL UNIT SOFTWARE WRITE PROTECTED\0"
+	"ASSOCIATED WRITE PROTECT\0"
+	"PERSISTENT WRITE PROTECT\0"
+	"PERMANENT WRITE PROTECT\0"
+	"CONDITIONAL WRITE PROTECT\0"
+	"SPACE ALLOCATION FAILED WRITE PROTECT\0"
+	"ZONE IS READ ONLY\0"
+	"NOT READY TO READY CHANGE, MEDIUM MAY HAVE CHANGED\0"
+	"IMPORT OR EXPORT ELEMENT ACCESSED\0"
+	"FORMAT-LAYER MAY HAVE CHANGED\0"
+	"IMPORT/EXPORT ELEMENT ACCESSED, MEDIUM CHANGED\0"
+	"POWER ON, RESET, OR BUS DEVICE RESET OCCURRED\0"
+	"POWER ON OCCURRED\0"
+	"SCSI BUS RESET OCCURRED\0"
+	"BUS DEVICE RESET FUNCTION OCCURRED\0"
+	"DEVICE INTERNAL RESET\0"
+	"TRANSCEIVER MODE CHANGED TO SINGLE-ENDED\0"
+	"TRANSCEIVER MODE CHANGED TO LVD\0"
+	"I_T NEXUS LOSS OCCURRED\0"
+	"PARAMETERS CHANGED\0"
+	"MODE PARAMETERS CHANGED\0"
+	"LOG PARAMETERS CHANGED\0"
+	"RESERVATIONS PREEMPTED\0"
+	"RESERVATIONS RELEASED\0"
+	"REGISTRATIONS PREEMPTED\0"
+	"ASYMMETRIC ACCESS STATE CHANGED\0"
+	"IMPLICIT ASYMMETRIC ACCESS STATE TRANSITION FAILED\0"
+	"PRIORITY CHANGED\0"
+	"CAPACITY DATA HAS CHANGED\0"
+	"ERROR HISTORY I_T NEXUS CLEARED\0"
+	"ERROR HISTORY SNAPSHOT RELEASED\0"
+	"ERROR RECOVERY ATTRIBUTES HAVE CHANGED\0"
+	"DATA ENCRYPTION CAPABILITIES CHANGED\0"
+	"TIMESTAMP CHANGED\0"
+	"DATA ENCRYPTION PARAMETERS CHANGED BY ANOTHER I_T NEXUS\0"
+	"DATA ENCRYPTION PARAMETERS CHANGED BY VENDOR SPECIFIC EVENT\0"
+	"DATA ENCRYPTION KEY INSTANCE COUNTER HAS CHANGED\0"
+	"SA CREATION CAPABILITIES DATA HAS CHANGED\0"
+	"MEDIUM REMOVAL PREVENTION PREEMPTED\0"
+	"COPY CANNOT EXECUTE SINCE HOST CANNOT DISCONNECT\0"
+	"COMMAND SEQUENCE ERROR\0"
+	"TOO MANY WINDOWS SPECIFIED\0"
+	"INVALID COMBINATION OF WINDOWS SPECIFIED\0"
+	"CURRENT PROGRAM AREA IS NOT EMPTY\0"
+	"CURRENT PROGRAM AREA IS EMPTY\0"
+	"ILLEGAL POWER CONDITION REQUEST\0"
+	"PERSISTENT PREVENT CONFLICT\0"
+	"PREVIOUS BUSY STATUS\0"
+	"PREVIOUS TASK SET FULL STATUS\0"
+	"PREVIOUS RESERVATION CONFLICT STATUS\0"
+	"PARTITION OR COLLECTION CONTAINS USER OBJECTS\0"
+	"NOT RESERVED\0"
+	"ORWRITE GENERATION DOES NOT MATCH\0"
+	"RESET WRITE POINTER NOT ALLOWED\0"
+	"ZONE IS OFFLINE\0"
+	"OVERWRITE ERROR ON UPDATE IN PLACE\0"
+	"INSUFFICIENT TIME FOR OPERATION\0"
+	"COMMAND TIMEOUT BEFORE PROCESSING\0"
+	"COMMAND TIMEOUT DURING PROCESSING\0"
+	"COMMAND TIMEOUT DURING PROCESSING DUE TO ERROR RECOVERY\0"
+	"COMMANDS CLEARED BY ANOTHER INITIATOR\0"
+	"COMMANDS CLEARED BY POWER LOSS NOTIFICATION\0"
+	"COMMANDS CLEARED BY DEVICE SERVER\0"
+	"SOME COMMANDS CLEARED BY QUEUING LAYER EVENT\0"
+	"INCOMPATIBLE MEDIUM INSTALLED\0"
+	"CANNOT READ MEDIUM - UNKNOWN FORMAT\0"
+	"CANNOT READ MEDIUM - INCOMPATIBLE FORMAT\0"
+	"CLEANING CARTRIDGE INSTALLED\0"
+	"CANNOT WRITE MEDIUM - UNKNOWN FORMAT\0"
+	"CANNOT WRITE MEDIUM - INCOMPATIBLE FORMAT\0"
+	"CANNOT FORMAT MEDIUM - INCOMPATIBLE MEDIUM\0"
+	"CLEANING FAILURE\0"
+	"CANNOT WRITE - APPLICATION CODE MISMATCH\0"
+	"CURRENT SESSION NOT FIXATED FOR APPEND\0"
+	"CLEANING REQUEST REJECTED\0"
+	"WORM MEDIUM - OVERWRITE ATTEMPTED\0"
+	"WORM MEDIUM - INTEGRITY CHECK\0"
+	"MEDIUM NOT FORMATTED\0"
+	"INCOMPATIBLE VOLUME TYPE\0"
+	"INCOMPATIBLE VOLUME QUALIFIER\0"
+	"CLEANING VOLUME EXPIRED\0"
+	"MEDIUM FORMAT CORRUPTED\0"
+	"FORMAT COMMAND FAILED\0"
+	"ZONED FORMATTING FAILED DUE TO SPARE LINKING\0"
+	"SANITIZE COMMAND FAILED\0"
+	"NO DEFECT SPARE LOCATION AVAILABLE\0"
+	"DEFECT LIST UPDATE FAILURE\0"
+	"TAPE LENGTH ERROR\0"
+	"ENCLOSURE FAILURE\0"
+	"ENCLOSURE SERVICES FAILURE\0"
+	"UNSUPPORTED ENCLOSURE FUNCTION\0"
+	"ENCLOSURE SERVICES UNAVAILABLE\0"
+	"ENCLOSURE SERVICES TRANSFER FAILURE\0"
+	"ENCLOSURE SERVICES TRANSFER REFUSED\0"
+	"ENCLOSURE SERVICES CHECKSUM ERROR\0"
+	"RIBBON, INK, OR TONER FAILURE\0"
+	"ROUNDED PARAMETER\0"
+	"EVENT STATUS NOTIFICATION\0"
+	"ESN - POWER MANAGEMENT CLASS EVENT\0"
+	"ESN - MEDIA CLASS EVENT\0"
+	"ESN - DEVICE BUSY CLASS EVENT\0"
+	"THIN PROVISIONING SOFT THRESHOLD REACHED\0"
+	"SAVING PARAMETERS NOT SUPPORTED\0"
+	"MEDIUM NOT PRESENT\0"
+	"MEDIUM NOT PRESENT - TRAY CLOSED\0"
+	"MEDIUM NOT PRESENT - TRAY OPEN\0"
+	"MEDIUM NOT PRESENT - LOADABLE\0"
+	"MEDIUM NOT PRESENT - MEDIUM AUXILIARY MEMORY ACCESSIBLE\0"
+	"SEQUENTIAL POSITIONING ERROR\0"
+	"TAPE POSITION ERROR AT BEGINNING-OF-MEDIUM\0"
+	"TAPE POSITION ERROR AT END-OF-MEDIUM\0"
+	"TAPE OR ELECTRONIC VERTICAL FORMS UNIT NOT READY\0"
+	"SLEW FAILURE\0"
+	"PAPER JAM\0"
+	"FAILED TO SENSE TOP-OF-FORM\0"
+	"FAILED TO SENSE BOTTOM-OF-FORM\0"
+	"REPOSITION ERROR\0"
+	"READ PAST END OF MEDIUM\0"
+	"READ PAST BEGINNING OF MEDIUM\0"
+	"POSITION PAST END OF MEDIUM\0"
+	"POSITION PAST BEGINNING OF MEDIUM\0"
+	"MEDIUM DESTINATION ELEMENT FULL\0"
+	"MEDIUM SOURCE ELEMENT EMPTY\0"
+	"END OF MEDIUM REACHED\0"
+	"MEDIUM MAGAZINE NOT ACCESSIBLE\0"
+	"MEDIUM MAGAZINE REMOVED\0"
+	"MEDIUM MAGAZINE INSERTED\0"
+	"MEDIUM MAGAZINE LOCKED\0"
+	"MEDIUM MAGAZINE UNLOCKED\0"
+	"MECHANICAL POSITIONING OR CHANGER ERROR\0"
+	"READ PAST END OF USER OBJECT\0"
+	"ELEMENT DISABLED\0"
+	"ELEMENT ENABLED\0"
+	"DATA TRANSFER DEVICE REMOVED\0"
+	"DATA TRANSFER DEVICE INSERTED\0"
+	"TOO MANY LOGICAL OBJECTS ON PARTITION TO SUPPORT OPERATION\0"
+	"INVALID BITS IN IDENTIFY MESSAGE\0"
+	"LOGICAL UNIT HAS NOT SELF-CONFIGURED YET\0"
+	"LOGICAL UNIT FAILURE\0"
+	"TIMEOUT ON LOGICAL UNIT\0"
+	"LOGICAL UNIT FAILED SELF-TEST\0"
+	"LOGICAL UNIT UNABLE TO UPDATE SELF-TEST LOG\0"
+	"TARGET OPERATING CONDITIONS HAVE CHANGED\0"
+	"MICROCODE HAS BEEN CHANGED\0"
+	"CHANGED OPERATING DEFINITION\0"
+	"INQUIRY DATA HAS CHANGED\0"
+	"COMPONENT DEVICE ATTACHED\0"
+	"DEVICE IDENTIFIER CHANGED\0"
+	"REDUNDANCY GROUP CREATED OR MODIFIED\0"
+	"REDUNDANCY GROUP DELETED\0"
+	"SPARE CREATED OR MODIFIED\0"
+	"SPARE DELETED\0"
+	"VOLUME SET CREATED OR MODIFIED\0"
+	"VOLUME SET DELETED\0"
+	"VOLUME SET DEASSIGNED\0"
+	"VOLUME SET REASSIGNED\0"
+	"REPORTED LUNS DATA HAS CHANGED\0"
+	"ECHO BUFFER OVERWRITTEN\0"
+	"MEDIUM LOADABLE\0"
+	"MEDIUM AUXILIARY MEMORY ACCESSIBLE\0"
+	"iSCSI IP ADDRESS ADDED\0"
+	"iSCSI IP ADDRESS REMOVED\0"
+	"iSCSI IP ADDRESS CHANGED\0"
+	"INSPECT REFERRALS SENSE DESCRIPTORS\0"
+	"MICROCODE HAS BEEN CHANGED WITHOUT RESET\0"
+	"RAM FAILURE (SHOULD USE 40 NN)\0"
+	"DIAGNOSTIC FAILURE ON COMPONENT %u (80h-FFh)\0"
+	"DATA PATH FAILURE (SHOULD USE 40 NN)\0"
+	"POWER-ON OR SELF-TEST FAILURE (SHOULD USE 40 NN)\0"
+	"MESSAGE ERROR\0"
+	"INTERNAL TARGET FAILURE\0"
+	"PERSISTENT RESERVATION INFORMATION LOST\0"
+	"ATA DEVICE FAILED SET FEATURES\0"
+	"SELECT OR RESELECT FAILURE\0"
+	"UNSUCCESSFUL SOFT RESET\0"
+	"SCSI PARITY ERROR\0"
+	"DATA PHASE CRC ERROR DETECTED\0"
+	"SCSI PARITY ERROR DETECTED DURING ST DATA PHASE\0"
+	"INFORMATION UNIT iuCRC ERROR DETECTED\0"
+	"ASYNCHRONOUS INFORMATION PROTECTION ERROR DETECTED\0"
+	"PROTOCOL SERVICE CRC ERROR\0"
+	"PHY TEST FUNCTION IN PROGRESS\0"
+	"SOME COMMANDS CLEARED BY ISCSI PROTOCOL EVENT\0"
+	"INITIATOR DETECTED ERROR MESSAGE RECEIVED\0"
+	"INVALID MESSAGE ERROR\0"
+	"COMMAND PHASE ERROR\0"
+	"DATA PHASE ERROR\0"
+	"INVALID TARGET PORT TRANSFER TAG RECEIVED\0"
+	"TOO MUCH WRITE DATA\0"
+	"ACK/NAK TIMEOUT\0"
+	"NAK RECEIVED\0"
+	"DATA OFFSET ERROR\0"
+	"INITIATOR RESPONSE TIMEOUT\0"
+	"CONNECTION LOST\0"
+	"DATA-IN BUFFER OVERFLOW - DATA BUFFER SIZE\0"
+	"DATA-IN BUFFER OVERFLOW - DATA BUFFER DESCRIPTOR AREA\0"
+	"DATA-IN BUFFER ERROR\0"
+	"DATA-OUT BUFFER OVERFLOW - DATA BUFFER SIZE\0"
+	"DATA-OUT BUFFER OVERFLOW - DATA BUFFER DESCRIPTOR AREA\0"
+	"DATA-OUT BUFFER ERROR\0"
+	"PCIE FABRIC ERROR\0"
+	"PCIE COMPLETION TIMEOUT\0"
+	"PCIE COMPLETER ABORT\0"
+	"PCIE POISONED TLP RECEIVED\0"
+	"PCIE ECRC CHECK FAILED\0"
+	"PCIE UNSUPPORTED REQUEST\0"
+	"PCIE ACS VIOLATION\0"
+	"PCIE TLP PREFIX BLOCKED\0"
+	"LOGICAL UNIT FAILED SELF-CONFIGURATION\0"
+	"TAGGED OVERLAPPED COMMANDS (%u = TASK TAG)\0"
+	"OVERLAPPED COMMANDS ATTEMPTED\0"
+	"WRITE APPEND ERROR\0"
+	"WRITE APPEND POSITION ERROR\0"
+	"POSITION ERROR RELATED TO TIMING\0"
+	"ERASE FAILURE\0"
+	"ERASE FAILURE - INCOMPLETE ERASE OPERATION DETECTED\0"
+	"CARTRIDGE FAULT\0"
+	"MEDIA LOAD OR EJECT FAILED\0"
+	"UNLOAD TAPE FAILURE\0"
+	"MEDIUM REMOVAL PREVENTED\0"
+	"MEDIUM REMOVAL PREVENTED BY DATA TRANSFER ELEMENT\0"
+	"MEDIUM THREAD OR UNTHREAD FAILURE\0"
+	"VOLUME IDENTIFIER INVALID\0"
+	"VOLUME IDENTIFIER MISSING\0"
+	"DUPLICATE VOLUME IDENTIFIER\0"
+	"ELEMENT STATUS UNKNOWN\0"
+	"DATA TRANSFER DEVICE ERROR - LOAD FAILED\0"
+	"DATA TRANSFER DEVICE ERROR - UNLOAD FAILED\0"
+	"DATA TRANSFER DEVICE ERROR - UNLOAD MISSING\0"
+	"DATA TRANSFER DEVICE ERROR - EJECT FAILED\0"
+	"DATA TRANSFER DEVICE ERROR - LIBRARY COMMUNICATION FAILED\0"
+	"SCSI TO HOST SYSTEM INTERFACE FAILURE\0"
+	"SYSTEM RESOURCE FAILURE\0"
+	"SYSTEM BUFFER FULL\0"
+	"INSUFFICIENT RESERVATION RESOURCES\0"
+	"INSUFFICIENT RESOURCES\0"
+	"INSUFFICIENT REGISTRATION RESOURCES\0"
+	"INSUFFICIENT ACCESS CONTROL RESOURCES\0"
+	"AUXILIARY MEMORY OUT OF SPACE\0"
+	"QUOTA ERROR\0"
+	"MAXIMUM NUMBER OF SUPPLEMENTAL DECRYPTION KEYS EXCEEDED\0"
+	"MEDIUM AUXILIARY MEMORY NOT ACCESSIBLE\0"
+	"DATA CURRENTLY UNAVAILABLE\0"
+	"INSUFFICIENT POWER FOR OPERATION\0"
+	"INSUFFICIENT RESOURCES TO CREATE ROD\0"
+	"INSUFFICIENT RESOURCES TO CREATE ROD TOKEN\0"
+	"INSUFFICIENT ZONE RESOURCES\0"
+	"UNABLE TO RECOVER TABLE-OF-CONTENTS\0"
+	"GENERATION DOES NOT EXIST\0"
+	"UPDATED BLOCK READ\0"
+	"OPERATOR REQUEST OR STATE CHANGE INPUT\0"
+	"OPERATOR MEDIUM REMOVAL REQUEST\0"
+	"OPERATOR SELECTED WRITE PROTECT\0"
+	"OPERATOR SELECTED WRITE PERMIT\0"
+	"LOG EXCEPTION\0"
+	"THRESHOLD CONDITION MET\0"
+	"LOG COUNTER AT MAXIMUM\0"
+	"LOG LIST CODES EXHAUSTED\0"
+	"RPL STATUS CHANGE\0"
+	"SPINDLES SYNCHRONIZED\0"
+	"SPINDLES NOT SYNCHRONIZED\0"
+	"FAILURE PREDICTION THRESHOLD EXCEEDED\0"
+	"MEDIA FAILURE PREDICTION THRESHOLD EXCEEDED\0"
+	"LOGICAL UNIT FAILURE PREDICTION THRESHOLD EXCEEDED\0"
+	"SPARE AREA EXHAUSTION PREDICTION THRESHOLD EXCEEDED\0"
+	"HARDWARE IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"HARDWARE IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"HARDWARE IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"HARDWARE IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"HARDWARE IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"HARDWARE IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"HARDWARE IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"HARDWARE IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"HARDWARE IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"HARDWARE IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"HARDWARE IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"HARDWARE IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"HARDWARE IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"CONTROLLER IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"CONTROLLER IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"CONTROLLER IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"CONTROLLER IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"CONTROLLER IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"CONTROLLER IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"CONTROLLER IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"CONTROLLER IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"CONTROLLER IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"CONTROLLER IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"CONTROLLER IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"CONTROLLER IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"CONTROLLER IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"DATA CHANNEL IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"DATA CHANNEL IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"DATA CHANNEL IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"DATA CHANNEL IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"DATA CHANNEL IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"DATA CHANNEL IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"DATA CHANNEL IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"DATA CHANNEL IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"DATA CHANNEL IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"DATA CHANNEL IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"DATA CHANNEL IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"DATA CHANNEL IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"DATA CHANNEL IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"SERVO IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"SERVO IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"SERVO IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"SERVO IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"SERVO IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"SERVO IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"SERVO IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"SERVO IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"SERVO IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"SERVO IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"SERVO IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"SERVO IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"SERVO IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"SPINDLE IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"SPINDLE IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"SPINDLE IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"SPINDLE IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"SPINDLE IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"SPINDLE IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"SPINDLE IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"SPINDLE IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"SPINDLE IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"SPINDLE IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"SPINDLE IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"SPINDLE IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"SPINDLE IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"FIRMWARE IMPENDING FAILURE GENERAL HARD DRIVE FAILURE\0"
+	"FIRMWARE IMPENDING FAILURE DRIVE ERROR RATE TOO HIGH\0"
+	"FIRMWARE IMPENDING FAILURE DATA ERROR RATE TOO HIGH\0"
+	"FIRMWARE IMPENDING FAILURE SEEK ERROR RATE TOO HIGH\0"
+	"FIRMWARE IMPENDING FAILURE TOO MANY BLOCK REASSIGNS\0"
+	"FIRMWARE IMPENDING FAILURE ACCESS TIMES TOO HIGH\0"
+	"FIRMWARE IMPENDING FAILURE START UNIT TIMES TOO HIGH\0"
+	"FIRMWARE IMPENDING FAILURE CHANNEL PARAMETRICS\0"
+	"FIRMWARE IMPENDING FAILURE CONTROLLER DETECTED\0"
+	"FIRMWARE IMPENDING FAILURE THROUGHPUT PERFORMANCE\0"
+	"FIRMWARE IMPENDING FAILURE SEEK TIME PERFORMANCE\0"
+	"FIRMWARE IMPENDING FAILURE SPIN-UP RETRY COUNT\0"
+	"FIRMWARE IMPENDING FAILURE DRIVE CALIBRATION RETRY COUNT\0"
+	"FAILURE PREDICTION THRESHOLD EXCEEDED (FALSE)\0"
+	"LOW POWER CONDITION ON\0"
+	"IDLE CONDITION ACTIVATED BY TIMER\0"
+	"STANDBY CONDITION ACTIVATED BY TIMER\0"
+	"IDLE CONDITION ACTIVATED BY COMMAND\0"
+	"STANDBY CONDITION ACTIVATED BY COMMAND\0"
+	"IDLE_B CONDITION ACTIVATED BY TIMER\0"
+	"IDLE_B CONDITION ACTIVATED BY COMMAND\0"
+	"IDLE_C CONDITION ACTIVATED BY TIMER\0"
+	"IDLE_C CONDITION ACTIVATED BY COMMAND\0"
+	"STANDBY_Y CONDITION ACTIVATED BY TIMER\0"
+	"STANDBY_Y CONDITION ACTIVATED BY COMMAND\0"
+	"POWER STATE CHANGE TO ACTIVE\0"
+	"POWER STATE CHANGE TO IDLE\0"
+	"POWER STATE CHANGE TO STANDBY\0"
+	"POWER STATE CHANGE TO SLEEP\0"
+	"POWER STATE CHANGE TO DEVICE CONTROL\0"
+	"LAMP FAILURE\0"
+	"VIDEO ACQUISITION ERROR\0"
+	"UNABLE TO ACQUIRE VIDEO\0"
+	"OUT OF FOCUS\0"
+	"SCAN HEAD POSITIONING ERROR\0"
+	"END OF USER AREA ENCOUNTERED ON THIS TRACK\0"
+	"PACKET DOES NOT FIT IN AVAILABLE SPACE\0"
+	"ILLEGAL MODE FOR THIS TRACK\0"
+	"INVALID PACKET SIZE\0"
+	"VOLTAGE FAULT\0"
+	"AUTOMATIC DOCUMENT FEEDER COVER UP\0"
+	"AUTOMATIC DOCUMENT FEEDER LIFT UP\0"
+	"DOCUMENT JAM IN AUTOMATIC DOCUMENT FEEDER\0"
+	"DOCUMENT MISS FEED AUTOMATIC IN DOCUMENT FEEDER\0"
+	"CONFIGURATION FAILURE\0"
+	"CONFIGURATION OF INCAPABLE LOGICAL UNITS FAILED\0"
+	"ADD LOGICAL UNIT FAILED\0"
+	"MODIFICATION OF LOGICAL UNIT FAILED\0"
+	"EXCHANGE OF LOGICAL UNIT FAILED\0"
+	"REMOVE OF LOGICAL UNIT FAILED\0"
+	"ATTACHMENT OF LOGICAL UNIT FAILED\0"
+	"CREATION OF LOGICAL UNIT FAILED\0"
+	"ASSIGN FAILURE OCCURRED\0"
+	"MULTIPLY ASSIGNED LOGICAL UNIT\0"
+	"SET TARGET PORT GROUPS COMMAND FAILED\0"
+	"ATA DEVICE FEATURE NOT ENABLED\0"
+	"LOGICAL UNIT NOT CONFIGURED\0"
+	"SUBSIDIARY LOGICAL UNIT NOT CONFIGURED\0"
+	"DATA LOSS ON LOGICAL UNIT\0"
+	"MULTIPLE LOGICAL UNIT FAILURES\0"
+	"PARITY/DATA MISMATCH\0"
+	"INFORMATIONAL, REFER TO LOG\0"
+	"STATE CHANGE HAS OCCURRED\0"
+	"REDUNDANCY LEVEL GOT BETTER\0"
+	"REDUNDANCY LEVEL GOT WORSE\0"
+	"REBUILD FAILURE OCCURRED\0"
+	"RECALCULATE FAILURE OCCURRED\0"
+	"COMMAND TO LOGICAL UNIT FAILED\0"
+	"COPY PROTECTION KEY EXCHANGE FAILURE - AUTHENTICATION FAILURE\0"
+	"COPY PROTECTION KEY EXCHANGE FAILURE - KEY NOT PRESENT\0"
+	"COPY PROTECTION KEY EXCHANGE FAILURE - KEY NOT ESTABLISHED\0"
+	"READ OF SCRAMBLED SECTOR WITHOUT AUTHENTICATION\0"
+	"MEDIA REGION CODE IS MISMATCHED TO LOGICAL UNIT REGION\0"
+	"DRIVE REGION MUST BE PERMANENT/REGION RESET COUNT ERROR\0"
+	"INSUFFICIENT BLOCK COUNT FOR BINDING NONCE RECORDING\0"
+	"CONFLICT IN BINDING NONCE RECORDING\0"
+	"DECOMPRESSION EXCEPTION SHORT ALGORITHM ID OF %u\0"
+	"DECOMPRESSION EXCEPTION LONG ALGORITHM ID\0"
+	"SESSION FIXATION ERROR\0"
+	"SESSION FIXATION ERROR WRITING LEAD-IN\0"
+	"SESSION FIXATION ERROR WRITING LEAD-OUT\0"
+	"SESSION FIXATION ERROR - INCOMPLETE TRACK IN SESSION\0"
+	"EMPTY OR PARTIALLY WRITTEN RESERVED TRACK\0"
+	"NO MORE TRACK RESERVATIONS ALLOWED\0"
+	"RMZ EXTENSION IS NOT ALLOWED\0"
+	"NO MORE TEST ZONE EXTENSIONS ARE ALLOWED\0"
+	"CD CONTROL ERROR\0"
+	"POWER CALIBRATION AREA ALMOST FULL\0"
+	"POWER CALIBRATION AREA IS FULL\0"
+	"POWER CALIBRATION AREA ERROR\0"
+	"PROGRAM MEMORY AREA UPDATE FAILURE\0"
+	"PROGRAM MEMORY AREA IS FULL\0"
+	"RMA/PMA IS ALMOST FULL\0"
+	"CURRENT POWER CALIBRATION AREA ALMOST FULL\0"
+	"CURRENT POWER CALIBRATION AREA IS FULL\0"
+	"RDZ IS FULL\0"
+	"SECURITY ERROR\0"
+	"UNABLE TO DECRYPT DATA\0"
+	"UNENCRYPTED DATA ENCOUNTERED WHILE DECRYPTING\0"
+	"INCORRECT DATA ENCRYPTION KEY\0"
+	"CRYPTOGRAPHIC INTEGRITY VALIDATION FAILED\0"
+	"ERROR DECRYPTING DATA\0"
+	"UNKNOWN SIGNATURE VERIFICATION KEY\0"
+	"ENCRYPTION PARAMETERS NOT USEABLE\0"
+	"DIGITAL SIGNATURE VALIDATION FAILURE\0"
+	"ENCRYPTION MODE MISMATCH ON READ\0"
+	"ENCRYPTED BLOCK NOT RAW READ ENABLED\0"
+	"INCORRECT ENCRYPTION PARAMETERS\0"
+	"UNABLE TO DECRYPT PARAMETER LIST\0"
+	"ENCRYPTION ALGORITHM DISABLED\0"
+	"SA CREATION PARAMETER VALUE INVALID\0"
+	"SA CREATION PARAMETER VALUE REJECTED\0"
+	"INVALID SA USAGE\0"
+	"DATA ENCRYPTION CONFIGURATION PREVENTED\0"
+	"SA CREATION PARAMETER NOT SUPPORTED\0"
+	"AUTHENTICATION FAILED\0"
+	"EXTERNAL DATA ENCRYPTION KEY MANAGER ACCESS ERROR\0"
+	"EXTERNAL DATA ENCRYPTION KEY MANAGER ERROR\0"
+	"EXTERNAL DATA ENCRYPTION KEY NOT FOUND\0"
+	"EXTERNAL DATA ENCRYPTION REQUEST NOT AUTHORIZED\0"
+	"EXTERNAL DATA ENCRYPTION CONTROL TIMEOUT\0"
+	"EXTERNAL DATA ENCRYPTION CONTROL ERROR\0"
+	"LOGICAL UNIT ACCESS NOT AUTHORIZED\0"
+	"SECURITY CONFLICT IN TRANSLATED DEVICE\0"
+;
+
+static const uint16_t asc_num_slots[1306] = {
+	0xFFFF, 0x0000, 0x0020, 0x0032, 0x0053, 0x0064, 0x008B, 0x00A0,
+	0x00B7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0x00DB, 0x00FC, 0x0118, 0x0144, 0x016E, 0x0190,
+	0x01A6, 0x01B9, 0x01D5, 0x01F2, 0x020F, 0x0232, 0x024F, 0x0276,
+	0x0296, 0x02CC, 0x02F0, 0x0312, 0x0329, 0x033A, 0x0358, 0x0369,
+	0x0380, 0x03AD, 0x03DA, 0x0410, 0x0445, 0x0470, 0x049C, 0x04CE,
+	0x04FC, 0x052B, 0x0559, 0x0599, 0x05D3, 0x0611, 0x0642, 0xFFFF,
+	0x0677, 0x06AF, 0x06E7, 0x0707, 0x0737, 0x076C, 0x0796, 0x07C5,
+	0x07F2, 0x0819, 0x084E, 0x088A, 0x08B7, 0x08F4, 0x0926, 0x095C,
+	0x0990, 0x09C4, 0x09F0, 0x0A1D, 0x0A48, 0x0A64, 0x0A89, 0x0AAC,
+	0x0AD0, 0x0AF8, 0x0B2C, 0x0B44, 0x0B5A, 0x0B71, 0x0B85, 0x0B9B,
+	0x0BAD, 0x0BCE, 0x0BE1, 0x0BE9, 0x0C12, 0x0C2F, 0x0C55, 0x0C89,
+	0x0CC0, 0x0CEA, 0x0D19, 0x0D37, 0x0D67, 0x0D9A, 0x0DCC, 0x0E00,
+	0x0E33, 0x0E63, 0x0E92, 0x0EC3, 0x0EF3, 0x0EFF, 0x0F2E, 0x0F55,
+	0x0F7A, 0x0F9D, 0x0FC8, 0x0FDF, 0x0FFD, 0x101B, 0x103B, 0x105E,
+	0x107B, 0x10A5, 0x10CF, 0x10E5, 0x10FD, 0x1129, 0x115B, 0x1176,
+	0x1197, 0x11B9, 0x11DA, 0x11FA, 0x1213, 0x122E, 0x1248, 0x1272,
+	0x1286, 0x12A7, 0x12D2, 0x12FB, 0x1333, 0x1359, 0x1370, 0x1387,
+	0x13A1, 0x13B6, 0x13E6, 0x13FF, 0x1416, 0x1434, 0x144A, 0x1457,
+	0x146A, 0x149A, 0x14CE, 0x14E7, 0x1512, 0x152F, 0x1549, 0x1568,
+	0x1584, 0x15AF, 0x15E1, 0x15FF, 0x1623, 0x1649, 0x1663, 0x1674,
+	0x1692, 0x16A8, 0x16BD, 0x16E7, 0x1710, 0x1729, 0x1742, 0x175F,
+	0x178C, 0x17AC, 0x17CD, 0x17F1, 0x1819, 0x1842, 0x1872, 0x188E,
+	0x18B7, 0x18E0, 0x1910, 0x1938, 0x196B, 0x199F, 0x19CE, 0x19FA,
+	0x1A27, 0x1A59, 0x1A80, 0x1A99, 0x1AB2, 0x1ADA, 0x1AFD, 0x1B26,
+	0x1B42, 0x1B54, 0x1B6E, 0x1B90, 0x1BB0, 0x1BCC, 0x1BEC, 0x1C02,
+	0x1C20, 0x1C3C, 0x1C5F, 0x1C81, 0x1CA2, 0x1CBF, 0x1CDE, 0x1D09,
+	0x1D2A, 0x1D4E, 0x1D7B, 0x1D84, 0x1DB3, 0x1DE2, 0x1E06, 0x1E2C,
+	0x1E50, 0x1E71, 0x1E9E, 0x1EC1, 0x1ED9, 0x1EF3, 0x1F15, 0x1F2D,
+	0x1F46, 0x1F63, 0x1F7B, 0x1FA9, 0x1FD7, 0x2007, 0x2041, 0x2082,
+	0x20A9, 0x20D0, 0x20F7, 0x211E, 0x2147, 0x216E, 0x219C, 0x21B1,
+	0x1D7B, 0x1D7B, 0x21C6, 0x21E2, 0x21FE, 0x220F, 0x222C, 0x2239,
+	0x2254, 0x2274, 0x228C, 0x22A4, 0x22C7, 0x22F1, 0x2307, 0x2323,
+	0x234B, 0x2368, 0x2391, 0x23AC, 0x23C8, 0x23F9, 0x241C, 0x2444,
+	0x2472, 0x2499, 0x24BC, 0x24E4, 0x2509, 0x2519, 0x2532, 0x2558,
+	0x2571, 0x258A, 0x25A2, 0x25BC, 0x25E2, 0x25F4, 0x2627, 0x2649,
+	0x2667, 0x2696, 0x26C4, 0x26D6, 0x26EE, 0x2711, 0x2727, 0x2750,
+	0x2770, 0x2788, 0x279B, 0x27B3, 0x27CA, 0x27E1, 0x27F7, 0x280F,
+	0x282F, 0x2862, 0x2873, 0x288D, 0x28AD, 0x28CD, 0x28F4, 0xFFFF,
+	0xFFFF, 0x2919, 0x292B, 0x2963, 0x299F, 0x29D0, 0x29FA, 0x2A1E,
+	0x2A4F, 0x2A66, 0x2A81, 0x2AAA, 0x2ACC, 0x2AEA, 0x2B0A, 0x2B26,
+	0x2B3B, 0x2B59, 0x2B7E, 0x2BAC, 0x2BB9, 0x2BDB, 0x2BFB, 0x2C0B,
+	0x2C2E, 0x2C4E, 0x2C70, 0x2C92, 0x2CCA, 0x2CF0, 0x2D1C, 0x2D3E,
+	0x2D6B, 0x2D89, 0x2DAD, 0x2DD6, 0x2DF3, 0x2E18, 0x2E42, 0x2E6D,
+	0x2E7E, 0x2EA7, 0x2ECE, 0xFFFF, 0x2EE8, 0x2F0A, 0xFFFF, 0xFFFF,
+	0x2F28, 0x2F3D, 0x2F56, 0x2F74, 0x2F8C, 0x2FA4, 0x2FBA, 0x2FE7,
+	0x2FFF, 0x3022, 0x303D, 0x304F, 0x3061, 0x307C, 0x309B, 0x30BA,
+	0x30DE, 0x3102, 0x3124, 0x3142, 0x3154, 0xFFFF, 0x316E, 0xFFFF,
+	0x3191, 0xFFFF, 0x31A9, 0x31C7, 0x31F0, 0x3210, 0x3223, 0x3244,
+	0x3263, 0x3281, 0x32B9, 0x32D6, 0x3301, 0x3326, 0x3357, 0x3364,
+	0x336E, 0x338A, 0x33A9, 0x33BA, 0x33D2, 0x33F0, 0x340C, 0x342E,
+	0x344E, 0x346A, 0xFFFF, 0x3480, 0x349F, 0x34B7, 0x34D0, 0x34E7,
+	0x3500, 0x3528, 0x3545, 0x3556, 0x3566, 0x3583, 0x35A1, 0x35DC,
+	0x35FD, 0x3626, 0x363B, 0x3653, 0x3671, 0x369D, 0x36C6, 0x36E1,
+	0x36FE, 0x3717, 0x3731, 0x374B, 0x3770, 0x3789, 0x37A3, 0x37B1,
+	0x37D0, 0x37E3, 0x37F9, 0x380F, 0x382E, 0x3846, 0x3856, 0x3879,
+	0x3890, 0x38A9, 0x38C2, 0x38E6, 0x390F, 0x395B, 0x3980, 0x39B1,
+	0x39BF, 0x39D7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x39FF, 0x3A1E, 0x3A39, 0x3A51, 0x3A63, 0x3A81, 0x3AB1,
+	0x3AD7, 0x3B0A, 0x3B25, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0x3B43, 0x3B71, 0x3B9B, 0x3BB1, 0x3BC5,
+	0x3BD6, 0x3C00, 0x3C14, 0x3C24, 0x3C31, 0x3C43, 0x3C5E, 0x3C6E,
+	0x3C99, 0x3CCF, 0x3CE4, 0x3D10, 0x3D47, 0x3D5D, 0x3D6F, 0x3D87,
+	0x3D9C, 0x3DB7, 0x3DCE, 0x3DE7, 0x3DFA, 0x3E12, 0x3E64, 0x3E82,
+	0x3E95, 0x3EB1, 0x3ED2, 0x3EE0, 0x3F14, 0x3F24, 0x3F3F, 0x3F53,
+	0x3F6C, 0x3F9E, 0x3FC0, 0x3FDA, 0x3FF4, 0x4010, 0x4027, 0x4050,
+	0x407B, 0x40A7, 0x40D1, 0x410B, 0x4131, 0x4149, 0x415C, 0x417F,
+	0x4196, 0x41BA, 0x41E0, 0x41FE, 0x420A, 0x4242, 0x4269, 0x4284,
+	0x42A5, 0x42CA, 0x42F5, 0x4311, 0x4335, 0x434F, 0x4362, 0x4389,
+	0x43A9, 0x43C9, 0x43E8, 0x43F6, 0x440E, 0x4425, 0x443E, 0x4450,
+	0x4466, 0x4480, 0x44A6, 0x44D2, 0x4505, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x4539, 0x456F, 0x45A4, 0x45D8, 0x460C, 0x4640, 0x4671,
+	0x46A6, 0x46D5, 0x4704, 0x4736, 0x4767, 0x4796, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x47CF, 0x4807, 0x483E, 0x4874, 0x48AA, 0x48E0, 0x4913,
+	0x494A, 0x497B, 0x49AC, 0x49E0, 0x4A13, 0x4A44, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x4A7F, 0x4AB9, 0x4AF2, 0x4B2A, 0x4B62, 0x4B9A, 0x4BCF,
+	0x4C08, 0x4C3B, 0x4C6E, 0x4CA4, 0x4CD9, 0x4D0C, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x4D49, 0x4D7C, 0x4DAE, 0x4DDF, 0x4E10, 0x4E41, 0x4E6F,
+	0x4EA1, 0x4ECD, 0x4EF9, 0x4F28, 0x4F56, 0x4F82, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x4FB8, 0x4FED, 0x5021, 0x5054, 0x5087, 0x50BA, 0x50EA,
+	0x511E, 0x514C, 0x517A, 0x51AB, 0x51DB, 0x5209, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x5241, 0x5277, 0x52AC, 0x52E0, 0x5314, 0x5348, 0x5379,
+	0x53AE, 0x53DD, 0x540C, 0x543E, 0x546F, 0x549E, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x54D7, 0x5505, 0x551C, 0x553E, 0x5563, 0x5587, 0x55AE, 0x55D2,
+	0x55F8, 0x561C, 0x5642, 0x5669, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0x5692, 0x56AF, 0x56CA, 0xFFFF, 0x56E8, 0xFFFF,
+	0x5704, 0x5729, 0x5736, 0x574E, 0x5766, 0x5773, 0x578F, 0x57BA,
+	0x57E1, 0x57FD, 0x5811, 0x581F, 0x5842, 0x5864, 0x588E, 0x58BE,
+	0x58D4, 0x5904, 0x591C, 0x5940, 0x5960, 0x597E, 0x59A0, 0x59C0,
+	0x59D8, 0x59F7, 0x5A1D, 0x5A3C, 0x5A58, 0x5A7F, 0x5A99, 0x5AB8,
+	0x5ACD, 0x5AE9, 0x5B03, 0x5B1F, 0x5B3A, 0x5B53, 0x5B70, 0x5B8F,
+	0x5BCD, 0x5C04, 0x5C3F, 0x5C6F, 0x5CA6, 0x5CDE, 0x5D13, 0x5D68,
+	0x5D92, 0x5DA9, 0x5DD0, 0x5DF8, 0x5E2D, 0x5E57, 0x5E7A, 0x5E97,
+	0x5EC0, 0x5ED1, 0x5EF4, 0x5F13, 0x5F30, 0x5F53, 0x5F6F, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x5F86, 0x5FB1, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x5FD8,
+	0x5FE4, 0x5FF3, 0x600A, 0x6038, 0x6056, 0x6080, 0x6096, 0x60B9,
+	0x60DB, 0x6100, 0x6121, 0x6146, 0x6166, 0x6187, 0xFFFF, 0xFFFF,
+	0x61A5, 0x61C9, 0x61EE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x61FF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x6227, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0x624B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x6261, 0x6293, 0x62BE, 0x62E5, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x6315, 0x633E,
+	0xFFFF, 0x6365, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+	0xFFFF, 0x6388,
+};
+
+static const asc_num_row_t asc_num_rows[256] = {
+	{    1, 0x21, 0xFFFF }, /* 00h */
+	{   35, 0x00, 0xFFFF }, /* 01h */
+	{   36, 0x00, 0xFFFF }, /* 02h */
+	{   37, 0x02, 0xFFFF }, /* 03h */
+	{   40, 0x22, 0xFFFF }, /* 04h */
+	{   75, 0x00, 0xFFFF }, /* 05h */
+	{   76, 0x00, 0xFFFF }, /* 06h */
+	{   77, 0x00, 0xFFFF }, /* 07h */
+	{   78, 0x04, 0xFFFF }, /* 08h */
+	{   83, 0x05, 0xFFFF }, /* 09h */
+	{   89, 0x00, 0xFFFF }, /* 0Ah */
+	{   90, 0x11, 0xFFFF }, /* 0Bh */
+	{  108, 0x10, 0xFFFF }, /* 0Ch */
+	{  125, 0x05, 0xFFFF }, /* 0Dh */
+	{  131, 0x03, 0xFFFF }, /* 0Eh */
+	{    0, 0x00, 0xFFFF }, /* 0Fh */
+	{  135, 0x05, 0xFFFF }, /* 10h */
+	{  141, 0x15, 0xFFFF }, /* 11h */
+	{  163, 0x00, 0xFFFF }, /* 12h */
+	{  164, 0x00, 0xFFFF }, /* 13h */
+	{  165, 0x07, 0xFFFF }, /* 14h */
+	{  173, 0x02, 0xFFFF }, /* 15h */
+	{  176, 0x04, 0xFFFF }, /* 16h */
+	{  181, 0x09, 0xFFFF }, /* 17h */
+	{  191, 0x08, 0xFFFF }, /* 18h */
+	{  200, 0x03, 0xFFFF }, /* 19h */
+	{  204, 0x00, 0xFFFF }, /* 1Ah */
+	{  205, 0x00, 0xFFFF }, /* 1Bh */
+	{  206, 0x02, 0xFFFF }, /* 1Ch */
+	{  209, 0x01, 0xFFFF }, /* 1Dh */
+	{  211, 0x00, 0xFFFF }, /* 1Eh */
+	{  212, 0x00, 0xFFFF }, /* 1Fh */
+	{  213, 0x0C, 0xFFFF }, /* 20h */
+	{  226, 0x07, 0xFFFF }, /* 21h */
+	{  234, 0x00, 0xFFFF }, /* 22h */
+	{  235, 0x0A, 0xFFFF }, /* 23h */
+	{  246, 0x08, 0xFFFF }, /* 24h */
+	{  255, 0x00, 0xFFFF }, /* 25h */
+	{  256, 0x13, 0xFFFF }, /* 26h */
+	{  276, 0x08, 0xFFFF }, /* 27h */
+	{  285, 0x03, 0xFFFF }, /* 28h */
+	{  289, 0x07, 0xFFFF }, /* 29h */
+	{  297, 0x15, 0xFFFF }, /* 2Ah */
+	{  319, 0x00, 0xFFFF }, /* 2Bh */
+	{  320, 0x0E, 0xFFFF }, /* 2Ch */
+	{  335, 0x00, 0xFFFF }, /* 2Dh */
+	{  336, 0x03, 0xFFFF }, /* 2Eh */
+	{  340, 0x03, 0xFFFF }, /* 2Fh */
+	{  344, 0x13, 0xFFFF }, /* 30h */
+	{  364, 0x03, 0xFFFF }, /* 31h */
+	{  368, 0x01, 0xFFFF }, /* 32h */
+	{  370, 0x00, 0xFFFF }, /* 33h */
+	{  371, 0x00, 0xFFFF }, /* 34h */
+	{  372, 0x05, 0xFFFF }, /* 35h */
+	{  378, 0x00, 0xFFFF }, /* 36h */
+	{  379, 0x00, 0xFFFF }, /* 37h */
+	{  380, 0x07, 0xFFFF }, /* 38h */
+	{  388, 0x00, 0xFFFF }, /* 39h */
+	{  389, 0x04, 0xFFFF }, /* 3Ah */
+	{  394, 0x1C, 0xFFFF }, /* 3Bh */
+	{    0, 0x00, 0xFFFF }, /* 3Ch */
+	{  423, 0x00, 0xFFFF }, /* 3Dh */
+	{  424, 0x04, 0xFFFF }, /* 3Eh */
+	{  429, 0x16, 0xFFFF }, /* 3Fh */
+	{  452, 0x00, 0x392E }, /* 40h */
+	{  453, 0x00, 0xFFFF }, /* 41h */
+	{  454, 0x00, 0xFFFF }, /* 42h */
+	{  455, 0x00, 0xFFFF }, /* 43h */
+	{  456, 0x71, 0xFFFF }, /* 44h */
+	{  570, 0x00, 0xFFFF }, /* 45h */
+	{  571, 0x00, 0xFFFF }, /* 46h */
+	{  572, 0x7F, 0xFFFF }, /* 47h */
+	{  700, 0x00, 0xFFFF }, /* 48h */
+	{  701, 0x00, 0xFFFF }, /* 49h */
+	{  702, 0x00, 0xFFFF }, /* 4Ah */
+	{  703, 0x15, 0xFFFF }, /* 4Bh */
+	{  725, 0x00, 0xFFFF }, /* 4Ch */
+	{    0, 0x00, 0x3E39 }, /* 4Dh */
+	{  726, 0x00, 0xFFFF }, /* 4Eh */
+	{    0, 0x00, 0xFFFF }, /* 4Fh */
+	{  727, 0x02, 0xFFFF }, /* 50h */
+	{  730, 0x01, 0xFFFF }, /* 51h */
+	{  732, 0x00, 0xFFFF }, /* 52h */
+	{  733, 0x0D, 0xFFFF }, /* 53h */
+	{  747, 0x00, 0xFFFF }, /* 54h */
+	{  748, 0x0E, 0xFFFF }, /* 55h */
+	{    0, 0x00, 0xFFFF }, /* 56h */
+	{  763, 0x00, 0xFFFF }, /* 57h */
+	{  764, 0x00, 0xFFFF }, /* 58h */
+	{  765, 0x00, 0xFFFF }, /* 59h */
+	{  766, 0x03, 0xFFFF }, /* 5Ah */
+	{  770, 0x03, 0xFFFF }, /* 5Bh */
+	{  774, 0x02, 0xFFFF }, /* 5Ch */
+	{  777, 0xFF, 0xFFFF }, /* 5Dh */
+	{ 1033, 0x47, 0xFFFF }, /* 5Eh */
+	{    0, 0x00, 0xFFFF }, /* 5Fh */
+	{ 1105, 0x00, 0xFFFF }, /* 60h */
+	{ 1106, 0x02, 0xFFFF }, /* 61h */
+	{ 1109, 0x00, 0xFFFF }, /* 62h */
+	{ 1110, 0x01, 0xFFFF }, /* 63h */
+	{ 1112, 0x01, 0xFFFF }, /* 64h */
+	{ 1114, 0x00, 0xFFFF }, /* 65h */
+	{ 1115, 0x03, 0xFFFF }, /* 66h */
+	{ 1119, 0x0B, 0xFFFF }, /* 67h */
+	{ 1131, 0x01, 0xFFFF }, /* 68h */
+	{ 1133, 0x02, 0xFFFF }, /* 69h */
+	{ 1136, 0x00, 0xFFFF }, /* 6Ah */
+	{ 1137, 0x02, 0xFFFF }, /* 6Bh */
+	{ 1140, 0x00, 0xFFFF }, /* 6Ch */
+	{ 1141, 0x00, 0xFFFF }, /* 6Dh */
+	{ 1142, 0x00, 0xFFFF }, /* 6Eh */
+	{ 1143, 0x07, 0xFFFF }, /* 6Fh */
+	{    0, 0x00, 0x5D37 }, /* 70h */
+	{ 1151, 0x00, 0xFFFF }, /* 71h */
+	{ 1152, 0x07, 0xFFFF }, /* 72h */
+	{ 1160, 0x17, 0xFFFF }, /* 73h */
+	{ 1184, 0x79, 0xFFFF }, /* 74h */
+	{    0, 0x00, 0xFFFF }, /* 75h */
+	{    0, 0x00, 0xFFFF }, /* 76h */
+	{    0, 0x00, 0xFFFF }, /* 77h */
+	{    0, 0x00, 0xFFFF }, /* 78h */
+	{    0, 0x00, 0xFFFF }, /* 79h */
+	{    0, 0x00, 0xFFFF }, /* 7Ah */
+	{    0, 0x00, 0xFFFF }, /* 7Bh */
+	{    0, 0x00, 0xFFFF }, /* 7Ch */
+	{    0, 0x00, 0xFFFF }, /* 7Dh */
+	{    0, 0x00, 0xFFFF }, /* 7Eh */
+	{    0, 0x00, 0xFFFF }, /* 7Fh */
+	{    0, 0x00, 0xFFFF }, /* 80h */
+	{    0, 0x00, 0xFFFF }, /* 81h */
+	{    0, 0x00, 0xFFFF }, /* 82h */
+	{    0, 0x00, 0xFFFF }, /* 83h */
+	{    0, 0x00, 0xFFFF }, /* 84h */
+	{    0, 0x00, 0xFFFF }, /* 85h */
+	{    0, 0x00, 0xFFFF }, /* 86h */
+	{    0, 0x00, 0xFFFF }, /* 87h */
+	{    0, 0x00, 0xFFFF }, /* 88h */
+	{    0, 0x00, 0xFFFF }, /* 89h */
+	{    0, 0x00, 0xFFFF }, /* 8Ah */
+	{    0, 0x00, 0xFFFF }, /* 8Bh */
+	{    0, 0x00, 0xFFFF }, /* 8Ch */
+	{    0, 0x00, 0xFFFF }, /* 8Dh */
+	{    0, 0x00, 0xFFFF }, /* 8Eh */
+	{    0, 0x00, 0xFFFF }, /* 8Fh */
+	{    0, 0x00, 0xFFFF }, /* 90h */
+	{    0, 0x00, 0xFFFF }, /* 91h */
+	{    0, 0x00, 0xFFFF }, /* 92h */
+	{    0, 0x00, 0xFFFF }, /* 93h */
+	{    0, 0x00, 0xFFFF }, /* 94h */
+	{    0, 0x00, 0xFFFF }, /* 95h */
+	{    0, 0x00, 0xFFFF }, /* 96h */
+	{    0, 0x00, 0xFFFF }, /* 97h */
+	{    0, 0x00, 0xFFFF }, /* 98h */
+	{    0, 0x00, 0xFFFF }, /* 99h */
+	{    0, 0x00, 0xFFFF }, /* 9Ah */
+	{    0, 0x00, 0xFFFF }, /* 9Bh */
+	{    0, 0x00, 0xFFFF }, /* 9Ch */
+	{    0, 0x00, 0xFFFF }, /* 9Dh */
+	{    0, 0x00, 0xFFFF }, /* 9Eh */
+	{    0, 0x00, 0xFFFF }, /* 9Fh */
+	{    0, 0x00, 0xFFFF }, /* A0h */
+	{    0, 0x00, 0xFFFF }, /* A1h */
+	{    0, 0x00, 0xFFFF }, /* A2h */
+	{    0, 0x00, 0xFFFF }, /* A3h */
+	{    0, 0x00, 0xFFFF }, /* A4h */
+	{    0, 0x00, 0xFFFF }, /* A5h */
+	{    0, 0x00, 0xFFFF }, /* A6h */
+	{    0, 0x00, 0xFFFF }, /* A7h */
+	{    0, 0x00, 0xFFFF }, /* A8h */
+	{    0, 0x00, 0xFFFF }, /* A9h */
+	{    0, 0x00, 0xFFFF }, /* AAh */
+	{    0, 0x00, 0xFFFF }, /* ABh */
+	{    0, 0x00, 0xFFFF }, /* ACh */
+	{    0, 0x00, 0xFFFF }, /* ADh */
+	{    0, 0x00, 0xFFFF }, /* AEh */
+	{    0, 0x00, 0xFFFF }, /* AFh */
+	{    0, 0x00, 0xFFFF }, /* B0h */
+	{    0, 0x00, 0xFFFF }, /* B1h */
+	{    0, 0x00, 0xFFFF }, /* B2h */
+	{    0, 0x00, 0xFFFF }, /* B3h */
+	{    0, 0x00, 0xFFFF }, /* B4h */
+	{    0, 0x00, 0xFFFF }, /* B5h */
+	{    0, 0x00, 0xFFFF }, /* B6h */
+	{    0, 0x00, 0xFFFF }, /* B7h */
+	{    0, 0x00, 0xFFFF }, /* B8h */
+	{    0, 0x00, 0xFFFF }, /* B9h */
+	{    0, 0x00, 0xFFFF }, /* BAh */
+	{    0, 0x00, 0xFFFF }, /* BBh */
+	{    0, 0x00, 0xFFFF }, /* BCh */
+	{    0, 0x00, 0xFFFF }, /* BDh */
+	{    0, 0x00, 0xFFFF }, /* BEh */
+	{    0, 0x00, 0xFFFF }, /* BFh */
+	{    0, 0x00, 0xFFFF }, /* C0h */
+	{    0, 0x00, 0xFFFF }, /* C1h */
+	{    0, 0x00, 0xFFFF }, /* C2h */
+	{    0, 0x00, 0xFFFF }, /* C3h */
+	{    0, 0x00, 0xFFFF }, /* C4h */
+	{    0, 0x00, 0xFFFF }, /* C5h */
+	{    0, 0x00, 0xFFFF }, /* C6h */
+	{    0, 0x00, 0xFFFF }, /* C7h */
+	{    0, 0x00, 0xFFFF }, /* C8h */
+	{    0, 0x00, 0xFFFF }, /* C9h */
+	{    0, 0x00, 0xFFFF }, /* CAh */
+	{    0, 0x00, 0xFFFF }, /* CBh */
+	{    0, 0x00, 0xFFFF }, /* CCh */
+	{    0, 0x00, 0xFFFF }, /* CDh */
+	{    0, 0x00, 0xFFFF }, /* CEh */
+	{    0, 0x00, 0xFFFF }, /* CFh */
+	{    0, 0x00, 0xFFFF }, /* D0h */
+	{    0, 0x00, 0xFFFF }, /* D1h */
+	{    0, 0x00, 0xFFFF }, /* D2h */
+	{    0, 0x00, 0xFFFF }, /* D3h */
+	{    0, 0x00, 0xFFFF }, /* D4h */
+	{    0, 0x00, 0xFFFF }, /* D5h */
+	{    0, 0x00, 0xFFFF }, /* D6h */
+	{    0, 0x00, 0xFFFF }, /* D7h */
+	{    0, 0x00, 0xFFFF }, /* D8h */
+	{    0, 0x00, 0xFFFF }, /* D9h */
+	{    0, 0x00, 0xFFFF }, /* DAh */
+	{    0, 0x00, 0xFFFF }, /* DBh */
+	{    0, 0x00, 0xFFFF }, /* DCh */
+	{    0, 0x00, 0xFFFF }, /* DDh */
+	{    0, 0x00, 0xFFFF }, /* DEh */
+	{    0, 0x00, 0xFFFF }, /* DFh */
+	{    0, 0x00, 0xFFFF }, /* E0h */
+	{    0, 0x00, 0xFFFF }, /* E1h */
+	{    0, 0x00, 0xFFFF }, /* E2h */
+	{    0, 0x00, 0xFFFF }, /* E3h */
+	{    0, 0x00, 0xFFFF }, /* E4h */
+	{    0, 0x00, 0xFFFF }, /* E5h */
+	{    0, 0x00, 0xFFFF }, /* E6h */
+	{    0, 0x00, 0xFFFF }, /* E7h */
+	{    0, 0x00, 0xFFFF }, /* E8h */
+	{    0, 0x00, 0xFFFF }, /* E9h */
+	{    0, 0x00, 0xFFFF }, /* EAh */
+	{    0, 0x00, 0xFFFF }, /* EBh */
+	{    0, 0x00, 0xFFFF }, /* ECh */
+	{    0, 0x00, 0xFFFF }, /* EDh */
+	{    0, 0x00, 0xFFFF }, /* EEh */
+	{    0, 0x00, 0xFFFF }, /* EFh */
+	{    0, 0x00, 0xFFFF }, /* F0h */
+	{    0, 0x00, 0xFFFF }, /* F1h */
+	{    0, 0x00, 0xFFFF }, /* F2h */
+	{    0, 0x00, 0xFFFF }, /* F3h */
+	{    0, 0x00, 0xFFFF }, /* F4h */
+	{    0, 0x00, 0xFFFF }, /* F5h */
+	{    0, 0x00, 0xFFFF }, /* F6h */
+	{    0, 0x00, 0xFFFF }, /* F7h */
+	{    0, 0x00, 0xFFFF }, /* F8h */
+	{    0, 0x00, 0xFFFF }, /* F9h */
+	{    0, 0x00, 0xFFFF }, /* FAh */
+	{    0, 0x00, 0xFFFF }, /* FBh */
+	{    0, 0x00, 0xFFFF }, /* FCh */
+	{    0, 0x00, 0xFFFF }, /* FDh */
+	{    0, 0x00, 0xFFFF }, /* FEh */
+	{    0, 0x00, 0xFFFF }, /* FFh */
+};
+
+#endif
@@ -97,7 +97,7 @@ int ata_parse_ata_smart_read_data(const unsigned char *buf, ata_smart_attr_t *at
 		attr->raw = (raw_attr[5]) |
 			        (raw_attr[6] << 8) |
 					(raw_attr[7] << 16) |
-					(raw_attr[8] << 24) |
+					((uint64_t)raw_attr[8] << 24) |
 					((uint64_t)raw_attr[9] << 32) |
 					((uint64_t)raw_attr[10] << 40);
 
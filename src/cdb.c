@@ -17,6 +17,8 @@
 #include "scsicmd.h"
 
 #include <memory.h>
+#include <endian.h>
+#include <stdlib.h>
 
 static inline void set_uint16(unsigned char *cdb, int start, uint16_t val)
 {
@@ -44,6 +46,19 @@ static inline void set_uint64(unsigned char *cdb, int start, uint64_t val)
         cdb[start+7] = val & 0xFF;
 }
 
+/* Single unaligned big-endian stores, used where many CDBs are built in a loop */
+static inline void put_be32(unsigned char *cdb, int start, uint32_t val)
+{
+        val = htobe32(val);
+        memcpy(cdb + start, &val, sizeof(val));
+}
+
+static inline void put_be64(unsigned char *cdb, int start, uint64_t val)
+{
+        val = htobe64(val);
+        memcpy(cdb + start, &val, sizeof(val));
+}
+
 int cdb_tur(unsigned char *cdb)
 {
 	const int TUR_LEN = 6;
@@ -130,6 +145,247 @@ int cdb_write_16(unsigned char *cdb, bool dpo, bool fua, bool fua_nv, uint64_t l
 	return LEN;
 }
 
+static int cdb_rw_16_range(unsigned char *cdbs, uint8_t opcode, uint8_t flags, uint64_t start_lba,
+                           uint32_t transfer_length_blocks, unsigned count, uint64_t stride)
+{
+	const int LEN = 16;
+	unsigned char tmpl[16];
+	unsigned i;
+
+	/* Everything but the LBA is the same in all the CDBs */
+	memset(tmpl, 0, sizeof(tmpl));
+	tmpl[0] = opcode;
+	tmpl[1] = flags;
+	put_be32(tmpl, 10, transfer_length_blocks);
+
+	for (i = 0; i < count; i++, cdbs += LEN, start_lba += stride) {
+		memcpy(cdbs, tmpl, LEN);
+		put_be64(cdbs, 2, start_lba);
+	}
+
+	return count;
+}
+
+int cdb_read_16_range(unsigned char *cdbs, bool fua, bool fua_nv, bool dpo, uint64_t start_lba,
+                      uint32_t transfer_length_blocks, unsigned count, uint64_t stride)
+{
+	return cdb_rw_16_range(cdbs, 0x88, (dpo<<4) | (fua<<3) | (fua_nv<<1), start_lba, transfer_length_blocks, count, stride);
+}
+
+int cdb_write_16_range(unsigned char *cdbs, bool dpo, bool fua, bool fua_nv, uint64_t start_lba,
+                       uint32_t transfer_length_blocks, unsigned count, uint64_t stride)
+{
+	return cdb_rw_16_range(cdbs, 0x8A, (dpo<<4) | (fua<<3) | (fua_nv<<1), start_lba, transfer_length_blocks, count, stride);
+}
+
+int cdb_rw_plan(cdb_rw_cmd_t *cmds, unsigned max_cmds, bool write, bool fua, uint64_t lba, uint64_t byte_len,
+                uint32_t block_size, const cdb_rw_limits_t *limits)
+{
+	const uint64_t LBA_10_MAX = 0xFFFFFFFFULL;
+	uint64_t num_blocks;
+	uint64_t offset = 0;
+	uint32_t max_len = 0xFFFFFFFF;
+	uint32_t opt_len = 0;
+	unsigned num_cmds = 0;
+
+	if (block_size == 0 || byte_len % block_size != 0)
+		return -1;
+	num_blocks = byte_len / block_size;
+	if (num_blocks > 0 && lba + num_blocks - 1 < lba)
+		return -1;
+
+	if (limits) {
+		if (limits->max_transfer_length)
+			max_len = limits->max_transfer_length;
+		if (limits->opt_transfer_length && limits->opt_transfer_length <= max_len)
+			opt_len = limits->opt_transfer_length;
+		if (limits->no_rw_16) {
+			if (num_blocks > 0 && lba + num_blocks - 1 > LBA_10_MAX)
+				return -1;
+			if (max_len > 0xFFFF)
+				max_len = 0xFFFF;
+			if (opt_len > max_len)
+				opt_len = 0;
+		}
+	}
+
+	while (num_blocks > 0) {
+		uint64_t len = num_blocks < max_len ? num_blocks : max_len;
+
+		/* Stop at the next optimal boundary so that the following commands are aligned */
+		if (opt_len) {
+			const uint64_t to_boundary = opt_len - lba % opt_len;
+			if (len > to_boundary)
+				len = to_boundary;
+		}
+
+		if (num_cmds < max_cmds) {
+			cdb_rw_cmd_t *cmd = &cmds[num_cmds];
+			const bool fits_10 = len <= 0xFFFF && lba + len - 1 <= LBA_10_MAX;
+
+			if (fits_10)
+				cmd->cdb_len = write ? cdb_write_10(cmd->cdb, fua, lba, len) : cdb_read_10(cmd->cdb, fua, lba, len);
+			else
+				cmd->cdb_len = write ? cdb_write_16(cmd->cdb, false, fua, false, lba, len) : cdb_read_16(cmd->cdb, fua, false, false, lba, len);
+			cmd->lba = lba;
+			cmd->transfer_length_blocks = len;
+			cmd->buf_offset = offset;
+		}
+
+		num_cmds++;
+		lba += len;
+		num_blocks -= len;
+		offset += len * block_size;
+	}
+
+	return num_cmds;
+}
+
+int cdb_unmap(unsigned char *cdb, bool anchor, uint8_t group, uint16_t param_len)
+{
+	const int LEN = 10;
+	memset(cdb, 0, LEN);
+	cdb[0] = 0x42;
+	cdb[1] = anchor;
+	cdb[6] = group & 0x1F;
+	set_uint16(cdb, 7, param_len);
+	return LEN;
+}
+
+int cdb_write_same_16(unsigned char *cdb, bool anchor, bool unmap, bool ndob, uint64_t lba, uint32_t num_blocks)
+{
+	const int LEN = 16;
+	cdb[0] = 0x93;
+	cdb[1] = (anchor<<4) | (unmap<<3) | ndob;
+	set_uint64(cdb, 2, lba);
+	set_uint32(cdb, 10, num_blocks);
+	cdb[14] = 0;
+	cdb[15] = 0;
+	return LEN;
+}
+
+static int unmap_extent_cmp(const void *a, const void *b)
+{
+	const unmap_extent_t *ea = a;
+	const unmap_extent_t *eb = b;
+
+	if (ea->lba < eb->lba)
+		return -1;
+	return ea->lba > eb->lba;
+}
+
+unsigned unmap_extents_normalize(unmap_extent_t *extents, unsigned num, const unmap_limits_t *limits)
+{
+	const uint64_t gran = limits && limits->granularity > 1 ? limits->granularity : 1;
+	const uint64_t align = limits ? limits->granularity_alignment % gran : 0;
+	unsigned i, out = 0;
+
+	qsort(extents, num, sizeof(*extents), unmap_extent_cmp);
+
+	for (i = 0; i < num; i++) {
+		uint64_t lba = extents[i].lba;
+		uint64_t end = lba + extents[i].num_blocks;
+
+		if (extents[i].num_blocks == 0)
+			continue;
+		if (end < lba)
+			end = UINT64_MAX;
+
+		if (out > 0 && lba <= extents[out-1].lba + extents[out-1].num_blocks) {
+			unmap_extent_t *last = &extents[out-1];
+			if (end > last->lba + last->num_blocks)
+				last->num_blocks = end - last->lba;
+		} else {
+			extents[out].lba = lba;
+			extents[out].num_blocks = end - lba;
+			out++;
+		}
+	}
+
+	if (gran == 1)
+		return out;
+
+	/* Only whole granules are unmapped by the device, trim the partial ones at the edges */
+	num = out;
+	out = 0;
+	for (i = 0; i < num; i++) {
+		uint64_t start = extents[i].lba;
+		uint64_t end = start + extents[i].num_blocks;
+
+		if (end < align)
+			continue;
+		start = start <= align ? align : align + (start - align + gran - 1) / gran * gran;
+		end = align + (end - align) / gran * gran;
+		if (end <= start)
+			continue;
+
+		extents[out].lba = start;
+		extents[out].num_blocks = end - start;
+		out++;
+	}
+
+	return out;
+}
+
+unsigned unmap_param_list_next(unmap_cursor_t *cursor, const unmap_limits_t *limits, unsigned char *buf, unsigned buf_len)
+{
+	const uint64_t gran = limits && limits->granularity > 1 ? limits->granularity : 1;
+	unsigned max_descs = UNMAP_MAX_DESCS;
+	uint64_t max_lba = UINT64_MAX;
+	uint64_t desc_max = UNMAP_DESC_MAX_BLOCKS - UNMAP_DESC_MAX_BLOCKS % gran;
+	uint64_t total = 0;
+	unsigned num_descs = 0;
+	unsigned len;
+
+	if (buf_len < UNMAP_HEADER_LEN + UNMAP_DESC_LEN)
+		return 0;
+	if ((buf_len - UNMAP_HEADER_LEN) / UNMAP_DESC_LEN < max_descs)
+		max_descs = (buf_len - UNMAP_HEADER_LEN) / UNMAP_DESC_LEN;
+
+	if (limits) {
+		if (limits->max_descriptor_count && limits->max_descriptor_count < max_descs)
+			max_descs = limits->max_descriptor_count;
+		if (limits->max_lba_count) {
+			max_lba = limits->max_lba_count;
+			/* Keep the split points of a long extent on granule boundaries */
+			if (max_lba >= gran)
+				max_lba -= max_lba % gran;
+		}
+	}
+
+	while (cursor->idx < cursor->num && num_descs < max_descs && total < max_lba) {
+		const unmap_extent_t *extent = &cursor->extents[cursor->idx];
+		unsigned char *desc = buf + UNMAP_HEADER_LEN + num_descs * UNMAP_DESC_LEN;
+		uint64_t num_blocks = extent->num_blocks - cursor->done_blocks;
+
+		if (num_blocks > desc_max)
+			num_blocks = desc_max;
+		if (num_blocks > max_lba - total)
+			num_blocks = max_lba - total;
+
+		set_uint64(desc, 0, extent->lba + cursor->done_blocks);
+		set_uint32(desc, 8, num_blocks);
+		memset(desc + 12, 0, 4);
+		num_descs++;
+		total += num_blocks;
+
+		cursor->done_blocks += num_blocks;
+		if (cursor->done_blocks == extent->num_blocks) {
+			cursor->idx++;
+			cursor->done_blocks = 0;
+		}
+	}
+
+	if (num_descs == 0)
+		return 0;
+
+	len = UNMAP_HEADER_LEN + num_descs * UNMAP_DESC_LEN;
+	set_uint16(buf, 0, len - 2);
+	set_uint16(buf, 2, num_descs * UNMAP_DESC_LEN);
+	memset(buf + 4, 0, 4);
+	return len;
+}
+
 int cdb_log_sense(unsigned char *cdb, uint8_t page_code, uint8_t subpage_code, uint16_t alloc_len)
 {
 	const int LEN = 10;
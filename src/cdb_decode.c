@@ -0,0 +1,181 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "cdb_decode.h"
+
+#include <memory.h>
+
+#define STRINGIFY(name) # name
+
+/* Where every field lives in the CDB of an opcode, an offset of 0 means the command doesn't have the field since
+ * byte 0 is always the opcode.
+ */
+typedef struct cdb_layout_t {
+	uint8_t len;
+	uint8_t kind;
+	uint8_t flags_off;
+	uint8_t flags_mask;
+	uint8_t lba_off;
+	uint8_t lba_size;
+	uint8_t xfer_off;
+	uint8_t xfer_size;
+	uint8_t page_off;
+	uint8_t page_mask;
+	uint8_t subpage_off;
+	uint8_t pc_off;
+	uint8_t pc_shift;
+	uint8_t format_off;
+} cdb_layout_t;
+
+#define RW_FLAGS (CDB_FLAG_DPO | CDB_FLAG_FUA | CDB_FLAG_FUA_NV)
+
+static const cdb_layout_t cdb_layouts[256] = {
+	[0x00] = { .len = 6, .kind = CDB_KIND_TEST_UNIT_READY },
+	[0x12] = { .len = 6, .kind = CDB_KIND_INQUIRY, .flags_off = 1, .flags_mask = CDB_FLAG_EVPD,
+	           .xfer_off = 3, .xfer_size = 2, .page_off = 2, .page_mask = 0xFF },
+	[0x1A] = { .len = 6, .kind = CDB_KIND_MODE_SENSE_6, .flags_off = 1, .flags_mask = CDB_FLAG_DBD,
+	           .xfer_off = 4, .xfer_size = 1, .page_off = 2, .page_mask = 0x3F, .subpage_off = 3, .pc_off = 2, .pc_shift = 6 },
+	[0x1C] = { .len = 6, .kind = CDB_KIND_RECEIVE_DIAGNOSTICS, .flags_off = 1, .flags_mask = CDB_FLAG_PCV,
+	           .xfer_off = 3, .xfer_size = 2, .page_off = 2, .page_mask = 0xFF },
+	[0x1D] = { .len = 6, .kind = CDB_KIND_SEND_DIAGNOSTICS, .xfer_off = 3, .xfer_size = 2, .pc_off = 1, .pc_shift = 5 },
+	[0x25] = { .len = 10, .kind = CDB_KIND_READ_CAPACITY_10 },
+	[0x28] = { .len = 10, .kind = CDB_KIND_READ_10, .flags_off = 1, .flags_mask = CDB_FLAG_FUA,
+	           .lba_off = 2, .lba_size = 4, .xfer_off = 7, .xfer_size = 2 },
+	[0x2A] = { .len = 10, .kind = CDB_KIND_WRITE_10, .flags_off = 1, .flags_mask = CDB_FLAG_FUA,
+	           .lba_off = 2, .lba_size = 4, .xfer_off = 7, .xfer_size = 2 },
+	[0x37] = { .len = 10, .kind = CDB_KIND_READ_DEFECT_DATA_10, .flags_off = 2, .flags_mask = CDB_FLAG_PLIST | CDB_FLAG_GLIST,
+	           .xfer_off = 7, .xfer_size = 2, .format_off = 2 },
+	[0x42] = { .len = 10, .kind = CDB_KIND_UNMAP, .flags_off = 1, .flags_mask = CDB_FLAG_ANCHOR, .xfer_off = 7, .xfer_size = 2 },
+	[0x4D] = { .len = 10, .kind = CDB_KIND_LOG_SENSE, .xfer_off = 7, .xfer_size = 2,
+	           .page_off = 2, .page_mask = 0x3F, .subpage_off = 3, .pc_off = 2, .pc_shift = 6 },
+	[0x5A] = { .len = 10, .kind = CDB_KIND_MODE_SENSE_10, .flags_off = 1, .flags_mask = CDB_FLAG_LLBAA | CDB_FLAG_DBD,
+	           .xfer_off = 7, .xfer_size = 2, .page_off = 2, .page_mask = 0x3F, .subpage_off = 3, .pc_off = 2, .pc_shift = 6 },
+	[0x85] = { .len = 16, .kind = CDB_KIND_ATA_PASSTHROUGH_16 },
+	[0x88] = { .len = 16, .kind = CDB_KIND_READ_16, .flags_off = 1, .flags_mask = RW_FLAGS,
+	           .lba_off = 2, .lba_size = 8, .xfer_off = 10, .xfer_size = 4 },
+	[0x8A] = { .len = 16, .kind = CDB_KIND_WRITE_16, .flags_off = 1, .flags_mask = RW_FLAGS,
+	           .lba_off = 2, .lba_size = 8, .xfer_off = 10, .xfer_size = 4 },
+	[0x93] = { .len = 16, .kind = CDB_KIND_WRITE_SAME_16, .flags_off = 1, .flags_mask = CDB_FLAG_WS_ANCHOR | CDB_FLAG_UNMAP | CDB_FLAG_NDOB,
+	           .lba_off = 2, .lba_size = 8, .xfer_off = 10, .xfer_size = 4 },
+	[0x9E] = { .len = 16, .kind = CDB_KIND_READ_CAPACITY_16, .xfer_off = 10, .xfer_size = 4 },
+	[0xA1] = { .len = 12, .kind = CDB_KIND_ATA_PASSTHROUGH_12 },
+	[0xB7] = { .len = 12, .kind = CDB_KIND_READ_DEFECT_DATA_12, .flags_off = 1, .flags_mask = CDB_FLAG_PLIST | CDB_FLAG_GLIST,
+	           .xfer_off = 6, .xfer_size = 4, .format_off = 1 },
+};
+
+const char *cdb_kind_name(cdb_kind_e kind)
+{
+#define X(name, opcode) case CDB_KIND_##name: return STRINGIFY(name);
+	switch (kind) {
+	CDB_KIND_LIST
+#undef X
+	case CDB_KIND_UNKNOWN: break;
+	}
+
+	return "UNKNOWN";
+}
+
+cdb_kind_e cdb_opcode_kind(uint8_t opcode)
+{
+	return cdb_layouts[opcode].kind;
+}
+
+static inline uint64_t cdb_get_field(const unsigned char *cdb, unsigned off, unsigned size)
+{
+	uint64_t val = 0;
+	unsigned i;
+
+	for (i = 0; i < size; i++)
+		val = (val << 8) | cdb[off + i];
+	return val;
+}
+
+static void cdb_decode_ata_12(const unsigned char *cdb, cdb_ata_taskfile_t *ata)
+{
+	ata->protocol = (cdb[1] >> 1) & 0xF;
+	ata->extend = false;
+	ata->flags_2 = cdb[2];
+	ata->feature = cdb[3];
+	ata->sector_count = cdb[4];
+	ata->device = cdb[8];
+	ata->lba = (uint64_t)(cdb[8] & 0x0F) << 24 | cdb[7] << 16 | cdb[6] << 8 | cdb[5];
+	ata->command = cdb[9];
+}
+
+static void cdb_decode_ata_16(const unsigned char *cdb, cdb_ata_taskfile_t *ata)
+{
+	ata->protocol = (cdb[1] >> 1) & 0xF;
+	ata->extend = cdb[1] & 1;
+	ata->flags_2 = cdb[2];
+	ata->device = cdb[13];
+	ata->command = cdb[14];
+
+	if (ata->extend) {
+		ata->feature = cdb[3] << 8 | cdb[4];
+		ata->sector_count = cdb[5] << 8 | cdb[6];
+		ata->lba = (uint64_t)cdb[11] << 40 | (uint64_t)cdb[9] << 32 | (uint64_t)cdb[7] << 24 |
+		           cdb[12] << 16 | cdb[10] << 8 | cdb[8];
+	} else {
+		ata->feature = cdb[4];
+		ata->sector_count = cdb[6];
+		ata->lba = (uint64_t)(cdb[13] & 0x0F) << 24 | cdb[12] << 16 | cdb[10] << 8 | cdb[8];
+	}
+}
+
+bool cdb_decode(const unsigned char *cdb, unsigned cdb_len, cdb_decoded_t *out)
+{
+	const cdb_layout_t *layout;
+
+	memset(out, 0, sizeof(*out));
+	if (cdb_len == 0)
+		return false;
+
+	out->opcode = cdb[0];
+	layout = &cdb_layouts[cdb[0]];
+	out->kind = layout->kind;
+	out->cdb_len = layout->len;
+
+	if (layout->kind == CDB_KIND_UNKNOWN || cdb_len < layout->len)
+		return false;
+
+	/* SERVICE ACTION IN (16) carries more than READ CAPACITY 16 */
+	if (layout->kind == CDB_KIND_READ_CAPACITY_16 && (cdb[1] & 0x1F) != 0x10) {
+		out->kind = CDB_KIND_UNKNOWN;
+		return false;
+	}
+
+	if (layout->flags_off)
+		out->flags = cdb[layout->flags_off] & layout->flags_mask;
+	if (layout->lba_size)
+		out->lba = cdb_get_field(cdb, layout->lba_off, layout->lba_size);
+	if (layout->xfer_size)
+		out->transfer_len = cdb_get_field(cdb, layout->xfer_off, layout->xfer_size);
+	if (layout->page_off)
+		out->page_code = cdb[layout->page_off] & layout->page_mask;
+	if (layout->subpage_off)
+		out->subpage_code = cdb[layout->subpage_off];
+	if (layout->pc_off)
+		out->page_control = cdb[layout->pc_off] >> layout->pc_shift;
+	if (layout->format_off)
+		out->format = cdb[layout->format_off] & 0x7;
+
+	if (layout->kind == CDB_KIND_ATA_PASSTHROUGH_12)
+		cdb_decode_ata_12(cdb, &out->ata);
+	else if (layout->kind == CDB_KIND_ATA_PASSTHROUGH_16)
+		cdb_decode_ata_16(cdb, &out->ata);
+
+	return true;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "cdb_template.h"
+
+/* Called after the CDB itself was built into tmpl->cdb */
+static int cdb_template_init(cdb_template_t *tmpl, int cdb_len)
+{
+	tmpl->cdb_len = cdb_len;
+	tmpl->lba_offset = 2;
+	if (cdb_len == 16) {
+		tmpl->len_offset = 10;
+		tmpl->long_lba = true;
+	} else {
+		tmpl->len_offset = 7;
+		tmpl->long_lba = false;
+	}
+	return cdb_len;
+}
+
+int cdb_template_read_10(cdb_template_t *tmpl, bool fua)
+{
+	return cdb_template_init(tmpl, cdb_read_10(tmpl->cdb, fua, 0, 0));
+}
+
+int cdb_template_write_10(cdb_template_t *tmpl, bool fua)
+{
+	return cdb_template_init(tmpl, cdb_write_10(tmpl->cdb, fua, 0, 0));
+}
+
+int cdb_template_read_16(cdb_template_t *tmpl, bool fua, bool fua_nv, bool dpo)
+{
+	return cdb_template_init(tmpl, cdb_read_16(tmpl->cdb, fua, fua_nv, dpo, 0, 0));
+}
+
+int cdb_template_write_16(cdb_template_t *tmpl, bool dpo, bool fua, bool fua_nv)
+{
+	return cdb_template_init(tmpl, cdb_write_16(tmpl->cdb, dpo, fua, fua_nv, 0, 0));
+}
+
+void cdb_template_pool_init(cdb_template_t *pool, unsigned count, const cdb_template_t *proto)
+{
+	unsigned i;
+
+	for (i = 0; i < count; i++)
+		pool[i] = *proto;
+}
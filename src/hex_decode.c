@@ -0,0 +1,290 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "hex_decode.h"
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HEX_DECODE_X86 1
+#include <immintrin.h>
+#endif
+
+#define HEX_SPACE 0x20
+
+/* Digit value + 1, HEX_SPACE for white space and zero for anything else */
+static const uint8_t hex_class[256] = {
+	['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+	['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+	['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+	[' '] = HEX_SPACE, ['\t'] = HEX_SPACE, ['\n'] = HEX_SPACE, ['\v'] = HEX_SPACE, ['\f'] = HEX_SPACE, ['\r'] = HEX_SPACE,
+};
+
+static inline const char *hex_skip_space(const char *str, const char *end)
+{
+	while (str < end && hex_class[(uint8_t)*str] == HEX_SPACE)
+		str++;
+	return str;
+}
+
+/* Decode the two digits at str, there must be at least two chars left */
+static inline bool hex_decode_pair(const char *str, unsigned char *out)
+{
+	const uint8_t hi = hex_class[(uint8_t)str[0]] - 1;
+	const uint8_t lo = hex_class[(uint8_t)str[1]] - 1;
+
+	if (hi >= 16 || lo >= 16)
+		return false;
+	*out = hi << 4 | lo;
+	return true;
+}
+
+static long hex_decode_scalar(const char *str, const char *end, unsigned char *out)
+{
+	unsigned char *o = out;
+
+	for (;;) {
+		str = hex_skip_space(str, end);
+		if (str == end)
+			return o - out;
+		if (end - str < 2 || !hex_decode_pair(str, o))
+			return -1;
+		str += 2;
+		o++;
+	}
+}
+
+#ifdef HEX_DECODE_X86
+
+/* A block is 48 chars of "xx " that make 16 bytes. The digits are gathered from the three 16 char loads with a
+ * shuffle each, hence SSSE3, SSE2 has no byte shuffle. Separator positions in each load and the shuffles that pick the
+ * high and low digits of every byte follow.
+ */
+static const uint16_t hex_sep_mask[3] = { 0x4924, 0x2492, 0x9249 };
+
+static const int8_t hex_hi_shuf[3][16] = {
+	{ 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128 },
+	{ -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128 },
+	{ -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13 },
+};
+
+static const int8_t hex_lo_shuf[3][16] = {
+	{ 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128 },
+	{ -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128 },
+	{ -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14 },
+};
+
+/* Digit chars to their values, valid is cleared for the chars that aren't hex digits */
+__attribute__((target("ssse3")))
+static inline __m128i hex_nibbles_128(__m128i x, __m128i *valid)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+	const __m128i a = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	const __m128i is_digit = _mm_cmpeq_epi8(_mm_subs_epu8(d, _mm_set1_epi8(9)), zero);
+	const __m128i is_alpha = _mm_cmpeq_epi8(_mm_subs_epu8(a, _mm_set1_epi8(5)), zero);
+
+	*valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_alpha));
+	return _mm_or_si128(_mm_and_si128(is_digit, d), _mm_andnot_si128(is_digit, _mm_add_epi8(a, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static inline bool hex_block_ssse3(const char *str, unsigned char *out)
+{
+	const __m128i space = _mm_set1_epi8(' ');
+	__m128i in[3];
+	__m128i hi = _mm_setzero_si128();
+	__m128i lo = _mm_setzero_si128();
+	__m128i valid = _mm_set1_epi8(-1);
+	unsigned i;
+
+	for (i = 0; i < 3; i++) {
+		in[i] = _mm_loadu_si128((const __m128i *)(str + 16*i));
+		if ((_mm_movemask_epi8(_mm_cmpeq_epi8(in[i], space)) & hex_sep_mask[i]) != hex_sep_mask[i])
+			return false;
+		hi = _mm_or_si128(hi, _mm_shuffle_epi8(in[i], _mm_loadu_si128((const __m128i *)hex_hi_shuf[i])));
+		lo = _mm_or_si128(lo, _mm_shuffle_epi8(in[i], _mm_loadu_si128((const __m128i *)hex_lo_shuf[i])));
+	}
+
+	hi = hex_nibbles_128(hi, &valid);
+	lo = hex_nibbles_128(lo, &valid);
+	if (_mm_movemask_epi8(valid) != 0xFFFF)
+		return false;
+
+	/* The nibbles are below 16, shifting the 16 bit lanes doesn't spill between the bytes */
+	_mm_storeu_si128((__m128i *)out, _mm_or_si128(_mm_slli_epi16(hi, 4), lo));
+	return true;
+}
+
+__attribute__((target("ssse3")))
+static long hex_decode_ssse3(const char *str, const char *end, unsigned char *out)
+{
+	unsigned char *o = out;
+
+	for (;;) {
+		str = hex_skip_space(str, end);
+		while (end - str >= 48 && hex_block_ssse3(str, o)) {
+			str += 48;
+			o += 16;
+		}
+		str = hex_skip_space(str, end);
+		if (str == end)
+			return o - out;
+		if (end - str < 2 || !hex_decode_pair(str, o))
+			return -1;
+		str += 2;
+		o++;
+	}
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hex_nibbles_256(__m256i x, __m256i *valid)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8('0'));
+	const __m256i a = _mm256_sub_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+	const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_subs_epu8(d, _mm256_set1_epi8(9)), zero);
+	const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_subs_epu8(a, _mm256_set1_epi8(5)), zero);
+
+	*valid = _mm256_and_si256(*valid, _mm256_or_si256(is_digit, is_alpha));
+	return _mm256_or_si256(_mm256_and_si256(is_digit, d), _mm256_andnot_si256(is_digit, _mm256_add_epi8(a, _mm256_set1_epi8(10))));
+}
+
+/* Two blocks at once, one in each 128 bit lane since the AVX2 shuffle doesn't cross lanes */
+__attribute__((target("avx2")))
+static inline bool hex_block_avx2(const char *str, unsigned char *out)
+{
+	const __m256i space = _mm256_set1_epi8(' ');
+	__m256i hi = _mm256_setzero_si256();
+	__m256i lo = _mm256_setzero_si256();
+	__m256i valid = _mm256_set1_epi8(-1);
+	unsigned i;
+
+	for (i = 0; i < 3; i++) {
+		const uint32_t sep = hex_sep_mask[i] | (uint32_t)hex_sep_mask[i] << 16;
+		const __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(str + 16*i))),
+		                                           _mm_loadu_si128((const __m128i *)(str + 48 + 16*i)), 1);
+
+		if (((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, space)) & sep) != sep)
+			return false;
+		hi = _mm256_or_si256(hi, _mm256_shuffle_epi8(in, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hex_hi_shuf[i]))));
+		lo = _mm256_or_si256(lo, _mm256_shuffle_epi8(in, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hex_lo_shuf[i]))));
+	}
+
+	hi = hex_nibbles_256(hi, &valid);
+	lo = hex_nibbles_256(lo, &valid);
+	if ((uint32_t)_mm256_movemask_epi8(valid) != 0xFFFFFFFF)
+		return false;
+
+	_mm256_storeu_si256((__m256i *)out, _mm256_or_si256(_mm256_slli_epi16(hi, 4), lo));
+	return true;
+}
+
+__attribute__((target("avx2")))
+static long hex_decode_avx2(const char *str, const char *end, unsigned char *out)
+{
+	unsigned char *o = out;
+
+	for (;;) {
+		str = hex_skip_space(str, end);
+		while (end - str >= 96 && hex_block_avx2(str, o)) {
+			str += 96;
+			o += 32;
+		}
+		while (end - str >= 48 && hex_block_ssse3(str, o)) {
+			str += 48;
+			o += 16;
+		}
+		str = hex_skip_space(str, end);
+		if (str == end)
+			return o - out;
+		if (end - str < 2 || !hex_decode_pair(str, o))
+			return -1;
+		str += 2;
+		o++;
+	}
+}
+
+#endif
+
+bool hex_decode_impl_supported(hex_decode_impl_e impl)
+{
+	switch (impl) {
+		case HEX_DECODE_SCALAR:
+		case HEX_DECODE_BEST:
+			return true;
+#ifdef HEX_DECODE_X86
+		case HEX_DECODE_SSSE3:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("ssse3");
+		case HEX_DECODE_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+
+const char *hex_decode_impl_name(hex_decode_impl_e impl)
+{
+	switch (impl) {
+		case HEX_DECODE_SCALAR: return "scalar";
+		case HEX_DECODE_SSSE3: return "ssse3";
+		case HEX_DECODE_AVX2: return "avx2";
+		case HEX_DECODE_BEST: return "best";
+	}
+	return "unknown";
+}
+
+static hex_decode_impl_e hex_decode_best(void)
+{
+	/* Resolved on first use, every thread resolves to the same so the race is harmless */
+	static int best = -1;
+	int impl = __atomic_load_n(&best, __ATOMIC_RELAXED);
+
+	if (impl < 0) {
+		if (hex_decode_impl_supported(HEX_DECODE_AVX2))
+			impl = HEX_DECODE_AVX2;
+		else if (hex_decode_impl_supported(HEX_DECODE_SSSE3))
+			impl = HEX_DECODE_SSSE3;
+		else
+			impl = HEX_DECODE_SCALAR;
+		__atomic_store_n(&best, impl, __ATOMIC_RELAXED);
+	}
+	return impl;
+}
+
+long hex_decode_impl(hex_decode_impl_e impl, const char *str, size_t len, unsigned char *out)
+{
+	if (impl == HEX_DECODE_BEST)
+		impl = hex_decode_best();
+	else if (!hex_decode_impl_supported(impl))
+		return -2;
+
+	switch (impl) {
+#ifdef HEX_DECODE_X86
+		case HEX_DECODE_SSSE3: return hex_decode_ssse3(str, str + len, out);
+		case HEX_DECODE_AVX2: return hex_decode_avx2(str, str + len, out);
+#endif
+		default: return hex_decode_scalar(str, str + len, out);
+	}
+}
+
+long hex_decode(const char *str, size_t len, unsigned char *out)
+{
+	return hex_decode_impl(HEX_DECODE_BEST, str, len, out);
+}
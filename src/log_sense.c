@@ -1,17 +1,27 @@
 #include "parse_log_sense.h"
 
-bool log_sense_page_informational_exceptions(uint8_t *page, unsigned page_len, uint8_t *asc, uint8_t *ascq, uint8_t *temperature)
+#include <string.h>
+#include <stdlib.h>
+
+static bool log_sense_page_is(uint8_t *page, unsigned page_len, uint8_t page_code)
 {
 	if (!log_sense_is_valid(page, page_len))
 		return false;
-	if (log_sense_page_code(page) != 0x2F)
+	if (log_sense_page_code(page) != page_code)
 		return false;
 	if (log_sense_subpage_format(page) && log_sense_subpage_code(page) != 0)
 		return false;
+	return true;
+}
+
+bool log_sense_page_informational_exceptions(uint8_t *page, unsigned page_len, uint8_t *asc, uint8_t *ascq, uint8_t *temperature)
+{
+	if (!log_sense_page_is(page, page_len, 0x2F))
+		return false;
 
 	uint8_t *param;
 	for_all_log_sense_params(page, page_len, param) {
-		if (log_sense_param_code(param) == 0) {
+		if (log_sense_param_code(param) == 0 && log_sense_param_len(param) >= 3) {
 			uint8_t *param_data = log_sense_param_data(param);
 			*asc = param_data[0];
 			*ascq = param_data[1];
@@ -24,3 +34,486 @@ bool log_sense_page_informational_exceptions(uint8_t *page, unsigned page_len, u
 }
 
 
+
+static int log_sense_index_entry_cmp(const void *a, const void *b)
+{
+	const log_sense_index_entry_t *ea = a;
+	const log_sense_index_entry_t *eb = b;
+
+	if (ea->param_code != eb->param_code)
+		return ea->param_code < eb->param_code ? -1 : 1;
+	/* Keep the page order of a repeated code so that the first one is found */
+	return ea->offset < eb->offset ? -1 : ea->offset > eb->offset;
+}
+
+bool log_sense_index_build(log_sense_index_t *idx, uint8_t *page, unsigned page_len)
+{
+	bool sorted = true;
+	uint8_t *param;
+
+	idx->page = page;
+	idx->num_entries = 0;
+	idx->truncated = false;
+
+	if (!log_sense_is_valid(page, page_len))
+		return false;
+
+	for_all_log_sense_params(page, page_len, param) {
+		log_sense_index_entry_t *entry;
+
+		if (idx->num_entries == idx->max_entries) {
+			idx->truncated = true;
+			break;
+		}
+
+		entry = &idx->entries[idx->num_entries];
+		entry->param_code = log_sense_param_code(param);
+		entry->flags = log_sense_param_flags(param);
+		entry->len = log_sense_param_len(param);
+		entry->offset = param - page;
+		if (idx->num_entries > 0 && entry[-1].param_code > entry->param_code)
+			sorted = false;
+		idx->num_entries++;
+	}
+
+	if (!sorted)
+		qsort(idx->entries, idx->num_entries, sizeof(idx->entries[0]), log_sense_index_entry_cmp);
+	return true;
+}
+
+const log_sense_index_entry_t *log_sense_index_find_entry(const log_sense_index_t *idx, uint16_t param_code)
+{
+	unsigned low = 0;
+	unsigned high = idx->num_entries;
+
+	/* Lower bound so that the first of a repeated code is found */
+	while (low < high) {
+		const unsigned mid = low + (high - low) / 2;
+
+		if (idx->entries[mid].param_code < param_code)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low < idx->num_entries && idx->entries[low].param_code == param_code)
+		return &idx->entries[low];
+	return NULL;
+}
+
+static bool log_sense_param_is_counter(uint8_t *param)
+{
+	const uint8_t fmt = log_sense_param_fmt(param);
+	return fmt == LOG_PARAM_FMT_COUNTER_STOP || fmt == LOG_PARAM_FMT_COUNTER_ROLLOVER;
+}
+
+static uint64_t log_counter_max(unsigned len)
+{
+	return len >= 8 ? UINT64_MAX : (UINT64_C(1) << (8 * len)) - 1;
+}
+
+static void log_counter_delta(const log_sense_index_t *prev_idx, uint8_t *param, log_counter_delta_t *delta)
+{
+	uint8_t *prev_param = log_sense_index_find(prev_idx, delta->param_code);
+	const unsigned len = log_sense_param_len(param);
+	const uint64_t max = log_counter_max(len);
+	const uint8_t fmt = log_sense_param_fmt(param);
+	uint64_t prev;
+
+	if (!prev_param && prev_idx->truncated) {
+		delta->status = LOG_DELTA_UNKNOWN;
+		delta->delta = 0;
+		return;
+	}
+	if (!prev_param || !log_sense_param_is_counter(prev_param) || !log_sense_param_counter(prev_param, &prev)) {
+		delta->status = LOG_DELTA_NEW;
+		delta->delta = 0;
+		return;
+	}
+
+	if ((delta->flags | log_sense_param_flags(prev_param)) & LOG_PARAM_FLAG_DU) {
+		delta->status = LOG_DELTA_DISABLED;
+		delta->delta = 0;
+		return;
+	}
+
+	if (log_sense_param_len(prev_param) != len) {
+		delta->status = LOG_DELTA_RESET;
+		delta->delta = delta->value;
+		return;
+	}
+
+	if (delta->value >= prev) {
+		delta->delta = delta->value - prev;
+		if (fmt == LOG_PARAM_FMT_COUNTER_STOP && delta->value == max)
+			delta->status = LOG_DELTA_SATURATED;
+		else
+			delta->status = LOG_DELTA_OK;
+	} else if (fmt == LOG_PARAM_FMT_COUNTER_ROLLOVER && !(delta->flags & LOG_PARAM_FLAG_TSD)) {
+		delta->status = LOG_DELTA_ROLLOVER;
+		delta->delta = (max - prev) + delta->value + 1;
+	} else {
+		delta->status = LOG_DELTA_RESET;
+		delta->delta = delta->value;
+	}
+}
+
+int log_sense_counter_deltas(const log_sense_index_t *prev, uint8_t *cur, unsigned cur_len, double elapsed_sec,
+                             log_counter_delta_t *deltas, unsigned max_deltas)
+{
+	unsigned num_deltas = 0;
+	uint8_t *param;
+
+	if (!log_sense_is_valid(cur, cur_len) || !prev->page)
+		return -1;
+	if (log_sense_page_code(cur) != log_sense_page_code(prev->page) ||
+	    log_sense_subpage_format(cur) != log_sense_subpage_format(prev->page) ||
+	    log_sense_subpage_code(cur) != log_sense_subpage_code(prev->page))
+		return -1;
+
+	for_all_log_sense_params(cur, cur_len, param) {
+		log_counter_delta_t *delta;
+
+		if (num_deltas == max_deltas)
+			break;
+		if (!log_sense_param_is_counter(param))
+			continue;
+
+		delta = &deltas[num_deltas];
+		if (!log_sense_param_counter(param, &delta->value))
+			continue;
+		num_deltas++;
+
+		delta->param_code = log_sense_param_code(param);
+		delta->flags = log_sense_param_flags(param);
+		log_counter_delta(prev, param, delta);
+		delta->rate = elapsed_sec > 0 ? delta->delta / elapsed_sec : 0;
+	}
+
+	return num_deltas;
+}
+
+bool log_sense_page_error_counter(uint8_t *page, unsigned page_len, log_page_error_counter_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_WRITE_ERROR_COUNTER) &&
+	    !log_sense_page_is(page, page_len, LOG_PAGE_READ_ERROR_COUNTER) &&
+	    !log_sense_page_is(page, page_len, LOG_PAGE_VERIFY_ERROR_COUNTER))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+
+		if (param_code < LOG_ERROR_COUNTER_NUM_PARAMS && log_sense_param_counter(param, &out->counter[param_code]))
+			out->valid |= LOG_PARAM_BIT(param_code);
+	}
+	return true;
+}
+
+bool log_sense_page_non_medium_error(uint8_t *page, unsigned page_len, log_page_non_medium_error_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_NON_MEDIUM_ERROR))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		if (log_sense_param_code(param) == LOG_NON_MEDIUM_ERROR_COUNT && log_sense_param_counter(param, &out->count))
+			out->valid |= LOG_PARAM_BIT(LOG_NON_MEDIUM_ERROR_COUNT);
+	}
+	return true;
+}
+
+bool log_sense_page_temperature(uint8_t *page, unsigned page_len, log_page_temperature_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_TEMPERATURE))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+		uint8_t temperature;
+
+		if (log_sense_param_len(param) < 2)
+			continue;
+		temperature = log_sense_param_data(param)[1];
+		if (temperature == LOG_TEMPERATURE_INVALID)
+			continue;
+
+		switch (param_code) {
+			case LOG_TEMPERATURE_CURRENT:
+				out->temperature = temperature;
+				break;
+			case LOG_TEMPERATURE_REFERENCE:
+				out->reference_temperature = temperature;
+				break;
+			default:
+				continue;
+		}
+		out->valid |= LOG_PARAM_BIT(param_code);
+	}
+	return true;
+}
+
+static bool log_sense_param_uint32(uint8_t *param, uint32_t *val)
+{
+	if (log_sense_param_len(param) < 4)
+		return false;
+	*val = get_uint32(log_sense_param_data(param), 0);
+	return true;
+}
+
+static void log_sense_date(uint8_t *data, char *year, char *week)
+{
+	memcpy(year, data, 4);
+	year[4] = 0;
+	memcpy(week, data + 4, 2);
+	week[2] = 0;
+}
+
+bool log_sense_page_start_stop_cycle(uint8_t *page, unsigned page_len, log_page_start_stop_cycle_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_START_STOP_CYCLE))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+		uint8_t *data = log_sense_param_data(param);
+		const unsigned len = log_sense_param_len(param);
+
+		switch (param_code) {
+			case LOG_START_STOP_MANUFACTURE_DATE:
+				if (len < 6)
+					continue;
+				log_sense_date(data, out->manufacture_year, out->manufacture_week);
+				break;
+			case LOG_START_STOP_ACCOUNTING_DATE:
+				if (len < 6)
+					continue;
+				log_sense_date(data, out->accounting_year, out->accounting_week);
+				break;
+			case LOG_START_STOP_SPECIFIED_CYCLES:
+				if (!log_sense_param_uint32(param, &out->specified_cycles))
+					continue;
+				break;
+			case LOG_START_STOP_ACCUMULATED_CYCLES:
+				if (!log_sense_param_uint32(param, &out->accumulated_cycles))
+					continue;
+				break;
+			case LOG_START_STOP_SPECIFIED_LOAD_UNLOAD:
+				if (!log_sense_param_uint32(param, &out->specified_load_unload))
+					continue;
+				break;
+			case LOG_START_STOP_ACCUMULATED_LOAD_UNLOAD:
+				if (!log_sense_param_uint32(param, &out->accumulated_load_unload))
+					continue;
+				break;
+			default:
+				continue;
+		}
+		out->valid |= LOG_PARAM_BIT(param_code);
+	}
+	return true;
+}
+
+bool log_sense_page_self_test_results(uint8_t *page, unsigned page_len, log_page_self_test_results_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_SELF_TEST_RESULTS))
+		return false;
+
+	out->num_results = 0;
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+		uint8_t *data = log_sense_param_data(param);
+		log_self_test_result_t *result;
+
+		if (param_code < 1 || param_code > LOG_SELF_TEST_MAX_RESULTS || log_sense_param_len(param) < LOG_SELF_TEST_PARAM_LEN)
+			continue;
+		if (out->num_results == LOG_SELF_TEST_MAX_RESULTS)
+			break;
+
+		result = &out->results[out->num_results++];
+		result->param_code = param_code;
+		result->self_test_code = data[0] >> 5;
+		result->result = data[0] & 0xF;
+		result->number = data[1];
+		result->power_on_hours = get_uint16(data, 2);
+		result->first_failure_lba = get_uint64(data, 4);
+		result->sense_key = data[12] & 0xF;
+		result->asc = data[13];
+		result->ascq = data[14];
+	}
+	return true;
+}
+
+bool log_sense_page_solid_state_media(uint8_t *page, unsigned page_len, log_page_solid_state_media_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_SOLID_STATE_MEDIA))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		if (log_sense_param_code(param) == LOG_SOLID_STATE_PERCENTAGE_USED && log_sense_param_len(param) >= 4) {
+			out->percentage_used = log_sense_param_data(param)[3];
+			out->valid |= LOG_PARAM_BIT(LOG_SOLID_STATE_PERCENTAGE_USED);
+		}
+	}
+	return true;
+}
+
+bool log_sense_page_background_scan(uint8_t *page, unsigned page_len, log_page_background_scan_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_BACKGROUND_SCAN))
+		return false;
+
+	out->valid = 0;
+	out->num_medium = 0;
+	out->medium_truncated = false;
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+		uint8_t *data = log_sense_param_data(param);
+		log_background_scan_medium_t *medium;
+
+		if (param_code == LOG_BACKGROUND_SCAN_STATUS) {
+			if (log_sense_param_len(param) < LOG_BACKGROUND_SCAN_STATUS_LEN)
+				continue;
+			out->power_on_minutes = get_uint32(data, 0);
+			out->status = data[5];
+			out->num_scans = get_uint16(data, 6);
+			out->progress = get_uint16(data, 8);
+			out->num_medium_scans = get_uint16(data, 10);
+			out->valid |= LOG_PARAM_BIT(LOG_BACKGROUND_SCAN_STATUS);
+			continue;
+		}
+
+		if (param_code > 0x0800 || log_sense_param_len(param) < LOG_BACKGROUND_SCAN_MEDIUM_LEN)
+			continue;
+		if (out->num_medium == out->max_medium) {
+			out->medium_truncated = true;
+			continue;
+		}
+
+		medium = &out->medium[out->num_medium++];
+		medium->param_code = param_code;
+		medium->power_on_minutes = get_uint32(data, 0);
+		medium->reassign_status = data[4] >> 4;
+		medium->sense_key = data[4] & 0xF;
+		medium->asc = data[5];
+		medium->ascq = data[6];
+		medium->lba = get_uint64(data, 12);
+	}
+	return true;
+}
+
+static void log_protocol_phy(uint8_t *desc, log_protocol_phy_t *phy)
+{
+	phy->phy_id = desc[1];
+	phy->attached_device_type = (desc[4] >> 4) & 0x7;
+	phy->attached_reason = desc[4] & 0xF;
+	phy->reason = desc[5] >> 4;
+	phy->negotiated_link_rate = desc[5] & 0xF;
+	phy->sas_address = get_uint64(desc, 8);
+	phy->attached_sas_address = get_uint64(desc, 16);
+	phy->attached_phy_id = desc[24];
+	phy->invalid_dword_count = get_uint32(desc, 32);
+	phy->running_disparity_error_count = get_uint32(desc, 36);
+	phy->loss_of_dword_sync_count = get_uint32(desc, 40);
+	phy->phy_reset_problem_count = get_uint32(desc, 44);
+}
+
+bool log_sense_page_protocol_port(uint8_t *page, unsigned page_len, log_page_protocol_port_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_PROTOCOL_PORT))
+		return false;
+
+	out->num_ports = 0;
+	for_all_log_sense_params(page, page_len, param) {
+		uint8_t *data = log_sense_param_data(param);
+		const unsigned len = log_sense_param_len(param);
+		log_protocol_port_t *port;
+		unsigned offset;
+
+		if (len < LOG_PROTOCOL_PORT_HDR_LEN || (data[0] & 0xF) != LOG_PROTOCOL_ID_SAS)
+			continue;
+		if (out->num_ports == LOG_PROTOCOL_MAX_PORTS)
+			break;
+
+		port = &out->ports[out->num_ports++];
+		port->port_id = log_sense_param_code(param);
+		port->protocol_id = data[0] & 0xF;
+		port->generation = data[2];
+		port->num_phys = data[3];
+		port->num_phys_decoded = 0;
+
+		for (offset = LOG_PROTOCOL_PORT_HDR_LEN;
+		     offset + LOG_PROTOCOL_PHY_MIN_LEN <= len && port->num_phys_decoded < LOG_PROTOCOL_MAX_PHYS;
+		     offset += data[offset + 3] + 4)
+		{
+			if (data[offset + 3] + 4 < LOG_PROTOCOL_PHY_MIN_LEN)
+				break;
+			log_protocol_phy(data + offset, &port->phys[port->num_phys_decoded++]);
+		}
+	}
+	return true;
+}
+
+bool log_sense_page_general_statistics(uint8_t *page, unsigned page_len, log_page_general_statistics_t *out)
+{
+	uint8_t *param;
+
+	if (!log_sense_page_is(page, page_len, LOG_PAGE_GENERAL_STATISTICS))
+		return false;
+
+	memset(out, 0, sizeof(*out));
+	for_all_log_sense_params(page, page_len, param) {
+		const uint16_t param_code = log_sense_param_code(param);
+		uint8_t *data = log_sense_param_data(param);
+		const unsigned len = log_sense_param_len(param);
+
+		switch (param_code) {
+			case LOG_GENERAL_STATISTICS_ACCESS:
+				if (len < LOG_GENERAL_STATISTICS_ACCESS_LEN)
+					continue;
+				out->read_commands = get_uint64(data, 0);
+				out->write_commands = get_uint64(data, 8);
+				out->blocks_received = get_uint64(data, 16);
+				out->blocks_transmitted = get_uint64(data, 24);
+				out->read_processing_intervals = get_uint64(data, 32);
+				out->write_processing_intervals = get_uint64(data, 40);
+				out->weighted_commands = get_uint64(data, 48);
+				out->weighted_processing = get_uint64(data, 56);
+				break;
+			case LOG_GENERAL_STATISTICS_IDLE_TIME:
+				if (len < 8)
+					continue;
+				out->idle_time_intervals = get_uint64(data, 0);
+				break;
+			case LOG_GENERAL_STATISTICS_TIME_INTERVAL:
+				if (len < 8)
+					continue;
+				out->time_interval_exponent = get_uint32(data, 0);
+				out->time_interval_integer = get_uint32(data, 4);
+				break;
+			default:
+				continue;
+		}
+		out->valid |= LOG_PARAM_BIT(param_code);
+	}
+	return true;
+}
@@ -34,6 +34,8 @@ bool parse_inquiry(unsigned char *buf, unsigned buf_len, int *device_type, scsi_
         unsigned char fmt = buf[3] & 0xf; 
 
         int valid_len = buf[4] + 4;
+        if (valid_len > (int)buf_len)
+                valid_len = buf_len;
 
         *device_type = buf[0] & 0x1f;
 
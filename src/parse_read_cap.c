@@ -55,7 +55,7 @@ bool parse_read_capacity_16(unsigned char *buf, unsigned buf_len, uint64_t *max_
 		*thin_provisioning_enabled = buf[14] & 0x80;
 	if (thin_provisioning_zero)
 		*thin_provisioning_zero = buf[14] & 0x40;
-	if (*lowest_aligned_lba)
+	if (lowest_aligned_lba)
 		*lowest_aligned_lba = (buf[14] & 0x3f) << 8 | buf[15];
 	return true;
 }
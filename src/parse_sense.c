@@ -1,5 +1,4 @@
-#include "scsicmd.h"
-#include "scsicmd_utils.h"
+#include "parse_sense.h"
 
 #include <memory.h>
 
@@ -41,149 +40,326 @@ static void parse_sense_key_specific(unsigned char *sks, sense_info_t *info)
         }
 }
 
-static bool parse_sense_fixed(unsigned char *sense, int sense_len, sense_info_t *info)
+bool sense_view_init(sense_view_t *view, unsigned char *sense, int sense_len)
 {
-        if (sense_len < 18)
+        view->sense = sense;
+        view->sense_len = sense_len > 0 ? sense_len : 0;
+        view->is_fixed = false;
+        view->is_current = false;
+
+        if (sense_len <= 0)
                 return false;
 
-        info->information_valid = sense[0] & 0x80;
-        if (info->information_valid)
-                info->information = get_uint32(sense, 3);
+        uint8_t response_code = sense[0] & 0x7F;
+        if (response_code != 0x70 && response_code != 0x71 && response_code != 0x72 && response_code != 0x73)
+                return false;
 
-        info->incorrect_len_indicator = sense[2] & 0x20;
-        info->sense_key = sense[2] & 0xF;
-        info->asc = sense[12];
-        info->ascq = sense[13];
+        view->is_fixed = response_code == 0x70 || response_code == 0x71;
+        view->is_current = response_code == 0x70 || response_code == 0x72;
 
-        info->cmd_specific_valid = true;
-        info->cmd_specific = get_uint32(sense, 8);
+        if (view->is_fixed)
+                return view->sense_len >= SENSE_FIXED_MIN_LEN;
 
-        info->fru_code_valid = true;
-        info->fru_code = sense[14];
+        if (view->sense_len < SENSE_DESCRIPTOR_MIN_LEN)
+                return false;
 
-        parse_sense_key_specific(sense + 15, info);
+        unsigned additional_sense_length = sense[7];
+        if (view->sense_len > additional_sense_length + 8)
+                view->sense_len = additional_sense_length + 8;
+        return true;
+}
 
-        if (sense_len >= 21)
-            info->vendor_unique_error = get_uint16(sense, 20);
+unsigned char *sense_view_descriptor(const sense_view_t *view, uint8_t desc_type)
+{
+        unsigned char *desc;
 
-        //uint8_t additional_sense_len = sense[7];
+        for_all_sense_descriptors(view, desc) {
+                if (sense_desc_type(desc) == desc_type)
+                        return desc;
+        }
 
-        return true;
+        return NULL;
 }
 
-static bool parse_sense_descriptor(unsigned char *sense, unsigned sense_len, sense_info_t *info)
+bool sense_desc_ata_status(unsigned char *desc, ata_status_t *status)
 {
-        if (sense_len < 8)
+        if (desc[1] != 0x0C)
                 return false;
 
-        info->sense_key = sense[1] & 0xF;
-        info->asc = sense[2];
-        info->ascq = sense[3];
+        status->extend = desc[2] & 1;
+        status->error = desc[3];
+        if (status->extend) {
+                status->sector_count = (desc[4] << 8) | desc[5];
+                status->lba =
+                        ((uint64_t)desc[7]) |
+                        ((uint64_t)desc[6]<<8) |
+                        ((uint64_t)desc[9]<<16) |
+                        ((uint64_t)desc[8]<<24) |
+                        ((uint64_t)desc[11]<<32) |
+                        ((uint64_t)desc[10]<<40);
+        } else {
+                status->sector_count = desc[4];
+                status->lba = desc[7] | (desc[9]<<8) | (desc[11]<<16);
+        }
+        status->device = desc[12];
+        status->status = desc[13];
+        return true;
+}
 
-        unsigned additional_sense_length = sense[7];
-        if (sense_len > additional_sense_length + 8)
-                sense_len = additional_sense_length + 8;
-
-        unsigned idx;
-        unsigned desc_len;
-
-        for (idx = 8; idx < sense_len; idx += desc_len+2) {
-                uint8_t desc_type = sense[idx];
-                desc_len = sense[idx+1];
-
-                if (idx + desc_len + 2 > sense_len)
-                        break;
-
-                switch (desc_type) {
-                        case 0x00: // Information
-                                if (desc_len == 0x0A) {
-                                        info->information_valid = sense[idx+2] & 0x80;
-                                        info->information = get_uint64(sense, idx+4);
-                                }
-                                break;
-                        case 0x01: // Command specific information
-                                if (desc_len == 0x0A) {
-                                        info->cmd_specific_valid = true;
-                                        info->cmd_specific = get_uint64(sense, idx+4);
-                                }
-                                break;
-                        case 0x02: // Sense key specific
-                                if (desc_len == 0x06) {
-                                        parse_sense_key_specific(sense+4, info);
-                                }
-                                break;
-                        case 0x03: // FRU
-                                if (desc_len == 0x02) {
-                                        info->fru_code_valid = true;
-                                        info->fru_code = sense[idx+3];
-                                }
-                                break;
-                        case 0x04: // Stream commands
-                                break;
-                        case 0x05: // Block commands
-                                if (desc_len == 0x02) {
-                                        info->incorrect_len_indicator = sense[idx+3] & 0x20;
-                                }
-                                break;
-                        case 0x06: // OSD object identification
-                                break;
-                        case 0x07: // OSD response integrity check value
-                                break;
-                        case 0x08: // OSD attribute identification
-                                break;
-                        case 0x09: // ATA Status Return
-                                if (desc_len == 0x0C) {
-                                        info->ata_status_valid = true;
-                                        info->ata_status.extend = sense[idx+2] & 1;
-                                        info->ata_status.error = sense[idx+3];
-                                        if (info->ata_status.extend) {
-                                                info->ata_status.sector_count = (sense[idx+4] << 8) | sense[idx+5];
-                                                info->ata_status.lba =
-													((uint64_t)sense[idx+7]) | 
-													((uint64_t)sense[idx+6]<<8) |
-													((uint64_t)sense[idx+9]<<16) |
-													((uint64_t)sense[idx+8]<<24) |
-													((uint64_t)sense[idx+11]<<32) |
-													((uint64_t)sense[idx+10]<<40);
-                                        } else {
-                                                info->ata_status.sector_count = sense[idx+4];
-                                                info->ata_status.lba = sense[idx+7] | (sense[idx+9]<<8) | (sense[idx+11]<<16);
-                                        }
-                                        info->ata_status.device = sense[idx+12];
-                                        info->ata_status.status = sense[idx+13];
-                                }
-                                break;
-                        case 0x0A: // Progress indication
-                                break;
-                        case 0x0B: // User data segment referral
-                                break;
-                        case 0x80: // Vendor Unique Unit Error
-                                if (desc_len == 0x02) {
-                                    info->vendor_unique_error = get_uint16(sense, idx+2);
-                                }
+bool sense_view_information(const sense_view_t *view, uint64_t *information)
+{
+        if (view->is_fixed) {
+                *information = get_uint32(view->sense, 3);
+                return view->sense[0] & 0x80;
+        }
+
+        unsigned char *desc = sense_view_descriptor(view, 0x00);
+        bool valid;
+        return desc && sense_desc_information(desc, information, &valid) && valid;
+}
+
+bool sense_view_cmd_specific(const sense_view_t *view, uint64_t *cmd_specific)
+{
+        if (view->is_fixed) {
+                *cmd_specific = get_uint32(view->sense, 8);
+                return true;
+        }
+
+        unsigned char *desc = sense_view_descriptor(view, 0x01);
+        return desc && sense_desc_cmd_specific(desc, cmd_specific);
+}
+
+unsigned char *sense_view_sense_key_specific(const sense_view_t *view)
+{
+        unsigned char *sks;
+
+        if (view->is_fixed) {
+                sks = view->sense + 15;
+        } else {
+                unsigned char *desc = sense_view_descriptor(view, 0x02);
+                if (!desc)
+                        return NULL;
+                sks = sense_desc_sense_key_specific(desc);
+                if (!sks)
+                        return NULL;
+        }
+
+        return (sks[0] & 0x80) ? sks : NULL;
+}
+
+bool sense_view_fru(const sense_view_t *view, uint8_t *fru_code)
+{
+        if (view->is_fixed) {
+                *fru_code = view->sense[14];
+                return true;
+        }
+
+        unsigned char *desc = sense_view_descriptor(view, 0x03);
+        return desc && sense_desc_fru(desc, fru_code);
+}
+
+bool sense_view_incorrect_len_indicator(const sense_view_t *view)
+{
+        if (view->is_fixed)
+                return view->sense[2] & 0x20;
+
+        unsigned char *desc = sense_view_descriptor(view, 0x05);
+        bool ili;
+        return desc && sense_desc_block_commands(desc, &ili) && ili;
+}
+
+bool sense_view_vendor_unique_error(const sense_view_t *view, uint32_t *error)
+{
+        if (view->is_fixed) {
+                if (view->sense_len < 22)
+                        return false;
+                *error = get_uint16(view->sense, 20);
+                return true;
+        }
+
+        unsigned char *desc = sense_view_descriptor(view, 0x80);
+        return desc && sense_desc_vendor_unique_error(desc, error);
+}
+
+bool sense_view_ata_status(const sense_view_t *view, ata_status_t *status)
+{
+        unsigned char *desc = sense_view_descriptor(view, 0x09);
+        return desc && sense_desc_ata_status(desc, status);
+}
+
+static void parse_sense_fixed(sense_view_t *view, sense_info_t *info)
+{
+        info->information_valid = sense_view_information(view, &info->information);
+        info->cmd_specific_valid = sense_view_cmd_specific(view, &info->cmd_specific);
+        info->fru_code_valid = sense_view_fru(view, &info->fru_code);
+        info->incorrect_len_indicator = sense_view_incorrect_len_indicator(view);
+        sense_view_vendor_unique_error(view, &info->vendor_unique_error);
+        parse_sense_key_specific(view->sense + 15, info);
+}
+
+static void parse_sense_descriptor(sense_view_t *view, sense_info_t *info)
+{
+        unsigned char *desc;
+        unsigned char *sks;
+        sense_desc_direct_access_t direct_access;
+
+        /* Walk the descriptors once instead of looking up each field on its own */
+        for_all_sense_descriptors(view, desc) {
+                switch (sense_desc_type(desc)) {
+                        case SENSE_DESC_INFORMATION:
+                                sense_desc_information(desc, &info->information, &info->information_valid);
+                                break;
+                        case SENSE_DESC_CMD_SPECIFIC:
+                                info->cmd_specific_valid = sense_desc_cmd_specific(desc, &info->cmd_specific);
+                                break;
+                        case SENSE_DESC_SENSE_KEY_SPECIFIC:
+                                sks = sense_desc_sense_key_specific(desc);
+                                if (sks)
+                                        parse_sense_key_specific(sks, info);
+                                break;
+                        case SENSE_DESC_FRU:
+                                info->fru_code_valid = sense_desc_fru(desc, &info->fru_code);
+                                break;
+                        case SENSE_DESC_BLOCK_COMMANDS:
+                                sense_desc_block_commands(desc, &info->incorrect_len_indicator);
+                                break;
+                        case SENSE_DESC_ATA_STATUS_RETURN:
+                                info->ata_status_valid = sense_desc_ata_status(desc, &info->ata_status);
+                                break;
+                        case SENSE_DESC_DIRECT_ACCESS_BLOCK_DEVICE:
+                                if (!sense_desc_direct_access_block_device(desc, &direct_access))
+                                        break;
+                                info->information_valid = direct_access.information_valid;
+                                info->information = direct_access.information;
+                                info->cmd_specific_valid = true;
+                                info->cmd_specific = direct_access.cmd_specific;
+                                info->fru_code_valid = true;
+                                info->fru_code = direct_access.fru_code;
+                                info->incorrect_len_indicator = direct_access.ili;
+                                if (direct_access.sense_key_specific)
+                                        parse_sense_key_specific(direct_access.sense_key_specific, info);
+                                break;
+                        case SENSE_DESC_VENDOR_UNIQUE_ERROR:
+                                sense_desc_vendor_unique_error(desc, &info->vendor_unique_error);
                                 break;
                 }
         }
+}
 
-        return true;
+/* The information field as scsi_parse_sense() reports it for descriptor sense, the last information or direct access
+ * block device descriptor wins. Returns false if there is none or its VALID bit is clear.
+ */
+static bool sense_descriptor_information(const sense_view_t *view, uint64_t *information)
+{
+        unsigned char *desc;
+        sense_desc_direct_access_t direct_access;
+        uint64_t value = 0;
+        bool valid = false;
+
+        for_all_sense_descriptors(view, desc) {
+                switch (sense_desc_type(desc)) {
+                        case SENSE_DESC_INFORMATION:
+                                sense_desc_information(desc, &value, &valid);
+                                break;
+                        case SENSE_DESC_DIRECT_ACCESS_BLOCK_DEVICE:
+                                if (!sense_desc_direct_access_block_device(desc, &direct_access))
+                                        break;
+                                valid = direct_access.information_valid;
+                                value = direct_access.information;
+                                break;
+                }
+        }
+
+        if (valid)
+                *information = value;
+        return valid;
 }
 
 bool scsi_parse_sense(unsigned char *sense, int sense_len, sense_info_t *info)
 {
-        uint8_t response_code = sense[0] & 0x7F;
+        sense_view_t view;
+        bool valid = sense_view_init(&view, sense, sense_len);
 
         memset(info, 0, sizeof(*info));
+        info->is_fixed = view.is_fixed;
+        info->is_current = view.is_current;
 
-        if (response_code != 0x70 && response_code != 0x71 && response_code != 0x72 && response_code != 0x73)
+        if (!valid)
                 return false;
 
-        if (response_code == 0x70 || response_code == 0x71)
-                info->is_fixed = true;
-        if (response_code == 0x70 || response_code == 0x72)
-                info->is_current = true;
+        info->sense_key = sense_view_key(&view);
+        info->asc = sense_view_asc(&view);
+        info->ascq = sense_view_ascq(&view);
 
-        if (info->is_fixed)
-                return parse_sense_fixed(sense, sense_len, info);
+        if (view.is_fixed)
+                parse_sense_fixed(&view, info);
         else
-                return parse_sense_descriptor(sense, sense_len, info);
+                parse_sense_descriptor(&view, info);
+        return true;
+}
+
+void scsi_parse_sense_batch(const sense_buf_t *bufs, unsigned num, sense_batch_t *out)
+{
+        unsigned word;
+
+        for (word = 0; word < SENSE_BATCH_WORDS(num); word++) {
+                const unsigned base = word * 64;
+                const unsigned count = num - base < 64 ? num - base : 64;
+                uint64_t fixed = 0;
+                uint64_t descriptor = 0;
+                uint64_t current = 0;
+                uint64_t information_valid = 0;
+                uint64_t mask;
+                unsigned i;
+
+                /* Classify the whole chunk first so that each format is then decoded in its own loop */
+                for (i = 0; i < count; i++) {
+                        const sense_buf_t *buf = &bufs[base + i];
+                        const uint8_t response_code = buf->sense_len > 0 ? buf->sense[0] & 0x7F : 0;
+                        const uint64_t bit = 1ULL << i;
+
+                        if ((response_code == 0x70 || response_code == 0x71) && buf->sense_len >= 18)
+                                fixed |= bit;
+                        else if ((response_code == 0x72 || response_code == 0x73) && buf->sense_len >= 8)
+                                descriptor |= bit;
+                        if (response_code == 0x70 || response_code == 0x72)
+                                current |= bit;
+
+                        out->sense_key[base + i] = 0;
+                        out->asc[base + i] = 0;
+                        out->ascq[base + i] = 0;
+                        out->information[base + i] = 0;
+                }
+
+                for (mask = fixed; mask; mask &= mask - 1) {
+                        const unsigned idx = base + __builtin_ctzll(mask);
+                        unsigned char *sense = bufs[idx].sense;
+
+                        out->sense_key[idx] = sense[2] & 0xF;
+                        out->asc[idx] = sense[12];
+                        out->ascq[idx] = sense[13];
+                        if (sense[0] & 0x80) {
+                                out->information[idx] = get_uint32(sense, 3);
+                                information_valid |= 1ULL << (idx - base);
+                        }
+                }
+
+                for (mask = descriptor; mask; mask &= mask - 1) {
+                        const unsigned idx = base + __builtin_ctzll(mask);
+                        sense_view_t view;
+
+                        sense_view_init(&view, bufs[idx].sense, bufs[idx].sense_len);
+                        out->sense_key[idx] = sense_view_key(&view);
+                        out->asc[idx] = sense_view_asc(&view);
+                        out->ascq[idx] = sense_view_ascq(&view);
+
+                        if (sense_descriptor_information(&view, &out->information[idx]))
+                                information_valid |= 1ULL << (idx - base);
+                }
+
+                out->valid[word] = fixed | descriptor;
+                out->is_fixed[word] = fixed;
+                out->is_current[word] = current & (fixed | descriptor);
+                out->information_valid[word] = information_valid;
+        }
 }
@@ -0,0 +1,566 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_capture.h"
+#include "scsicmd_utils.h"
+#include "cdb_decode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CAPTURE_MAGIC "SCSICAP"
+#define CAPTURE_INDEX_MAGIC "SCSICIDX"
+#define CAPTURE_HEADER_LEN 16
+#define CAPTURE_RECORD_HEADER_LEN 32
+#define CAPTURE_INDEX_ENTRY_LEN 16
+#define CAPTURE_TRAILER_LEN 32
+
+#define CAPTURE_KEY(opcode, page, subpage, dev) \
+	((uint64_t)(opcode) << 56 | (uint64_t)(page) << 40 | (uint64_t)(subpage) << 32 | (uint64_t)(dev) << 16)
+
+static inline void set_uint16(unsigned char *buf, int start, uint16_t val)
+{
+	buf[start] = val >> 8;
+	buf[start+1] = val & 0xFF;
+}
+
+static inline void set_uint32(unsigned char *buf, int start, uint32_t val)
+{
+	set_uint16(buf, start, val >> 16);
+	set_uint16(buf, start+2, val & 0xFFFF);
+}
+
+static inline void set_uint64(unsigned char *buf, int start, uint64_t val)
+{
+	set_uint32(buf, start, val >> 32);
+	set_uint32(buf, start+4, val & 0xFFFFFFFF);
+}
+
+static inline uint64_t capture_align(uint64_t len)
+{
+	return (len + 7) & ~(uint64_t)7;
+}
+
+void scsi_capture_cdb_key(const unsigned char *cdb, unsigned cdb_len, uint16_t *page, uint8_t *subpage)
+{
+	cdb_decoded_t decoded;
+
+	*page = SCSI_CAPTURE_NO_PAGE;
+	*subpage = 0;
+	if (!cdb_decode(cdb, cdb_len, &decoded))
+		return;
+
+	switch (decoded.kind) {
+		case CDB_KIND_INQUIRY:
+			if (decoded.flags & CDB_FLAG_EVPD)
+				*page = decoded.page_code;
+			break;
+		case CDB_KIND_RECEIVE_DIAGNOSTICS:
+			if (decoded.flags & CDB_FLAG_PCV)
+				*page = decoded.page_code;
+			break;
+		case CDB_KIND_LOG_SENSE:
+		case CDB_KIND_MODE_SENSE_6:
+		case CDB_KIND_MODE_SENSE_10:
+			*page = decoded.page_code;
+			*subpage = decoded.subpage_code;
+			break;
+		default:
+			break;
+	}
+}
+
+static uint64_t capture_record_key(const unsigned char *cdb, unsigned cdb_len, uint16_t dev)
+{
+	uint16_t page;
+	uint8_t subpage;
+
+	scsi_capture_cdb_key(cdb, cdb_len, &page, &subpage);
+	return CAPTURE_KEY(cdb[0], page, subpage, dev);
+}
+
+/* Writer */
+
+typedef struct capture_index_entry_t {
+	uint64_t key;
+	uint64_t offset;
+} capture_index_entry_t;
+
+struct scsi_capture_writer_t {
+	FILE *f;
+	uint64_t offset;
+	capture_index_entry_t *index;
+	size_t num_index;
+	size_t index_size;
+	char **dev_names;
+	unsigned num_devs;
+};
+
+static int capture_write(scsi_capture_writer_t *w, const void *buf, size_t len)
+{
+	if (len && fwrite(buf, 1, len, w->f) != len)
+		return -EIO;
+	w->offset += len;
+	return 0;
+}
+
+static int capture_write_pad(scsi_capture_writer_t *w)
+{
+	static const unsigned char zeros[8];
+	return capture_write(w, zeros, capture_align(w->offset) - w->offset);
+}
+
+scsi_capture_writer_t *scsi_capture_writer_create(const char *filename)
+{
+	unsigned char header[CAPTURE_HEADER_LEN];
+	scsi_capture_writer_t *w = calloc(1, sizeof(*w));
+
+	if (!w)
+		return NULL;
+
+	w->f = fopen(filename, "w");
+	if (!w->f) {
+		free(w);
+		return NULL;
+	}
+	setvbuf(w->f, NULL, _IOFBF, 1024*1024);
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+	set_uint16(header, 8, SCSI_CAPTURE_VERSION);
+	set_uint16(header, 10, CAPTURE_HEADER_LEN);
+	if (capture_write(w, header, sizeof(header)) < 0) {
+		fclose(w->f);
+		free(w);
+		errno = EIO;
+		return NULL;
+	}
+
+	return w;
+}
+
+int scsi_capture_writer_add_dev(scsi_capture_writer_t *w, const char *name)
+{
+	char **names;
+
+	if (w->num_devs > 0xFFFF)
+		return -ENOSPC;
+
+	names = realloc(w->dev_names, (w->num_devs + 1) * sizeof(*names));
+	if (!names)
+		return -ENOMEM;
+	w->dev_names = names;
+	names[w->num_devs] = strdup(name);
+	if (!names[w->num_devs])
+		return -ENOMEM;
+	return w->num_devs++;
+}
+
+int scsi_capture_write(scsi_capture_writer_t *w, const scsi_capture_record_t *rec)
+{
+	unsigned char header[CAPTURE_RECORD_HEADER_LEN];
+	const uint64_t len = capture_align(CAPTURE_RECORD_HEADER_LEN + rec->cdb_len + rec->sense_len + (uint64_t)rec->data_len);
+	capture_index_entry_t *entry;
+	int ret;
+
+	if (rec->cdb_len == 0 || len > 0xFFFFFFFF)
+		return -EINVAL;
+
+	if (w->num_index == w->index_size) {
+		size_t size = w->index_size ? w->index_size * 2 : 1024;
+		capture_index_entry_t *index = realloc(w->index, size * sizeof(*index));
+		if (!index)
+			return -ENOMEM;
+		w->index = index;
+		w->index_size = size;
+	}
+
+	memset(header, 0, sizeof(header));
+	set_uint32(header, 0, len);
+	set_uint16(header, 4, rec->dev);
+	header[6] = rec->cdb_len;
+	header[7] = rec->sense_len;
+	set_uint32(header, 8, rec->data_len);
+	header[12] = rec->status;
+	header[13] = rec->host_status;
+	set_uint16(header, 14, rec->driver_status);
+	set_uint64(header, 16, rec->start_ns);
+	set_uint32(header, 24, rec->duration_us);
+
+	entry = &w->index[w->num_index];
+	entry->key = capture_record_key(rec->cdb, rec->cdb_len, rec->dev);
+	entry->offset = w->offset;
+
+	if ((ret = capture_write(w, header, sizeof(header))) < 0 ||
+	    (ret = capture_write(w, rec->cdb, rec->cdb_len)) < 0 ||
+	    (ret = capture_write(w, rec->sense, rec->sense_len)) < 0 ||
+	    (ret = capture_write(w, rec->data, rec->data_len)) < 0 ||
+	    (ret = capture_write_pad(w)) < 0)
+		return ret;
+
+	w->num_index++;
+	return 0;
+}
+
+static int capture_index_cmp(const void *a, const void *b)
+{
+	const capture_index_entry_t *ea = a;
+	const capture_index_entry_t *eb = b;
+
+	if (ea->key != eb->key)
+		return ea->key < eb->key ? -1 : 1;
+	if (ea->offset != eb->offset)
+		return ea->offset < eb->offset ? -1 : 1;
+	return 0;
+}
+
+static int capture_write_footer(scsi_capture_writer_t *w)
+{
+	unsigned char buf[CAPTURE_TRAILER_LEN];
+	const uint64_t devs_offset = w->offset;
+	uint64_t index_offset;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < w->num_devs; i++) {
+		const size_t name_len = strlen(w->dev_names[i]) > 0xFFFF ? 0xFFFF : strlen(w->dev_names[i]);
+
+		set_uint16(buf, 0, name_len);
+		if ((ret = capture_write(w, buf, 2)) < 0 || (ret = capture_write(w, w->dev_names[i], name_len)) < 0)
+			return ret;
+	}
+	if ((ret = capture_write_pad(w)) < 0)
+		return ret;
+
+	index_offset = w->offset;
+	qsort(w->index, w->num_index, sizeof(*w->index), capture_index_cmp);
+	for (i = 0; i < w->num_index; i++) {
+		set_uint64(buf, 0, w->index[i].key);
+		set_uint64(buf, 8, w->index[i].offset);
+		if ((ret = capture_write(w, buf, CAPTURE_INDEX_ENTRY_LEN)) < 0)
+			return ret;
+	}
+
+	memcpy(buf, CAPTURE_INDEX_MAGIC, 8);
+	set_uint64(buf, 8, devs_offset);
+	set_uint64(buf, 16, index_offset);
+	set_uint32(buf, 24, w->num_devs);
+	set_uint32(buf, 28, w->num_index);
+	return capture_write(w, buf, CAPTURE_TRAILER_LEN);
+}
+
+int scsi_capture_writer_close(scsi_capture_writer_t *w)
+{
+	unsigned i;
+	int ret;
+
+	ret = w->num_index > 0xFFFFFFFF ? -EOVERFLOW : capture_write_footer(w);
+	if (fclose(w->f) != 0 && ret == 0)
+		ret = -errno;
+
+	for (i = 0; i < w->num_devs; i++)
+		free(w->dev_names[i]);
+	free(w->dev_names);
+	free(w->index);
+	free(w);
+	return ret;
+}
+
+/* Reader */
+
+struct scsi_capture_t {
+	unsigned char *map;
+	uint64_t size;
+	uint64_t records_end;
+	unsigned char *index;
+	uint64_t num_index;
+	char **dev_names;
+	unsigned num_devs;
+};
+
+/* The names are copied out to have them NUL terminated, there are few of them */
+static bool capture_load_devs(scsi_capture_t *c, uint64_t offset, uint64_t end, unsigned num_devs)
+{
+	unsigned i;
+
+	c->dev_names = calloc(num_devs ? num_devs : 1, sizeof(*c->dev_names));
+	if (!c->dev_names)
+		return false;
+
+	for (i = 0; i < num_devs; i++) {
+		unsigned name_len;
+
+		if (offset + 2 > end)
+			return false;
+		name_len = get_uint16(c->map, offset);
+		offset += 2;
+		if (offset + name_len > end)
+			return false;
+
+		c->dev_names[i] = strndup((const char *)c->map + offset, name_len);
+		if (!c->dev_names[i])
+			return false;
+		c->num_devs = i + 1;
+		offset += name_len;
+	}
+
+	return true;
+}
+
+static void capture_free_devs(scsi_capture_t *c)
+{
+	unsigned i;
+
+	for (i = 0; i < c->num_devs; i++)
+		free(c->dev_names[i]);
+	free(c->dev_names);
+	c->dev_names = NULL;
+	c->num_devs = 0;
+}
+
+static void capture_load_trailer(scsi_capture_t *c)
+{
+	unsigned char *trailer;
+	uint64_t devs_offset, index_offset;
+	uint32_t num_devs, num_index;
+
+	if (c->size < CAPTURE_HEADER_LEN + CAPTURE_TRAILER_LEN)
+		return;
+
+	trailer = c->map + c->size - CAPTURE_TRAILER_LEN;
+	if (memcmp(trailer, CAPTURE_INDEX_MAGIC, 8) != 0)
+		return;
+
+	devs_offset = get_uint64(trailer, 8);
+	index_offset = get_uint64(trailer, 16);
+	num_devs = get_uint32(trailer, 24);
+	num_index = get_uint32(trailer, 28);
+	if (devs_offset < CAPTURE_HEADER_LEN || devs_offset > index_offset || index_offset % 8 != 0 ||
+	    index_offset > c->size - CAPTURE_TRAILER_LEN ||
+	    (c->size - CAPTURE_TRAILER_LEN - index_offset) % CAPTURE_INDEX_ENTRY_LEN != 0 ||
+	    (c->size - CAPTURE_TRAILER_LEN - index_offset) / CAPTURE_INDEX_ENTRY_LEN != num_index)
+		return;
+
+	if (!capture_load_devs(c, devs_offset, index_offset, num_devs)) {
+		capture_free_devs(c);
+		return;
+	}
+
+	c->records_end = devs_offset;
+	c->index = c->map + index_offset;
+	c->num_index = num_index;
+}
+
+scsi_capture_t *scsi_capture_open(const char *filename)
+{
+	scsi_capture_t *c;
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+	if ((uint64_t)st.st_size < CAPTURE_HEADER_LEN) {
+		close(fd);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	if (memcmp(map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 || get_uint16(map, 8) != SCSI_CAPTURE_VERSION ||
+	    get_uint16(map, 10) != CAPTURE_HEADER_LEN) {
+		munmap(map, st.st_size);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	c = calloc(1, sizeof(*c));
+	if (!c) {
+		munmap(map, st.st_size);
+		return NULL;
+	}
+
+	c->map = map;
+	c->size = st.st_size;
+	c->records_end = c->size;
+	capture_load_trailer(c);
+	return c;
+}
+
+void scsi_capture_close(scsi_capture_t *c)
+{
+	capture_free_devs(c);
+	munmap(c->map, c->size);
+	free(c);
+}
+
+bool scsi_capture_has_index(const scsi_capture_t *c)
+{
+	return c->index != NULL;
+}
+
+unsigned scsi_capture_num_devs(const scsi_capture_t *c)
+{
+	return c->num_devs;
+}
+
+const char *scsi_capture_dev_name(const scsi_capture_t *c, unsigned dev)
+{
+	return dev < c->num_devs ? c->dev_names[dev] : NULL;
+}
+
+/* Returns the record length or 0 if there is no whole record at offset */
+static uint64_t capture_read_record(const scsi_capture_t *c, uint64_t offset, scsi_capture_record_t *rec)
+{
+	unsigned char *hdr;
+	uint64_t len;
+
+	/* The offset comes from the file, compare against what is left so that a huge one cannot wrap */
+	if (offset < CAPTURE_HEADER_LEN || offset % 8 != 0 || offset > c->records_end ||
+	    c->records_end - offset < CAPTURE_RECORD_HEADER_LEN)
+		return 0;
+
+	hdr = c->map + offset;
+	len = get_uint32(hdr, 0);
+	rec->dev = get_uint16(hdr, 4);
+	rec->cdb_len = hdr[6];
+	rec->sense_len = hdr[7];
+	rec->data_len = get_uint32(hdr, 8);
+	if (len % 8 != 0 || len < CAPTURE_RECORD_HEADER_LEN + rec->cdb_len + rec->sense_len + (uint64_t)rec->data_len ||
+	    len > c->records_end - offset || rec->cdb_len == 0)
+		return 0;
+
+	rec->status = hdr[12];
+	rec->host_status = hdr[13];
+	rec->driver_status = get_uint16(hdr, 14);
+	rec->start_ns = get_uint64(hdr, 16);
+	rec->duration_us = get_uint32(hdr, 24);
+	rec->cdb = hdr + CAPTURE_RECORD_HEADER_LEN;
+	rec->sense = rec->cdb + rec->cdb_len;
+	rec->data = rec->sense + rec->sense_len;
+	return len;
+}
+
+static bool capture_key_matches(const scsi_capture_query_t *q, uint64_t key)
+{
+	return (q->opcode == SCSI_CAPTURE_ANY || (uint8_t)(key >> 56) == q->opcode) &&
+	       (q->page == SCSI_CAPTURE_ANY || (uint16_t)(key >> 40) == q->page) &&
+	       (q->subpage == SCSI_CAPTURE_ANY || (uint8_t)(key >> 32) == q->subpage) &&
+	       (q->dev == SCSI_CAPTURE_ANY || (uint16_t)(key >> 16) == q->dev);
+}
+
+/* The leading fields of the key the query gives and a mask of them, the index range of a query is where they match */
+static uint64_t capture_query_prefix(const scsi_capture_query_t *q, uint64_t *mask)
+{
+	*mask = 0xFFULL << 56;
+	if (q->page == SCSI_CAPTURE_ANY)
+		return CAPTURE_KEY(q->opcode, 0, 0, 0);
+	*mask |= 0xFFFFULL << 40;
+	if (q->subpage == SCSI_CAPTURE_ANY)
+		return CAPTURE_KEY(q->opcode, q->page, 0, 0);
+	*mask |= 0xFFULL << 32;
+	if (q->dev == SCSI_CAPTURE_ANY)
+		return CAPTURE_KEY(q->opcode, q->page, q->subpage, 0);
+	*mask |= 0xFFFFULL << 16;
+	return CAPTURE_KEY(q->opcode, q->page, q->subpage, q->dev);
+}
+
+static inline uint64_t capture_index_key(const scsi_capture_t *c, uint64_t i)
+{
+	return get_uint64(c->index, i * CAPTURE_INDEX_ENTRY_LEN);
+}
+
+void scsi_capture_iter_init(const scsi_capture_t *c, scsi_capture_iter_t *it, const scsi_capture_query_t *query)
+{
+	memset(it, 0, sizeof(*it));
+	if (query) {
+		it->query = *query;
+	} else {
+		it->query.opcode = it->query.page = it->query.subpage = it->query.dev = SCSI_CAPTURE_ANY;
+	}
+
+	if (c->index && it->query.opcode != SCSI_CAPTURE_ANY) {
+		uint64_t mask;
+		const uint64_t prefix = capture_query_prefix(&it->query, &mask);
+		uint64_t lo = 0, hi = c->num_index;
+
+		while (lo < hi) {
+			const uint64_t mid = lo + (hi - lo) / 2;
+			if (capture_index_key(c, mid) < prefix)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		it->use_index = true;
+		it->pos = lo;
+		it->end = c->num_index;
+	} else {
+		it->pos = CAPTURE_HEADER_LEN;
+		it->end = c->records_end;
+	}
+}
+
+bool scsi_capture_iter_next(const scsi_capture_t *c, scsi_capture_iter_t *it, scsi_capture_record_t *rec)
+{
+	if (it->use_index) {
+		uint64_t mask;
+		const uint64_t prefix = capture_query_prefix(&it->query, &mask);
+
+		while (it->pos < it->end) {
+			const uint64_t key = capture_index_key(c, it->pos);
+			const uint64_t offset = get_uint64(c->index, it->pos * CAPTURE_INDEX_ENTRY_LEN + 8);
+
+			if ((key & mask) != prefix) {
+				it->pos = it->end;
+				break;
+			}
+			it->pos++;
+			if (capture_key_matches(&it->query, key) && capture_read_record(c, offset, rec))
+				return true;
+		}
+		return false;
+	}
+
+	while (it->pos < it->end) {
+		const uint64_t len = capture_read_record(c, it->pos, rec);
+
+		if (len == 0) {
+			/* Cut short, there is nothing readable after it */
+			it->pos = it->end;
+			break;
+		}
+		it->pos += len;
+		if (capture_key_matches(&it->query, capture_record_key(rec->cdb, rec->cdb_len, rec->dev)))
+			return true;
+	}
+	return false;
+}
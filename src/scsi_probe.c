@@ -0,0 +1,609 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_probe.h"
+#include "scsi_stats.h"
+#include "ata.h"
+#include "parse_extended_inquiry.h"
+#include "parse_log_sense.h"
+#include "parse_receive_diagnostics.h"
+#include "parse_read_defect_data.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+#include <pthread.h>
+
+#define PROBE_MAX_DEVS_PER_THREAD 64
+#define PROBE_MAX_CMDS_PER_DEV 4
+
+typedef enum probe_kind_e {
+	PROBE_INQUIRY,
+	PROBE_READ_CAPACITY_10,
+	PROBE_READ_CAPACITY_16,
+	PROBE_EVPD_LIST,
+	PROBE_EVPD,
+	PROBE_LOG_LIST,
+	PROBE_LOG_SUBPAGE_LIST,
+	PROBE_LOG,
+	PROBE_MODE_SENSE_10,
+	PROBE_MODE_SENSE_6,
+	PROBE_DIAG_LIST,
+	PROBE_DIAG,
+	PROBE_GROWN_DEFECTS,
+	PROBE_ATA_IDENTIFY,
+	PROBE_ATA_CHECK_POWER_MODE,
+	PROBE_ATA_SMART_RETURN_STATUS,
+	PROBE_ATA_SMART_READ_DATA,
+	PROBE_ATA_SMART_READ_THRESHOLD,
+} probe_kind_e;
+
+struct probe_dev_t;
+
+/* A node of the probe graph of a device */
+typedef struct probe_step_t {
+	scsi_cmd_t cmd; // cmd.priv is the step
+	struct probe_dev_t *dev;
+	uint8_t kind; // probe_kind_e
+	uint32_t key; // Position in the graph, root index in the high half and child index + 1 in the low half
+	unsigned num_children;
+	struct probe_step_t *next;
+} probe_step_t;
+
+typedef struct probe_dev_t {
+	scsi_probe_snapshot_t *snap;
+	int handle;
+	unsigned num_roots;
+	probe_step_t *pending_head;
+	probe_step_t *pending_tail;
+	probe_step_t *in_flight_head; // Submitted and not completed yet
+	unsigned in_flight;
+	uint32_t *keys; // Graph position of each response, to sort them at the end
+	unsigned responses_size;
+	struct probe_dev_t *next;
+} probe_dev_t;
+
+struct probe_run_t;
+
+typedef struct probe_worker_t {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	unsigned *queue; // Indices of devices not started yet, the owner takes from the tail and thieves from the head
+	unsigned head;
+	unsigned tail;
+	struct probe_run_t *run;
+} probe_worker_t;
+
+typedef struct probe_run_t {
+	const scsi_probe_config_t *config;
+	unsigned steps;
+	unsigned max_devs;
+	unsigned max_cmds;
+	const char * const *names;
+	scsi_probe_snapshot_t *snapshots;
+	probe_worker_t *workers;
+	unsigned num_workers;
+} probe_run_t;
+
+static probe_step_t *probe_step_add(probe_dev_t *dev, probe_step_t *parent, probe_kind_e kind,
+                                    const unsigned char *cdb, int cdb_len, scsi_dir_e dir, unsigned buf_len)
+{
+	probe_step_t *step = calloc(1, sizeof(*step));
+	unsigned char *buf = NULL;
+
+	if (!step)
+		return NULL;
+	if (buf_len) {
+		buf = malloc(buf_len);
+		if (!buf) {
+			free(step);
+			return NULL;
+		}
+	}
+
+	scsi_cmd_init(&step->cmd, dev->handle, cdb, cdb_len, dir, buf, buf_len);
+	step->cmd.priv = step;
+	step->dev = dev;
+	step->kind = kind;
+	if (parent)
+		step->key = (parent->key & 0xFFFF0000) | ++parent->num_children;
+	else
+		step->key = dev->num_roots++ << 16;
+
+	if (dev->pending_tail)
+		dev->pending_tail->next = step;
+	else
+		dev->pending_head = step;
+	dev->pending_tail = step;
+	return step;
+}
+
+static void probe_add_inquiry(probe_dev_t *dev, probe_step_t *parent, probe_kind_e kind, bool evpd, uint8_t page, unsigned len)
+{
+	unsigned char cdb[16];
+	probe_step_add(dev, parent, kind, cdb, cdb_inquiry(cdb, evpd, page, len), SCSI_DIR_FROM_DEV, len);
+}
+
+static void probe_add_log_sense(probe_dev_t *dev, probe_step_t *parent, probe_kind_e kind, uint8_t page, uint8_t subpage)
+{
+	unsigned char cdb[16];
+	probe_step_add(dev, parent, kind, cdb, cdb_log_sense(cdb, page, subpage, 16*1024), SCSI_DIR_FROM_DEV, 16*1024);
+}
+
+static void probe_add_diag(probe_dev_t *dev, probe_step_t *parent, probe_kind_e kind, uint8_t page)
+{
+	unsigned char cdb[16];
+	probe_step_add(dev, parent, kind, cdb, cdb_receive_diagnostics(cdb, true, page, 16*1024), SCSI_DIR_FROM_DEV, 16*1024);
+}
+
+static void probe_add_roots(probe_dev_t *dev, unsigned steps)
+{
+	unsigned char cdb[16];
+
+	probe_add_inquiry(dev, NULL, PROBE_INQUIRY, false, 0, 96);
+	if (steps & SCSI_PROBE_CAPACITY) {
+		probe_step_add(dev, NULL, PROBE_READ_CAPACITY_10, cdb, cdb_read_capacity_10(cdb), SCSI_DIR_FROM_DEV, 8);
+		probe_step_add(dev, NULL, PROBE_READ_CAPACITY_16, cdb, cdb_read_capacity_16(cdb, 32), SCSI_DIR_FROM_DEV, 32);
+	}
+	if (steps & SCSI_PROBE_EVPD)
+		probe_add_inquiry(dev, NULL, PROBE_EVPD_LIST, true, 0, 512);
+	if (steps & SCSI_PROBE_LOG_SENSE) {
+		probe_add_log_sense(dev, NULL, PROBE_LOG_LIST, 0, 0);
+		probe_add_log_sense(dev, NULL, PROBE_LOG_SUBPAGE_LIST, 0, 0xFF);
+	}
+	if (steps & SCSI_PROBE_MODE_SENSE) {
+		probe_step_add(dev, NULL, PROBE_MODE_SENSE_10, cdb,
+		               cdb_mode_sense_10(cdb, true, false, PAGE_CONTROL_CURRENT, 0x3F, 0xFF, 4096), SCSI_DIR_FROM_DEV, 4096);
+		probe_step_add(dev, NULL, PROBE_MODE_SENSE_6, cdb,
+		               cdb_mode_sense_6(cdb, false, PAGE_CONTROL_CURRENT, 0x3F, 0xFF, 255), SCSI_DIR_FROM_DEV, 255);
+	}
+	if (steps & SCSI_PROBE_DIAGNOSTICS)
+		probe_add_diag(dev, NULL, PROBE_DIAG_LIST, 0);
+	if (steps & SCSI_PROBE_DEFECTS)
+		probe_step_add(dev, NULL, PROBE_GROWN_DEFECTS, cdb,
+		               cdb_read_defect_data_10(cdb, false, true, ADDRESS_FORMAT_LONG, READ_DEFECT_DATA_10_MIN_LEN),
+		               SCSI_DIR_FROM_DEV, READ_DEFECT_DATA_10_MIN_LEN);
+}
+
+static void probe_add_ata(probe_dev_t *dev, probe_step_t *parent)
+{
+	unsigned char cdb[16];
+
+	probe_step_add(dev, parent, PROBE_ATA_IDENTIFY, cdb, cdb_ata_identify_16(cdb), SCSI_DIR_FROM_DEV, 512);
+	probe_step_add(dev, parent, PROBE_ATA_CHECK_POWER_MODE, cdb, cdb_ata_check_power_mode(cdb), SCSI_DIR_NONE, 0);
+	probe_step_add(dev, parent, PROBE_ATA_SMART_RETURN_STATUS, cdb, cdb_ata_smart_return_status(cdb), SCSI_DIR_NONE, 0);
+	probe_step_add(dev, parent, PROBE_ATA_SMART_READ_DATA, cdb, cdb_ata_smart_read_data(cdb), SCSI_DIR_FROM_DEV, 512);
+	probe_step_add(dev, parent, PROBE_ATA_SMART_READ_THRESHOLD, cdb, cdb_ata_smart_read_threshold(cdb), SCSI_DIR_FROM_DEV, 512);
+}
+
+/* The data is usable with GOOD status or a RECOVERED ERROR */
+static bool probe_cmd_ok(scsi_cmd_t *cmd)
+{
+	sense_info_t info;
+
+	if (cmd->error || cmd->host_status)
+		return false;
+	if (cmd->sense_len == 0)
+		return cmd->status == 0;
+	return scsi_parse_sense(cmd->sense, cmd->sense_len, &info) && info.sense_key == SENSE_KEY_RECOVERED_ERROR;
+}
+
+/* Parse what the snapshot keeps from the response and add the steps that depend on it */
+static void probe_step_parse(probe_dev_t *dev, probe_step_t *step, unsigned steps)
+{
+	scsi_probe_snapshot_t *snap = dev->snap;
+	unsigned char *buf = step->cmd.buf;
+	const unsigned len = step->cmd.data_len;
+	unsigned i;
+
+	if (!probe_cmd_ok(&step->cmd))
+		return;
+
+	switch ((probe_kind_e)step->kind) {
+		case PROBE_INQUIRY:
+			snap->inquiry_valid = parse_inquiry(buf, len, &snap->device_type, snap->vendor, snap->model, snap->rev, snap->serial);
+			snap->is_ata = snap->inquiry_valid && strncmp(snap->vendor, "ATA", 3) == 0;
+			if (snap->is_ata && (steps & SCSI_PROBE_ATA))
+				probe_add_ata(dev, step);
+			break;
+
+		case PROBE_READ_CAPACITY_10:
+			if (!snap->capacity_valid) {
+				uint32_t max_lba;
+				if (parse_read_capacity_10(buf, len, &max_lba, &snap->block_size) && max_lba != 0xFFFFFFFF) {
+					snap->max_lba = max_lba;
+					snap->capacity_valid = true;
+				}
+			}
+			break;
+
+		case PROBE_READ_CAPACITY_16:
+			if (parse_read_capacity_16_simple(buf, len, &snap->max_lba, &snap->block_size))
+				snap->capacity_valid = true;
+			break;
+
+		case PROBE_EVPD_LIST:
+			if (evpd_is_valid(buf, len)) {
+				for (i = 4; i < evpd_page_len(buf) + 4u && i < len; i++)
+					if (buf[i] != 0)
+						probe_add_inquiry(dev, step, PROBE_EVPD, true, buf[i], 512);
+			}
+			break;
+
+		case PROBE_LOG_LIST:
+			if (log_sense_is_valid(buf, len) && buf[0] == 0 && buf[1] == 0) {
+				for (i = 0; i < log_sense_data_len(buf) && 4 + i < len; i++)
+					if (buf[4 + i] != 0)
+						probe_add_log_sense(dev, step, PROBE_LOG, buf[4 + i], 0);
+			}
+			break;
+
+		case PROBE_LOG_SUBPAGE_LIST:
+			if (log_sense_is_valid(buf, len) && buf[0] == 0x40 && buf[1] == 0xFF) {
+				/* Subpage 0 of every page was already read from the pages list */
+				for (i = 0; i + 1 < log_sense_data_len(buf) && 4 + i + 1 < len; i += 2)
+					if (buf[4 + i + 1] != 0 && (buf[4 + i] & 0x3F) != 0)
+						probe_add_log_sense(dev, step, PROBE_LOG, buf[4 + i] & 0x3F, buf[4 + i + 1]);
+			}
+			break;
+
+		case PROBE_LOG:
+			if (log_sense_page_informational_exceptions(buf, len, &snap->ie_asc, &snap->ie_ascq, &snap->temperature))
+				snap->ie_valid = true;
+			break;
+
+		case PROBE_DIAG_LIST:
+			if (recv_diag_is_valid(buf, len) && recv_diag_get_page_code(buf) == 0) {
+				for (i = 0; i < recv_diag_get_len(buf) && 4 + i < len; i++)
+					if (buf[4 + i] != 0)
+						probe_add_diag(dev, step, PROBE_DIAG, buf[4 + i]);
+			}
+			break;
+
+		case PROBE_GROWN_DEFECTS:
+			if (read_defect_data_10_hdr_is_valid(buf, len) && read_defect_data_10_is_glist_valid(buf)) {
+				const unsigned fmt_len = read_defect_data_fmt_len(read_defect_data_10_list_format(buf));
+				if (fmt_len) {
+					snap->grown_defects = read_defect_data_10_len(buf) / fmt_len;
+					snap->grown_defects_valid = true;
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/* Move the finished command into the snapshot, the data buffer goes with it */
+static void probe_step_record(probe_dev_t *dev, probe_step_t *step)
+{
+	scsi_probe_snapshot_t *snap = dev->snap;
+	scsi_probe_response_t *resp;
+
+	if (snap->num_responses == dev->responses_size) {
+		const unsigned size = dev->responses_size ? dev->responses_size * 2 : 32;
+		scsi_probe_response_t *responses = realloc(snap->responses, size * sizeof(*responses));
+		uint32_t *keys = realloc(dev->keys, size * sizeof(*keys));
+		if (responses)
+			snap->responses = responses;
+		if (keys)
+			dev->keys = keys;
+		if (!responses || !keys) {
+			free(step->cmd.buf);
+			return;
+		}
+		dev->responses_size = size;
+	}
+
+	dev->keys[snap->num_responses] = step->key;
+	resp = &snap->responses[snap->num_responses++];
+	memcpy(resp->cdb, step->cmd.cdb, step->cmd.cdb_len);
+	resp->cdb_len = step->cmd.cdb_len;
+	resp->status = step->cmd.status;
+	resp->error = step->cmd.error;
+	resp->sense_len = step->cmd.sense_len;
+	memcpy(resp->sense, step->cmd.sense, step->cmd.sense_len);
+	resp->data_len = step->cmd.data_len;
+	resp->data = step->cmd.buf;
+}
+
+static void probe_step_done(probe_run_t *run, probe_step_t *step)
+{
+	probe_step_parse(step->dev, step, run->steps);
+	probe_step_record(step->dev, step);
+	free(step);
+}
+
+/* Close the device, a worker holds open only the devices it is probing. Then order the responses by their place in
+ * the graph, completions come in whatever order the devices answered. t is NULL when it was already destroyed.
+ */
+static void probe_dev_finish(scsi_transport_t *t, probe_dev_t *dev)
+{
+	scsi_probe_snapshot_t *snap = dev->snap;
+	unsigned i, j;
+
+	if (t)
+		scsi_transport_close(t, dev->handle);
+
+	for (i = 1; i < snap->num_responses; i++) {
+		const scsi_probe_response_t resp = snap->responses[i];
+		const uint32_t key = dev->keys[i];
+		for (j = i; j > 0 && dev->keys[j-1] > key; j--) {
+			snap->responses[j] = snap->responses[j-1];
+			dev->keys[j] = dev->keys[j-1];
+		}
+		snap->responses[j] = resp;
+		dev->keys[j] = key;
+	}
+
+	free(dev->keys);
+	free(dev);
+}
+
+static bool probe_take(probe_run_t *run, probe_worker_t *self, unsigned *idx)
+{
+	unsigned i;
+
+	pthread_mutex_lock(&self->lock);
+	if (self->head < self->tail) {
+		*idx = self->queue[--self->tail];
+		pthread_mutex_unlock(&self->lock);
+		return true;
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	for (i = 1; i < run->num_workers; i++) {
+		probe_worker_t *victim = &run->workers[(self - run->workers + i) % run->num_workers];
+		bool found = false;
+
+		pthread_mutex_lock(&victim->lock);
+		if (victim->head < victim->tail) {
+			*idx = victim->queue[victim->head++];
+			found = true;
+		}
+		pthread_mutex_unlock(&victim->lock);
+		if (found)
+			return true;
+	}
+
+	return false;
+}
+
+static probe_dev_t *probe_dev_start(probe_run_t *run, scsi_transport_t *t, unsigned idx)
+{
+	scsi_probe_snapshot_t *snap = &run->snapshots[idx];
+	probe_dev_t *dev;
+	int handle;
+
+	handle = scsi_transport_open(t, run->names[idx]);
+	if (handle < 0) {
+		snap->error = handle;
+		return NULL;
+	}
+
+	dev = calloc(1, sizeof(*dev));
+	if (!dev) {
+		snap->error = -ENOMEM;
+		return NULL;
+	}
+	snap->error = 0;
+	dev->snap = snap;
+	dev->handle = handle;
+	probe_add_roots(dev, run->steps);
+	return dev;
+}
+
+static void probe_dev_submit(probe_run_t *run, scsi_transport_t *t, probe_dev_t *dev)
+{
+	while (dev->pending_head && dev->in_flight < run->max_cmds) {
+		probe_step_t *step = dev->pending_head;
+		int ret;
+
+		ret = scsi_transport_submit(t, &step->cmd);
+		if (ret == -EAGAIN && dev->in_flight > 0)
+			break;
+
+		dev->pending_head = step->next;
+		if (!dev->pending_head)
+			dev->pending_tail = NULL;
+		step->next = NULL;
+
+		if (ret == 0) {
+			step->next = dev->in_flight_head;
+			dev->in_flight_head = step;
+			dev->in_flight++;
+		} else {
+			step->cmd.error = ret;
+			probe_step_done(run, step);
+		}
+	}
+}
+
+static void probe_dev_completed(probe_dev_t *dev, probe_step_t *step)
+{
+	probe_step_t **pstep;
+
+	for (pstep = &dev->in_flight_head; *pstep; pstep = &(*pstep)->next) {
+		if (*pstep == step) {
+			*pstep = step->next;
+			break;
+		}
+	}
+	step->next = NULL;
+	dev->in_flight--;
+}
+
+static void probe_step_free_list(probe_step_t *step)
+{
+	while (step) {
+		probe_step_t *next = step->next;
+		free(step->cmd.buf);
+		free(step);
+		step = next;
+	}
+}
+
+static void *probe_worker(void *arg)
+{
+	probe_worker_t *self = arg;
+	probe_run_t *run = self->run;
+	scsi_transport_t *t = run->config->transport_create(run->config->transport_ctx);
+	probe_dev_t *active = NULL;
+	unsigned num_active = 0;
+
+	if (!t)
+		return NULL;
+	if (run->config->stats)
+		scsi_transport_attach_stats(t, run->config->stats);
+
+	for (;;) {
+		probe_dev_t **pdev;
+		scsi_cmd_t *done[64];
+		unsigned idx;
+		unsigned num_done, i;
+
+		while (num_active < run->max_devs && probe_take(run, self, &idx)) {
+			probe_dev_t *dev = probe_dev_start(run, t, idx);
+			if (dev) {
+				dev->next = active;
+				active = dev;
+				num_active++;
+			}
+		}
+
+		/* Nothing active after trying to take more means there is nothing left to take */
+		if (num_active == 0)
+			break;
+
+		/* Submit what is ready and retire the devices that have nothing left */
+		for (pdev = &active; *pdev; ) {
+			probe_dev_t *dev = *pdev;
+
+			probe_dev_submit(run, t, dev);
+			if (dev->in_flight == 0 && !dev->pending_head) {
+				*pdev = dev->next;
+				num_active--;
+				probe_dev_finish(t, dev);
+			} else {
+				pdev = &dev->next;
+			}
+		}
+		if (scsi_transport_in_flight(t) == 0)
+			continue;
+
+		if (scsi_transport_poll(t, -1) < 0)
+			break;
+
+		while ((num_done = scsi_transport_complete(t, done, 64)) > 0) {
+			for (i = 0; i < num_done; i++) {
+				probe_step_t *step = done[i]->priv;
+				probe_dev_completed(step->dev, step);
+				probe_step_done(run, step);
+			}
+		}
+	}
+
+	/* Only reached early on a transport failure, the devices still active are abandoned. The transport goes first so
+	 * that nothing refers to the commands still in flight when they are freed.
+	 */
+	scsi_transport_destroy(t);
+	while (active) {
+		probe_dev_t *dev = active;
+		active = dev->next;
+		dev->snap->error = -EIO;
+		probe_step_free_list(dev->pending_head);
+		probe_step_free_list(dev->in_flight_head);
+		probe_dev_finish(NULL, dev);
+	}
+
+	return NULL;
+}
+
+int scsi_probe_run(const scsi_probe_config_t *config, const char * const *names, unsigned num_names,
+                   scsi_probe_snapshot_t *snapshots)
+{
+	probe_run_t run;
+	unsigned i;
+	int ret = 0;
+
+	if (!config->transport_create)
+		return -EINVAL;
+
+	memset(&run, 0, sizeof(run));
+	run.config = config;
+	run.steps = config->steps ? config->steps : SCSI_PROBE_ALL;
+	run.max_devs = config->max_devs_per_thread ? config->max_devs_per_thread : PROBE_MAX_DEVS_PER_THREAD;
+	run.max_cmds = config->max_cmds_per_dev ? config->max_cmds_per_dev : PROBE_MAX_CMDS_PER_DEV;
+	run.names = names;
+	run.snapshots = snapshots;
+	run.num_workers = config->num_threads ? config->num_threads : 1;
+	if (run.num_workers > num_names)
+		run.num_workers = num_names ? num_names : 1;
+
+	for (i = 0; i < num_names; i++) {
+		memset(&snapshots[i], 0, sizeof(snapshots[i]));
+		snapshots[i].name = names[i];
+		snapshots[i].error = -ECANCELED;
+	}
+
+	run.workers = calloc(run.num_workers, sizeof(*run.workers));
+	if (!run.workers)
+		return -ENOMEM;
+
+	/* Round robin to start with, stealing evens out the devices that are slower to probe */
+	for (i = 0; i < run.num_workers; i++) {
+		probe_worker_t *worker = &run.workers[i];
+		worker->run = &run;
+		pthread_mutex_init(&worker->lock, NULL);
+		worker->queue = malloc((num_names / run.num_workers + 1) * sizeof(*worker->queue));
+		if (!worker->queue)
+			ret = -ENOMEM;
+	}
+	for (i = 0; ret == 0 && i < num_names; i++) {
+		probe_worker_t *worker = &run.workers[i % run.num_workers];
+		worker->queue[worker->tail++] = num_names - 1 - i;
+	}
+
+	for (i = 0; ret == 0 && i < run.num_workers; i++) {
+		if (pthread_create(&run.workers[i].thread, NULL, probe_worker, &run.workers[i]) != 0) {
+			/* The workers already started pick up the devices of the ones that didn't */
+			if (i == 0)
+				ret = -EAGAIN;
+			break;
+		}
+	}
+	while (i-- > 0)
+		pthread_join(run.workers[i].thread, NULL);
+
+	for (i = 0; i < run.num_workers; i++) {
+		pthread_mutex_destroy(&run.workers[i].lock);
+		free(run.workers[i].queue);
+	}
+	free(run.workers);
+	return ret;
+}
+
+void scsi_probe_snapshot_free(scsi_probe_snapshot_t *snapshot)
+{
+	unsigned i;
+
+	for (i = 0; i < snapshot->num_responses; i++)
+		free(snapshot->responses[i].data);
+	free(snapshot->responses);
+	snapshot->responses = NULL;
+	snapshot->num_responses = 0;
+}
@@ -0,0 +1,413 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_stats.h"
+#include "scsicmd.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+
+#define SUB_BUCKETS (1u << SCSI_STATS_SUB_BITS)
+
+/* Octaves written as Prometheus buckets, 2^10ns (1.024us) to 2^34ns (~17.2s) */
+#define PROM_FIRST_OCTAVE 10
+#define PROM_LAST_OCTAVE 34
+
+struct scsi_stats_t {
+	unsigned max_devs;
+	unsigned max_shards;
+	unsigned num_shards;
+	scsi_stats_snapshot_t **shards;
+};
+
+/* Only the owning transport writes a shard, a relaxed load and store is enough for readers to never see torn values */
+static inline void stat_add(uint64_t *counter, uint64_t val)
+{
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + val, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t stat_get(const uint64_t *counter)
+{
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static inline unsigned stats_bucket(uint64_t val)
+{
+	unsigned shift, idx;
+
+	if (val < SUB_BUCKETS)
+		return val;
+	shift = 63 - __builtin_clzll(val) - SCSI_STATS_SUB_BITS;
+	idx = (shift + 1) << SCSI_STATS_SUB_BITS | ((val >> shift) & (SUB_BUCKETS - 1));
+	return idx < SCSI_STATS_NUM_BUCKETS ? idx : SCSI_STATS_NUM_BUCKETS - 1;
+}
+
+/* First value past the bucket */
+static inline uint64_t stats_bucket_end(unsigned idx)
+{
+	unsigned shift;
+
+	if (idx < SUB_BUCKETS)
+		return idx + 1;
+	shift = (idx >> SCSI_STATS_SUB_BITS) - 1;
+	return (uint64_t)((idx & (SUB_BUCKETS - 1)) + SUB_BUCKETS + 1) << shift;
+}
+
+static size_t stats_snapshot_size(unsigned max_devs)
+{
+	return sizeof(scsi_stats_snapshot_t) + max_devs * sizeof(scsi_stats_class_t);
+}
+
+uint64_t scsi_stats_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+scsi_stats_t *scsi_stats_create(unsigned max_devs, unsigned max_transports)
+{
+	scsi_stats_t *stats = calloc(1, sizeof(*stats));
+	if (!stats)
+		return NULL;
+
+	stats->shards = calloc(max_transports, sizeof(*stats->shards));
+	if (!stats->shards) {
+		free(stats);
+		return NULL;
+	}
+	stats->max_devs = max_devs;
+	stats->max_shards = max_transports;
+	return stats;
+}
+
+void scsi_stats_destroy(scsi_stats_t *stats)
+{
+	unsigned i;
+
+	for (i = 0; i < stats->max_shards; i++)
+		free(stats->shards[i]);
+	free(stats->shards);
+	free(stats);
+}
+
+int scsi_transport_attach_stats(scsi_transport_t *t, scsi_stats_t *stats)
+{
+	const size_t size = stats_snapshot_size(stats->max_devs);
+	scsi_stats_snapshot_t *shard;
+	unsigned idx;
+
+	idx = __atomic_fetch_add(&stats->num_shards, 1, __ATOMIC_RELAXED);
+	if (idx >= stats->max_shards)
+		return -ENOSPC;
+
+	/* Cache line aligned so that shards of different threads don't share lines */
+	if (posix_memalign((void **)&shard, 64, size) != 0)
+		return -ENOMEM;
+	memset(shard, 0, size);
+	shard->num_devs = stats->max_devs;
+
+	__atomic_store_n(&stats->shards[idx], shard, __ATOMIC_RELEASE);
+	t->stats = shard;
+	return 0;
+}
+
+static void stats_hist_record(scsi_stats_hist_t *hist, uint64_t latency_ns)
+{
+	stat_add(&hist->count, 1);
+	stat_add(&hist->sum_ns, latency_ns);
+	if (latency_ns > stat_get(&hist->max_ns))
+		__atomic_store_n(&hist->max_ns, latency_ns, __ATOMIC_RELAXED);
+	stat_add(&hist->buckets[stats_bucket(latency_ns)], 1);
+}
+
+static void stats_class_record(scsi_stats_class_t *class, const scsi_cmd_t *cmd, uint64_t latency_ns)
+{
+	stats_hist_record(&class->latency, latency_ns);
+	if (cmd->error)
+		stat_add(&class->errors, 1);
+	else if (cmd->status == SCSI_STATUS_CHECK_CONDITION)
+		stat_add(&class->check_conditions, 1);
+	stat_add(&class->bytes, cmd->data_len);
+}
+
+void scsi_stats_record(scsi_stats_snapshot_t *shard, const scsi_cmd_t *cmd, uint64_t now_ns)
+{
+	scsi_stats_outcome_t *total = &shard->total;
+	const uint64_t latency_ns = now_ns > cmd->submit_ns ? now_ns - cmd->submit_ns : 0;
+
+	stat_add(&total->commands, 1);
+	if (cmd->error) {
+		stat_add(&total->errors, 1);
+	} else {
+		stat_add(&total->status[(cmd->status >> 1) & 31], 1);
+		stat_add(&total->host_status[cmd->host_status < 31 ? cmd->host_status : 31], 1);
+		stat_add(&total->driver_status[cmd->driver_status & 0xF], 1);
+
+		if (cmd->status == SCSI_STATUS_CHECK_CONDITION) {
+			sense_info_t info;
+			if (scsi_parse_sense((unsigned char *)cmd->sense, cmd->sense_len, &info))
+				stat_add(&total->sense_keys[info.sense_key & 0xF], 1);
+			else
+				stat_add(&total->sense_unparsed, 1);
+		}
+
+		if (cmd->dir == SCSI_DIR_FROM_DEV)
+			stat_add(&total->bytes_in, cmd->data_len);
+		else if (cmd->dir == SCSI_DIR_TO_DEV)
+			stat_add(&total->bytes_out, cmd->data_len);
+	}
+
+	stats_class_record(&shard->kinds[cdb_opcode_kind(cmd->cdb[0])], cmd, latency_ns);
+	if (cmd->dev >= 0 && (unsigned)cmd->dev < shard->num_devs)
+		stats_class_record(&shard->devs[cmd->dev], cmd, latency_ns);
+}
+
+static void stats_sum(uint64_t *dst, const uint64_t *src, unsigned num)
+{
+	unsigned i;
+
+	for (i = 0; i < num; i++)
+		dst[i] += stat_get(&src[i]);
+}
+
+static void stats_hist_sum(scsi_stats_hist_t *dst, const scsi_stats_hist_t *src)
+{
+	const uint64_t max_ns = stat_get(&src->max_ns);
+
+	dst->count += stat_get(&src->count);
+	dst->sum_ns += stat_get(&src->sum_ns);
+	if (max_ns > dst->max_ns)
+		dst->max_ns = max_ns;
+	stats_sum(dst->buckets, src->buckets, SCSI_STATS_NUM_BUCKETS);
+}
+
+static void stats_class_sum(scsi_stats_class_t *dst, const scsi_stats_class_t *src)
+{
+	stats_hist_sum(&dst->latency, &src->latency);
+	dst->errors += stat_get(&src->errors);
+	dst->check_conditions += stat_get(&src->check_conditions);
+	dst->bytes += stat_get(&src->bytes);
+}
+
+scsi_stats_snapshot_t *scsi_stats_snapshot(scsi_stats_t *stats)
+{
+	scsi_stats_snapshot_t *snap = calloc(1, stats_snapshot_size(stats->max_devs));
+	unsigned num_shards = __atomic_load_n(&stats->num_shards, __ATOMIC_RELAXED);
+	unsigned i, j;
+
+	if (!snap)
+		return NULL;
+	snap->num_devs = stats->max_devs;
+
+	if (num_shards > stats->max_shards)
+		num_shards = stats->max_shards;
+	for (i = 0; i < num_shards; i++) {
+		const scsi_stats_snapshot_t *shard = __atomic_load_n(&stats->shards[i], __ATOMIC_ACQUIRE);
+		if (!shard)
+			continue;
+
+		/* The outcome counters are all uint64_t in a row */
+		stats_sum((uint64_t *)&snap->total, (const uint64_t *)&shard->total, sizeof(snap->total) / sizeof(uint64_t));
+		for (j = 0; j < CDB_KIND_NUM; j++)
+			stats_class_sum(&snap->kinds[j], &shard->kinds[j]);
+		for (j = 0; j < snap->num_devs; j++)
+			stats_class_sum(&snap->devs[j], &shard->devs[j]);
+	}
+
+	return snap;
+}
+
+uint64_t scsi_stats_hist_percentile(const scsi_stats_hist_t *hist, double percentile)
+{
+	uint64_t target, seen = 0;
+	unsigned i;
+
+	if (hist->count == 0)
+		return 0;
+
+	target = hist->count * percentile / 100.0;
+	if (target == 0)
+		target = 1;
+	if (target > hist->count)
+		target = hist->count;
+
+	for (i = 0; i < SCSI_STATS_NUM_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen >= target) {
+			const uint64_t end = stats_bucket_end(i) - 1;
+			return end < hist->max_ns ? end : hist->max_ns;
+		}
+	}
+	return hist->max_ns;
+}
+
+static const char *stats_status_name(unsigned status)
+{
+	switch (status) {
+		case 0x00: return "GOOD";
+		case 0x02: return "CHECK_CONDITION";
+		case 0x04: return "CONDITION_MET";
+		case 0x08: return "BUSY";
+		case 0x18: return "RESERVATION_CONFLICT";
+		case 0x28: return "TASK_SET_FULL";
+		case 0x30: return "ACA_ACTIVE";
+		case 0x40: return "TASK_ABORTED";
+		default: return NULL;
+	}
+}
+
+static void prom_header(FILE *f, const char *name, const char *type, const char *help)
+{
+	fprintf(f, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void prom_label_value(FILE *f, const char *val)
+{
+	for (; *val; val++) {
+		if (*val == '\\' || *val == '"')
+			fputc('\\', f);
+		if (*val == '\n')
+			fputs("\\n", f);
+		else
+			fputc(*val, f);
+	}
+}
+
+static void prom_labels(FILE *f, const char *label, const char *val, unsigned dev, const char *extra)
+{
+	fprintf(f, "{%s=\"", label);
+	if (val)
+		prom_label_value(f, val);
+	else
+		fprintf(f, "%u", dev);
+	fputc('"', f);
+	if (extra)
+		fprintf(f, ",%s", extra);
+	fputc('}', f);
+}
+
+static void prom_hist(FILE *f, const char *name, const char *label, const char *val, unsigned dev, const scsi_stats_hist_t *hist)
+{
+	uint64_t cumulative = 0;
+	unsigned bucket = 0;
+	unsigned octave;
+	char le[64];
+
+	for (octave = PROM_FIRST_OCTAVE; octave <= PROM_LAST_OCTAVE; octave++) {
+		const unsigned end = stats_bucket(1ULL << octave);
+		for (; bucket < end; bucket++)
+			cumulative += hist->buckets[bucket];
+		snprintf(le, sizeof(le), "le=\"%.9g\"", (double)(1ULL << octave) / 1e9);
+		fprintf(f, "%s_bucket", name);
+		prom_labels(f, label, val, dev, le);
+		fprintf(f, " %" PRIu64 "\n", cumulative);
+	}
+	fprintf(f, "%s_bucket", name);
+	prom_labels(f, label, val, dev, "le=\"+Inf\"");
+	fprintf(f, " %" PRIu64 "\n", hist->count);
+	fprintf(f, "%s_sum", name);
+	prom_labels(f, label, val, dev, NULL);
+	fprintf(f, " %.9f\n", hist->sum_ns / 1e9);
+	fprintf(f, "%s_count", name);
+	prom_labels(f, label, val, dev, NULL);
+	fprintf(f, " %" PRIu64 "\n", hist->count);
+}
+
+static void prom_classes(FILE *f, const char *prefix, const char *label, const scsi_stats_class_t *classes, unsigned num,
+                         const char * const *names, bool by_kind)
+{
+	static const char *suffixes[] = { "command_latency_seconds", "errors_total", "check_conditions_total", "bytes_total" };
+	static const char *types[] = { "histogram", "counter", "counter", "counter" };
+	static const char *helps[] = {
+		"Latency from submission to completion",
+		"Commands that didn't reach the device",
+		"Commands that ended with CHECK CONDITION",
+		"Bytes transferred",
+	};
+	unsigned metric, i;
+	char name[128];
+
+	for (metric = 0; metric < 4; metric++) {
+		snprintf(name, sizeof(name), "%s%s", prefix, suffixes[metric]);
+		prom_header(f, name, types[metric], helps[metric]);
+
+		for (i = 0; i < num; i++) {
+			const scsi_stats_class_t *class = &classes[i];
+			const char *val = by_kind ? cdb_kind_name(i) : names ? names[i] : NULL;
+
+			if (class->latency.count == 0)
+				continue;
+			if (metric == 0) {
+				prom_hist(f, name, label, val, i, &class->latency);
+				continue;
+			}
+			fputs(name, f);
+			prom_labels(f, label, val, i, NULL);
+			fprintf(f, " %" PRIu64 "\n", metric == 1 ? class->errors : metric == 2 ? class->check_conditions : class->bytes);
+		}
+	}
+}
+
+void scsi_stats_write_prometheus(const scsi_stats_snapshot_t *snap, const char * const *dev_names, FILE *f)
+{
+	const scsi_stats_outcome_t *total = &snap->total;
+	unsigned i;
+
+	prom_header(f, "scsi_commands_total", "counter", "Commands completed");
+	fprintf(f, "scsi_commands_total %" PRIu64 "\n", total->commands);
+
+	prom_header(f, "scsi_command_errors_total", "counter", "Commands that didn't reach the device");
+	fprintf(f, "scsi_command_errors_total %" PRIu64 "\n", total->errors);
+
+	prom_header(f, "scsi_status_total", "counter", "Commands by SCSI status");
+	for (i = 0; i < 32; i++) {
+		const char *status = stats_status_name(i << 1);
+		if (!total->status[i])
+			continue;
+		if (status)
+			fprintf(f, "scsi_status_total{status=\"%s\"} %" PRIu64 "\n", status, total->status[i]);
+		else
+			fprintf(f, "scsi_status_total{status=\"0x%02x\"} %" PRIu64 "\n", i << 1, total->status[i]);
+	}
+
+	prom_header(f, "scsi_sense_key_total", "counter", "CHECK CONDITION commands by sense key");
+	for (i = 0; i < 16; i++)
+		if (total->sense_keys[i])
+			fprintf(f, "scsi_sense_key_total{sense_key=\"%s\"} %" PRIu64 "\n", sense_key_to_name(i), total->sense_keys[i]);
+	if (total->sense_unparsed)
+		fprintf(f, "scsi_sense_key_total{sense_key=\"UNPARSED\"} %" PRIu64 "\n", total->sense_unparsed);
+
+	prom_header(f, "scsi_host_status_total", "counter", "Commands by host status");
+	for (i = 0; i < 32; i++)
+		if (total->host_status[i])
+			fprintf(f, "scsi_host_status_total{host_status=\"%u\"} %" PRIu64 "\n", i, total->host_status[i]);
+
+	prom_header(f, "scsi_driver_status_total", "counter", "Commands by driver status");
+	for (i = 0; i < 16; i++)
+		if (total->driver_status[i])
+			fprintf(f, "scsi_driver_status_total{driver_status=\"%u\"} %" PRIu64 "\n", i, total->driver_status[i]);
+
+	prom_header(f, "scsi_transferred_bytes_total", "counter", "Bytes transferred by direction");
+	fprintf(f, "scsi_transferred_bytes_total{dir=\"in\"} %" PRIu64 "\n", total->bytes_in);
+	fprintf(f, "scsi_transferred_bytes_total{dir=\"out\"} %" PRIu64 "\n", total->bytes_out);
+
+	prom_classes(f, "scsi_opcode_", "opcode", snap->kinds, CDB_KIND_NUM, NULL, true);
+	prom_classes(f, "scsi_device_", "device", snap->devs, snap->num_devs, dev_names, false);
+}
@@ -0,0 +1,96 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_transport.h"
+#include "scsi_stats.h"
+
+#include <memory.h>
+#include <errno.h>
+
+void scsi_transport_init(scsi_transport_t *t, const scsi_transport_ops_t *ops)
+{
+	memset(t, 0, sizeof(*t));
+	t->ops = ops;
+}
+
+void scsi_cmd_init(scsi_cmd_t *cmd, int dev, const unsigned char *cdb, unsigned cdb_len, scsi_dir_e dir,
+                   unsigned char *buf, unsigned buf_len)
+{
+	memset(cmd, 0, sizeof(*cmd));
+	cmd->dev = dev;
+	if (cdb_len > sizeof(cmd->cdb))
+		cdb_len = sizeof(cmd->cdb);
+	memcpy(cmd->cdb, cdb, cdb_len);
+	cmd->cdb_len = cdb_len;
+	cmd->dir = buf_len ? dir : SCSI_DIR_NONE;
+	cmd->timeout_ms = 30*1000;
+	cmd->buf = buf;
+	cmd->buf_len = buf_len;
+}
+
+int scsi_transport_submit(scsi_transport_t *t, scsi_cmd_t *cmd)
+{
+	int ret;
+
+	cmd->error = 0;
+	cmd->status = 0;
+	cmd->host_status = 0;
+	cmd->driver_status = 0;
+	cmd->sense_len = 0;
+	cmd->data_len = 0;
+	cmd->next = NULL;
+
+	if (cmd->cdb_len == 0 || cmd->cdb_len > sizeof(cmd->cdb))
+		return -EINVAL;
+
+	if (t->stats)
+		cmd->submit_ns = scsi_stats_now_ns();
+
+	ret = t->ops->submit(t, cmd);
+	if (ret == 0)
+		t->in_flight++;
+	return ret;
+}
+
+void scsi_transport_done(scsi_transport_t *t, scsi_cmd_t *cmd)
+{
+	if (t->stats)
+		scsi_stats_record(t->stats, cmd, scsi_stats_now_ns());
+
+	cmd->next = NULL;
+	if (t->done_tail)
+		t->done_tail->next = cmd;
+	else
+		t->done_head = cmd;
+	t->done_tail = cmd;
+	t->in_flight--;
+}
+
+unsigned scsi_transport_complete(scsi_transport_t *t, scsi_cmd_t **cmds, unsigned max)
+{
+	unsigned num = 0;
+
+	while (num < max && t->done_head) {
+		scsi_cmd_t *cmd = t->done_head;
+		t->done_head = cmd->next;
+		cmd->next = NULL;
+		cmds[num++] = cmd;
+	}
+
+	if (t->done_head == NULL)
+		t->done_tail = NULL;
+	return num;
+}
@@ -0,0 +1,574 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Synthetic in-memory block device target with injectable faults */
+
+#include "scsi_transport_sim.h"
+#include "scsicmd.h"
+#include "cdb_decode.h"
+#include "parse_extended_inquiry.h"
+#include "parse_log_sense.h"
+#include "parse_mode_sense.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+
+#define BLOCK_INQUIRY_LEN 96
+#define BLOCK_TEMPERATURE 35
+#define BLOCK_TRIP_TEMPERATURE 65
+#define BLOCK_NO_INFO UINT64_MAX
+
+typedef struct block_fault_t {
+	scsi_block_fault_t fault;
+	unsigned hits;
+} block_fault_t;
+
+typedef struct block_dev_t {
+	char serial[21];
+	unsigned char *data; // NULL unless the config asks to store data
+	unsigned in_flight;
+	uint64_t num_cmds;
+	block_fault_t *lba_faults; // Sorted by LBA
+	unsigned num_lba_faults;
+	block_fault_t *cmd_faults;
+	unsigned num_cmd_faults;
+	bool closed; // The slot is free for the next open
+} block_dev_t;
+
+typedef struct block_transport_t {
+	scsi_transport_t t; // Must be first
+	sim_queue_t q;
+	scsi_block_config_t config;
+	block_dev_t *devs;
+	unsigned num_devs;
+} block_transport_t;
+
+static inline void set_uint16(unsigned char *buf, int start, uint16_t val)
+{
+	buf[start] = (val >> 8) & 0xFF;
+	buf[start+1] = val & 0xFF;
+}
+
+static inline void set_uint32(unsigned char *buf, int start, uint32_t val)
+{
+	set_uint16(buf, start, val >> 16);
+	set_uint16(buf, start+2, val);
+}
+
+static inline void set_uint64(unsigned char *buf, int start, uint64_t val)
+{
+	set_uint32(buf, start, val >> 32);
+	set_uint32(buf, start+4, val);
+}
+
+/* ASCII fields are space padded and not NUL terminated */
+static void set_ascii(unsigned char *buf, const char *str, unsigned len)
+{
+	unsigned i;
+
+	for (i = 0; i < len && str && str[i]; i++)
+		buf[i] = str[i];
+	for (; i < len; i++)
+		buf[i] = ' ';
+}
+
+/* Counts a hit on the fault and removes it once it was hit the given number of times */
+static void block_fault_hit(block_fault_t *faults, unsigned *num_faults, unsigned idx)
+{
+	block_fault_t *fault = &faults[idx];
+
+	if (fault->fault.times && ++fault->hits == fault->fault.times) {
+		memmove(fault, fault + 1, (*num_faults - idx - 1) * sizeof(*fault));
+		(*num_faults)--;
+	}
+}
+
+/* Index of the first LBA fault that ends after lba */
+static unsigned block_fault_lookup(const block_dev_t *dev, uint64_t lba)
+{
+	unsigned lo = 0, hi = dev->num_lba_faults;
+
+	while (lo < hi) {
+		const unsigned mid = lo + (hi - lo) / 2;
+		const scsi_block_fault_t *fault = &dev->lba_faults[mid].fault;
+		if (fault->lba + fault->num_blocks <= lba)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Copies the fault that applies to the command into hit and counts the hit, info is the first failed LBA if any */
+static bool block_fault_match(block_dev_t *dev, const cdb_decoded_t *decoded, scsi_block_fault_t *hit, uint64_t *info)
+{
+	unsigned i;
+
+	for (i = 0; i < dev->num_cmd_faults; i++) {
+		if (dev->num_cmds > dev->cmd_faults[i].fault.cmd_count) {
+			*hit = dev->cmd_faults[i].fault;
+			*info = BLOCK_NO_INFO;
+			block_fault_hit(dev->cmd_faults, &dev->num_cmd_faults, i);
+			return true;
+		}
+	}
+
+	if (dev->num_lba_faults &&
+	    (decoded->kind == CDB_KIND_READ_10 || decoded->kind == CDB_KIND_READ_16 ||
+	     decoded->kind == CDB_KIND_WRITE_10 || decoded->kind == CDB_KIND_WRITE_16))
+	{
+		i = block_fault_lookup(dev, decoded->lba);
+		if (i < dev->num_lba_faults && dev->lba_faults[i].fault.lba < decoded->lba + decoded->transfer_len) {
+			const uint64_t start = dev->lba_faults[i].fault.lba;
+			*hit = dev->lba_faults[i].fault;
+			*info = decoded->lba > start ? decoded->lba : start;
+			block_fault_hit(dev->lba_faults, &dev->num_lba_faults, i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void block_inquiry(block_transport_t *block, block_dev_t *dev, scsi_cmd_t *cmd, const cdb_decoded_t *decoded)
+{
+	unsigned char buf[BLOCK_INQUIRY_LEN];
+	unsigned len;
+
+	memset(buf, 0, sizeof(buf));
+
+	if (!(decoded->flags & CDB_FLAG_EVPD)) {
+		if (decoded->page_code != 0) {
+			sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+			return;
+		}
+		buf[2] = 0x06; // SPC-4
+		buf[3] = 0x02; // Response data format
+		buf[4] = BLOCK_INQUIRY_LEN - 5;
+		buf[7] = 0x02; // CMDQUE
+		set_ascii(buf + 8, block->config.vendor, 8);
+		set_ascii(buf + 16, block->config.model, 16);
+		set_ascii(buf + 32, block->config.revision, 4);
+		set_ascii(buf + 36, dev->serial, 20);
+		len = BLOCK_INQUIRY_LEN;
+	} else {
+		buf[1] = decoded->page_code;
+		switch (decoded->page_code) {
+			case 0x00:
+				buf[4] = 0x00;
+				buf[5] = 0x80;
+				buf[6] = EVPD_BLOCK_LIMITS;
+				len = 7;
+				break;
+			case 0x80:
+				set_ascii(buf + 4, dev->serial, strlen(dev->serial));
+				len = 4 + strlen(dev->serial);
+				break;
+			case EVPD_BLOCK_LIMITS:
+				set_uint32(buf, 8, block->config.max_transfer_length);
+				set_uint32(buf, 12, block->config.opt_transfer_length);
+				len = EVPD_BLOCK_LIMITS_LEN;
+				break;
+			default:
+				sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+				return;
+		}
+		set_uint16(buf, 2, len - 4);
+	}
+
+	if (len > decoded->transfer_len)
+		len = decoded->transfer_len;
+	sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, buf, len);
+}
+
+static void block_read_capacity(block_transport_t *block, scsi_cmd_t *cmd, const cdb_decoded_t *decoded)
+{
+	const uint64_t max_lba = block->config.num_blocks - 1;
+	unsigned char buf[32];
+	unsigned len;
+
+	memset(buf, 0, sizeof(buf));
+	if (decoded->kind == CDB_KIND_READ_CAPACITY_10) {
+		set_uint32(buf, 0, max_lba > 0xFFFFFFFF ? 0xFFFFFFFF : max_lba);
+		set_uint32(buf, 4, block->config.block_size);
+		len = 8;
+	} else {
+		set_uint64(buf, 0, max_lba);
+		set_uint32(buf, 8, block->config.block_size);
+		len = decoded->transfer_len < sizeof(buf) ? decoded->transfer_len : sizeof(buf);
+	}
+	sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, buf, len);
+}
+
+static void block_rw(block_transport_t *block, block_dev_t *dev, scsi_cmd_t *cmd, const cdb_decoded_t *decoded)
+{
+	const bool write = decoded->kind == CDB_KIND_WRITE_10 || decoded->kind == CDB_KIND_WRITE_16;
+	const uint64_t len = (uint64_t)decoded->transfer_len * block->config.block_size;
+	const unsigned buf_len = len < cmd->buf_len ? len : cmd->buf_len;
+
+	if (decoded->lba >= block->config.num_blocks || decoded->transfer_len > block->config.num_blocks - decoded->lba) {
+		/* LOGICAL BLOCK ADDRESS OUT OF RANGE */
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x21, 0x00);
+		return;
+	}
+	if (block->config.max_transfer_length && decoded->transfer_len > block->config.max_transfer_length) {
+		/* INVALID FIELD IN CDB */
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+		return;
+	}
+
+	if (write) {
+		if (dev->data)
+			memcpy(dev->data + decoded->lba * block->config.block_size, cmd->buf, buf_len);
+		sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, NULL, 0);
+		cmd->data_len = buf_len;
+	} else if (dev->data) {
+		sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, dev->data + decoded->lba * block->config.block_size, buf_len);
+	} else {
+		sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, NULL, 0);
+		memset(cmd->buf, 0, buf_len);
+		cmd->data_len = buf_len;
+	}
+}
+
+static unsigned block_log_param(unsigned char *buf, uint16_t param_code, const uint8_t *data, uint8_t data_len)
+{
+	set_uint16(buf, 0, param_code);
+	buf[2] = 0x03; // Binary format list
+	buf[3] = data_len;
+	memcpy(buf + 4, data, data_len);
+	return 4 + data_len;
+}
+
+static void block_log_sense(scsi_cmd_t *cmd, const cdb_decoded_t *decoded)
+{
+	static const uint8_t supported_pages[] = { 0x00, 0x0D, 0x2F };
+	static const uint8_t supported_subpages[] = { 0x00, 0x00, 0x00, 0xFF, 0x0D, 0x00, 0x2F, 0x00 };
+	unsigned char buf[64];
+	unsigned len = LOG_SENSE_MIN_LEN;
+
+	memset(buf, 0, sizeof(buf));
+	buf[0] = decoded->page_code;
+	buf[1] = decoded->subpage_code;
+
+	if (decoded->page_code == 0x00 && decoded->subpage_code == 0x00) {
+		memcpy(buf + len, supported_pages, sizeof(supported_pages));
+		len += sizeof(supported_pages);
+	} else if (decoded->page_code == 0x00 && decoded->subpage_code == 0xFF) {
+		buf[0] |= 0x40;
+		memcpy(buf + len, supported_subpages, sizeof(supported_subpages));
+		len += sizeof(supported_subpages);
+	} else if (decoded->page_code == 0x0D && decoded->subpage_code == 0x00) {
+		const uint8_t temperature[2] = { 0, BLOCK_TEMPERATURE };
+		const uint8_t reference[2] = { 0, BLOCK_TRIP_TEMPERATURE };
+		len += block_log_param(buf + len, 0x0000, temperature, sizeof(temperature));
+		len += block_log_param(buf + len, 0x0001, reference, sizeof(reference));
+	} else if (decoded->page_code == 0x2F && decoded->subpage_code == 0x00) {
+		const uint8_t ie[3] = { 0x00, 0x00, BLOCK_TEMPERATURE };
+		len += block_log_param(buf + len, 0x0000, ie, sizeof(ie));
+	} else {
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+		return;
+	}
+
+	set_uint16(buf, 2, len - LOG_SENSE_MIN_LEN);
+	if (len > decoded->transfer_len)
+		len = decoded->transfer_len;
+	sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, buf, len);
+}
+
+static unsigned block_mode_pages(unsigned char *buf, uint8_t page_code)
+{
+	unsigned len = 0;
+
+	if (page_code == 0x08 || page_code == 0x3F) {
+		/* Caching, write cache enabled */
+		buf[len] = 0x08;
+		buf[len+1] = 0x12;
+		buf[len+2] = 0x04;
+		len += 2 + 0x12;
+	}
+	if (page_code == 0x0A || page_code == 0x3F) {
+		/* Control, all defaults */
+		buf[len] = 0x0A;
+		buf[len+1] = 0x0A;
+		len += 2 + 0x0A;
+	}
+	return len;
+}
+
+static void block_mode_sense(block_transport_t *block, scsi_cmd_t *cmd, const cdb_decoded_t *decoded)
+{
+	const bool ms6 = decoded->kind == CDB_KIND_MODE_SENSE_6;
+	const unsigned header_len = ms6 ? MODE_SENSE_6_MIN_LEN : MODE_SENSE_10_MIN_LEN;
+	const unsigned bd_len = decoded->flags & CDB_FLAG_DBD ? 0 : BLOCK_DESCRIPTOR_LENGTH;
+	unsigned char buf[128];
+	unsigned pages_len;
+	unsigned len;
+
+	memset(buf, 0, sizeof(buf));
+
+	if (decoded->subpage_code != 0 && !(decoded->page_code == 0x3F && decoded->subpage_code == 0xFF)) {
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+		return;
+	}
+	pages_len = block_mode_pages(buf + header_len + bd_len, decoded->page_code);
+	if (pages_len == 0) {
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x24, 0x00);
+		return;
+	}
+
+	if (bd_len) {
+		unsigned char *bd = buf + header_len;
+		const uint64_t num_blocks = block->config.num_blocks;
+		const uint32_t num = num_blocks > BLOCK_DESCRIPTOR_NUM_BLOCKS_OVERFLOW ? BLOCK_DESCRIPTOR_NUM_BLOCKS_OVERFLOW : num_blocks;
+		set_uint32(bd, 0, num); // Density code is zero, it overlaps the top byte
+		set_uint32(bd, 4, block->config.block_size & 0xFFFFFF);
+	}
+
+	len = header_len + bd_len + pages_len;
+	if (ms6) {
+		buf[0] = len - 1;
+		buf[3] = bd_len;
+	} else {
+		set_uint16(buf, 0, len - 2);
+		set_uint16(buf, 6, bd_len);
+	}
+
+	if (len > decoded->transfer_len)
+		len = decoded->transfer_len;
+	sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, buf, len);
+}
+
+static const scsi_latency_t *block_execute(block_transport_t *block, block_dev_t *dev, scsi_cmd_t *cmd)
+{
+	scsi_block_fault_t fault;
+	cdb_decoded_t decoded;
+	uint64_t info;
+
+	if (!cdb_decode(cmd->cdb, cmd->cdb_len, &decoded)) {
+		/* INVALID COMMAND OPERATION CODE */
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x20, 0x00);
+		return &block->config.other_latency;
+	}
+
+	if (block_fault_match(dev, &decoded, &fault, &info)) {
+		if (info != BLOCK_NO_INFO)
+			sim_cmd_respond_sense_info(cmd, fault.sense_key, fault.asc, fault.ascq, info);
+		else
+			sim_cmd_respond_sense(cmd, fault.sense_key, fault.asc, fault.ascq);
+		return &block->config.other_latency;
+	}
+
+	switch (decoded.kind) {
+		case CDB_KIND_TEST_UNIT_READY:
+			sim_cmd_respond(cmd, SCSI_STATUS_GOOD, NULL, 0, NULL, 0);
+			break;
+		case CDB_KIND_INQUIRY:
+			block_inquiry(block, dev, cmd, &decoded);
+			break;
+		case CDB_KIND_READ_CAPACITY_10:
+		case CDB_KIND_READ_CAPACITY_16:
+			block_read_capacity(block, cmd, &decoded);
+			break;
+		case CDB_KIND_READ_10:
+		case CDB_KIND_READ_16:
+			block_rw(block, dev, cmd, &decoded);
+			return &block->config.read_latency;
+		case CDB_KIND_WRITE_10:
+		case CDB_KIND_WRITE_16:
+			block_rw(block, dev, cmd, &decoded);
+			return &block->config.write_latency;
+		case CDB_KIND_LOG_SENSE:
+			block_log_sense(cmd, &decoded);
+			break;
+		case CDB_KIND_MODE_SENSE_6:
+		case CDB_KIND_MODE_SENSE_10:
+			block_mode_sense(block, cmd, &decoded);
+			break;
+		default:
+			sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x20, 0x00);
+			break;
+	}
+
+	return &block->config.other_latency;
+}
+
+static void block_on_done(void *ctx, scsi_cmd_t *cmd)
+{
+	block_transport_t *block = ctx;
+
+	if (cmd->status != SCSI_STATUS_TASK_SET_FULL)
+		block->devs[cmd->dev].in_flight--;
+}
+
+static int block_open(scsi_transport_t *t, const char *name)
+{
+	block_transport_t *block = (block_transport_t *)t;
+	block_dev_t *devs, *dev;
+	unsigned idx;
+
+	for (idx = 0; idx < block->num_devs && !block->devs[idx].closed; idx++)
+		;
+	if (idx == block->num_devs) {
+		devs = realloc(block->devs, (block->num_devs + 1) * sizeof(*devs));
+		if (!devs)
+			return -ENOMEM;
+		block->devs = devs;
+	}
+	dev = &block->devs[idx];
+	memset(dev, 0, sizeof(*dev));
+
+	strncpy(dev->serial, name, sizeof(dev->serial) - 1);
+	if (block->config.store_data) {
+		dev->data = calloc(block->config.num_blocks, block->config.block_size);
+		if (!dev->data) {
+			dev->closed = true;
+			return -ENOMEM;
+		}
+	}
+
+	if (idx == block->num_devs)
+		block->num_devs++;
+	return idx;
+}
+
+static void block_dev_free(block_dev_t *dev)
+{
+	free(dev->data);
+	free(dev->lba_faults);
+	free(dev->cmd_faults);
+	memset(dev, 0, sizeof(*dev));
+}
+
+static void block_close(scsi_transport_t *t, int dev)
+{
+	block_transport_t *block = (block_transport_t *)t;
+
+	if (dev < 0 || (unsigned)dev >= block->num_devs || block->devs[dev].closed)
+		return;
+	block_dev_free(&block->devs[dev]);
+	block->devs[dev].closed = true;
+}
+
+static int block_submit(scsi_transport_t *t, scsi_cmd_t *cmd)
+{
+	block_transport_t *block = (block_transport_t *)t;
+	const scsi_latency_t *latency;
+	block_dev_t *dev;
+
+	if (cmd->dev < 0 || (unsigned)cmd->dev >= block->num_devs || block->devs[cmd->dev].closed)
+		return -EBADF;
+	dev = &block->devs[cmd->dev];
+
+	if (block->config.queue_depth && dev->in_flight >= block->config.queue_depth) {
+		sim_cmd_respond(cmd, SCSI_STATUS_TASK_SET_FULL, NULL, 0, NULL, 0);
+		return sim_queue_push(&block->q, cmd, sim_now_ns());
+	}
+
+	dev->num_cmds++;
+	latency = block_execute(block, dev, cmd);
+	dev->in_flight++;
+	return sim_queue_push(&block->q, cmd, sim_now_ns() + sim_latency_ns(&block->q, latency));
+}
+
+static int block_poll(scsi_transport_t *t, int timeout_ms)
+{
+	block_transport_t *block = (block_transport_t *)t;
+	return sim_queue_poll(t, &block->q, timeout_ms);
+}
+
+static void block_destroy(scsi_transport_t *t)
+{
+	block_transport_t *block = (block_transport_t *)t;
+	unsigned i;
+
+	for (i = 0; i < block->num_devs; i++)
+		block_dev_free(&block->devs[i]);
+	free(block->devs);
+	sim_queue_free(&block->q);
+	free(block);
+}
+
+static const scsi_transport_ops_t block_ops = {
+	.open = block_open,
+	.submit = block_submit,
+	.poll = block_poll,
+	.close = block_close,
+	.destroy = block_destroy,
+};
+
+scsi_transport_t *scsi_transport_block_create(const scsi_block_config_t *config)
+{
+	block_transport_t *block;
+
+	if (config->num_blocks == 0 || config->block_size == 0)
+		return NULL;
+
+	block = calloc(1, sizeof(*block));
+	if (!block)
+		return NULL;
+
+	scsi_transport_init(&block->t, &block_ops);
+	sim_queue_init(&block->q, config->seed);
+	block->q.on_done = block_on_done;
+	block->q.on_done_ctx = block;
+	block->config = *config;
+	return &block->t;
+}
+
+int scsi_transport_block_inject(scsi_transport_t *t, int dev, const scsi_block_fault_t *fault)
+{
+	block_transport_t *block = (block_transport_t *)t;
+	block_fault_t **faults;
+	unsigned *num_faults;
+	block_fault_t *resized;
+	unsigned idx;
+	block_dev_t *d;
+
+	if (t->ops != &block_ops)
+		return -EINVAL;
+	if (dev < 0 || (unsigned)dev >= block->num_devs || block->devs[dev].closed)
+		return -EBADF;
+	d = &block->devs[dev];
+
+	if (fault->type == SCSI_FAULT_LBA_RANGE) {
+		if (fault->num_blocks == 0)
+			return -EINVAL;
+		faults = &d->lba_faults;
+		num_faults = &d->num_lba_faults;
+		idx = block_fault_lookup(d, fault->lba);
+		if (idx < *num_faults && (*faults)[idx].fault.lba < fault->lba + fault->num_blocks)
+			return -EEXIST;
+	} else if (fault->type == SCSI_FAULT_AFTER_CMDS) {
+		faults = &d->cmd_faults;
+		num_faults = &d->num_cmd_faults;
+		idx = *num_faults;
+	} else {
+		return -EINVAL;
+	}
+
+	resized = realloc(*faults, (*num_faults + 1) * sizeof(**faults));
+	if (!resized)
+		return -ENOMEM;
+	*faults = resized;
+	memmove(resized + idx + 1, resized + idx, (*num_faults - idx) * sizeof(*resized));
+	resized[idx].fault = *fault;
+	resized[idx].hits = 0;
+	(*num_faults)++;
+	return 0;
+}
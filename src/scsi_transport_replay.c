@@ -0,0 +1,331 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Simulated target that answers from a collect_raw_data capture, lines of msg,cdb,sense,data in hex */
+
+#include "scsi_transport_sim.h"
+#include "scsicmd.h"
+#include "hex_decode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+
+#define REPLAY_NONE 0xFFFFFFFF
+
+typedef struct replay_entry_t {
+	uint8_t cdb[SCSI_CMD_MAX_CDB_LEN];
+	uint8_t cdb_len;
+	uint8_t sense_len;
+	uint32_t data_len;
+	size_t offset; // Sense followed by data in the arena
+	uint32_t next_dup; // Next entry with the same CDB
+	uint32_t cursor; // In the first entry of a CDB, the entry to replay next
+} replay_entry_t;
+
+typedef struct replay_dev_t {
+	replay_entry_t *entries;
+	unsigned num_entries;
+	unsigned char *arena;
+	size_t arena_len;
+	uint32_t *slots; // Hash of the CDB to the first entry index + 1, zero is empty
+	uint32_t slots_mask;
+	bool closed; // The slot is free for the next open
+} replay_dev_t;
+
+typedef struct replay_transport_t {
+	scsi_transport_t t; // Must be first
+	sim_queue_t q;
+	scsi_latency_t latency;
+	replay_dev_t *devs;
+	unsigned num_devs;
+} replay_transport_t;
+
+static uint32_t replay_hash(const uint8_t *cdb, unsigned cdb_len)
+{
+	uint32_t hash = 2166136261U;
+	unsigned i;
+
+	for (i = 0; i < cdb_len; i++)
+		hash = (hash ^ cdb[i]) * 16777619U;
+	return hash;
+}
+
+static int replay_add_line(replay_dev_t *dev, const char *line, size_t line_len, unsigned *entries_size, size_t *arena_size)
+{
+	const char *end = line + line_len;
+	const char *fields[4];
+	const char *p = line;
+	replay_entry_t *entry;
+	unsigned char cdb[SCSI_CMD_MAX_CDB_LEN * 3];
+	long cdb_len, sense_len, data_len;
+	unsigned i;
+
+	while (end > line && (end[-1] == '\n' || end[-1] == '\r'))
+		end--;
+
+	/* msg,cdb,sense,data */
+	fields[0] = line;
+	for (i = 1; i < 4; i++) {
+		while (p < end && *p != ',')
+			p++;
+		if (p == end)
+			return 0;
+		fields[i] = ++p;
+	}
+
+	if ((size_t)(fields[2] - 1 - fields[1]) > sizeof(cdb) * 2)
+		return 0;
+	cdb_len = hex_decode(fields[1], fields[2] - 1 - fields[1], cdb);
+	if (cdb_len <= 0 || cdb_len > SCSI_CMD_MAX_CDB_LEN)
+		return 0;
+
+	/* Worst case size of the sense and data, the hex takes at least two characters per byte */
+	if (dev->arena_len + (end - fields[2]) / 2 + 1 > *arena_size) {
+		size_t size = *arena_size ? *arena_size : 64*1024;
+		unsigned char *arena;
+		while (dev->arena_len + (end - fields[2]) / 2 + 1 > size)
+			size *= 2;
+		arena = realloc(dev->arena, size);
+		if (!arena)
+			return -ENOMEM;
+		dev->arena = arena;
+		*arena_size = size;
+	}
+
+	sense_len = hex_decode(fields[2], fields[3] - 1 - fields[2], dev->arena + dev->arena_len);
+	if (sense_len < 0 || sense_len > SCSI_CMD_MAX_SENSE_LEN)
+		return 0;
+	data_len = hex_decode(fields[3], end - fields[3], dev->arena + dev->arena_len + sense_len);
+	if (data_len < 0)
+		return 0;
+
+	if (dev->num_entries == *entries_size) {
+		unsigned size = *entries_size ? *entries_size * 2 : 256;
+		replay_entry_t *entries = realloc(dev->entries, size * sizeof(*entries));
+		if (!entries)
+			return -ENOMEM;
+		dev->entries = entries;
+		*entries_size = size;
+	}
+
+	entry = &dev->entries[dev->num_entries++];
+	memset(entry, 0, sizeof(*entry));
+	memcpy(entry->cdb, cdb, cdb_len);
+	entry->cdb_len = cdb_len;
+	entry->sense_len = sense_len;
+	entry->data_len = data_len;
+	entry->offset = dev->arena_len;
+	entry->next_dup = REPLAY_NONE;
+	entry->cursor = dev->num_entries - 1;
+	dev->arena_len += sense_len + data_len;
+	return 1;
+}
+
+static replay_entry_t *replay_find_head(replay_dev_t *dev, const uint8_t *cdb, unsigned cdb_len)
+{
+	uint32_t slot = replay_hash(cdb, cdb_len) & dev->slots_mask;
+
+	for (; dev->slots[slot]; slot = (slot + 1) & dev->slots_mask) {
+		replay_entry_t *entry = &dev->entries[dev->slots[slot] - 1];
+		if (entry->cdb_len == cdb_len && memcmp(entry->cdb, cdb, cdb_len) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+static int replay_index(replay_dev_t *dev)
+{
+	uint32_t num_slots = 16;
+	replay_entry_t **last;
+	unsigned i;
+
+	while (num_slots < dev->num_entries * 2)
+		num_slots *= 2;
+	dev->slots = calloc(num_slots, sizeof(*dev->slots));
+	last = calloc(dev->num_entries, sizeof(*last));
+	if (!dev->slots || !last) {
+		free(last);
+		return -ENOMEM;
+	}
+	dev->slots_mask = num_slots - 1;
+
+	/* Repeated CDBs are chained in capture order behind the first one */
+	for (i = 0; i < dev->num_entries; i++) {
+		replay_entry_t *entry = &dev->entries[i];
+		replay_entry_t *head = replay_find_head(dev, entry->cdb, entry->cdb_len);
+
+		if (head) {
+			const unsigned head_idx = head - dev->entries;
+			if (last[head_idx])
+				last[head_idx]->next_dup = i;
+			else
+				head->next_dup = i;
+			last[head_idx] = entry;
+		} else {
+			uint32_t slot = replay_hash(entry->cdb, entry->cdb_len) & dev->slots_mask;
+			while (dev->slots[slot])
+				slot = (slot + 1) & dev->slots_mask;
+			dev->slots[slot] = i + 1;
+		}
+	}
+
+	free(last);
+	return 0;
+}
+
+static void replay_dev_free(replay_dev_t *dev)
+{
+	free(dev->entries);
+	free(dev->arena);
+	free(dev->slots);
+	memset(dev, 0, sizeof(*dev));
+}
+
+static int replay_load(replay_dev_t *dev, const char *name)
+{
+	unsigned entries_size = 0;
+	size_t arena_size = 0;
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t line_len;
+	int ret = 0;
+	FILE *f;
+
+	f = fopen(name, "r");
+	if (!f)
+		return -errno;
+
+	while ((line_len = getline(&line, &line_size, f)) >= 0) {
+		ret = replay_add_line(dev, line, line_len, &entries_size, &arena_size);
+		if (ret < 0)
+			break;
+		ret = 0;
+	}
+
+	free(line);
+	fclose(f);
+
+	if (ret == 0 && dev->num_entries == 0)
+		ret = -ENOENT;
+	if (ret == 0)
+		ret = replay_index(dev);
+	if (ret < 0)
+		replay_dev_free(dev);
+	return ret;
+}
+
+static int replay_open(scsi_transport_t *t, const char *name)
+{
+	replay_transport_t *replay = (replay_transport_t *)t;
+	replay_dev_t *devs;
+	unsigned idx;
+	int ret;
+
+	for (idx = 0; idx < replay->num_devs && !replay->devs[idx].closed; idx++)
+		;
+	if (idx == replay->num_devs) {
+		devs = realloc(replay->devs, (replay->num_devs + 1) * sizeof(*devs));
+		if (!devs)
+			return -ENOMEM;
+		replay->devs = devs;
+	}
+	memset(&replay->devs[idx], 0, sizeof(replay->devs[idx]));
+
+	ret = replay_load(&replay->devs[idx], name);
+	if (ret < 0) {
+		replay->devs[idx].closed = true;
+		return ret;
+	}
+	if (idx == replay->num_devs)
+		replay->num_devs++;
+	return idx;
+}
+
+static void replay_close(scsi_transport_t *t, int dev)
+{
+	replay_transport_t *replay = (replay_transport_t *)t;
+
+	if (dev < 0 || (unsigned)dev >= replay->num_devs || replay->devs[dev].closed)
+		return;
+	replay_dev_free(&replay->devs[dev]);
+	replay->devs[dev].closed = true;
+}
+
+static int replay_submit(scsi_transport_t *t, scsi_cmd_t *cmd)
+{
+	replay_transport_t *replay = (replay_transport_t *)t;
+	replay_entry_t *head, *entry;
+	replay_dev_t *dev;
+
+	if (cmd->dev < 0 || (unsigned)cmd->dev >= replay->num_devs || replay->devs[cmd->dev].closed)
+		return -EBADF;
+	dev = &replay->devs[cmd->dev];
+
+	head = replay_find_head(dev, cmd->cdb, cmd->cdb_len);
+	if (head) {
+		entry = &dev->entries[head->cursor];
+		head->cursor = entry->next_dup != REPLAY_NONE ? entry->next_dup : (uint32_t)(head - dev->entries);
+		sim_cmd_respond(cmd, entry->sense_len ? SCSI_STATUS_CHECK_CONDITION : SCSI_STATUS_GOOD,
+		                dev->arena + entry->offset, entry->sense_len,
+		                dev->arena + entry->offset + entry->sense_len, entry->data_len);
+	} else {
+		/* Not in the capture, INVALID COMMAND OPERATION CODE */
+		sim_cmd_respond_sense(cmd, SENSE_KEY_ILLEGAL_REQUEST, 0x20, 0x00);
+	}
+
+	return sim_queue_push(&replay->q, cmd, sim_now_ns() + sim_latency_ns(&replay->q, &replay->latency));
+}
+
+static int replay_poll(scsi_transport_t *t, int timeout_ms)
+{
+	replay_transport_t *replay = (replay_transport_t *)t;
+	return sim_queue_poll(t, &replay->q, timeout_ms);
+}
+
+static void replay_destroy(scsi_transport_t *t)
+{
+	replay_transport_t *replay = (replay_transport_t *)t;
+	unsigned i;
+
+	for (i = 0; i < replay->num_devs; i++)
+		replay_dev_free(&replay->devs[i]);
+	free(replay->devs);
+	sim_queue_free(&replay->q);
+	free(replay);
+}
+
+static const scsi_transport_ops_t replay_ops = {
+	.open = replay_open,
+	.submit = replay_submit,
+	.poll = replay_poll,
+	.close = replay_close,
+	.destroy = replay_destroy,
+};
+
+scsi_transport_t *scsi_transport_replay_create(const scsi_latency_t *latency, uint64_t seed)
+{
+	replay_transport_t *replay = calloc(1, sizeof(*replay));
+	if (!replay)
+		return NULL;
+
+	scsi_transport_init(&replay->t, &replay_ops);
+	sim_queue_init(&replay->q, seed);
+	if (latency)
+		replay->latency = *latency;
+	return &replay->t;
+}
@@ -0,0 +1,307 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_transport.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <scsi/sg.h>
+
+/* Missing from the glibc copy of the sg header */
+#ifndef SG_FLAG_MMAP_IO
+#define SG_FLAG_MMAP_IO 4
+#endif
+
+#define SG_POLL_EVENTS 64
+
+typedef struct sg_dev_t {
+	int fd;
+	unsigned char *map; // The reserved buffer of the fd mapped, NULL when not mapped
+	unsigned map_len;
+	bool map_busy; // A command that uses the map is in flight
+} sg_dev_t;
+
+typedef struct sg_transport_t {
+	scsi_transport_t t; // Must be first
+	int epoll_fd;
+	uint32_t next_tag;
+	unsigned reserved_size;
+	unsigned num_devs;
+	unsigned max_devs;
+	sg_dev_t *devs;
+} sg_transport_t;
+
+/* The driver keeps one reserved buffer per fd, resizing it may give less than asked when memory is short and mapping
+ * fails when the fd already has a command using it. A device without a map works as usual with the caller buffers.
+ */
+static void sg_map_reserved(sg_transport_t *sg, sg_dev_t *dev)
+{
+	int size = sg->reserved_size;
+	void *map;
+
+	if (ioctl(dev->fd, SG_SET_RESERVED_SIZE, &size) < 0 || ioctl(dev->fd, SG_GET_RESERVED_SIZE, &size) < 0 || size <= 0)
+		return;
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, 0);
+	if (map == MAP_FAILED)
+		return;
+
+	dev->map = map;
+	dev->map_len = size;
+}
+
+static int sg_open(scsi_transport_t *t, const char *name)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+	struct epoll_event ev;
+	unsigned idx;
+	int fd;
+
+	/* Reuse the slot of a closed device before taking a new one */
+	for (idx = 0; idx < sg->num_devs && sg->devs[idx].fd >= 0; idx++)
+		;
+	if (idx == sg->max_devs)
+		return -ENOSPC;
+
+	fd = open(name, O_RDWR | O_NONBLOCK);
+	if (fd < 0)
+		return -errno;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = idx;
+	if (epoll_ctl(sg->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		int err = -errno;
+		close(fd);
+		return err;
+	}
+
+	memset(&sg->devs[idx], 0, sizeof(sg->devs[idx]));
+	sg->devs[idx].fd = fd;
+	if (sg->reserved_size)
+		sg_map_reserved(sg, &sg->devs[idx]);
+	if (idx == sg->num_devs)
+		sg->num_devs++;
+	return idx;
+}
+
+static void sg_close_dev(sg_dev_t *dev)
+{
+	if (dev->map)
+		munmap(dev->map, dev->map_len);
+	dev->map = NULL;
+	close(dev->fd);
+	dev->fd = -1;
+}
+
+static int sg_submit(scsi_transport_t *t, scsi_cmd_t *cmd)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+	sg_io_hdr_t hdr;
+	sg_dev_t *dev;
+	bool use_map;
+	ssize_t ret;
+
+	if (cmd->dev < 0 || (unsigned)cmd->dev >= sg->num_devs || sg->devs[cmd->dev].fd < 0)
+		return -EBADF;
+	dev = &sg->devs[cmd->dev];
+
+	use_map = dev->map && cmd->buf == dev->map && cmd->dir != SCSI_DIR_NONE;
+	if (use_map) {
+		if (cmd->buf_len > dev->map_len)
+			return -EINVAL;
+		if (dev->map_busy)
+			return -EBUSY;
+	}
+
+	cmd->tag = sg->next_tag++;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.interface_id = 'S';
+	switch (cmd->dir) {
+		case SCSI_DIR_FROM_DEV: hdr.dxfer_direction = SG_DXFER_FROM_DEV; break;
+		case SCSI_DIR_TO_DEV: hdr.dxfer_direction = SG_DXFER_TO_DEV; break;
+		default: hdr.dxfer_direction = SG_DXFER_NONE; break;
+	}
+	hdr.cmd_len = cmd->cdb_len;
+	hdr.mx_sb_len = sizeof(cmd->sense);
+	hdr.dxfer_len = cmd->buf_len;
+	hdr.dxferp = use_map ? NULL : cmd->buf;
+	hdr.cmdp = cmd->cdb;
+	hdr.sbp = cmd->sense;
+	hdr.timeout = cmd->timeout_ms;
+	hdr.flags = SG_FLAG_LUN_INHIBIT | (use_map ? SG_FLAG_MMAP_IO : 0);
+	hdr.pack_id = cmd->tag;
+	hdr.usr_ptr = cmd;
+
+	ret = write(dev->fd, &hdr, sizeof(hdr));
+	if (ret == sizeof(hdr)) {
+		dev->map_busy |= use_map;
+		return 0;
+	}
+	if (ret >= 0)
+		return -EIO;
+	/* The sg driver reports a full command queue with EDOM */
+	if (errno == EDOM)
+		return -EAGAIN;
+	return -errno;
+}
+
+/* Read all the finished commands of a device, returns how many were read */
+static int sg_reap(sg_transport_t *sg, sg_dev_t *dev)
+{
+	int num = 0;
+
+	for (;;) {
+		sg_io_hdr_t hdr;
+		scsi_cmd_t *cmd;
+		ssize_t ret;
+
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.interface_id = 'S';
+		hdr.pack_id = -1;
+		ret = read(dev->fd, &hdr, sizeof(hdr));
+		if (ret != sizeof(hdr))
+			break;
+
+		/* The completion was consumed, dropping it would leave the command in flight forever */
+		cmd = hdr.usr_ptr;
+		if (cmd == NULL)
+			return -EIO;
+
+		if (dev->map && cmd->buf == dev->map)
+			dev->map_busy = false;
+		if ((int)cmd->tag != hdr.pack_id) {
+			cmd->error = -EIO;
+			scsi_transport_done(&sg->t, cmd);
+			num++;
+			continue;
+		}
+		cmd->status = hdr.status;
+		cmd->host_status = hdr.host_status;
+		cmd->driver_status = hdr.driver_status;
+		cmd->sense_len = hdr.sb_len_wr;
+		cmd->data_len = hdr.resid < 0 || (unsigned)hdr.resid > hdr.dxfer_len ? 0 : hdr.dxfer_len - hdr.resid;
+		scsi_transport_done(&sg->t, cmd);
+		num++;
+	}
+
+	return num;
+}
+
+static int sg_poll(scsi_transport_t *t, int timeout_ms)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+	struct epoll_event events[SG_POLL_EVENTS];
+	int num_events;
+	int num = 0;
+	int i;
+
+	if (t->in_flight == 0)
+		return 0;
+
+	num_events = epoll_wait(sg->epoll_fd, events, SG_POLL_EVENTS, timeout_ms);
+	if (num_events < 0)
+		return errno == EINTR ? 0 : -errno;
+
+	for (i = 0; i < num_events; i++) {
+		const uint32_t dev = events[i].data.u32;
+		if (dev < sg->num_devs && sg->devs[dev].fd >= 0) {
+			const int ret = sg_reap(sg, &sg->devs[dev]);
+			if (ret < 0)
+				return ret;
+			num += ret;
+		}
+	}
+
+	return num;
+}
+
+static void sg_close(scsi_transport_t *t, int dev)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+
+	if (dev < 0 || (unsigned)dev >= sg->num_devs || sg->devs[dev].fd < 0)
+		return;
+	/* Closing the fd takes it out of the epoll set */
+	sg_close_dev(&sg->devs[dev]);
+}
+
+static void sg_destroy(scsi_transport_t *t)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+	unsigned i;
+
+	for (i = 0; i < sg->num_devs; i++) {
+		if (sg->devs[i].fd >= 0)
+			sg_close_dev(&sg->devs[i]);
+	}
+	close(sg->epoll_fd);
+	free(sg->devs);
+	free(sg);
+}
+
+static unsigned char *sg_dev_buffer(scsi_transport_t *t, int dev, unsigned *len)
+{
+	sg_transport_t *sg = (sg_transport_t *)t;
+
+	if (dev < 0 || (unsigned)dev >= sg->num_devs || sg->devs[dev].map == NULL)
+		return NULL;
+	*len = sg->devs[dev].map_len;
+	return sg->devs[dev].map;
+}
+
+static const scsi_transport_ops_t sg_ops = {
+	.open = sg_open,
+	.submit = sg_submit,
+	.poll = sg_poll,
+	.close = sg_close,
+	.destroy = sg_destroy,
+	.dev_buffer = sg_dev_buffer,
+};
+
+scsi_transport_t *scsi_transport_sg_create_mmap(unsigned max_devs, unsigned reserved_size)
+{
+	sg_transport_t *sg = calloc(1, sizeof(*sg));
+	if (!sg)
+		return NULL;
+
+	sg->devs = calloc(max_devs ? max_devs : 1, sizeof(*sg->devs));
+	sg->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (!sg->devs || sg->epoll_fd < 0) {
+		if (sg->epoll_fd >= 0)
+			close(sg->epoll_fd);
+		free(sg->devs);
+		free(sg);
+		return NULL;
+	}
+
+	scsi_transport_init(&sg->t, &sg_ops);
+	sg->max_devs = max_devs;
+	sg->reserved_size = reserved_size;
+	return &sg->t;
+}
+
+scsi_transport_t *scsi_transport_sg_create(unsigned max_devs)
+{
+	return scsi_transport_sg_create_mmap(max_devs, 0);
+}
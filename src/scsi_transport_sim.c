@@ -0,0 +1,218 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "scsi_transport_sim.h"
+
+#include <stdlib.h>
+#include <memory.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+
+uint64_t sim_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void sim_queue_init(sim_queue_t *q, uint64_t seed)
+{
+	memset(q, 0, sizeof(*q));
+	q->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+void sim_queue_free(sim_queue_t *q)
+{
+	free(q->heap);
+	q->heap = NULL;
+	q->num = q->size = 0;
+}
+
+uint64_t sim_random(sim_queue_t *q, uint64_t max)
+{
+	/* xorshift64* */
+	q->rng ^= q->rng >> 12;
+	q->rng ^= q->rng << 25;
+	q->rng ^= q->rng >> 27;
+	if (max == UINT64_MAX)
+		return q->rng * 0x2545F4914F6CDD1DULL;
+	return (q->rng * 0x2545F4914F6CDD1DULL) % (max + 1);
+}
+
+uint64_t sim_latency_ns(sim_queue_t *q, const scsi_latency_t *latency)
+{
+	uint64_t ns;
+
+	if (!latency)
+		return 0;
+
+	ns = latency->latency_us * 1000ULL;
+	if (latency->jitter_us) {
+		if (latency->dist == SCSI_LATENCY_EXPONENTIAL) {
+			/* Inverse of the CDF on a uniform number in (0, 1] */
+			const double u = (sim_random(q, (1ULL << 53) - 1) + 1) / (double)(1ULL << 53);
+			ns += -log(u) * latency->jitter_us * 1000.0;
+		} else {
+			ns += sim_random(q, latency->jitter_us * 1000ULL);
+		}
+	}
+	if (latency->tail_permille && sim_random(q, 999) < latency->tail_permille)
+		ns += latency->tail_us * 1000ULL;
+	return ns;
+}
+
+int sim_queue_push(sim_queue_t *q, scsi_cmd_t *cmd, uint64_t due_ns)
+{
+	unsigned i;
+
+	if (q->num == q->size) {
+		unsigned size = q->size ? q->size * 2 : 64;
+		sim_pending_t *heap = realloc(q->heap, size * sizeof(*heap));
+		if (!heap)
+			return -ENOMEM;
+		q->heap = heap;
+		q->size = size;
+	}
+
+	for (i = q->num++; i > 0 && q->heap[(i-1)/2].due_ns > due_ns; i = (i-1)/2)
+		q->heap[i] = q->heap[(i-1)/2];
+	q->heap[i].due_ns = due_ns;
+	q->heap[i].cmd = cmd;
+	return 0;
+}
+
+static scsi_cmd_t *sim_queue_pop(sim_queue_t *q)
+{
+	scsi_cmd_t *cmd = q->heap[0].cmd;
+	sim_pending_t last = q->heap[--q->num];
+	unsigned i = 0;
+
+	for (;;) {
+		unsigned child = i*2 + 1;
+		if (child >= q->num)
+			break;
+		if (child + 1 < q->num && q->heap[child+1].due_ns < q->heap[child].due_ns)
+			child++;
+		if (last.due_ns <= q->heap[child].due_ns)
+			break;
+		q->heap[i] = q->heap[child];
+		i = child;
+	}
+	q->heap[i] = last;
+	return cmd;
+}
+
+static int sim_queue_deliver(scsi_transport_t *t, sim_queue_t *q, uint64_t now)
+{
+	int num = 0;
+
+	while (q->num > 0 && q->heap[0].due_ns <= now) {
+		scsi_cmd_t *cmd = sim_queue_pop(q);
+		if (q->on_done)
+			q->on_done(q->on_done_ctx, cmd);
+		scsi_transport_done(t, cmd);
+		num++;
+	}
+	return num;
+}
+
+int sim_queue_poll(scsi_transport_t *t, sim_queue_t *q, int timeout_ms)
+{
+	uint64_t now = sim_now_ns();
+	uint64_t wait_ns;
+	struct timespec ts;
+	int num;
+
+	num = sim_queue_deliver(t, q, now);
+	if (num > 0 || timeout_ms == 0 || q->num == 0)
+		return num;
+
+	wait_ns = q->heap[0].due_ns - now;
+	if (timeout_ms > 0 && (uint64_t)timeout_ms * 1000000ULL < wait_ns)
+		wait_ns = (uint64_t)timeout_ms * 1000000ULL;
+
+	ts.tv_sec = wait_ns / 1000000000ULL;
+	ts.tv_nsec = wait_ns % 1000000000ULL;
+	nanosleep(&ts, NULL);
+
+	return sim_queue_deliver(t, q, sim_now_ns());
+}
+
+void sim_cmd_respond(scsi_cmd_t *cmd, uint8_t status, const unsigned char *sense, unsigned sense_len,
+                     const unsigned char *data, unsigned data_len)
+{
+	cmd->status = status;
+	cmd->host_status = 0;
+	cmd->driver_status = 0;
+
+	if (sense_len > sizeof(cmd->sense))
+		sense_len = sizeof(cmd->sense);
+	if (sense_len)
+		memcpy(cmd->sense, sense, sense_len);
+	cmd->sense_len = sense_len;
+
+	if (cmd->dir != SCSI_DIR_FROM_DEV)
+		data_len = 0;
+	if (data_len > cmd->buf_len)
+		data_len = cmd->buf_len;
+	if (data_len)
+		memcpy(cmd->buf, data, data_len);
+	cmd->data_len = data_len;
+}
+
+void sim_cmd_respond_sense(scsi_cmd_t *cmd, uint8_t sense_key, uint8_t asc, uint8_t ascq)
+{
+	unsigned char sense[18];
+
+	memset(sense, 0, sizeof(sense));
+	sense[0] = 0x70;
+	sense[2] = sense_key & 0xF;
+	sense[7] = sizeof(sense) - 8;
+	sense[12] = asc;
+	sense[13] = ascq;
+	sim_cmd_respond(cmd, SCSI_STATUS_CHECK_CONDITION, sense, sizeof(sense), NULL, 0);
+}
+
+void sim_cmd_respond_sense_info(scsi_cmd_t *cmd, uint8_t sense_key, uint8_t asc, uint8_t ascq, uint64_t info)
+{
+	unsigned char sense[20];
+	unsigned i;
+
+	memset(sense, 0, sizeof(sense));
+	if (info <= 0xFFFFFFFF) {
+		sense[0] = 0x80 | 0x70;
+		sense[2] = sense_key & 0xF;
+		for (i = 0; i < 4; i++)
+			sense[3+i] = info >> (24 - 8*i);
+		sense[7] = 18 - 8;
+		sense[12] = asc;
+		sense[13] = ascq;
+		sim_cmd_respond(cmd, SCSI_STATUS_CHECK_CONDITION, sense, 18, NULL, 0);
+	} else {
+		sense[0] = 0x72;
+		sense[1] = sense_key & 0xF;
+		sense[2] = asc;
+		sense[3] = ascq;
+		sense[7] = 12;
+		sense[8] = 0x00; // Information descriptor
+		sense[9] = 0x0A;
+		sense[10] = 0x80;
+		for (i = 0; i < 8; i++)
+			sense[12+i] = info >> (56 - 8*i);
+		sim_cmd_respond(cmd, SCSI_STATUS_CHECK_CONDITION, sense, 20, NULL, 0);
+	}
+}
@@ -0,0 +1,66 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_TRANSPORT_SIM_H
+#define LIBSCSICMD_SCSI_TRANSPORT_SIM_H
+
+/* Shared parts of the simulated target backends: completion scheduling by latency and filling the response */
+
+#include "scsi_transport.h"
+
+typedef struct sim_pending_t {
+	uint64_t due_ns;
+	scsi_cmd_t *cmd;
+} sim_pending_t;
+
+/* Commands waiting for their latency to pass, a min-heap by due time */
+typedef struct sim_queue_t {
+	sim_pending_t *heap;
+	unsigned num;
+	unsigned size;
+	uint64_t rng;
+	void (*on_done)(void *ctx, scsi_cmd_t *cmd); // Optional, called as every command is completed
+	void *on_done_ctx;
+} sim_queue_t;
+
+uint64_t sim_now_ns(void);
+
+void sim_queue_init(sim_queue_t *q, uint64_t seed);
+void sim_queue_free(sim_queue_t *q);
+
+/** Uniform random number in [0, max] */
+uint64_t sim_random(sim_queue_t *q, uint64_t max);
+
+/** Sample the latency of a command in nanoseconds */
+uint64_t sim_latency_ns(sim_queue_t *q, const scsi_latency_t *latency);
+
+/** Schedule the command, with its response already filled, to complete at due_ns. Returns 0 or -ENOMEM. */
+int sim_queue_push(sim_queue_t *q, scsi_cmd_t *cmd, uint64_t due_ns);
+
+/** The poll hook of a simulated backend: completes the due commands, waiting for the next one up to timeout_ms. */
+int sim_queue_poll(scsi_transport_t *t, sim_queue_t *q, int timeout_ms);
+
+/** Fill the response part of the command, data is truncated to the command buffer */
+void sim_cmd_respond(scsi_cmd_t *cmd, uint8_t status, const unsigned char *sense, unsigned sense_len,
+                     const unsigned char *data, unsigned data_len);
+
+/** Respond with CHECK CONDITION and fixed format sense data with the given sense key, ASC and ASCQ */
+void sim_cmd_respond_sense(scsi_cmd_t *cmd, uint8_t sense_key, uint8_t asc, uint8_t ascq);
+
+/** As sim_cmd_respond_sense() with a valid information field, descriptor format is used if it needs 64 bits */
+void sim_cmd_respond_sense_info(scsi_cmd_t *cmd, uint8_t sense_key, uint8_t asc, uint8_t ascq, uint64_t info);
+
+#endif
@@ -0,0 +1,21 @@
+#include "sense_action.h"
+#include "sense_action_table.h"
+
+#define STRINGIFY(name) # name
+
+const char *sense_action_name(sense_action_e action)
+{
+#define X(name) case SENSE_ACTION_##name: return STRINGIFY(name);
+	switch (action) {
+	SENSE_ACTION_LIST
+#undef X
+	}
+
+	return "Unknown sense action";
+}
+
+sense_decision_t sense_classify(uint8_t sense_key, uint8_t asc, uint8_t ascq)
+{
+	const uint8_t row = sense_action_rows[sense_key & 0xF][asc];
+	return sense_decisions[sense_action_ids[row][ascq]];
+}
@@ -1,4 +1,5 @@
 #include "scsicmd.h"
+#include "asc_num_table.h"
 
 #include <stdio.h>
 
@@ -16,26 +17,26 @@ const char *sense_key_to_name(enum sense_key_e sense_key)
 	return "Unknown sense key";
 }
 
-const char *asc_num_to_name(uint8_t asc, uint8_t ascq)
+const char *asc_num_to_name_r(uint8_t asc, uint8_t ascq, char *buf, unsigned buf_len)
 {
-	static char msg[64];
-
-	uint16_t asc_full = asc<<8 | ascq;
+	const asc_num_row_t *row = &asc_num_rows[asc];
 
-	switch (asc_full) {
-#define SENSE_CODE_KEYED(_asc_, _fmt_)
-#define SENSE_CODE(_asc_, _ascq_, _msg_) case _asc_<<8 | _ascq_: return _msg_;
-	ASC_NUM_LIST
-#undef SENSE_CODE
-#undef SENSE_CODE_KEYED
+	if (ascq <= row->max_ascq) {
+		uint16_t name = asc_num_slots[row->first + ascq];
+		if (name != ASC_NUM_NONE)
+			return asc_num_names + name;
 	}
 
-#define SENSE_CODE_KEYED(_asc_, _fmt_) if (asc == _asc_) { snprintf(msg, sizeof(msg), _fmt_, ascq); return msg; }
-#define SENSE_CODE(_asc_, _ascq_, _msg_)
-	ASC_NUM_LIST
-#undef SENSE_CODE
-#undef SENSE_CODE_KEYED
+	if (row->keyed != ASC_NUM_NONE)
+		snprintf(buf, buf_len, asc_num_names + row->keyed, ascq);
+	else
+		snprintf(buf, buf_len, "UNKNOWN ASC/ASCQ (%02Xh/%02Xh)", asc, ascq);
+	return buf;
+}
+
+const char *asc_num_to_name(uint8_t asc, uint8_t ascq)
+{
+	static __thread char msg[ASC_NUM_NAME_MAX_LEN];
 
-	snprintf(msg, sizeof(msg), "UNKNOWN ASC/ASCQ (%02Xh/%02Xh)", asc, ascq);
-	return msg;
+	return asc_num_to_name_r(asc, ascq, msg, sizeof(msg));
 }
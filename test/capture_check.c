@@ -0,0 +1,233 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Check that the capture reader stays inside the file when the trailer or the index of a capture is corrupt. Every
+ * check writes a small capture, patches it and reads it back, run it under ASan to catch the reads out of the map.
+ */
+
+#include "scsi_capture.h"
+#include "scsicmd_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define NUM_RECORDS 4
+#define TRAILER_LEN 32
+
+static unsigned long failures;
+
+static void fail(const char *check, const char *msg)
+{
+	failures++;
+	printf("%s: %s\n", check, msg);
+}
+
+static bool write_capture(const char *filename)
+{
+	unsigned char cdb[6] = {0x12, 0, 0, 0, 0x60, 0};
+	unsigned char data[0x60];
+	scsi_capture_record_t rec;
+	scsi_capture_writer_t *w;
+	unsigned i;
+	int dev;
+
+	w = scsi_capture_writer_create(filename);
+	if (!w)
+		return false;
+	dev = scsi_capture_writer_add_dev(w, "/dev/sg0");
+
+	memset(data, 0, sizeof(data));
+	memset(&rec, 0, sizeof(rec));
+	rec.dev = dev;
+	rec.cdb = cdb;
+	rec.cdb_len = sizeof(cdb);
+	rec.data = data;
+	rec.data_len = sizeof(data);
+	for (i = 0; i < NUM_RECORDS; i++) {
+		data[0] = i;
+		if (scsi_capture_write(w, &rec) < 0)
+			break;
+	}
+
+	return scsi_capture_writer_close(w) == 0 && i == NUM_RECORDS;
+}
+
+/* Overwrite len bytes at offset with val in big endian */
+static bool patch_be(const char *filename, off_t offset, uint64_t val, unsigned len)
+{
+	unsigned char buf[8];
+	unsigned i;
+	bool ok;
+	int fd;
+
+	for (i = 0; i < len; i++)
+		buf[i] = val >> (8 * (len - 1 - i));
+
+	fd = open(filename, O_WRONLY);
+	if (fd < 0)
+		return false;
+	ok = pwrite(fd, buf, len, offset) == (ssize_t)len;
+	close(fd);
+	return ok;
+}
+
+static bool read_trailer(const char *filename, uint64_t *size, uint64_t *index_offset, uint32_t *num_index)
+{
+	unsigned char trailer[TRAILER_LEN];
+	struct stat st;
+	bool ok;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	ok = fstat(fd, &st) == 0 && st.st_size >= TRAILER_LEN &&
+	     pread(fd, trailer, sizeof(trailer), st.st_size - TRAILER_LEN) == sizeof(trailer);
+	close(fd);
+	if (!ok)
+		return false;
+
+	*size = st.st_size;
+	*index_offset = get_uint64(trailer, 16);
+	*num_index = get_uint32(trailer, 28);
+	return true;
+}
+
+/* Number of INQUIRY records read through the index and in file order, or -1 if the capture didn't open */
+static int count_records(const char *filename, bool *has_index, int *scanned)
+{
+	const scsi_capture_query_t query = { 0x12, SCSI_CAPTURE_ANY, SCSI_CAPTURE_ANY, SCSI_CAPTURE_ANY };
+	scsi_capture_record_t rec;
+	scsi_capture_iter_t it;
+	scsi_capture_t *c;
+	int num = 0;
+
+	c = scsi_capture_open(filename);
+	if (!c)
+		return -1;
+
+	*has_index = scsi_capture_has_index(c);
+	scsi_capture_iter_init(c, &it, &query);
+	while (scsi_capture_iter_next(c, &it, &rec))
+		num++;
+
+	*scanned = 0;
+	scsi_capture_iter_init(c, &it, NULL);
+	while (scsi_capture_iter_next(c, &it, &rec))
+		(*scanned)++;
+
+	scsi_capture_close(c);
+	return num;
+}
+
+static void check_intact(const char *filename)
+{
+	bool has_index;
+	int scanned;
+
+	if (count_records(filename, &has_index, &scanned) != NUM_RECORDS || !has_index || scanned != NUM_RECORDS)
+		fail("intact", "did not read all the records through the index");
+}
+
+/* An index entry with a record offset near 2^64 used to wrap the bounds check of the record */
+static void check_index_offset(const char *filename, uint64_t record_offset)
+{
+	uint64_t size, index_offset;
+	uint32_t num_index;
+	bool has_index;
+	int scanned;
+	int num;
+
+	if (!read_trailer(filename, &size, &index_offset, &num_index) || num_index != NUM_RECORDS ||
+	    !patch_be(filename, index_offset + 8, record_offset, 8)) {
+		fail("index offset", "failed to patch the capture");
+		return;
+	}
+
+	num = count_records(filename, &has_index, &scanned);
+	if (num != NUM_RECORDS - 1 || scanned != NUM_RECORDS) {
+		printf("index offset %llx: %d records through the index, %d scanned\n", (unsigned long long)record_offset,
+		       num, scanned);
+		fail("index offset", "the corrupt entry was not skipped");
+	}
+}
+
+/* A trailer whose index offset plus the index length wraps to the end of the file used to be taken as valid */
+static void check_trailer_wrap(const char *filename)
+{
+	const uint32_t bad_num_index = 0x10000000;
+	uint64_t size, index_offset;
+	uint32_t num_index;
+	bool has_index;
+	int scanned;
+
+	if (!read_trailer(filename, &size, &index_offset, &num_index)) {
+		fail("trailer wrap", "failed to read the trailer");
+		return;
+	}
+
+	index_offset = size - TRAILER_LEN - (uint64_t)bad_num_index * 16;
+	if (!patch_be(filename, size - TRAILER_LEN + 16, index_offset, 8) ||
+	    !patch_be(filename, size - TRAILER_LEN + 28, bad_num_index, 4)) {
+		fail("trailer wrap", "failed to patch the capture");
+		return;
+	}
+
+	if (count_records(filename, &has_index, &scanned) < 0 || has_index)
+		fail("trailer wrap", "the corrupt trailer was used");
+}
+
+int main(int argc, char **argv)
+{
+	const char *tmpdir = getenv("TMPDIR");
+	static const uint64_t bad_offsets[] = { 0xFFFFFFFFFFFFFFF8ULL, 0xFFFFFFFFFFFFFFE0ULL, 0x8000000000000000ULL };
+	char filename[4096];
+	unsigned i;
+	int fd;
+
+	(void)argc;
+	snprintf(filename, sizeof(filename), "%s/capture_check.XXXXXX", tmpdir ? tmpdir : "/tmp");
+	fd = mkstemp(filename);
+	if (fd < 0) {
+		fprintf(stderr, "%s: failed to create '%s': %m\n", argv[0], filename);
+		return 1;
+	}
+	close(fd);
+
+	if (!write_capture(filename)) {
+		fprintf(stderr, "%s: failed to write '%s': %m\n", argv[0], filename);
+		unlink(filename);
+		return 1;
+	}
+	check_intact(filename);
+
+	for (i = 0; i < sizeof(bad_offsets) / sizeof(bad_offsets[0]); i++) {
+		if (!write_capture(filename))
+			break;
+		check_index_offset(filename, bad_offsets[i]);
+	}
+
+	if (write_capture(filename))
+		check_trailer_wrap(filename);
+
+	unlink(filename);
+	printf("%lu failures\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Convert collect_raw_data CSV captures to the binary capture format and back, and look up records in the index.
+ *
+ *   capture_convert -w capture.bin [-n device_name] < capture.csv
+ *   capture_convert [-o opcode] [-p page] [-s subpage] [-d device] capture.bin > records.csv
+ *   capture_convert -i capture.bin
+ */
+
+#include "scsi_capture.h"
+#include "scsi_transport.h"
+#include "hex_decode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+static void hex_dump(const unsigned char *data, unsigned len)
+{
+	unsigned i;
+
+	for (i = 0; i < len; i++)
+		printf(i ? " %02x" : "%02x", data[i]);
+}
+
+/* Split "msg,cdb,sense,data" and decode the hex fields into buf, false for lines that aren't a command */
+static bool parse_line(char *line, size_t len, unsigned char *buf, scsi_capture_record_t *rec)
+{
+	char *fields[4];
+	size_t field_len[4];
+	long decoded[3];
+	char *end = line + len;
+	unsigned i;
+
+	/* Trailing empty fields may be left out */
+	for (i = 0; i < 4; i++) {
+		char *comma = line && i < 3 ? memchr(line, ',', end - line) : NULL;
+
+		fields[i] = line;
+		field_len[i] = line ? (comma ? comma : end) - line : 0;
+		line = comma ? comma + 1 : NULL;
+	}
+
+	/* The message column is only filled by collect_raw_data when the command wasn't sent */
+	if (field_len[0] != 0)
+		return false;
+
+	for (i = 0; i < 3; i++) {
+		decoded[i] = hex_decode(fields[i+1], field_len[i+1], buf);
+		if (decoded[i] < 0)
+			return false;
+		buf += decoded[i];
+	}
+
+	if (decoded[0] == 0 || decoded[0] > 255 || decoded[1] > 255 || decoded[2] > 0xFFFFFFFFL)
+		return false;
+
+	rec->cdb_len = decoded[0];
+	rec->sense_len = decoded[1];
+	rec->data_len = decoded[2];
+	rec->cdb = buf - decoded[2] - decoded[1] - decoded[0];
+	rec->sense = rec->cdb + rec->cdb_len;
+	rec->data = rec->sense + rec->sense_len;
+	return true;
+}
+
+static int csv_to_capture(const char *filename, const char *dev_name)
+{
+	scsi_capture_writer_t *w;
+	char *line = NULL;
+	size_t line_size = 0;
+	unsigned char *buf = NULL;
+	size_t buf_size = 0;
+	unsigned long records = 0, skipped = 0;
+	ssize_t len;
+	int ret = 0;
+
+	w = scsi_capture_writer_create(filename);
+	if (!w) {
+		fprintf(stderr, "Failed to create '%s': %m\n", filename);
+		return 1;
+	}
+	scsi_capture_writer_add_dev(w, dev_name);
+
+	while ((len = getline(&line, &line_size, stdin)) > 0) {
+		scsi_capture_record_t rec;
+
+		while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+			len--;
+
+		if (buf_size < (size_t)len / 2 + 1) {
+			buf_size = len / 2 + 1;
+			buf = realloc(buf, buf_size);
+			if (!buf) {
+				fprintf(stderr, "Out of memory\n");
+				ret = 1;
+				break;
+			}
+		}
+
+		memset(&rec, 0, sizeof(rec));
+		if (!parse_line(line, len, buf, &rec)) {
+			skipped++;
+			continue;
+		}
+
+		rec.status = rec.sense_len ? SCSI_STATUS_CHECK_CONDITION : SCSI_STATUS_GOOD;
+		if (scsi_capture_write(w, &rec) < 0) {
+			fprintf(stderr, "Failed to write record to '%s'\n", filename);
+			ret = 1;
+			break;
+		}
+		records++;
+	}
+
+	if (scsi_capture_writer_close(w) < 0) {
+		fprintf(stderr, "Failed to write the index of '%s'\n", filename);
+		ret = 1;
+	}
+
+	fprintf(stderr, "%lu records, %lu lines skipped\n", records, skipped);
+	free(buf);
+	free(line);
+	return ret;
+}
+
+static int capture_to_csv(const char *filename, const scsi_capture_query_t *query)
+{
+	scsi_capture_t *c = scsi_capture_open(filename);
+	scsi_capture_iter_t it;
+	scsi_capture_record_t rec;
+
+	if (!c) {
+		fprintf(stderr, "Failed to open capture '%s': %m\n", filename);
+		return 1;
+	}
+
+	printf("msg,cdb,sense,data\n");
+	scsi_capture_iter_init(c, &it, query);
+	while (scsi_capture_iter_next(c, &it, &rec)) {
+		putchar(',');
+		hex_dump(rec.cdb, rec.cdb_len);
+		putchar(',');
+		hex_dump(rec.sense, rec.sense_len);
+		putchar(',');
+		hex_dump(rec.data, rec.data_len);
+		putchar('\n');
+	}
+
+	scsi_capture_close(c);
+	return 0;
+}
+
+static int capture_info(const char *filename)
+{
+	scsi_capture_t *c = scsi_capture_open(filename);
+	scsi_capture_iter_t it;
+	scsi_capture_record_t rec;
+	unsigned long records = 0;
+	unsigned long long bytes = 0;
+	unsigned i;
+
+	if (!c) {
+		fprintf(stderr, "Failed to open capture '%s': %m\n", filename);
+		return 1;
+	}
+
+	scsi_capture_iter_init(c, &it, NULL);
+	while (scsi_capture_iter_next(c, &it, &rec)) {
+		records++;
+		bytes += rec.cdb_len + rec.sense_len + rec.data_len;
+	}
+
+	printf("Index: %s\n", scsi_capture_has_index(c) ? "yes" : "no, the capture was cut short");
+	printf("Records: %lu\n", records);
+	printf("Payload bytes: %llu\n", bytes);
+	for (i = 0; i < scsi_capture_num_devs(c); i++)
+		printf("Device %u: %s\n", i, scsi_capture_dev_name(c, i));
+
+	scsi_capture_close(c);
+	return 0;
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s -w capture.bin [-n device_name] < capture.csv\n", name);
+	fprintf(stderr, "       %s [-o opcode] [-p page] [-s subpage] [-d device] capture.bin\n", name);
+	fprintf(stderr, "       %s -i capture.bin\n", name);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	scsi_capture_query_t query = {SCSI_CAPTURE_ANY, SCSI_CAPTURE_ANY, SCSI_CAPTURE_ANY, SCSI_CAPTURE_ANY};
+	const char *write_file = NULL;
+	const char *dev_name = "stdin";
+	bool info = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "w:n:o:p:s:d:i")) != -1) {
+		switch (opt) {
+			case 'w': write_file = optarg; break;
+			case 'n': dev_name = optarg; break;
+			case 'o': query.opcode = strtol(optarg, NULL, 0); break;
+			case 'p': query.page = strtol(optarg, NULL, 0); break;
+			case 's': query.subpage = strtol(optarg, NULL, 0); break;
+			case 'd': query.dev = strtol(optarg, NULL, 0); break;
+			case 'i': info = true; break;
+			default: return usage(argv[0]);
+		}
+	}
+
+	if (write_file)
+		return optind == argc ? csv_to_capture(write_file, dev_name) : usage(argv[0]);
+	if (optind != argc - 1)
+		return usage(argv[0]);
+	if (info)
+		return capture_info(argv[optind]);
+	return capture_to_csv(argv[optind], &query);
+}
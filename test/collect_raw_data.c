@@ -23,6 +23,8 @@
 #include "parse_extended_inquiry.h"
 #include "parse_receive_diagnostics.h"
 #include "parse_log_sense.h"
+#include "scsi_capture.h"
+#include "scsi_transport.h"
 #include <stdio.h>
 #include <memory.h>
 #include <errno.h>
@@ -33,8 +35,14 @@
 #include <scsi/sg.h>
 #include <inttypes.h>
 #include <ctype.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LARGE_BUF_LEN (512*256)
 
 static bool is_ata;
+static scsi_capture_writer_t *capture;
+static int capture_dev;
 
 static void hex_dump(uint8_t *data, uint16_t len)
 {
@@ -60,10 +68,40 @@ static void emit_data_csv(uint8_t *cdb, uint8_t cdb_len, uint8_t *sense, uint8_t
 	putchar('\n');
 }
 
+static inline uint64_t timespec_ns(const struct timespec *ts)
+{
+	return ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+/* The sg header status isn't passed up by read_response_buf(), sense data means CHECK CONDITION */
+static void emit_data_capture(uint8_t *cdb, uint8_t cdb_len, uint8_t *sense, uint8_t sense_len, uint8_t *buf, unsigned buf_len,
+                              const struct timespec *start, const struct timespec *start_mono, const struct timespec *end_mono)
+{
+	scsi_capture_record_t rec = {
+		.dev = capture_dev,
+		.status = sense_len ? SCSI_STATUS_CHECK_CONDITION : SCSI_STATUS_GOOD,
+		.start_ns = timespec_ns(start),
+		.duration_us = (timespec_ns(end_mono) - timespec_ns(start_mono)) / 1000,
+		.cdb_len = cdb_len,
+		.sense_len = sense_len,
+		.data_len = buf_len,
+		.cdb = cdb,
+		.sense = sense,
+		.data = buf,
+	};
+
+	if (scsi_capture_write(capture, &rec) < 0)
+		fprintf(stderr, "Failed to write to the capture file\n");
+}
+
 static int simple_command(int fd, uint8_t *cdb, unsigned cdb_len, uint8_t *buf, unsigned buf_len)
 {
+	struct timespec start, start_mono, end_mono;
+
 	memset(buf, 0, buf_len);
 
+	clock_gettime(CLOCK_REALTIME, &start);
+	clock_gettime(CLOCK_MONOTONIC, &start_mono);
 	bool ret = submit_cmd(fd, cdb, cdb_len, buf, buf_len, buf_len ? SG_DXFER_FROM_DEV : SG_DXFER_NONE);
 	if (!ret) {
 		printf("Failed to submit command,\n");
@@ -73,8 +111,11 @@ static int simple_command(int fd, uint8_t *cdb, unsigned cdb_len, uint8_t *buf,
 	unsigned char *sense = NULL;
 	unsigned sense_len = 0;
 	ret = read_response_buf(fd, &sense, &sense_len, &buf_len);
+	clock_gettime(CLOCK_MONOTONIC, &end_mono);
 
 	emit_data_csv(cdb, cdb_len, sense, sense_len, buf, buf_len);
+	if (capture)
+		emit_data_capture(cdb, cdb_len, sense, sense_len, buf, buf_len, &start, &start_mono, &end_mono);
 
 	if (sense_len > 0) {
 		sense_info_t sense_info;
@@ -346,10 +387,22 @@ static void do_read_defect_data_10_all(int fd, uint8_t format)
 static void do_read_defect_data_12(int fd, bool plist, bool glist, uint8_t format, bool count_only)
 {
 	unsigned char cdb[32];
-	unsigned char buf[512];
-	unsigned cdb_len = cdb_read_defect_data_12(cdb, plist, glist, format, count_only ? 8 : sizeof(buf));
+	unsigned char small_buf[512];
+	unsigned char *buf = small_buf;
+	unsigned buf_len = sizeof(small_buf);
+
+	/* The whole list straight into the mapped reserved buffer, a grown list can be far larger than the stack buffer */
+	if (!count_only) {
+		unsigned char *map = map_reserved_buf(fd, LARGE_BUF_LEN);
+		if (map) {
+			buf = map;
+			buf_len = LARGE_BUF_LEN;
+		}
+	}
 
-	simple_command(fd, cdb, cdb_len, buf, sizeof(buf));
+	unsigned cdb_len = cdb_read_defect_data_12(cdb, plist, glist, format, count_only ? 8 : buf_len);
+
+	simple_command(fd, cdb, cdb_len, buf, buf_len);
 }
 
 static void do_read_defect_data_12_all(int fd, uint8_t format)
@@ -474,7 +527,8 @@ static void do_ata_smart_read_log(int fd)
 {
 	unsigned log_addr;
 	uint8_t  __attribute__((aligned(512))) buf[512];
-	uint8_t  __attribute__((aligned(512))) buf_data[512*256];
+	uint8_t *buf_data;
+	bool mapped = true;
 
 	int ret = do_ata_smart_read_log_addr(fd, buf, sizeof(buf), 0, 1);
 	if (ret < (int)sizeof(buf))
@@ -484,6 +538,14 @@ static void do_ata_smart_read_log(int fd)
 	if (buf[0] != 1 || buf[1] != 0)
 		return;
 
+	// Up to 255 pages of a log land in the mapped reserved buffer, without one fall back to a heap buffer
+	buf_data = map_reserved_buf(fd, LARGE_BUF_LEN);
+	if (buf_data == NULL) {
+		mapped = false;
+		if (posix_memalign((void **)&buf_data, 512, LARGE_BUF_LEN) != 0)
+			return;
+	}
+
 	for (log_addr = 1; log_addr < 255; log_addr++) {
 		unsigned num_pages = buf[log_addr*2];
 		if (num_pages > 0) {
@@ -492,6 +554,9 @@ static void do_ata_smart_read_log(int fd)
 			do_ata_smart_read_log_addr(fd, buf_data, 512*num_pages, log_addr, num_pages);
 		}
 	}
+
+	if (!mapped)
+		free(buf_data);
 }
 
 static void do_ata_check_power_mode(int fd)
@@ -509,6 +574,15 @@ void do_command(int fd)
 	debug = 0;
 	is_ata = false;
 
+	if (capture_file) {
+		capture = scsi_capture_writer_create(capture_file);
+		if (!capture) {
+			fprintf(stderr, "Failed to create capture file '%s': %m\n", capture_file);
+			return;
+		}
+		capture_dev = scsi_capture_writer_add_dev(capture, device_name);
+	}
+
 	printf("msg,cdb,sense,data\n");
 	do_read_capacity(fd);
 	do_simple_inquiry(fd);
@@ -528,4 +602,10 @@ void do_command(int fd)
 		do_ata_read_log_ext(fd);
 		do_ata_smart_read_log(fd);
 	}
+
+	if (capture) {
+		if (scsi_capture_writer_close(capture) < 0)
+			fprintf(stderr, "Failed to write the capture file index\n");
+		capture = NULL;
+	}
 }
@@ -0,0 +1,192 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Check that every hex_decode implementation gives the same result as the char at a time decoder of parse_scsi, on
+ * random mutations of collect_raw_data style hex or on the lines of stdin (for AFL).
+ */
+
+#include "hex_decode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#ifndef __AFL_LOOP
+/* Without AFL the input is read once */
+static unsigned loops;
+#define __AFL_LOOP(count) (loops++ == 0)
+#endif
+
+#define MAX_INPUT (64*1024)
+
+static uint64_t rng = 88172645463325252ULL;
+static unsigned long failures;
+
+static uint64_t random64(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return rng;
+}
+
+static unsigned char char2val(unsigned char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	else if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	else if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	else
+		return 0;
+}
+
+/* The parse_hex() of parse_scsi, except that it dropped a last lone digit and this fails on it */
+static long reference_decode(const char *str, size_t len, unsigned char *out)
+{
+	unsigned char ch = 0;
+	long out_len = 0;
+	bool top_char = true;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if (isspace((unsigned char)str[i])) {
+			if (!top_char)
+				return -1;
+		} else if (isxdigit((unsigned char)str[i])) {
+			if (top_char) {
+				ch = char2val(str[i]);
+				top_char = false;
+			} else {
+				out[out_len++] = (ch<<4) | char2val(str[i]);
+				top_char = true;
+			}
+		} else {
+			return -1;
+		}
+	}
+
+	return top_char ? out_len : -1;
+}
+
+static void check(const char *str, size_t len)
+{
+	static unsigned char expected[MAX_INPUT/2 + 1];
+	static unsigned char got[MAX_INPUT/2 + 1];
+	const long expected_len = reference_decode(str, len, expected);
+	hex_decode_impl_e impl;
+
+	for (impl = HEX_DECODE_SCALAR; impl <= HEX_DECODE_BEST; impl++) {
+		long got_len;
+
+		if (!hex_decode_impl_supported(impl))
+			continue;
+
+		got_len = hex_decode_impl(impl, str, len, got);
+		if (got_len != expected_len || (got_len > 0 && memcmp(got, expected, got_len) != 0)) {
+			failures++;
+			printf("%s: got %ld expected %ld for '%.*s'\n", hex_decode_impl_name(impl), got_len, expected_len, (int)len, str);
+		}
+	}
+}
+
+/* Mostly well formed "xx xx" so that the SIMD blocks run, with a few mutations that make them fall back */
+static size_t generate(char *buf)
+{
+	static const char digits[] = "0123456789abcdefABCDEF";
+	static const char spaces[] = " \t\n\r\v\f";
+	const unsigned num_bytes = random64() % 300;
+	const unsigned num_mutations = random64() % 4 == 0 ? random64() % 4 : 0;
+	const bool upper = random64() % 8 == 0;
+	size_t len = 0;
+	unsigned i;
+
+	if (random64() % 8 == 0)
+		buf[len++] = ' ';
+	for (i = 0; i < num_bytes; i++) {
+		if (i > 0)
+			buf[len++] = ' ';
+		buf[len++] = digits[random64() % (upper ? 22 : 16)];
+		buf[len++] = digits[random64() % (upper ? 22 : 16)];
+	}
+	if (random64() % 8 == 0)
+		buf[len++] = ' ';
+
+	for (i = 0; i < num_mutations && len > 0; i++) {
+		const size_t pos = random64() % len;
+
+		switch (random64() % 5) {
+			case 0: buf[pos] = random64() % 256; break;
+			case 1: buf[pos] = spaces[random64() % 6]; break;
+			case 2: buf[pos] = digits[random64() % 22]; break;
+			case 3: memmove(buf + pos, buf + pos + 1, len - pos - 1); len--; break;
+			case 4:
+				if (len < MAX_INPUT) {
+					memmove(buf + pos + 1, buf + pos, len - pos);
+					buf[pos] = spaces[random64() % 6];
+					len++;
+				}
+				break;
+		}
+	}
+
+	return len;
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-n iterations] [-s seed]\n", name);
+	fprintf(stderr, "       %s - < lines\n", name);
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	static char buf[MAX_INPUT + 1];
+	unsigned long iterations = 1000000;
+	unsigned long i;
+	hex_decode_impl_e impl;
+	int opt;
+
+	if (argc == 2 && strcmp(argv[1], "-") == 0) {
+		while (__AFL_LOOP(30000)) {
+			while (fgets(buf, sizeof(buf), stdin))
+				check(buf, strcspn(buf, "\n"));
+		}
+		return failures ? 1 : 0;
+	}
+
+	while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+		switch (opt) {
+			case 'n': iterations = strtoul(optarg, NULL, 0); break;
+			case 's': rng = strtoull(optarg, NULL, 0) | 1; break;
+			default: return usage(argv[0]);
+		}
+	}
+
+	for (impl = HEX_DECODE_SCALAR; impl < HEX_DECODE_BEST; impl++)
+		printf("%s: %s\n", hex_decode_impl_name(impl), hex_decode_impl_supported(impl) ? "checked" : "not supported");
+
+	for (i = 0; i < iterations; i++)
+		check(buf, generate(buf));
+
+	printf("%lu inputs, %lu failures\n", iterations, failures);
+	return failures ? 1 : 0;
+}
@@ -25,9 +25,20 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <scsi/sg.h>
 
+/* Missing from the glibc copy of the sg header */
+#ifndef SG_FLAG_MMAP_IO
+#define SG_FLAG_MMAP_IO 4
+#endif
+
 static unsigned char sense[128];
+static unsigned char *reserved_buf;
+const char *device_name;
+const char *capture_file;
+static unsigned reserved_len;
 
 int debug = 1;
 
@@ -50,6 +61,10 @@ bool submit_cmd(int fd, unsigned char *cdb, unsigned cdb_len, unsigned char *buf
 	hdr.sbp = sense;
 	hdr.timeout = 30*1000;
 	hdr.flags = SG_FLAG_LUN_INHIBIT;
+	if (buf && buf == reserved_buf && buf_len <= reserved_len && dxfer_dir != SG_DXFER_NONE) {
+		hdr.dxferp = NULL;
+		hdr.flags |= SG_FLAG_MMAP_IO;
+	}
 	hdr.pack_id = 0;
 	hdr.usr_ptr = 0;
 
@@ -90,6 +105,27 @@ bool read_response_buf(int fd, unsigned char **sensep, unsigned *sense_len, unsi
 	return true;
 }
 
+unsigned char *map_reserved_buf(int fd, unsigned size)
+{
+	int reserved = size;
+	void *map;
+
+	if (reserved_buf)
+		return reserved_len >= size ? reserved_buf : NULL;
+
+	if (ioctl(fd, SG_SET_RESERVED_SIZE, &reserved) < 0 || ioctl(fd, SG_GET_RESERVED_SIZE, &reserved) < 0 ||
+	    reserved < (int)size)
+		return NULL;
+
+	map = mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	reserved_buf = map;
+	reserved_len = reserved;
+	return reserved_buf;
+}
+
 static void test(const char *devname)
 {
 	int fd = open(devname, O_RDWR);
@@ -100,21 +136,27 @@ static void test(const char *devname)
 
 	do_command(fd);
 
+	if (reserved_buf) {
+		munmap(reserved_buf, reserved_len);
+		reserved_buf = NULL;
+	}
 	close(fd);
 }
 
 static int usage(char *name)
 {
 	fprintf(stderr, "Usage:\n");
-	fprintf(stderr, "\t%s disk_device\n", name);
+	fprintf(stderr, "\t%s disk_device [capture_file]\n", name);
 	return 1;
 }
 
 int main(int argc, char **argv)
 {
-	if (argc != 2 || strstr(argv[1], "/sd") != NULL)
+	if (argc < 2 || argc > 3 || strstr(argv[1], "/sd") != NULL)
 		return usage(argv[0]);
 
+	device_name = argv[1];
+	capture_file = argc == 3 ? argv[2] : NULL;
 	test(argv[1]);
 	return 0;
 }
@@ -4,10 +4,17 @@
 #include <stdio.h>
 
 extern int debug;
+extern const char *device_name;
+/** Optional second argument, the tests that record their commands write them to it. */
+extern const char *capture_file;
 
 /** Do the command that we want to test on the open disk interface. */
 void do_command(int fd);
 bool submit_cmd(int fd, unsigned char *cdb, unsigned cdb_len, unsigned char *buf, unsigned buf_len, int dxfer_dir);
+/** Map the sg reserved buffer of fd with at least size bytes, NULL if the driver can't give that much. A command
+ * submitted with the returned buffer gets its data there with SG_FLAG_MMAP_IO instead of a copy into a user buffer.
+ */
+unsigned char *map_reserved_buf(int fd, unsigned size);
 bool read_response_buf(int fd, unsigned char **sense, unsigned *sense_len, unsigned *buf_read);
 
 static inline bool read_response(int fd, unsigned char **sense, unsigned *sense_len)
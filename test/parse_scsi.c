@@ -4,7 +4,13 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
+#include "cdb_decode.h"
+#include "hex_decode.h"
 #include "parse_log_sense.h"
 #include "parse_mode_sense.h"
 #include "parse_extended_inquiry.h"
@@ -12,37 +18,28 @@
 #include "parse_receive_diagnostics.h"
 #include "scsicmd.h"
 #include "sense_dump.h"
+#include "scsi_record.h"
+
+#include <inttypes.h>
 
 #ifndef __AFL_LOOP
-#define __AFL_LOOP(count) 1
+/* Without AFL the input is read once */
+static unsigned afl_loops;
+#define __AFL_LOOP(count) (afl_loops++ == 0)
 #endif
 
-static char *csvtok_last;
-
-static void csvtok_reset(void)
-{
-	csvtok_last = NULL;
-}
-
-static char *csvtok(char *start)
-{
-	if (start)
-		csvtok_last = start;
-
-	if (!csvtok_last)
-		return NULL;
+/* Every thread writes to its own stream, stdout unless parsing a chunk of a batch */
+static __thread FILE *out;
+/* Structured output of the stream instead of the text, NULL for text */
+static __thread record_writer_t *records;
+static bool structured;
+static record_format_e structured_format;
 
-	char *ret = csvtok_last;
-	for (; *csvtok_last && *csvtok_last != ','; csvtok_last++)
-		;
-	if (*csvtok_last) {
-		*csvtok_last = 0;
-		csvtok_last++;
-	}
-	else
-		csvtok_last = NULL;
-	return ret;
-}
+/* A CSV field, not NUL terminated as the fields of a batch point into the mapped capture */
+typedef struct field_t {
+	const char *str; // NULL when the line has no such field
+	unsigned len;
+} field_t;
 
 static unsigned char char2val(unsigned char ch)
 {
@@ -60,28 +57,39 @@ static void print_hex(uint8_t *buf, unsigned buf_len)
 {
 	unsigned i;
 	for (i = 0; i < buf_len; i++) {
-		printf("%02x ", buf[i]);
+		fprintf(out, "%02x ", buf[i]);
 	}
-	printf("\n");
+	fprintf(out, "\n");
 }
 
-static unsigned char *parse_hex(char *str, int *len_out)
+static unsigned char *parse_hex(const field_t *field, int *len_out)
 {
-	char buf[64*1024];
-	const unsigned buf_size = sizeof(buf);
-	unsigned char ch;
+	const char *str = field->str;
+	const char *end = str + field->len;
+	unsigned char *buf = malloc(field->len / 2 + 1);
+	unsigned char ch = 0;
 	unsigned len = 0;
 	bool top_char = true;
 
+	long decoded;
+
 	*len_out = -1;
+	if (!buf)
+		return NULL;
+
+	/* Well formed fields take the fast decoder, the rest go char by char to report what's wrong with them */
+	decoded = hex_decode(str, field->len, buf);
+	if (decoded >= 0)
+		len = decoded;
 
-	for (; *str && len < buf_size; str++) {
-		if (isspace(*str)) {
+	for (; decoded < 0 && str < end && *str; str++) {
+		if (isspace((unsigned char)*str)) {
 			if (!top_char) {
-				printf("Leftover character\n");
+				fprintf(out, "Leftover character\n");
+				free(buf);
 				return NULL;
 			}
-		} else if (isxdigit(*str)) {
+		} else if (isxdigit((unsigned char)*str)) {
 			if (top_char) {
 				ch = char2val(*str);
 				top_char = false;
@@ -90,16 +98,20 @@ static unsigned char *parse_hex(char *str, int *len_out)
 				top_char = true;
 			}
 		} else {
-			printf("Unknown character '%c'\n", *str);
+			fprintf(out, "Unknown character '%c'\n", *str);
+			free(buf);
 			return NULL;
 		}
 	}
 
-	// For valgrind and AFL, copy the data to a malloc buffer to easily detect out of bounds accesses
-	unsigned char *out = malloc(len);
-	memcpy(out, buf, len);
+	// For valgrind and AFL, shrink the buffer to the data to easily detect out of bounds accesses
+	if (len > 0 && len < field->len / 2 + 1) {
+		unsigned char *exact = realloc(buf, len);
+		if (exact)
+			buf = exact;
+	}
 	*len_out = len;
-	return out;
+	return buf;
 }
 
 static inline const char *yes_no(bool val)
@@ -110,7 +122,7 @@ static inline const char *yes_no(bool val)
 static void unparsed_data(uint8_t *buf, unsigned buf_len, uint8_t *start, unsigned total_len)
 {
 	const unsigned len = safe_len(start, total_len, buf, buf_len);
-	printf("Unparsed data: ");
+	fprintf(out, "Unparsed data: ");
 	print_hex(buf, len);
 }
 
@@ -118,9 +130,9 @@ static void parse_log_sense_param_informational_exceptions(uint16_t param_code,
 {
 	switch (param_code) {
 		case 0:
-			printf("Information Exceptions ASC: %02X\n", param[0]);
-			printf("Information Exceptions ASCQ: %02X\n", param[1]);
-			printf("Temperature: %u\n", param[2]);
+			fprintf(out, "Information Exceptions ASC: %02X\n", param[0]);
+			fprintf(out, "Information Exceptions ASCQ: %02X\n", param[1]);
+			fprintf(out, "Temperature: %u\n", param[2]);
 			if (param_len > 3)
 				unparsed_data(param+3, param_len-3, param, param_len);
 			break;
@@ -135,10 +147,10 @@ static void parse_log_sense_param_ascii(uint8_t *param, unsigned param_len)
 	unsigned ascii_len = log_sense_param_len(param);
 	ascii_len = safe_len(param, param_len, ascii, ascii_len);
 
-	printf("ASCII (%u): '", ascii_len);
+	fprintf(out, "ASCII (%u): '", ascii_len);
 	for (; ascii_len > 0; ascii_len--, ascii++)
-		putchar(*ascii);
-	printf("'\n");
+		fputc(*ascii, out);
+	fprintf(out, "'\n");
 }
 
 static void parse_log_sense_param_counter(uint8_t *param, unsigned param_len)
@@ -148,16 +160,16 @@ static void parse_log_sense_param_counter(uint8_t *param, unsigned param_len)
 
 	switch (data_len) {
 		case 2:
-			printf("Counter 16bit: %u\n", get_uint16(data, 0));
+			fprintf(out, "Counter 16bit: %u\n", get_uint16(data, 0));
 			break;
 		case 4:
-			printf("Counter 32bit: %u\n", get_uint32(data, 0));
+			fprintf(out, "Counter 32bit: %u\n", get_uint32(data, 0));
 			break;
 		case 8:
-			printf("Counter 64bit: %lu\n", get_uint64(data, 0));
+			fprintf(out, "Counter 64bit: %lu\n", get_uint64(data, 0));
 			break;
 		default:
-			printf("Counter %d bytes\n", data_len);
+			fprintf(out, "Counter %d bytes\n", data_len);
 			unparsed_data(data, data_len, param, param_len);
 			break;
 	}
@@ -187,46 +199,146 @@ static void parse_log_sense_param(uint8_t page, uint8_t subpage, uint16_t param_
 	}
 }
 
+static void print_log_valid_u64(uint32_t valid, uint16_t param_code, const char *name, uint64_t val)
+{
+	if (valid & LOG_PARAM_BIT(param_code))
+		fprintf(out, "%s: %"PRIu64"\n", name, val);
+}
+
+static void parse_log_sense_typed(uint8_t *data, unsigned data_len)
+{
+	log_page_error_counter_t error_counter;
+	log_page_non_medium_error_t non_medium;
+	log_page_temperature_t temperature;
+	log_page_start_stop_cycle_t start_stop;
+	log_page_self_test_results_t self_test;
+	log_page_solid_state_media_t solid_state;
+	log_background_scan_medium_t medium[16];
+	log_page_background_scan_t background_scan = {.medium = medium, .max_medium = 16};
+	log_page_protocol_port_t protocol;
+	log_page_general_statistics_t stats;
+	unsigned i, j;
+
+	if (log_sense_page_error_counter(data, data_len, &error_counter)) {
+		static const char * const names[LOG_ERROR_COUNTER_NUM_PARAMS] = {
+			"Errors corrected without substantial delay", "Errors corrected with possible delays",
+			"Total rewrites or rereads", "Total errors corrected", "Total times correction algorithm processed",
+			"Total bytes processed", "Total uncorrected errors",
+		};
+		fprintf(out, "\nError Counters\n");
+		for (i = 0; i < LOG_ERROR_COUNTER_NUM_PARAMS; i++)
+			print_log_valid_u64(error_counter.valid, i, names[i], error_counter.counter[i]);
+	} else if (log_sense_page_non_medium_error(data, data_len, &non_medium)) {
+		fprintf(out, "\nNon-Medium Errors\n");
+		print_log_valid_u64(non_medium.valid, LOG_NON_MEDIUM_ERROR_COUNT, "Non-medium error count", non_medium.count);
+	} else if (log_sense_page_temperature(data, data_len, &temperature)) {
+		fprintf(out, "\nTemperature\n");
+		print_log_valid_u64(temperature.valid, LOG_TEMPERATURE_CURRENT, "Temperature", temperature.temperature);
+		print_log_valid_u64(temperature.valid, LOG_TEMPERATURE_REFERENCE, "Reference temperature", temperature.reference_temperature);
+	} else if (log_sense_page_start_stop_cycle(data, data_len, &start_stop)) {
+		fprintf(out, "\nStart-Stop Cycle Counter\n");
+		if (start_stop.valid & LOG_PARAM_BIT(LOG_START_STOP_MANUFACTURE_DATE))
+			fprintf(out, "Date of manufacture: %s week %s\n", start_stop.manufacture_year, start_stop.manufacture_week);
+		if (start_stop.valid & LOG_PARAM_BIT(LOG_START_STOP_ACCOUNTING_DATE))
+			fprintf(out, "Accounting date: %s week %s\n", start_stop.accounting_year, start_stop.accounting_week);
+		print_log_valid_u64(start_stop.valid, LOG_START_STOP_SPECIFIED_CYCLES, "Specified start-stop cycles", start_stop.specified_cycles);
+		print_log_valid_u64(start_stop.valid, LOG_START_STOP_ACCUMULATED_CYCLES, "Accumulated start-stop cycles", start_stop.accumulated_cycles);
+		print_log_valid_u64(start_stop.valid, LOG_START_STOP_SPECIFIED_LOAD_UNLOAD, "Specified load-unload cycles", start_stop.specified_load_unload);
+		print_log_valid_u64(start_stop.valid, LOG_START_STOP_ACCUMULATED_LOAD_UNLOAD, "Accumulated load-unload cycles", start_stop.accumulated_load_unload);
+	} else if (log_sense_page_self_test_results(data, data_len, &self_test)) {
+		fprintf(out, "\nSelf-Test Results\n");
+		for (i = 0; i < self_test.num_results; i++) {
+			const log_self_test_result_t *r = &self_test.results[i];
+			fprintf(out, "%u: code %u result %u number %u hours %u lba %"PRIu64" sense %X/%02X/%02X\n",
+					r->param_code, r->self_test_code, r->result, r->number, r->power_on_hours,
+					r->first_failure_lba, r->sense_key, r->asc, r->ascq);
+		}
+	} else if (log_sense_page_solid_state_media(data, data_len, &solid_state)) {
+		fprintf(out, "\nSolid State Media\n");
+		print_log_valid_u64(solid_state.valid, LOG_SOLID_STATE_PERCENTAGE_USED, "Percentage used endurance", solid_state.percentage_used);
+	} else if (log_sense_page_background_scan(data, data_len, &background_scan)) {
+		fprintf(out, "\nBackground Scan Results\n");
+		if (background_scan.valid & LOG_PARAM_BIT(LOG_BACKGROUND_SCAN_STATUS)) {
+			fprintf(out, "Power on minutes: %u\n", background_scan.power_on_minutes);
+			fprintf(out, "Status: %u\n", background_scan.status);
+			fprintf(out, "Background scans: %u\n", background_scan.num_scans);
+			fprintf(out, "Progress: %u\n", background_scan.progress);
+			fprintf(out, "Background medium scans: %u\n", background_scan.num_medium_scans);
+		}
+		for (i = 0; i < background_scan.num_medium; i++)
+			fprintf(out, "Medium scan %u: minutes %u reassign %u sense %X/%02X/%02X lba %"PRIu64"\n",
+					medium[i].param_code, medium[i].power_on_minutes, medium[i].reassign_status,
+					medium[i].sense_key, medium[i].asc, medium[i].ascq, medium[i].lba);
+		if (background_scan.medium_truncated)
+			fprintf(out, "More medium scans not shown\n");
+	} else if (log_sense_page_protocol_port(data, data_len, &protocol)) {
+		fprintf(out, "\nProtocol Specific Port\n");
+		for (i = 0; i < protocol.num_ports; i++) {
+			const log_protocol_port_t *port = &protocol.ports[i];
+			fprintf(out, "Port %u: generation %u phys %u\n", port->port_id, port->generation, port->num_phys);
+			for (j = 0; j < port->num_phys_decoded; j++) {
+				const log_protocol_phy_t *phy = &port->phys[j];
+				fprintf(out, "\tPhy %u: rate %u address %016"PRIx64" attached %016"PRIx64" invalid dword %u disparity %u loss of sync %u reset problem %u\n",
+						phy->phy_id, phy->negotiated_link_rate, phy->sas_address, phy->attached_sas_address,
+						phy->invalid_dword_count, phy->running_disparity_error_count,
+						phy->loss_of_dword_sync_count, phy->phy_reset_problem_count);
+			}
+		}
+	} else if (log_sense_page_general_statistics(data, data_len, &stats)) {
+		fprintf(out, "\nGeneral Statistics and Performance\n");
+		if (stats.valid & LOG_PARAM_BIT(LOG_GENERAL_STATISTICS_ACCESS)) {
+			fprintf(out, "Read commands: %"PRIu64"\n", stats.read_commands);
+			fprintf(out, "Write commands: %"PRIu64"\n", stats.write_commands);
+			fprintf(out, "Logical blocks received: %"PRIu64"\n", stats.blocks_received);
+			fprintf(out, "Logical blocks transmitted: %"PRIu64"\n", stats.blocks_transmitted);
+		}
+		print_log_valid_u64(stats.valid, LOG_GENERAL_STATISTICS_IDLE_TIME, "Idle time intervals", stats.idle_time_intervals);
+		if (stats.valid & LOG_PARAM_BIT(LOG_GENERAL_STATISTICS_TIME_INTERVAL))
+			fprintf(out, "Time interval: %u * 10^-%u s\n", stats.time_interval_integer, stats.time_interval_exponent);
+	}
+}
+
 static int parse_log_sense(unsigned char *data, unsigned data_len)
 {
-	printf("Log Sense\n");
+	fprintf(out, "Log Sense\n");
 	if (data_len < LOG_SENSE_MIN_LEN) {
-		printf("Insufficient data in log sense to begin parsing\n");
+		fprintf(out, "Insufficient data in log sense to begin parsing\n");
 		return 1;
 	}
-	printf("Log Sense Page Code: 0x%02x\n", log_sense_page_code(data));
-	printf("Log Sense Subpage format: %s\n", yes_no(log_sense_subpage_format(data)));
+	fprintf(out, "Log Sense Page Code: 0x%02x\n", log_sense_page_code(data));
+	fprintf(out, "Log Sense Subpage format: %s\n", yes_no(log_sense_subpage_format(data)));
 	if (log_sense_subpage_format(data))
-		printf("Log Sense Subpage: 0x%02x\n", log_sense_subpage_code(data));
-	printf("Log Sense Data Saved: %s\n", yes_no(log_sense_data_saved(data)));
-	printf("Log Sense Data Length: %u\n", log_sense_data_len(data));
+		fprintf(out, "Log Sense Subpage: 0x%02x\n", log_sense_subpage_code(data));
+	fprintf(out, "Log Sense Data Saved: %s\n", yes_no(log_sense_data_saved(data)));
+	fprintf(out, "Log Sense Data Length: %u\n", log_sense_data_len(data));
 
 	if (log_sense_page_code(data) == 0) {
 		if (!log_sense_subpage_format(data)) {
-			printf("Supported Log Pages:\n");
+			fprintf(out, "Supported Log Pages:\n");
 			uint8_t supported_page;
 			for_all_log_sense_pg_0_supported_pages(data, data_len, supported_page) {
-				printf("\t%02X\n", supported_page & 0x3F);
+				fprintf(out, "\t%02X\n", supported_page & 0x3F);
 			}
 		} else if (log_sense_subpage_code(data) == 0xFF) {
-			printf("Supported Log Subpages:\n");
+			fprintf(out, "Supported Log Subpages:\n");
 			uint8_t supported_page, supported_subpage;
 			for_all_log_sense_pg_0_supported_subpages(data, data_len, supported_page, supported_subpage) {
-				printf("\t%02X %02X\n", supported_page & 0x3F, supported_subpage);
+				fprintf(out, "\t%02X %02X\n", supported_page & 0x3F, supported_subpage);
 			}
 		} else {
-			printf("Unknown supported log page combination");
+			fprintf(out, "Unknown supported log page combination");
 			unparsed_data(log_sense_data(data), log_sense_data_len(data), data, data_len);
 		}
 	} else {
 		uint8_t *param;
 		for_all_log_sense_params(data, data_len, param) {
-			putchar('\n');
-			printf("Log Sense Param Code: 0x%04x\n", log_sense_param_code(param));
-			printf("Log Sense Param Len: %u\n", log_sense_param_len(param));
-			printf("Log Sense Param format: %u\n", log_sense_param_fmt(param));
+			fputc('\n', out);
+			fprintf(out, "Log Sense Param Code: 0x%04x\n", log_sense_param_code(param));
+			fprintf(out, "Log Sense Param Len: %u\n", log_sense_param_len(param));
+			fprintf(out, "Log Sense Param format: %u\n", log_sense_param_fmt(param));
 			parse_log_sense_param(log_sense_page_code(data), log_sense_subpage_code(data), log_sense_param_code(param), param, log_sense_param_len(param) + 4);
 		}
+		parse_log_sense_typed(data, data_len);
 	}
 
 	return 0;
@@ -238,14 +350,14 @@ static int parse_read_cap_10(unsigned char *data, unsigned data_len)
 	uint32_t block_size;
 	bool parsed = parse_read_capacity_10(data, data_len, &max_lba, &block_size);
 
-	printf("Read Capacity 10\n");
+	fprintf(out, "Read Capacity 10\n");
 	if (!parsed) {
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Max LBA: %u\n", max_lba);
-	printf("Block Size: %u\n", block_size);
+	fprintf(out, "Max LBA: %u\n", max_lba);
+	fprintf(out, "Block Size: %u\n", block_size);
 
 	if (data_len > 8)
 		unparsed_data(data+8, data_len-8, data, data_len);
@@ -259,7 +371,7 @@ static int parse_read_cap_16(unsigned char *data, unsigned data_len)
 	bool prot_enable, thin_provisioning_enabled, thin_provisioning_zero;
 	unsigned p_type, p_i_exponent, logical_blocks_per_physical_block_exponent, lowest_aligned_lba;
 
-	printf("Read Capacity 16\n");
+	fprintf(out, "Read Capacity 16\n");
 
 	bool parsed = parse_read_capacity_16(data, data_len, &max_lba, &block_size, &prot_enable,
 		&p_type, &p_i_exponent, &logical_blocks_per_physical_block_exponent,
@@ -270,33 +382,63 @@ static int parse_read_cap_16(unsigned char *data, unsigned data_len)
 		return 1;
 	}
 
-	printf("Max LBA: %lu\n", max_lba);
-	printf("Block Size: %u\n", block_size);
-	printf("Protection enabled: %s\n", yes_no(prot_enable));
-	printf("Thin Provisioning enabled: %s\n", yes_no(thin_provisioning_enabled));
-	printf("Thin Provisioning zero: %s\n", yes_no(thin_provisioning_zero));
-	printf("P Type: %u\n", p_type);
-	printf("Pi Exponent: %u\n", p_i_exponent);
-	printf("Logical blocks per physical block exponent: %u\n", logical_blocks_per_physical_block_exponent);
-	printf("Lowest aligned LBA: %u\n", lowest_aligned_lba);
+	fprintf(out, "Max LBA: %lu\n", max_lba);
+	fprintf(out, "Block Size: %u\n", block_size);
+	fprintf(out, "Protection enabled: %s\n", yes_no(prot_enable));
+	fprintf(out, "Thin Provisioning enabled: %s\n", yes_no(thin_provisioning_enabled));
+	fprintf(out, "Thin Provisioning zero: %s\n", yes_no(thin_provisioning_zero));
+	fprintf(out, "P Type: %u\n", p_type);
+	fprintf(out, "Pi Exponent: %u\n", p_i_exponent);
+	fprintf(out, "Logical blocks per physical block exponent: %u\n", logical_blocks_per_physical_block_exponent);
+	fprintf(out, "Lowest aligned LBA: %u\n", lowest_aligned_lba);
 
 	return 0;
 }
 
+static void parse_evpd_block_limits(uint8_t *data, unsigned data_len)
+{
+	const unsigned page_len = evpd_page_len(data) + EVPD_MIN_LEN;
+	const unsigned len = page_len < data_len ? page_len : data_len;
+
+	if (len < EVPD_BLOCK_LIMITS_SHORT_LEN) {
+		fprintf(out, "Not enough data for Block Limits\n");
+		unparsed_data(evpd_page_data(data), len - EVPD_MIN_LEN, data, data_len);
+		return;
+	}
+
+	fprintf(out, "Block Limits\n");
+	fprintf(out, "WSNZ: %d\n", evpd_block_limits_wsnz(data));
+	fprintf(out, "Maximum Compare and Write Length: %u\n", evpd_block_limits_max_compare_and_write_len(data));
+	fprintf(out, "Optimal Transfer Length Granularity: %u\n", evpd_block_limits_opt_transfer_length_granularity(data));
+	fprintf(out, "Maximum Transfer Length: %u\n", evpd_block_limits_max_transfer_length(data));
+	fprintf(out, "Optimal Transfer Length: %u\n", evpd_block_limits_opt_transfer_length(data));
+
+	if (len < EVPD_BLOCK_LIMITS_LEN)
+		return;
+
+	fprintf(out, "Maximum Prefetch Length: %u\n", evpd_block_limits_max_prefetch_length(data));
+	fprintf(out, "Maximum Unmap LBA Count: %u\n", evpd_block_limits_max_unmap_lba_count(data));
+	fprintf(out, "Maximum Unmap Block Descriptor Count: %u\n", evpd_block_limits_max_unmap_block_descriptor_count(data));
+	fprintf(out, "Optimal Unmap Granularity: %u\n", evpd_block_limits_opt_unmap_granularity(data));
+	if (evpd_block_limits_unmap_granularity_alignment_valid(data))
+		fprintf(out, "Unmap Granularity Alignment: %u\n", evpd_block_limits_unmap_granularity_alignment(data));
+	fprintf(out, "Maximum Write Same Length: %" PRIu64 "\n", evpd_block_limits_max_write_same_length(data));
+}
+
 static int parse_extended_inquiry_data(uint8_t *data, unsigned data_len)
 {
-	printf("Extended Inquiry\n");
+	fprintf(out, "Extended Inquiry\n");
 
 	if (data_len < EVPD_MIN_LEN) {
-		printf("Not enough data for EVPD header\n");
+		fprintf(out, "Not enough data for EVPD header\n");
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Peripheral Qualifier: %d\n", evpd_peripheral_qualifier(data));
-	printf("Peripheral Device Type: %d\n", evpd_peripheral_device_type(data));
-	printf("EVPD page code: 0x%02X\n", evpd_page_code(data));
-	printf("EVPD data len: %u\n", evpd_page_len(data));
+	fprintf(out, "Peripheral Qualifier: %d\n", evpd_peripheral_qualifier(data));
+	fprintf(out, "Peripheral Device Type: %d\n", evpd_peripheral_device_type(data));
+	fprintf(out, "EVPD page code: 0x%02X\n", evpd_page_code(data));
+	fprintf(out, "EVPD data len: %u\n", evpd_page_len(data));
 
 	if (!evpd_is_valid(data, data_len))
 		return 0;
@@ -304,10 +446,12 @@ static int parse_extended_inquiry_data(uint8_t *data, unsigned data_len)
 	uint8_t *page_data = evpd_page_data(data);
 
 	if (evpd_is_ascii_page(evpd_page_code(data))) {
-		printf("ASCII len: %u\n", evpd_ascii_len(page_data));
-		printf("ASCII string: '%*s'\n", evpd_ascii_len(page_data), evpd_ascii_data(page_data));
+		fprintf(out, "ASCII len: %u\n", evpd_ascii_len(page_data));
+		fprintf(out, "ASCII string: '%*s'\n", evpd_ascii_len(page_data), evpd_ascii_data(page_data));
 		if (evpd_ascii_post_data_len(page_data, data_len) > 0)
 			unparsed_data(evpd_ascii_post_data(page_data), evpd_ascii_post_data_len(page_data, data_len), data, data_len);
+	} else if (evpd_page_code(data) == EVPD_BLOCK_LIMITS) {
+		parse_evpd_block_limits(data, data_len);
 	} else {
 		/* TODO: parse more of the extended inquiry pages */
 		unparsed_data(page_data, evpd_page_len(data), data, data_len);
@@ -324,18 +468,18 @@ static int parse_simple_inquiry_data(uint8_t *data, unsigned data_len)
 	scsi_serial_t serial;
 	bool parsed = parse_inquiry(data, data_len, &device_type, vendor, model, rev, serial);
 
-	printf("Simple Inquiry\n");
+	fprintf(out, "Simple Inquiry\n");
 
 	if (!parsed) {
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Device Type: %d\n", device_type);
-	printf("Vendor: %s\n", vendor);
-	printf("Model: %s\n", model);
-	printf("FW Revision: %s\n", rev);
-	printf("Serial: %s\n", serial);
+	fprintf(out, "Device Type: %d\n", device_type);
+	fprintf(out, "Vendor: %s\n", vendor);
+	fprintf(out, "Model: %s\n", model);
+	fprintf(out, "FW Revision: %s\n", rev);
+	fprintf(out, "Serial: %s\n", serial);
 	return 0;
 }
 
@@ -353,48 +497,48 @@ static int parse_inquiry_data(uint8_t *cdb, unsigned cdb_len, uint8_t *data, uns
 static void parse_mode_sense_block_descriptor(uint8_t *data, unsigned data_len)
 {
 	if (data_len != BLOCK_DESCRIPTOR_LENGTH) {
-		printf("Unknown block descriptor\n");
+		fprintf(out, "Unknown block descriptor\n");
 		unparsed_data(data, data_len, data, data_len);
 		return;
 	}
 
-	printf("Density code: %u\n", block_descriptor_density_code(data));
-	printf("Num blocks: %u\n", block_descriptor_num_blocks(data));
-	printf("Block length: %u\n", block_descriptor_block_length(data));
+	fprintf(out, "Density code: %u\n", block_descriptor_density_code(data));
+	fprintf(out, "Num blocks: %u\n", block_descriptor_num_blocks(data));
+	fprintf(out, "Block length: %u\n", block_descriptor_block_length(data));
 }
 
 static void parse_mode_sense_data_page(uint8_t *data, unsigned data_len)
 {
 	bool subpage_format = mode_sense_data_subpage_format(data);
-	printf("\nPage code: 0x%02x\n", mode_sense_data_page_code(data));
+	fprintf(out, "\nPage code: 0x%02x\n", mode_sense_data_page_code(data));
 
 	if (subpage_format)
-		printf("Subpage code: 0x%02x\n", mode_sense_data_subpage_code(data));
-	printf("Page Saveable: %s\n", yes_no(mode_sense_data_parameter_saveable(data)));
+		fprintf(out, "Subpage code: 0x%02x\n", mode_sense_data_subpage_code(data));
+	fprintf(out, "Page Saveable: %s\n", yes_no(mode_sense_data_parameter_saveable(data)));
 
-	printf("Page len: %u\n", mode_sense_data_param_len(data));
+	fprintf(out, "Page len: %u\n", mode_sense_data_param_len(data));
 	/* TODO: Parse the mode sense data */
 	unparsed_data(mode_sense_data_param(data), mode_sense_data_param_len(data), data, data_len);
 }
 
 static int parse_mode_sense_10(uint8_t *data, unsigned data_len)
 {
-	printf("Mode Sense 10\n");
+	fprintf(out, "Mode Sense 10\n");
 
 	if (data_len < MODE_SENSE_10_MIN_LEN) {
-		printf("Not enough data for MODE SENSE header\n");
+		fprintf(out, "Not enough data for MODE SENSE header\n");
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Mode Sense 10 data length: %u\n", mode_sense_10_data_len(data));
-	printf("Mode Sense 10 medium type: %u\n", mode_sense_10_medium_type(data));
-	printf("Mode Sense 10 Device specific param: %u\n", mode_sense_10_device_specific_param(data));
-	printf("Mode Sense 10 Long LBA: %s\n", yes_no(mode_sense_10_long_lba(data)));
-	printf("Mode Sense 10 Block descriptor length: %u\n", mode_sense_10_block_descriptor_length(data));
+	fprintf(out, "Mode Sense 10 data length: %u\n", mode_sense_10_data_len(data));
+	fprintf(out, "Mode Sense 10 medium type: %u\n", mode_sense_10_medium_type(data));
+	fprintf(out, "Mode Sense 10 Device specific param: %u\n", mode_sense_10_device_specific_param(data));
+	fprintf(out, "Mode Sense 10 Long LBA: %s\n", yes_no(mode_sense_10_long_lba(data)));
+	fprintf(out, "Mode Sense 10 Block descriptor length: %u\n", mode_sense_10_block_descriptor_length(data));
 
 	if (data_len < mode_sense_10_expected_length(data)) {
-		printf("Not enough data to parse full data\n");
+		fprintf(out, "Not enough data to parse full data\n");
 		unparsed_data(data + MODE_SENSE_10_MIN_LEN, data_len - MODE_SENSE_10_MIN_LEN, data, data_len);
 		return 1;
 	}
@@ -407,7 +551,7 @@ static int parse_mode_sense_10(uint8_t *data, unsigned data_len)
 	unsigned remaining_len;
 	uint8_t *mode_page;
 	for_all_mode_sense_10_pages(data, data_len, mode_page, remaining_len) {
-		printf("\nRemaining len: %u\n", remaining_len);
+		fprintf(out, "\nRemaining len: %u\n", remaining_len);
 		parse_mode_sense_data_page(mode_page, remaining_len);
 	}
 	return 0;
@@ -415,27 +559,27 @@ static int parse_mode_sense_10(uint8_t *data, unsigned data_len)
 
 static int parse_mode_sense_6(uint8_t *data, unsigned data_len)
 {
-	printf("Mode Sense 6\n");
+	fprintf(out, "Mode Sense 6\n");
 
 	if (data_len < MODE_SENSE_6_MIN_LEN) {
-		printf("Not enough data for MODE SENSE 6 header\n");
+		fprintf(out, "Not enough data for MODE SENSE 6 header\n");
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Mode Sense 6 data length: %u\n", mode_sense_6_data_len(data));
-	printf("Mode Sense 6 medium type: %u\n", mode_sense_6_medium_type(data));
-	printf("Mode Sense 6 Device specific param: %u\n", mode_sense_6_device_specific_param(data));
-	printf("Mode Sense 6 Block descriptor length: %u\n", mode_sense_6_block_descriptor_length(data));
+	fprintf(out, "Mode Sense 6 data length: %u\n", mode_sense_6_data_len(data));
+	fprintf(out, "Mode Sense 6 medium type: %u\n", mode_sense_6_medium_type(data));
+	fprintf(out, "Mode Sense 6 Device specific param: %u\n", mode_sense_6_device_specific_param(data));
+	fprintf(out, "Mode Sense 6 Block descriptor length: %u\n", mode_sense_6_block_descriptor_length(data));
 
 	if (data_len < mode_sense_6_expected_length(data)) {
-		printf("Not enough data to parse full data\n");
+		fprintf(out, "Not enough data to parse full data\n");
 		unparsed_data(data + MODE_SENSE_6_MIN_LEN, data_len - MODE_SENSE_6_MIN_LEN, data, data_len);
 		return 1;
 	}
 
 	if (!mode_sense_6_is_valid_header(data, data_len)) {
-		printf("Bad data in mode sense header\n");
+		fprintf(out, "Bad data in mode sense header\n");
 		return 1;
 	}
 
@@ -447,7 +591,7 @@ static int parse_mode_sense_6(uint8_t *data, unsigned data_len)
 	unsigned remaining_len;
 	uint8_t *mode_page;
 	for_all_mode_sense_6_pages(data, data_len, mode_page, remaining_len) {
-		printf("Remaining len: %u\n", remaining_len);
+		fprintf(out, "Remaining len: %u\n", remaining_len);
 		parse_mode_sense_data_page(mode_page, remaining_len);
 	}
 	return 0;
@@ -457,32 +601,32 @@ static void read_defect_data_format(address_desc_format_e fmt, uint8_t *data, un
 {
 	const unsigned fmt_len = read_defect_data_fmt_len(fmt);
 	if (fmt_len == 0) {
-		printf("Unknown format to decode\n");
+		fprintf(out, "Unknown format to decode\n");
 		unparsed_data(data, len, data, len);
 		return;
 	}
 	for (; len > fmt_len; data += fmt_len, len -= fmt_len) {
 		switch (fmt) {
 			case ADDRESS_FORMAT_SHORT:
-				printf("\t%u\n", get_uint32(data, 0));
+				fprintf(out, "\t%u\n", get_uint32(data, 0));
 				break;
 			case ADDRESS_FORMAT_LONG:
-				printf("\t%lu\n", get_uint64(data, 0));
+				fprintf(out, "\t%lu\n", get_uint64(data, 0));
 				break;
 			case ADDRESS_FORMAT_INDEX_OFFSET:
-				printf("\tC=%u H=%u B=%u\n",
+				fprintf(out, "\tC=%u H=%u B=%u\n",
 						format_address_byte_from_index_cylinder(data),
 						format_address_byte_from_index_head(data),
 						format_address_byte_from_index_bytes(data));
 				break;
 			case ADDRESS_FORMAT_PHYSICAL:
-				printf("\tC=%u H=%u S=%u\n",
+				fprintf(out, "\tC=%u H=%u S=%u\n",
 						format_address_physical_cylinder(data),
 						format_address_physical_head(data),
 						format_address_physical_sector(data));
 				break;
 			case ADDRESS_FORMAT_VENDOR:
-				printf("\t%08x\n", get_uint32(data, 0));
+				fprintf(out, "\t%08x\n", get_uint32(data, 0));
 				break;
 			default:
 				break;
@@ -492,18 +636,18 @@ static void read_defect_data_format(address_desc_format_e fmt, uint8_t *data, un
 
 static int parse_read_defect_data_10(uint8_t *data, unsigned data_len)
 {
-	printf("Read Defect Data 10\n");
+	fprintf(out, "Read Defect Data 10\n");
 
 	if (!read_defect_data_10_hdr_is_valid(data, data_len)) {
-		printf("Header is not valid\n");
+		fprintf(out, "Header is not valid\n");
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 }
 
-	printf("Plist: %s\n", yes_no(read_defect_data_10_is_plist_valid(data)));
-	printf("Glist: %s\n", yes_no(read_defect_data_10_is_glist_valid(data)));
-	printf("Format: %s\n", read_defect_data_format_to_str(read_defect_data_10_list_format(data)));
-	printf("Len: %u\n", read_defect_data_10_len(data));
+	fprintf(out, "Plist: %s\n", yes_no(read_defect_data_10_is_plist_valid(data)));
+	fprintf(out, "Glist: %s\n", yes_no(read_defect_data_10_is_glist_valid(data)));
+	fprintf(out, "Format: %s\n", read_defect_data_format_to_str(read_defect_data_10_list_format(data)));
+	fprintf(out, "Len: %u\n", read_defect_data_10_len(data));
 
 	if (!read_defect_data_10_is_valid(data, data_len))
 		return 0;
@@ -517,18 +661,18 @@ static int parse_read_defect_data_10(uint8_t *data, unsigned data_len)
 
 static int parse_read_defect_data_12(uint8_t *data, unsigned data_len)
 {
-	printf("Read Defect Data 12\n");
+	fprintf(out, "Read Defect Data 12\n");
 
 	if (!read_defect_data_12_hdr_is_valid(data, data_len)) {
-		printf("Header is not valid\n");
+		fprintf(out, "Header is not valid\n");
 		unparsed_data(data, data_len, data, data_len);
 		return 1;
 	}
 
-	printf("Plist: %s\n", yes_no(read_defect_data_12_is_plist_valid(data)));
-	printf("Glist: %s\n", yes_no(read_defect_data_12_is_glist_valid(data)));
-	printf("Format: %s\n", read_defect_data_format_to_str(read_defect_data_12_list_format(data)));
-	printf("Len: %u\n", read_defect_data_12_len(data));
+	fprintf(out, "Plist: %s\n", yes_no(read_defect_data_12_is_plist_valid(data)));
+	fprintf(out, "Glist: %s\n", yes_no(read_defect_data_12_is_glist_valid(data)));
+	fprintf(out, "Format: %s\n", read_defect_data_format_to_str(read_defect_data_12_list_format(data)));
+	fprintf(out, "Len: %u\n", read_defect_data_12_len(data));
 
 	if (!read_defect_data_12_is_valid(data, data_len))
 		return 0;
@@ -542,9 +686,9 @@ static int parse_read_defect_data_12(uint8_t *data, unsigned data_len)
 
 static void parse_receive_diagnostic_results_pg_0(uint8_t *data, unsigned data_len)
 {
-	printf("Supported Receive Diagnostic Results pages:\n");
+	fprintf(out, "Supported Receive Diagnostic Results pages:\n");
 	for (; data_len > 0; data_len--, data++)
-		printf("\t0x%02x\n", data[0]);
+		fprintf(out, "\t0x%02x\n", data[0]);
 }
 
 static unsigned parse_enclosure_descriptor(uint8_t *data, unsigned data_len)
@@ -554,23 +698,23 @@ static unsigned parse_enclosure_descriptor(uint8_t *data, unsigned data_len)
 	if (!ses_config_enclosure_descriptor_is_valid(data, data_len))
 		return data_len;
 
-	printf("\nProcess identifier: %u\n", ses_config_enclosure_descriptor_process_identifier(data));
-	printf("Num processes: %u\n", ses_config_enclosure_descriptor_num_processes(data));
-	printf("Subenclosure identifier: %u\n", ses_config_enclosure_descriptor_subenclosure_identifier(data));
-	printf("Num Type Descriptors: %u\n", ses_config_enclosure_descriptor_num_type_descriptors(data));
-	printf("Enclosure descriptor len: %u\n", ses_config_enclosure_descriptor_len(data));
-	printf("Logical identified: %016lx\n", ses_config_enclosure_descriptor_logical_identifier(data));
+	fprintf(out, "\nProcess identifier: %u\n", ses_config_enclosure_descriptor_process_identifier(data));
+	fprintf(out, "Num processes: %u\n", ses_config_enclosure_descriptor_num_processes(data));
+	fprintf(out, "Subenclosure identifier: %u\n", ses_config_enclosure_descriptor_subenclosure_identifier(data));
+	fprintf(out, "Num Type Descriptors: %u\n", ses_config_enclosure_descriptor_num_type_descriptors(data));
+	fprintf(out, "Enclosure descriptor len: %u\n", ses_config_enclosure_descriptor_len(data));
+	fprintf(out, "Logical identified: %016lx\n", ses_config_enclosure_descriptor_logical_identifier(data));
 
 	ses_config_enclosure_descriptor_vendor_identifier(data, name, sizeof(name));
-	printf("Vendor identifier: %s\n", name);
+	fprintf(out, "Vendor identifier: %s\n", name);
 
 	ses_config_enclosure_descriptor_product_identifier(data, name, sizeof(name));
-	printf("Product identifier: %s\n", name);
+	fprintf(out, "Product identifier: %s\n", name);
 
 	ses_config_enclosure_descriptor_revision_level(data, name, sizeof(name));
-	printf("Revision level: %s\n", name);
+	fprintf(out, "Revision level: %s\n", name);
 
-	printf("Vendor info len: %u\n", ses_config_enclosure_descriptor_vendor_len(data));
+	fprintf(out, "Vendor info len: %u\n", ses_config_enclosure_descriptor_vendor_len(data));
 	if (ses_config_enclosure_descriptor_vendor_len(data) > 0)
 		unparsed_data(ses_config_enclosure_descriptor_vendor_info(data), ses_config_enclosure_descriptor_vendor_len(data), data, data_len);
 
@@ -585,10 +729,10 @@ static void parse_receive_diagnostic_results_pg_1(uint8_t *data, unsigned data_l
 	if (!ses_config_is_valid(data, data_len))
 		return;
 
-	printf("SES config page:\n");
+	fprintf(out, "SES config page:\n");
 	num_enclosures = ses_config_num_sub_enclosures(data);
-	printf("Num subenclosures: %u\n", num_enclosures);
-	printf("Generation code: %u\n", ses_config_generation(data));
+	fprintf(out, "Num subenclosures: %u\n", num_enclosures);
+	fprintf(out, "Generation code: %u\n", ses_config_generation(data));
 
 	for (; num_enclosures > 0 && parsed_len < data_len; num_enclosures--)
 		parsed_len += parse_enclosure_descriptor(ses_config_sub_enclosure(data), data_len-parsed_len);
@@ -599,16 +743,16 @@ static void parse_receive_diagnostic_results_pg_1(uint8_t *data, unsigned data_l
 
 static int parse_receive_diagnostic_results(uint8_t *data, unsigned data_len)
 {
-	printf("Receive Diagnostic Results\n");
+	fprintf(out, "Receive Diagnostic Results\n");
 
 	if (!recv_diag_is_valid(data, data_len)) {
-		printf("Data is not valid\n");
+		fprintf(out, "Data is not valid\n");
 		return 1;
 	}
 
-	printf("Page code: 0x%02X\n", recv_diag_get_page_code(data));
-	printf("Page code specific: 0x%02x\n", recv_diag_get_page_code_specific(data));
-	printf("Len: %u\n", recv_diag_get_len(data));
+	fprintf(out, "Page code: 0x%02X\n", recv_diag_get_page_code(data));
+	fprintf(out, "Page code specific: 0x%02x\n", recv_diag_get_page_code_specific(data));
+	fprintf(out, "Len: %u\n", recv_diag_get_len(data));
 
 	switch (recv_diag_get_page_code(data)) {
 		case 0:
@@ -624,19 +768,81 @@ static int parse_receive_diagnostic_results(uint8_t *data, unsigned data_len)
 	return 0;
 }
 
-static void process_data(char *cdb_src, char *sense_src, char *data_src)
+static void cdb_decode_dump(uint8_t *cdb, unsigned cdb_len)
+{
+	cdb_decoded_t decoded;
+
+	if (!cdb_decode(cdb, cdb_len, &decoded)) {
+		fprintf(out, "Command: %s (opcode 0x%02X) not decoded\n", cdb_kind_name(decoded.kind), decoded.opcode);
+		return;
+	}
+
+	fprintf(out, "Command: %s\n", cdb_kind_name(decoded.kind));
+	fprintf(out, "Flags: 0x%02X\n", decoded.flags);
+
+	switch (decoded.kind) {
+		case CDB_KIND_READ_10:
+		case CDB_KIND_WRITE_10:
+		case CDB_KIND_READ_16:
+		case CDB_KIND_WRITE_16:
+		case CDB_KIND_WRITE_SAME_16:
+			fprintf(out, "LBA: %" PRIu64 "\n", decoded.lba);
+			fprintf(out, "Transfer Length: %u\n", decoded.transfer_len);
+			break;
+		case CDB_KIND_INQUIRY:
+		case CDB_KIND_RECEIVE_DIAGNOSTICS:
+		case CDB_KIND_LOG_SENSE:
+		case CDB_KIND_MODE_SENSE_6:
+		case CDB_KIND_MODE_SENSE_10:
+			fprintf(out, "Page Code: 0x%02X\n", decoded.page_code);
+			fprintf(out, "Subpage Code: 0x%02X\n", decoded.subpage_code);
+			fprintf(out, "Page Control: %u\n", decoded.page_control);
+			fprintf(out, "Allocation Length: %u\n", decoded.transfer_len);
+			break;
+		case CDB_KIND_READ_DEFECT_DATA_10:
+		case CDB_KIND_READ_DEFECT_DATA_12:
+			fprintf(out, "Format: %u\n", decoded.format);
+			fprintf(out, "Allocation Length: %u\n", decoded.transfer_len);
+			break;
+		case CDB_KIND_ATA_PASSTHROUGH_12:
+		case CDB_KIND_ATA_PASSTHROUGH_16:
+			fprintf(out, "ATA Protocol: %u\n", decoded.ata.protocol);
+			fprintf(out, "ATA Extend: %d\n", decoded.ata.extend);
+			fprintf(out, "ATA Flags: 0x%02X\n", decoded.ata.flags_2);
+			fprintf(out, "ATA Command: 0x%02X\n", decoded.ata.command);
+			fprintf(out, "ATA Feature: 0x%04X\n", decoded.ata.feature);
+			fprintf(out, "ATA Sector Count: %u\n", decoded.ata.sector_count);
+			fprintf(out, "ATA LBA: 0x%" PRIX64 "\n", decoded.ata.lba);
+			fprintf(out, "ATA Device: 0x%02X\n", decoded.ata.device);
+			break;
+		default:
+			if (decoded.transfer_len)
+				fprintf(out, "Transfer Length: %u\n", decoded.transfer_len);
+			break;
+	}
+}
+
+static void print_field(const char *name, const field_t *field)
+{
+	if (field->str)
+		fprintf(out, "%s: %.*s\n", name, field->len, field->str);
+	else
+		fprintf(out, "%s: (null)\n", name);
+}
+
+static void process_data(const field_t *cdb_src, const field_t *sense_src, const field_t *data_src)
 {
 	unsigned char *cdb = NULL;
 	unsigned char *sense = NULL;
 	unsigned char *data = NULL;
 	int cdb_len, sense_len, data_len;
 
-	printf("CDB: %s\n", cdb_src);
-	printf("Sense: %s\n", sense_src);
-	printf("Data: %s\n", data_src);
+	print_field("CDB", cdb_src);
+	print_field("Sense", sense_src);
+	print_field("Data", data_src);
 
-	if (cdb_src == NULL || sense_src == NULL || data_src == NULL) {
-		printf("Input csv is invalid\n");
+	if (cdb_src->str == NULL || sense_src->str == NULL || data_src->str == NULL) {
+		fprintf(out, "Input csv is invalid\n");
 		return;
 	}
 
@@ -644,26 +850,27 @@ static void process_data(char *cdb_src, char *sense_src, char *data_src)
 	sense = parse_hex(sense_src, &sense_len);
 	data = parse_hex(data_src, &data_len);
 
-	printf("CDB Len: %d\n", cdb_len);
-	printf("Sense Len: %d\n", sense_len);
-	printf("Data Len: %d\n", data_len);
+	fprintf(out, "CDB Len: %d\n", cdb_len);
+	fprintf(out, "Sense Len: %d\n", sense_len);
+	fprintf(out, "Data Len: %d\n", data_len);
 
 	if (cdb_len < 0) {
-		printf("Failed to parse CDB\n");
+		fprintf(out, "Failed to parse CDB\n");
 		goto Exit;
 	}
+	cdb_decode_dump(cdb, cdb_len);
 	if (sense_len < 0) {
-		printf("Failed to parse SENSE\n");
+		fprintf(out, "Failed to parse SENSE\n");
 		goto Exit;
 	}
 	if (data_len < 0) {
-		printf("Failed to parse DATA\n");
+		fprintf(out, "Failed to parse DATA\n");
 		goto Exit;
 	}
 
 	if (sense_len > 0) {
-		printf("Sense data indicates an error, not parsing data\n");
-		sense_dump(sense, sense_len);
+		fprintf(out, "Sense data indicates an error, not parsing data\n");
+		sense_dump_file(out, sense, sense_len);
 		goto Exit;
 	}
 
@@ -678,7 +885,7 @@ static void process_data(char *cdb_src, char *sense_src, char *data_src)
 		case 0x37: parse_read_defect_data_10(data, data_len); break;
 		case 0xB7: parse_read_defect_data_12(data, data_len); break;
 		default:
-				   printf("Unsupported CDB opcode %02X\n", cdb[0]);
+				   fprintf(out, "Unsupported CDB opcode %02X\n", cdb[0]);
 				   unparsed_data(data, data_len, data, data_len);
 				   break;
 	}
@@ -689,58 +896,380 @@ Exit:
 	free(data);
 }
 
-static ssize_t read_newline(char *buf, size_t buf_sz)
+/* All three fields are decoded into one buffer, a field that is missing or isn't hex is passed on as such */
+static void process_data_record(const field_t *cdb_src, const field_t *sense_src, const field_t *data_src)
 {
-	ssize_t data_read = 0;
+	const field_t *srcs[3] = {cdb_src, sense_src, data_src};
+	uint8_t *bufs[3] = {NULL, NULL, NULL};
+	int lens[3] = {-1, -1, -1};
+	uint8_t *buf = malloc((cdb_src->len + sense_src->len + data_src->len) / 2 + 3);
+	uint8_t *pos = buf;
+	unsigned i;
+
+	if (!buf)
+		return;
 
-	while (data_read < (ssize_t)buf_sz) {
-		int ch = getchar();
-		if (ch == EOF)
+	for (i = 0; i < 3; i++) {
+		if (!srcs[i]->str)
+			continue;
+		bufs[i] = pos;
+		lens[i] = hex_decode(srcs[i]->str, srcs[i]->len, pos);
+		if (lens[i] > 0)
+			pos += lens[i];
+	}
+
+	scsi_record_command(records, bufs[0], lens[0], bufs[1], lens[1], bufs[2], lens[2]);
+	free(buf);
+}
+
+/* A capture line is msg,cdb,sense,data, the message is skipped and anything after the data is ignored.
+ * The header line is skipped as well.
+ */
+static void process_line(const char *line, unsigned len)
+{
+	const char *end = line + len;
+	field_t fields[4];
+	unsigned i;
+
+	memset(fields, 0, sizeof(fields));
+	for (i = 0; i < 4 && line; i++) {
+		const char *comma = memchr(line, ',', end - line);
+
+		fields[i].str = line;
+		fields[i].len = (comma ? comma : end) - line;
+		line = comma ? comma + 1 : NULL;
+	}
+
+	/* collect_raw_data starts its output with a msg,cdb,sense,data header */
+	if (fields[1].len == 3 && memcmp(fields[1].str, "cdb", 3) == 0)
+		return;
+
+	if (records) {
+		process_data_record(&fields[1], &fields[2], &fields[3]);
+		return;
+	}
+
+	process_data(&fields[1], &fields[2], &fields[3]);
+	fprintf(out, "=================================================================================\n");
+}
+
+/* Parse the capture on stdin the same way batch_parse_chunk does, empty lines are skipped */
+static int process_stdin(void)
+{
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t len;
+	bool empty = true;
+
+	while ((len = getline(&line, &line_size, stdin)) >= 0) {
+		if (len > 0 && line[len-1] == '\n')
+			len--;
+		if (len > 0 && line[len-1] == '\r')
+			len--;
+		if (len == 0)
+			continue;
+
+		process_line(line, len);
+		empty = false;
+	}
+	free(line);
+
+	if (ferror(stdin)) {
+		fprintf(stderr, "Failed to read the input: %m\n");
+		return 1;
+	}
+	if (empty && !records) {
+		printf("Insufficient input\n");
+		return 1;
+	}
+	return 0;
+}
+
+/* Batch mode: the capture is mapped and cut into line aligned chunks that the threads take in turn. Each chunk is
+ * parsed into its own memory stream and the main thread writes them out in the input order, a thread doesn't run
+ * more than BATCH_WINDOW chunks ahead of the output so the memory stays bounded however big the capture is.
+ */
+#define BATCH_WINDOW_PER_THREAD 4
+
+typedef struct chunk_t {
+	const char *start;
+	const char *end;
+	char *output;
+	size_t output_len;
+	bool done;
+} chunk_t;
+
+typedef struct batch_t {
+	chunk_t *chunks;
+	unsigned num_chunks;
+	unsigned next_chunk;
+	unsigned written; // Chunks already written out
+	unsigned window;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} batch_t;
+
+static void batch_parse_chunk(chunk_t *chunk)
+{
+	const char *line = chunk->start;
+
+	out = open_memstream(&chunk->output, &chunk->output_len);
+	if (!out) {
+		chunk->output = NULL;
+		chunk->output_len = 0;
+		return;
+	}
+	if (structured)
+		records = record_writer_create(structured_format, out);
+
+	while (line < chunk->end) {
+		const char *eol = memchr(line, '\n', chunk->end - line);
+		const char *next;
+
+		if (!eol)
+			eol = chunk->end;
+		next = eol + 1;
+		if (eol > line && eol[-1] == '\r')
+			eol--;
+
+		if (eol > line)
+			process_line(line, eol - line);
+		line = next;
+	}
+
+	if (records) {
+		record_writer_close(records);
+		records = NULL;
+	}
+	fclose(out);
+	out = NULL;
+}
+
+static void *batch_worker(void *arg)
+{
+	batch_t *batch = arg;
+
+	for (;;) {
+		unsigned idx;
+
+		pthread_mutex_lock(&batch->lock);
+		while (batch->next_chunk < batch->num_chunks && batch->next_chunk >= batch->written + batch->window)
+			pthread_cond_wait(&batch->cond, &batch->lock);
+		idx = batch->next_chunk;
+		if (idx < batch->num_chunks)
+			batch->next_chunk++;
+		pthread_mutex_unlock(&batch->lock);
+
+		if (idx >= batch->num_chunks)
 			break;
 
-		if (ch == '\n' || ch == '\r')
-			return data_read;
+		batch_parse_chunk(&batch->chunks[idx]);
 
-		buf[data_read++] = ch;
+		pthread_mutex_lock(&batch->lock);
+		batch->chunks[idx].done = true;
+		pthread_cond_broadcast(&batch->cond);
+		pthread_mutex_unlock(&batch->lock);
 	}
 
-	return data_read;
+	return NULL;
 }
 
-int main(int argc, char **argv)
+static int batch_run(const char *filename, unsigned num_threads, size_t chunk_size)
 {
-	char *cdb_src, *sense_src, *data_src;
+	batch_t batch;
+	pthread_t *threads;
+	struct stat st;
+	const char *map, *pos, *map_end;
+	unsigned max_chunks;
+	unsigned i;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "Failed to open '%s': %m\n", filename);
+		if (fd >= 0)
+			close(fd);
+		return 1;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return 0;
+	}
 
-	if (argc != 4 && argc != 1) {
-		printf("Usage: %s \"cdb\" \"sense\" \"data\"\n", argv[0]);
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Failed to map '%s': %m\n", filename);
+		return 1;
+	}
+	madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+	map_end = map + st.st_size;
+
+	memset(&batch, 0, sizeof(batch));
+	max_chunks = st.st_size / chunk_size + 1;
+	batch.chunks = calloc(max_chunks, sizeof(*batch.chunks));
+	threads = calloc(num_threads, sizeof(*threads));
+	if (!batch.chunks || !threads) {
+		fprintf(stderr, "Failed to allocate\n");
+		free(batch.chunks);
+		free(threads);
+		munmap((void *)map, st.st_size);
 		return 1;
 	}
 
-	if (argc == 1) {
+	for (pos = map; pos < map_end; batch.num_chunks++) {
+		const char *end = pos + chunk_size < map_end ? pos + chunk_size : map_end;
+		const char *eol = memchr(end - 1, '\n', map_end - (end - 1));
+
+		end = eol ? eol + 1 : map_end;
+		batch.chunks[batch.num_chunks].start = pos;
+		batch.chunks[batch.num_chunks].end = end;
+		pos = end;
+	}
+
+	batch.window = num_threads * BATCH_WINDOW_PER_THREAD;
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.cond, NULL);
+
+	for (i = 0; i < num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, batch_worker, &batch) != 0) {
+			fprintf(stderr, "Failed to start thread %u\n", i);
+			num_threads = i;
+			break;
+		}
+	}
+	if (num_threads == 0) {
+		/* No writer runs yet, parse everything before writing it out */
+		batch.window = batch.num_chunks;
+		batch_worker(&batch);
+	}
+
+	for (i = 0; i < batch.num_chunks; i++) {
+		chunk_t *chunk = &batch.chunks[i];
+
+		pthread_mutex_lock(&batch.lock);
+		while (!chunk->done)
+			pthread_cond_wait(&batch.cond, &batch.lock);
+		pthread_mutex_unlock(&batch.lock);
+
+		fwrite(chunk->output, 1, chunk->output_len, stdout);
+		free(chunk->output);
+
+		pthread_mutex_lock(&batch.lock);
+		batch.written++;
+		pthread_cond_broadcast(&batch.cond);
+		pthread_mutex_unlock(&batch.lock);
+	}
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&batch.lock);
+	pthread_cond_destroy(&batch.cond);
+	munmap((void *)map, st.st_size);
+	free(batch.chunks);
+	free(threads);
+	return 0;
+}
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-o json|columnar] \"cdb\" \"sense\" \"data\"\n", name);
+	fprintf(stderr, "       %s [-o json|columnar] < capture.csv\n", name);
+	fprintf(stderr, "       %s [-o json|columnar] -f capture.csv [-j threads] [-c chunk_kb]\n", name);
+	fprintf(stderr, "\n-o json writes one JSON object per line and columnar writes blocks of columns, see record_writer.h\n");
+	return 1;
+}
+
+static bool parse_format(const char *name)
+{
+	if (strcmp(name, "json") == 0)
+		structured_format = RECORD_FORMAT_JSON;
+	else if (strcmp(name, "columnar") == 0)
+		structured_format = RECORD_FORMAT_COLUMNAR;
+	else
+		return false;
+	structured = true;
+	return true;
+}
+
+static bool structured_open(void)
+{
+	if (!structured)
+		return true;
+
+	records = record_writer_create(structured_format, stdout);
+	if (!records) {
+		fprintf(stderr, "Failed to allocate\n");
+		return false;
+	}
+	return true;
+}
+
+static int structured_close(int ret)
+{
+	if (records && !record_writer_close(records)) {
+		fprintf(stderr, "Failed to write the output\n");
+		ret = 1;
+	}
+	records = NULL;
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	const char *filename = NULL;
+	unsigned num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t chunk_size = 1024*1024;
+	int opt;
+
+	out = stdout;
+
+	while ((opt = getopt(argc, argv, "+f:j:c:o:")) != -1) {
+		switch (opt) {
+			case 'f': filename = optarg; break;
+			case 'j': num_threads = strtoul(optarg, NULL, 0); break;
+			case 'c': chunk_size = strtoul(optarg, NULL, 0) * 1024; break;
+			case 'o':
+				if (!parse_format(optarg))
+					return usage(argv[0]);
+				break;
+			default: return usage(argv[0]);
+		}
+	}
+
+	if (filename) {
+		if (optind != argc || chunk_size == 0 || num_threads == 0)
+			return usage(argv[0]);
+		return batch_run(filename, num_threads, chunk_size);
+	}
+
+	if (argc - optind != 3 && argc - optind != 0)
+		return usage(argv[0]);
+
+	if (argc == optind) {
+		int ret = 0;
+
+		/* One input per iteration, the structured output is closed after each so that every input gets all of it */
 		while (__AFL_LOOP(30000)) {
-			char buf[64*1024];
-			memset(buf, 0, sizeof(buf));
-			int ret = read_newline(buf, sizeof(buf));
-			if (ret <= 0) {
-				printf("Insufficient input\n");
+			if (!structured_open())
 				return 1;
-			}
-			buf[ret] = 0;
-
-			csvtok_reset();
-			csvtok(buf);
-			cdb_src = csvtok(NULL);
-			sense_src = csvtok(NULL);
-			data_src = csvtok(NULL);
-			process_data(cdb_src, sense_src, data_src);
-			printf("=================================================================================\n");
+			ret = structured_close(process_stdin());
+			clearerr(stdin);
 		}
+		return ret;
 	} else {
-		cdb_src = argv[1];
-		sense_src = argv[2];
-		data_src = argv[3];
-		process_data(cdb_src, sense_src, data_src);
+		const field_t cdb_src = { argv[optind], strlen(argv[optind]) };
+		const field_t sense_src = { argv[optind+1], strlen(argv[optind+1]) };
+		const field_t data_src = { argv[optind+2], strlen(argv[optind+2]) };
+
+		if (!structured_open())
+			return 1;
+		if (records)
+			process_data_record(&cdb_src, &sense_src, &data_src);
+		else
+			process_data(&cdb_src, &sense_src, &data_src);
 	}
 
-	return 0;
+	return structured_close(0);
 }
@@ -0,0 +1,481 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "record_writer.h"
+
+#include <stdlib.h>
+#include <endian.h>
+
+#define RECORD_MAX_DEPTH 8
+#define RECORD_FLUSH_LEN (256*1024) // Buffered output before it is written, a columnar block is at least this much
+#define RECORD_BLOCK_MAGIC "PSCB"
+#define RECORD_BLOCK_VERSION 1
+#define RECORD_MAX_KEYS 0xFFFF
+#define RECORD_KEY_HASH_SIZE 1024 // Power of two, larger than the keys of the parsers
+
+typedef struct byte_buf_t {
+	uint8_t *data;
+	size_t len;
+	size_t size;
+} byte_buf_t;
+
+/* The keys of the columnar form are looked up by the key pointer and the parent, the keys are string literals */
+typedef struct key_slot_t {
+	const char *key;
+	int parent;
+	int id;
+} key_slot_t;
+
+typedef struct record_level_t {
+	bool first; // No value was written yet at this level, for the JSON commas
+	int path; // Columnar key of the object or list, -1 for the record itself
+	uint32_t item; // Position in the innermost list
+	uint32_t list_len; // Objects started in this list
+} record_level_t;
+
+struct record_writer_t {
+	record_format_e format;
+	FILE *f;
+	bool failed;
+	unsigned depth;
+	record_level_t levels[RECORD_MAX_DEPTH];
+
+	/* JSON */
+	byte_buf_t json;
+
+	/* Columnar */
+	uint32_t rows;
+	uint32_t num_values;
+	unsigned num_keys;
+	char **key_paths;
+	byte_buf_t col_row, col_key, col_item, col_type, col_len, col_value, heap;
+	key_slot_t key_hash[RECORD_KEY_HASH_SIZE];
+};
+
+static uint8_t *buf_reserve(record_writer_t *w, byte_buf_t *buf, size_t len)
+{
+	if (buf->len + len > buf->size) {
+		size_t size = buf->size ? buf->size : 4096;
+		uint8_t *data;
+
+		while (size < buf->len + len)
+			size *= 2;
+		data = realloc(buf->data, size);
+		if (!data) {
+			w->failed = true;
+			return NULL;
+		}
+		buf->data = data;
+		buf->size = size;
+	}
+	return buf->data + buf->len;
+}
+
+static void buf_append(record_writer_t *w, byte_buf_t *buf, const void *data, size_t len)
+{
+	uint8_t *dst = buf_reserve(w, buf, len);
+	if (dst) {
+		memcpy(dst, data, len);
+		buf->len += len;
+	}
+}
+
+static inline void buf_append_char(record_writer_t *w, byte_buf_t *buf, char ch)
+{
+	uint8_t *dst = buf_reserve(w, buf, 1);
+	if (dst) {
+		*dst = ch;
+		buf->len++;
+	}
+}
+
+static void buf_pad(record_writer_t *w, byte_buf_t *buf)
+{
+	static const uint8_t zeros[8];
+	buf_append(w, buf, zeros, (8 - buf->len % 8) % 8);
+}
+
+static void buf_free(byte_buf_t *buf)
+{
+	free(buf->data);
+	memset(buf, 0, sizeof(*buf));
+}
+
+static void write_out(record_writer_t *w, byte_buf_t *buf)
+{
+	if (buf->len && fwrite(buf->data, 1, buf->len, w->f) != buf->len)
+		w->failed = true;
+	buf->len = 0;
+}
+
+/* JSON */
+
+static void json_uint(record_writer_t *w, uint64_t val)
+{
+	char digits[20];
+	unsigned len = 0;
+
+	do {
+		digits[sizeof(digits) - ++len] = '0' + val % 10;
+		val /= 10;
+	} while (val);
+	buf_append(w, &w->json, digits + sizeof(digits) - len, len);
+}
+
+/* Bytes outside of ASCII are taken as Latin-1 so that the output is always valid UTF-8 */
+static void json_string(record_writer_t *w, const char *str, unsigned len)
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8_t *dst = buf_reserve(w, &w->json, len * 6 + 2);
+	unsigned i;
+
+	if (!dst)
+		return;
+
+	*dst++ = '"';
+	for (i = 0; i < len; i++) {
+		const uint8_t ch = str[i];
+
+		if (ch == '"' || ch == '\\') {
+			*dst++ = '\\';
+			*dst++ = ch;
+		} else if (ch < 0x20 || ch >= 0x7F) {
+			*dst++ = '\\';
+			*dst++ = 'u';
+			*dst++ = '0';
+			*dst++ = '0';
+			*dst++ = hex[ch >> 4];
+			*dst++ = hex[ch & 0xF];
+		} else {
+			*dst++ = ch;
+		}
+	}
+	*dst++ = '"';
+	w->json.len = dst - w->json.data;
+}
+
+static void json_hex(record_writer_t *w, const uint8_t *buf, unsigned len)
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8_t *dst = buf_reserve(w, &w->json, len * 2 + 2);
+	unsigned i;
+
+	if (!dst)
+		return;
+
+	*dst++ = '"';
+	for (i = 0; i < len; i++) {
+		*dst++ = hex[buf[i] >> 4];
+		*dst++ = hex[buf[i] & 0xF];
+	}
+	*dst++ = '"';
+	w->json.len = dst - w->json.data;
+}
+
+static void json_key(record_writer_t *w, const char *key)
+{
+	record_level_t *level = &w->levels[w->depth];
+
+	if (!level->first)
+		buf_append_char(w, &w->json, ',');
+	level->first = false;
+
+	if (key) {
+		json_string(w, key, strlen(key));
+		buf_append_char(w, &w->json, ':');
+	}
+}
+
+/* Columnar */
+
+static int col_key_id(record_writer_t *w, int parent, const char *key)
+{
+	unsigned slot = ((uintptr_t)key * 31 + parent) & (RECORD_KEY_HASH_SIZE - 1);
+	key_slot_t *s;
+	char **paths;
+	char *path;
+	size_t parent_len;
+
+	for (;; slot = (slot + 1) & (RECORD_KEY_HASH_SIZE - 1)) {
+		s = &w->key_hash[slot];
+		if (!s->key)
+			break;
+		if (s->key == key && s->parent == parent)
+			return s->id;
+	}
+
+	if (w->num_keys >= RECORD_MAX_KEYS || w->num_keys >= RECORD_KEY_HASH_SIZE / 2) {
+		w->failed = true;
+		return 0;
+	}
+
+	paths = realloc(w->key_paths, (w->num_keys + 1) * sizeof(*paths));
+	if (!paths) {
+		w->failed = true;
+		return 0;
+	}
+	w->key_paths = paths;
+
+	parent_len = parent >= 0 ? strlen(paths[parent]) + 1 : 0;
+	path = malloc(parent_len + strlen(key) + 1);
+	if (!path) {
+		w->failed = true;
+		return 0;
+	}
+	if (parent >= 0) {
+		memcpy(path, paths[parent], parent_len - 1);
+		path[parent_len - 1] = '.';
+	}
+	strcpy(path + parent_len, key);
+	paths[w->num_keys] = path;
+
+	s->key = key;
+	s->parent = parent;
+	s->id = w->num_keys++;
+	return s->id;
+}
+
+static void col_value(record_writer_t *w, const char *key, record_type_e type, uint32_t len, uint64_t val)
+{
+	const record_level_t *level = &w->levels[w->depth];
+	const uint32_t row = htole32(w->rows);
+	const uint16_t key_id = htole16(col_key_id(w, level->path, key));
+	const uint32_t item = htole32(level->item);
+	const uint8_t type_val = type;
+	const uint32_t len_le = htole32(len);
+	const uint64_t val_le = htole64(val);
+
+	buf_append(w, &w->col_row, &row, sizeof(row));
+	buf_append(w, &w->col_key, &key_id, sizeof(key_id));
+	buf_append(w, &w->col_item, &item, sizeof(item));
+	buf_append(w, &w->col_type, &type_val, sizeof(type_val));
+	buf_append(w, &w->col_len, &len_le, sizeof(len_le));
+	buf_append(w, &w->col_value, &val_le, sizeof(val_le));
+	w->num_values++;
+}
+
+static void col_heap_value(record_writer_t *w, const char *key, record_type_e type, const void *data, unsigned len)
+{
+	col_value(w, key, type, len, w->heap.len);
+	buf_append(w, &w->heap, data, len);
+}
+
+static void col_write_block(record_writer_t *w)
+{
+	byte_buf_t block = {NULL, 0, 0};
+	uint32_t header[5] = {
+		htole32(RECORD_BLOCK_VERSION), htole32(w->rows), htole32(w->num_values), htole32(w->num_keys),
+		htole32(w->heap.len),
+	};
+	byte_buf_t *columns[] = {&w->col_row, &w->col_key, &w->col_item, &w->col_type, &w->col_len, &w->col_value, &w->heap};
+	unsigned i;
+
+	if (w->rows == 0)
+		return;
+
+	buf_append(w, &block, RECORD_BLOCK_MAGIC, 4);
+	buf_append(w, &block, header, sizeof(header));
+	buf_pad(w, &block);
+	for (i = 0; i < w->num_keys; i++) {
+		const uint16_t len = strlen(w->key_paths[i]);
+		const uint16_t len_le = htole16(len);
+
+		buf_append(w, &block, &len_le, sizeof(len_le));
+		buf_append(w, &block, w->key_paths[i], len);
+	}
+	buf_pad(w, &block);
+	write_out(w, &block);
+	buf_free(&block);
+
+	for (i = 0; i < sizeof(columns)/sizeof(columns[0]); i++) {
+		buf_pad(w, columns[i]);
+		write_out(w, columns[i]);
+	}
+
+	/* Every block has its own keys so that it can be read alone */
+	for (i = 0; i < w->num_keys; i++)
+		free(w->key_paths[i]);
+	w->num_keys = 0;
+	memset(w->key_hash, 0, sizeof(w->key_hash));
+	w->rows = 0;
+	w->num_values = 0;
+}
+
+/* Writer */
+
+record_writer_t *record_writer_create(record_format_e format, FILE *f)
+{
+	record_writer_t *w = calloc(1, sizeof(*w));
+
+	if (!w)
+		return NULL;
+	w->format = format;
+	w->f = f;
+	return w;
+}
+
+bool record_writer_close(record_writer_t *w)
+{
+	bool ok;
+	unsigned i;
+
+	if (w->format == RECORD_FORMAT_JSON)
+		write_out(w, &w->json);
+	else
+		col_write_block(w);
+	ok = !w->failed;
+
+	for (i = 0; i < w->num_keys; i++)
+		free(w->key_paths[i]);
+	free(w->key_paths);
+	buf_free(&w->json);
+	buf_free(&w->col_row);
+	buf_free(&w->col_key);
+	buf_free(&w->col_item);
+	buf_free(&w->col_type);
+	buf_free(&w->col_len);
+	buf_free(&w->col_value);
+	buf_free(&w->heap);
+	free(w);
+	return ok;
+}
+
+void record_begin(record_writer_t *w)
+{
+	w->depth = 0;
+	w->levels[0].first = true;
+	w->levels[0].path = -1;
+	w->levels[0].item = 0;
+	if (w->format == RECORD_FORMAT_JSON)
+		buf_append_char(w, &w->json, '{');
+}
+
+void record_end(record_writer_t *w)
+{
+	if (w->format == RECORD_FORMAT_JSON) {
+		buf_append(w, &w->json, "}\n", 2);
+		if (w->json.len >= RECORD_FLUSH_LEN)
+			write_out(w, &w->json);
+	} else {
+		w->rows++;
+		if (w->col_value.len >= RECORD_FLUSH_LEN || w->heap.len >= RECORD_FLUSH_LEN)
+			col_write_block(w);
+	}
+}
+
+void record_uint(record_writer_t *w, const char *key, uint64_t val)
+{
+	if (w->format == RECORD_FORMAT_JSON) {
+		json_key(w, key);
+		json_uint(w, val);
+	} else {
+		col_value(w, key, RECORD_TYPE_UINT, 0, val);
+	}
+}
+
+void record_bool(record_writer_t *w, const char *key, bool val)
+{
+	if (w->format == RECORD_FORMAT_JSON) {
+		json_key(w, key);
+		if (val)
+			buf_append(w, &w->json, "true", 4);
+		else
+			buf_append(w, &w->json, "false", 5);
+	} else {
+		col_value(w, key, RECORD_TYPE_BOOL, 0, val);
+	}
+}
+
+void record_str(record_writer_t *w, const char *key, const char *str, unsigned len)
+{
+	if (w->format == RECORD_FORMAT_JSON) {
+		json_key(w, key);
+		json_string(w, str, len);
+	} else {
+		col_heap_value(w, key, RECORD_TYPE_STR, str, len);
+	}
+}
+
+void record_hex(record_writer_t *w, const char *key, const uint8_t *buf, unsigned len)
+{
+	if (w->format == RECORD_FORMAT_JSON) {
+		json_key(w, key);
+		json_hex(w, buf, len);
+	} else {
+		col_heap_value(w, key, RECORD_TYPE_HEX, buf, len);
+	}
+}
+
+static void record_push(record_writer_t *w, const char *key, bool list)
+{
+	record_level_t *parent = &w->levels[w->depth];
+	record_level_t *level;
+
+	if (w->depth + 1 >= RECORD_MAX_DEPTH) {
+		w->failed = true;
+		return;
+	}
+	level = &w->levels[++w->depth];
+	level->first = true;
+	level->list_len = 0;
+
+	if (key) {
+		level->path = w->format == RECORD_FORMAT_COLUMNAR ? col_key_id(w, parent->path, key) : -1;
+		level->item = parent->item;
+	} else {
+		/* An object of a list */
+		level->path = parent->path;
+		level->item = parent->list_len++;
+	}
+
+	if (w->format == RECORD_FORMAT_JSON)
+		buf_append_char(w, &w->json, list ? '[' : '{');
+}
+
+static void record_pop(record_writer_t *w, bool list)
+{
+	if (w->depth == 0) {
+		w->failed = true;
+		return;
+	}
+	w->depth--;
+	if (w->format == RECORD_FORMAT_JSON)
+		buf_append_char(w, &w->json, list ? ']' : '}');
+}
+
+void record_object_begin(record_writer_t *w, const char *key)
+{
+	if (w->format == RECORD_FORMAT_JSON)
+		json_key(w, key);
+	record_push(w, key, false);
+}
+
+void record_object_end(record_writer_t *w)
+{
+	record_pop(w, false);
+}
+
+void record_list_begin(record_writer_t *w, const char *key)
+{
+	if (w->format == RECORD_FORMAT_JSON)
+		json_key(w, key);
+	record_push(w, key, true);
+}
+
+void record_list_end(record_writer_t *w)
+{
+	record_pop(w, true);
+}
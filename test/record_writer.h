@@ -0,0 +1,77 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_RECORD_WRITER_H
+#define LIBSCSICMD_RECORD_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Buffered writer of one structured record per input row, for the machine readable output of parse_scsi.
+ *
+ * A record is a set of named values, objects and lists of objects. The JSON Lines form writes each record as one JSON
+ * object on its own line. The columnar form collects the rows into blocks, all little endian:
+ *
+ *   block:   "PSCB", u32 version, u32 number of rows, u32 number of values, u32 number of keys, u32 heap length
+ *   keys:    per key u16 length and the name, the path of the value with the object and list names joined by '.'
+ *   columns: row u32[values], key u16[values], item u32[values], type u8[values], len u32[values], value u64[values]
+ *   heap:    the bytes of the string and hex values
+ *
+ * Every section is zero padded to a multiple of 8 bytes. The row counts from the start of the block, the item is the
+ * position in the innermost list or 0, the type is a record_type_e. Numbers and bools are in the value, strings and
+ * hex values are len bytes at the value offset in the heap. The rows of the blocks are in the input order.
+ */
+
+typedef enum record_format_e {
+	RECORD_FORMAT_JSON,
+	RECORD_FORMAT_COLUMNAR,
+} record_format_e;
+
+typedef enum record_type_e {
+	RECORD_TYPE_UINT = 0,
+	RECORD_TYPE_BOOL = 1,
+	RECORD_TYPE_STR = 2,
+	RECORD_TYPE_HEX = 3,
+} record_type_e;
+
+typedef struct record_writer_t record_writer_t;
+
+/** The output goes to f as the buffer fills and on close, NULL if out of memory. */
+record_writer_t *record_writer_create(record_format_e format, FILE *f);
+/** Write what's left and free the writer, returns false if a write failed. */
+bool record_writer_close(record_writer_t *w);
+
+void record_begin(record_writer_t *w);
+void record_end(record_writer_t *w);
+
+/* The key is NULL only for the objects of a list. Keys are expected to be string literals. */
+void record_uint(record_writer_t *w, const char *key, uint64_t val);
+void record_bool(record_writer_t *w, const char *key, bool val);
+void record_str(record_writer_t *w, const char *key, const char *str, unsigned len);
+void record_hex(record_writer_t *w, const char *key, const uint8_t *buf, unsigned len);
+void record_object_begin(record_writer_t *w, const char *key);
+void record_object_end(record_writer_t *w);
+void record_list_begin(record_writer_t *w, const char *key);
+void record_list_end(record_writer_t *w);
+
+static inline void record_cstr(record_writer_t *w, const char *key, const char *str)
+{
+	record_str(w, key, str, strlen(str));
+}
+
+#endif
@@ -0,0 +1,151 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Probe all the devices at once, print a summary per device and with -c the raw commands in the collect_raw_data
+ * format, each device in its own block preceded by a line with its name. -p adds the command stats in the Prometheus
+ * text format at the end.
+ */
+
+#include "scsi_probe.h"
+#include "scsi_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#define FLEET_DEVS_PER_THREAD 64
+
+static unsigned num_devs;
+
+/* A worker closes every device it is done with, its transport needs room only for the ones it probes together */
+static scsi_transport_t *sg_create(void *ctx)
+{
+	const scsi_probe_config_t *config = ctx;
+	return scsi_transport_sg_create(config->max_devs_per_thread);
+}
+
+static void hex_dump(const uint8_t *data, unsigned len)
+{
+	unsigned i;
+
+	for (i = 0; i < len; i++)
+		printf(i ? " %02x" : "%02x", data[i]);
+}
+
+static void print_snapshot(const scsi_probe_snapshot_t *snap, bool csv)
+{
+	unsigned i;
+
+	if (snap->error) {
+		printf("%s: probe failed: %s\n", snap->name, strerror(-snap->error));
+		return;
+	}
+
+	printf("%s:", snap->name);
+	if (snap->inquiry_valid)
+		printf(" type %d vendor '%s' model '%s' revision '%s' serial '%s'%s", snap->device_type, snap->vendor, snap->model,
+		       snap->rev, snap->serial, snap->is_ata ? " ATA" : "");
+	if (snap->capacity_valid)
+		printf(" max lba %" PRIu64 " block size %u", snap->max_lba, snap->block_size);
+	if (snap->ie_valid)
+		printf(" ie %02X/%02X temperature %u", snap->ie_asc, snap->ie_ascq, snap->temperature);
+	if (snap->grown_defects_valid)
+		printf(" grown defects %u", snap->grown_defects);
+	printf(" commands %u\n", snap->num_responses);
+
+	if (!csv)
+		return;
+
+	printf("msg,cdb,sense,data\n");
+	for (i = 0; i < snap->num_responses; i++) {
+		const scsi_probe_response_t *resp = &snap->responses[i];
+		putchar(',');
+		hex_dump(resp->cdb, resp->cdb_len);
+		putchar(',');
+		hex_dump(resp->sense, resp->sense_len);
+		putchar(',');
+		hex_dump(resp->data, resp->data_len);
+		putchar('\n');
+	}
+}
+
+int main(int argc, char **argv)
+{
+	scsi_probe_config_t config;
+	scsi_probe_snapshot_t *snapshots;
+	bool csv = false;
+	bool prometheus = false;
+	unsigned i;
+	int opt;
+	int ret;
+
+	memset(&config, 0, sizeof(config));
+	config.transport_create = sg_create;
+	config.transport_ctx = &config;
+	config.max_devs_per_thread = FLEET_DEVS_PER_THREAD;
+
+	while ((opt = getopt(argc, argv, "t:cp")) != -1) {
+		switch (opt) {
+			case 't': config.num_threads = strtoul(optarg, NULL, 0); break;
+			case 'c': csv = true; break;
+			case 'p': prometheus = true; break;
+			default: optind = argc; break;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "Usage: %s [-t threads] [-c] [-p] /dev/sgX...\n", argv[0]);
+		return 1;
+	}
+
+	num_devs = argc - optind;
+	snapshots = calloc(num_devs, sizeof(*snapshots));
+	if (!snapshots) {
+		fprintf(stderr, "Failed to allocate\n");
+		return 1;
+	}
+
+	if (prometheus) {
+		config.stats = scsi_stats_create(num_devs, config.num_threads ? config.num_threads : 1);
+		if (!config.stats) {
+			fprintf(stderr, "Failed to allocate\n");
+			return 1;
+		}
+	}
+
+	ret = scsi_probe_run(&config, (const char * const *)argv + optind, num_devs, snapshots);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to run the probe: %s\n", strerror(-ret));
+		return 1;
+	}
+
+	for (i = 0; i < num_devs; i++) {
+		print_snapshot(&snapshots[i], csv);
+		scsi_probe_snapshot_free(&snapshots[i]);
+	}
+
+	if (config.stats) {
+		scsi_stats_snapshot_t *stats = scsi_stats_snapshot(config.stats);
+		if (stats) {
+			scsi_stats_write_prometheus(stats, NULL, stdout);
+			free(stats);
+		}
+		scsi_stats_destroy(config.stats);
+	}
+
+	free(snapshots);
+	return 0;
+}
@@ -0,0 +1,622 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* The structured counterpart of the text parsers of parse_scsi, the same pages with the values as record fields */
+
+#include "scsi_record.h"
+
+#include "cdb_decode.h"
+#include "parse_log_sense.h"
+#include "parse_mode_sense.h"
+#include "parse_extended_inquiry.h"
+#include "parse_read_defect_data.h"
+#include "parse_receive_diagnostics.h"
+#include "scsicmd.h"
+
+static void record_unparsed(record_writer_t *w, uint8_t *buf, unsigned buf_len, uint8_t *start, unsigned total_len)
+{
+	const unsigned len = safe_len(start, total_len, buf, buf_len);
+	if (len > 0)
+		record_hex(w, "unparsed", buf, len);
+}
+
+static void record_log_sense_param(record_writer_t *w, uint8_t page, uint8_t *param, unsigned param_len)
+{
+	uint8_t *data = log_sense_param_data(param);
+	const unsigned data_len = log_sense_param_len(param);
+
+	record_uint(w, "code", log_sense_param_code(param));
+	record_uint(w, "format", log_sense_param_fmt(param));
+	record_uint(w, "len", data_len);
+
+	if (page == 0x2F && log_sense_param_code(param) == 0 && data_len >= 3) {
+		record_uint(w, "ie_asc", data[0]);
+		record_uint(w, "ie_ascq", data[1]);
+		record_uint(w, "temperature", data[2]);
+		record_unparsed(w, data + 3, data_len - 3, param, param_len);
+		return;
+	}
+
+	switch (log_sense_param_fmt(param)) {
+		case LOG_PARAM_FMT_COUNTER_STOP:
+		case LOG_PARAM_FMT_COUNTER_ROLLOVER:
+			switch (data_len) {
+				case 2: record_uint(w, "value", get_uint16(data, 0)); return;
+				case 4: record_uint(w, "value", get_uint32(data, 0)); return;
+				case 8: record_uint(w, "value", get_uint64(data, 0)); return;
+			}
+			break;
+		case LOG_PARAM_FMT_ASCII:
+			record_str(w, "ascii", (const char *)data, safe_len(param, param_len, data, data_len));
+			return;
+	}
+	record_unparsed(w, data, data_len, param, param_len);
+}
+
+static void record_log_sense(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	if (data_len < LOG_SENSE_MIN_LEN) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "log_sense");
+	record_uint(w, "page", log_sense_page_code(data));
+	if (log_sense_subpage_format(data))
+		record_uint(w, "subpage", log_sense_subpage_code(data));
+	record_bool(w, "saved", log_sense_data_saved(data));
+	record_uint(w, "len", log_sense_data_len(data));
+
+	if (log_sense_page_code(data) == 0) {
+		uint8_t supported_page, supported_subpage;
+
+		if (!log_sense_subpage_format(data)) {
+			record_list_begin(w, "supported_pages");
+			for_all_log_sense_pg_0_supported_pages(data, data_len, supported_page) {
+				record_object_begin(w, NULL);
+				record_uint(w, "page", supported_page & 0x3F);
+				record_object_end(w);
+			}
+			record_list_end(w);
+		} else if (log_sense_subpage_code(data) == 0xFF) {
+			record_list_begin(w, "supported_subpages");
+			for_all_log_sense_pg_0_supported_subpages(data, data_len, supported_page, supported_subpage) {
+				record_object_begin(w, NULL);
+				record_uint(w, "page", supported_page & 0x3F);
+				record_uint(w, "subpage", supported_subpage);
+				record_object_end(w);
+			}
+			record_list_end(w);
+		} else {
+			record_unparsed(w, log_sense_data(data), log_sense_data_len(data), data, data_len);
+		}
+	} else {
+		uint8_t *param;
+
+		record_list_begin(w, "params");
+		for_all_log_sense_params(data, data_len, param) {
+			record_object_begin(w, NULL);
+			record_log_sense_param(w, log_sense_page_code(data), param, log_sense_param_len(param) + 4);
+			record_object_end(w);
+		}
+		record_list_end(w);
+	}
+	record_object_end(w);
+}
+
+static void record_read_cap_10(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	uint32_t max_lba;
+	uint32_t block_size;
+
+	if (!parse_read_capacity_10(data, data_len, &max_lba, &block_size)) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "read_capacity");
+	record_uint(w, "max_lba", max_lba);
+	record_uint(w, "block_size", block_size);
+	record_object_end(w);
+}
+
+static void record_read_cap_16(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	uint64_t max_lba;
+	uint32_t block_size;
+	bool prot_enable, thin_provisioning_enabled, thin_provisioning_zero;
+	unsigned p_type, p_i_exponent, logical_blocks_per_physical_block_exponent, lowest_aligned_lba;
+
+	if (!parse_read_capacity_16(data, data_len, &max_lba, &block_size, &prot_enable,
+		&p_type, &p_i_exponent, &logical_blocks_per_physical_block_exponent,
+		&thin_provisioning_enabled, &thin_provisioning_zero, &lowest_aligned_lba))
+	{
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "read_capacity");
+	record_uint(w, "max_lba", max_lba);
+	record_uint(w, "block_size", block_size);
+	record_bool(w, "protection_enabled", prot_enable);
+	record_bool(w, "thin_provisioning_enabled", thin_provisioning_enabled);
+	record_bool(w, "thin_provisioning_zero", thin_provisioning_zero);
+	record_uint(w, "p_type", p_type);
+	record_uint(w, "p_i_exponent", p_i_exponent);
+	record_uint(w, "logical_per_physical_exponent", logical_blocks_per_physical_block_exponent);
+	record_uint(w, "lowest_aligned_lba", lowest_aligned_lba);
+	record_object_end(w);
+}
+
+static void record_evpd_block_limits(record_writer_t *w, uint8_t *data, unsigned len)
+{
+	record_bool(w, "wsnz", evpd_block_limits_wsnz(data));
+	record_uint(w, "max_compare_and_write_len", evpd_block_limits_max_compare_and_write_len(data));
+	record_uint(w, "opt_transfer_len_granularity", evpd_block_limits_opt_transfer_length_granularity(data));
+	record_uint(w, "max_transfer_len", evpd_block_limits_max_transfer_length(data));
+	record_uint(w, "opt_transfer_len", evpd_block_limits_opt_transfer_length(data));
+
+	if (len < EVPD_BLOCK_LIMITS_LEN)
+		return;
+
+	record_uint(w, "max_prefetch_len", evpd_block_limits_max_prefetch_length(data));
+	record_uint(w, "max_unmap_lba_count", evpd_block_limits_max_unmap_lba_count(data));
+	record_uint(w, "max_unmap_block_descriptor_count", evpd_block_limits_max_unmap_block_descriptor_count(data));
+	record_uint(w, "opt_unmap_granularity", evpd_block_limits_opt_unmap_granularity(data));
+	if (evpd_block_limits_unmap_granularity_alignment_valid(data))
+		record_uint(w, "unmap_granularity_alignment", evpd_block_limits_unmap_granularity_alignment(data));
+	record_uint(w, "max_write_same_len", evpd_block_limits_max_write_same_length(data));
+}
+
+static void record_extended_inquiry(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	uint8_t *page_data;
+
+	if (data_len < EVPD_MIN_LEN) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "evpd");
+	record_uint(w, "qualifier", evpd_peripheral_qualifier(data));
+	record_uint(w, "device_type", evpd_peripheral_device_type(data));
+	record_uint(w, "page", evpd_page_code(data));
+	record_uint(w, "len", evpd_page_len(data));
+
+	if (evpd_is_valid(data, data_len)) {
+		page_data = evpd_page_data(data);
+
+		if (evpd_is_ascii_page(evpd_page_code(data))) {
+			record_str(w, "ascii", (const char *)evpd_ascii_data(page_data),
+			           safe_len(data, data_len, evpd_ascii_data(page_data), evpd_ascii_len(page_data)));
+			if (evpd_ascii_post_data_len(page_data, data_len) > 0)
+				record_unparsed(w, evpd_ascii_post_data(page_data), evpd_ascii_post_data_len(page_data, data_len), data, data_len);
+		} else if (evpd_page_code(data) == EVPD_BLOCK_LIMITS) {
+			const unsigned page_len = evpd_page_len(data) + EVPD_MIN_LEN;
+			const unsigned len = page_len < data_len ? page_len : data_len;
+
+			if (len >= EVPD_BLOCK_LIMITS_SHORT_LEN)
+				record_evpd_block_limits(w, data, len);
+			else
+				record_unparsed(w, page_data, len - EVPD_MIN_LEN, data, data_len);
+		} else {
+			record_unparsed(w, page_data, evpd_page_len(data), data, data_len);
+		}
+	}
+	record_object_end(w);
+}
+
+static void record_simple_inquiry(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	int device_type;
+	scsi_vendor_t vendor;
+	scsi_model_t model;
+	scsi_fw_revision_t rev;
+	scsi_serial_t serial;
+
+	if (!parse_inquiry(data, data_len, &device_type, vendor, model, rev, serial)) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "inquiry");
+	record_uint(w, "device_type", device_type);
+	record_cstr(w, "vendor", vendor);
+	record_cstr(w, "model", model);
+	record_cstr(w, "revision", rev);
+	record_cstr(w, "serial", serial);
+	record_object_end(w);
+}
+
+static void record_mode_sense_block_descriptor(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	record_object_begin(w, "block_descriptor");
+	if (data_len == BLOCK_DESCRIPTOR_LENGTH) {
+		record_uint(w, "density_code", block_descriptor_density_code(data));
+		record_uint(w, "num_blocks", block_descriptor_num_blocks(data));
+		record_uint(w, "block_len", block_descriptor_block_length(data));
+	} else {
+		record_unparsed(w, data, data_len, data, data_len);
+	}
+	record_object_end(w);
+}
+
+static void record_mode_sense_page(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	record_object_begin(w, NULL);
+	record_uint(w, "page", mode_sense_data_page_code(data));
+	if (mode_sense_data_subpage_format(data))
+		record_uint(w, "subpage", mode_sense_data_subpage_code(data));
+	record_bool(w, "saveable", mode_sense_data_parameter_saveable(data));
+	record_uint(w, "len", mode_sense_data_param_len(data));
+	record_hex(w, "data", mode_sense_data_param(data), safe_len(data, data_len, mode_sense_data_param(data), mode_sense_data_param_len(data)));
+	record_object_end(w);
+}
+
+static void record_mode_sense_10(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	unsigned remaining_len;
+	uint8_t *mode_page;
+
+	if (data_len < MODE_SENSE_10_MIN_LEN) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "mode_sense");
+	record_uint(w, "len", mode_sense_10_data_len(data));
+	record_uint(w, "medium_type", mode_sense_10_medium_type(data));
+	record_uint(w, "device_specific_param", mode_sense_10_device_specific_param(data));
+	record_bool(w, "long_lba", mode_sense_10_long_lba(data));
+	record_uint(w, "block_descriptor_len", mode_sense_10_block_descriptor_length(data));
+
+	if (data_len < mode_sense_10_expected_length(data)) {
+		record_cstr(w, "error", "insufficient data");
+	} else {
+		if (mode_sense_10_block_descriptor_length(data) > 0)
+			record_mode_sense_block_descriptor(w, mode_sense_10_block_descriptor_data(data),
+				safe_len(data, data_len, mode_sense_10_block_descriptor_data(data), mode_sense_10_block_descriptor_length(data)));
+
+		record_list_begin(w, "pages");
+		for_all_mode_sense_10_pages(data, data_len, mode_page, remaining_len) {
+			record_mode_sense_page(w, mode_page, remaining_len);
+		}
+		record_list_end(w);
+	}
+	record_object_end(w);
+}
+
+static void record_mode_sense_6(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	unsigned remaining_len;
+	uint8_t *mode_page;
+
+	if (data_len < MODE_SENSE_6_MIN_LEN) {
+		record_cstr(w, "error", "insufficient data");
+		return;
+	}
+
+	record_object_begin(w, "mode_sense");
+	record_uint(w, "len", mode_sense_6_data_len(data));
+	record_uint(w, "medium_type", mode_sense_6_medium_type(data));
+	record_uint(w, "device_specific_param", mode_sense_6_device_specific_param(data));
+	record_uint(w, "block_descriptor_len", mode_sense_6_block_descriptor_length(data));
+
+	if (data_len < mode_sense_6_expected_length(data)) {
+		record_cstr(w, "error", "insufficient data");
+	} else if (!mode_sense_6_is_valid_header(data, data_len)) {
+		record_cstr(w, "error", "bad header");
+	} else {
+		if (mode_sense_6_block_descriptor_length(data) > 0)
+			record_mode_sense_block_descriptor(w, mode_sense_6_block_descriptor_data(data),
+				safe_len(data, data_len, mode_sense_6_block_descriptor_data(data), mode_sense_6_block_descriptor_length(data)));
+
+		record_list_begin(w, "pages");
+		for_all_mode_sense_6_pages(data, data_len, mode_page, remaining_len) {
+			record_mode_sense_page(w, mode_page, remaining_len);
+		}
+		record_list_end(w);
+	}
+	record_object_end(w);
+}
+
+static void record_defect_list(record_writer_t *w, address_desc_format_e fmt, uint8_t *data, unsigned len)
+{
+	const unsigned fmt_len = read_defect_data_fmt_len(fmt);
+
+	if (fmt_len == 0) {
+		record_unparsed(w, data, len, data, len);
+		return;
+	}
+
+	record_list_begin(w, "defects");
+	for (; len >= fmt_len; data += fmt_len, len -= fmt_len) {
+		record_object_begin(w, NULL);
+		switch (fmt) {
+			case ADDRESS_FORMAT_SHORT:
+				record_uint(w, "lba", get_uint32(data, 0));
+				break;
+			case ADDRESS_FORMAT_LONG:
+				record_uint(w, "lba", get_uint64(data, 0));
+				break;
+			case ADDRESS_FORMAT_INDEX_OFFSET:
+				record_uint(w, "cylinder", format_address_byte_from_index_cylinder(data));
+				record_uint(w, "head", format_address_byte_from_index_head(data));
+				record_uint(w, "bytes_from_index", format_address_byte_from_index_bytes(data));
+				break;
+			case ADDRESS_FORMAT_PHYSICAL:
+				record_uint(w, "cylinder", format_address_physical_cylinder(data));
+				record_uint(w, "head", format_address_physical_head(data));
+				record_uint(w, "sector", format_address_physical_sector(data));
+				break;
+			case ADDRESS_FORMAT_VENDOR:
+				record_uint(w, "vendor", get_uint32(data, 0));
+				break;
+			default:
+				break;
+		}
+		record_object_end(w);
+	}
+	record_list_end(w);
+}
+
+static void record_read_defect_data_10(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	if (!read_defect_data_10_hdr_is_valid(data, data_len)) {
+		record_cstr(w, "error", "bad header");
+		return;
+	}
+
+	record_object_begin(w, "defect_data");
+	record_bool(w, "plist", read_defect_data_10_is_plist_valid(data));
+	record_bool(w, "glist", read_defect_data_10_is_glist_valid(data));
+	record_cstr(w, "format", read_defect_data_format_to_str(read_defect_data_10_list_format(data)));
+	record_uint(w, "len", read_defect_data_10_len(data));
+	if (read_defect_data_10_is_valid(data, data_len))
+		record_defect_list(w, read_defect_data_10_list_format(data), read_defect_data_10_data(data),
+			safe_len(data, data_len, read_defect_data_10_data(data), read_defect_data_10_len(data)));
+	record_object_end(w);
+}
+
+static void record_read_defect_data_12(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	if (!read_defect_data_12_hdr_is_valid(data, data_len)) {
+		record_cstr(w, "error", "bad header");
+		return;
+	}
+
+	record_object_begin(w, "defect_data");
+	record_bool(w, "plist", read_defect_data_12_is_plist_valid(data));
+	record_bool(w, "glist", read_defect_data_12_is_glist_valid(data));
+	record_cstr(w, "format", read_defect_data_format_to_str(read_defect_data_12_list_format(data)));
+	record_uint(w, "len", read_defect_data_12_len(data));
+	if (read_defect_data_12_is_valid(data, data_len))
+		record_defect_list(w, read_defect_data_12_list_format(data), read_defect_data_12_data(data),
+			safe_len(data, data_len, read_defect_data_12_data(data), read_defect_data_12_len(data)));
+	record_object_end(w);
+}
+
+static void record_ses_enclosure(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	char name[16];
+
+	record_object_begin(w, NULL);
+	record_uint(w, "process_identifier", ses_config_enclosure_descriptor_process_identifier(data));
+	record_uint(w, "num_processes", ses_config_enclosure_descriptor_num_processes(data));
+	record_uint(w, "subenclosure_identifier", ses_config_enclosure_descriptor_subenclosure_identifier(data));
+	record_uint(w, "num_type_descriptors", ses_config_enclosure_descriptor_num_type_descriptors(data));
+	record_uint(w, "len", ses_config_enclosure_descriptor_len(data));
+	record_uint(w, "logical_identifier", ses_config_enclosure_descriptor_logical_identifier(data));
+
+	ses_config_enclosure_descriptor_vendor_identifier(data, name, sizeof(name));
+	record_cstr(w, "vendor", name);
+	ses_config_enclosure_descriptor_product_identifier(data, name, sizeof(name));
+	record_cstr(w, "product", name);
+	ses_config_enclosure_descriptor_revision_level(data, name, sizeof(name));
+	record_cstr(w, "revision", name);
+
+	if (ses_config_enclosure_descriptor_vendor_len(data) > 0)
+		record_hex(w, "vendor_info", ses_config_enclosure_descriptor_vendor_info(data),
+			safe_len(data, data_len, ses_config_enclosure_descriptor_vendor_info(data), ses_config_enclosure_descriptor_vendor_len(data)));
+	record_object_end(w);
+}
+
+static void record_ses_config(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	unsigned parsed_len = ses_config_sub_enclosure(data) - data;
+	unsigned num_enclosures;
+
+	if (!ses_config_is_valid(data, data_len))
+		return;
+
+	num_enclosures = ses_config_num_sub_enclosures(data);
+	record_uint(w, "num_subenclosures", num_enclosures);
+	record_uint(w, "generation", ses_config_generation(data));
+
+	record_list_begin(w, "enclosures");
+	for (; num_enclosures > 0 && parsed_len < data_len; num_enclosures--) {
+		uint8_t *desc = data + parsed_len;
+
+		if (!ses_config_enclosure_descriptor_is_valid(desc, data_len - parsed_len))
+			break;
+		record_ses_enclosure(w, desc, data_len - parsed_len);
+		parsed_len += ses_config_enclosure_descriptor_len(desc) + 4;
+	}
+	record_list_end(w);
+
+	/* The type descriptors and strings follow the enclosures */
+	if (parsed_len < data_len)
+		record_unparsed(w, data + parsed_len, data_len - parsed_len, data, data_len);
+}
+
+static void record_receive_diagnostic_results(record_writer_t *w, uint8_t *data, unsigned data_len)
+{
+	if (!recv_diag_is_valid(data, data_len)) {
+		record_cstr(w, "error", "bad header");
+		return;
+	}
+
+	record_object_begin(w, "diagnostics");
+	record_uint(w, "page", recv_diag_get_page_code(data));
+	record_uint(w, "page_specific", recv_diag_get_page_code_specific(data));
+	record_uint(w, "len", recv_diag_get_len(data));
+
+	switch (recv_diag_get_page_code(data)) {
+		case 0:
+			{
+				uint8_t *pages = recv_diag_data(data);
+				unsigned len = safe_len(data, data_len, pages, recv_diag_get_len(data));
+
+				record_list_begin(w, "supported_pages");
+				for (; len > 0; len--, pages++) {
+					record_object_begin(w, NULL);
+					record_uint(w, "page", pages[0]);
+					record_object_end(w);
+				}
+				record_list_end(w);
+			}
+			break;
+		case 1:
+			record_ses_config(w, data, data_len);
+			break;
+		default:
+			record_unparsed(w, recv_diag_data(data), recv_diag_get_len(data), data, data_len);
+			break;
+	}
+	record_object_end(w);
+}
+
+static void record_cdb(record_writer_t *w, uint8_t *cdb, unsigned cdb_len)
+{
+	cdb_decoded_t decoded;
+	const bool valid = cdb_decode(cdb, cdb_len, &decoded);
+
+	record_uint(w, "opcode", decoded.opcode);
+	record_cstr(w, "command", cdb_kind_name(decoded.kind));
+	if (!valid)
+		return;
+
+	switch (decoded.kind) {
+		case CDB_KIND_READ_10:
+		case CDB_KIND_WRITE_10:
+		case CDB_KIND_READ_16:
+		case CDB_KIND_WRITE_16:
+		case CDB_KIND_WRITE_SAME_16:
+			record_uint(w, "lba", decoded.lba);
+			record_uint(w, "transfer_len", decoded.transfer_len);
+			break;
+		case CDB_KIND_INQUIRY:
+		case CDB_KIND_RECEIVE_DIAGNOSTICS:
+		case CDB_KIND_LOG_SENSE:
+		case CDB_KIND_MODE_SENSE_6:
+		case CDB_KIND_MODE_SENSE_10:
+			record_uint(w, "page_code", decoded.page_code);
+			record_uint(w, "subpage_code", decoded.subpage_code);
+			record_uint(w, "page_control", decoded.page_control);
+			record_uint(w, "alloc_len", decoded.transfer_len);
+			break;
+		case CDB_KIND_READ_DEFECT_DATA_10:
+		case CDB_KIND_READ_DEFECT_DATA_12:
+			record_uint(w, "format", decoded.format);
+			record_uint(w, "alloc_len", decoded.transfer_len);
+			break;
+		case CDB_KIND_ATA_PASSTHROUGH_12:
+		case CDB_KIND_ATA_PASSTHROUGH_16:
+			record_uint(w, "ata_protocol", decoded.ata.protocol);
+			record_uint(w, "ata_command", decoded.ata.command);
+			record_uint(w, "ata_feature", decoded.ata.feature);
+			record_uint(w, "ata_sector_count", decoded.ata.sector_count);
+			record_uint(w, "ata_lba", decoded.ata.lba);
+			break;
+		default:
+			if (decoded.transfer_len)
+				record_uint(w, "transfer_len", decoded.transfer_len);
+			break;
+	}
+}
+
+static void record_sense(record_writer_t *w, uint8_t *sense, unsigned sense_len)
+{
+	sense_info_t info;
+
+	record_hex(w, "sense", sense, sense_len);
+	if (!scsi_parse_sense(sense, sense_len, &info))
+		return;
+	record_uint(w, "sense_key", info.sense_key);
+	record_uint(w, "asc", info.asc);
+	record_uint(w, "ascq", info.ascq);
+	if (info.information_valid)
+		record_uint(w, "information", info.information);
+}
+
+void scsi_record_command(record_writer_t *w, uint8_t *cdb, int cdb_len, uint8_t *sense, int sense_len,
+                         uint8_t *data, int data_len)
+{
+	record_begin(w);
+
+	if (!cdb || !sense || !data) {
+		record_cstr(w, "error", "invalid csv");
+		goto Exit;
+	}
+	if (cdb_len <= 0) {
+		record_cstr(w, "error", "invalid cdb");
+		goto Exit;
+	}
+
+	record_hex(w, "cdb", cdb, cdb_len);
+	record_cdb(w, cdb, cdb_len);
+
+	if (sense_len < 0) {
+		record_cstr(w, "error", "invalid sense");
+		goto Exit;
+	}
+	if (data_len < 0) {
+		record_cstr(w, "error", "invalid data");
+		goto Exit;
+	}
+
+	record_uint(w, "data_len", data_len);
+	if (sense_len > 0) {
+		record_sense(w, sense, sense_len);
+		goto Exit;
+	}
+
+	switch (cdb[0]) {
+		case 0x4D: record_log_sense(w, data, data_len); break;
+		case 0x25: record_read_cap_10(w, data, data_len); break;
+		case 0x9E: record_read_cap_16(w, data, data_len); break;
+		case 0x12:
+			if (cdb_len < 6)
+				record_cstr(w, "error", "invalid cdb");
+			else if (cdb[1] & 1)
+				record_extended_inquiry(w, data, data_len);
+			else
+				record_simple_inquiry(w, data, data_len);
+			break;
+		case 0x5A: record_mode_sense_10(w, data, data_len); break;
+		case 0x1A: record_mode_sense_6(w, data, data_len); break;
+		case 0x1C: record_receive_diagnostic_results(w, data, data_len); break;
+		case 0x37: record_read_defect_data_10(w, data, data_len); break;
+		case 0xB7: record_read_defect_data_12(w, data, data_len); break;
+		default:
+			if (data_len > 0)
+				record_hex(w, "unparsed", data, data_len);
+			break;
+	}
+
+Exit:
+	record_end(w);
+}
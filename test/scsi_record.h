@@ -0,0 +1,30 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LIBSCSICMD_SCSI_RECORD_H
+#define LIBSCSICMD_SCSI_RECORD_H
+
+#include "record_writer.h"
+
+/** Write one record of a captured command with everything parse_scsi knows to decode of it.
+ *
+ * A NULL buffer is a field that is missing from the capture line and a negative length is a field that isn't valid
+ * hex, the record then only has the error. The data is parsed only when there is no sense, as in the text output.
+ */
+void scsi_record_command(record_writer_t *w, uint8_t *cdb, int cdb_len, uint8_t *sense, int sense_len,
+                         uint8_t *data, int data_len);
+
+#endif
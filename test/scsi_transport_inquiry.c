@@ -0,0 +1,129 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Send INQUIRY and READ CAPACITY 16 to all the devices at once and print the results as they complete */
+
+#include "scsicmd.h"
+#include "scsi_transport.h"
+#include "sense_dump.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define CMDS_PER_DEV 2
+#define BUF_LEN 512
+
+static void print_result(scsi_cmd_t *cmd)
+{
+	const char *devname = cmd->priv;
+
+	if (cmd->error) {
+		printf("%s: command %02X failed: %s\n", devname, cmd->cdb[0], strerror(-cmd->error));
+		return;
+	}
+
+	if (cmd->sense_len) {
+		printf("%s: command %02X returned sense\n", devname, cmd->cdb[0]);
+		sense_dump(cmd->sense, cmd->sense_len);
+		return;
+	}
+
+	if (cmd->cdb[0] == 0x12) {
+		int device_type;
+		scsi_vendor_t vendor;
+		scsi_model_t model;
+		scsi_fw_revision_t rev;
+		scsi_serial_t serial;
+
+		if (parse_inquiry(cmd->buf, cmd->data_len, &device_type, vendor, model, rev, serial))
+			printf("%s: type %d vendor '%s' model '%s' revision '%s' serial '%s'\n", devname, device_type, vendor, model, rev, serial);
+		else
+			printf("%s: failed to parse inquiry\n", devname);
+	} else {
+		uint64_t max_lba;
+		uint32_t block_size;
+
+		if (parse_read_capacity_16_simple(cmd->buf, cmd->data_len, &max_lba, &block_size))
+			printf("%s: max lba %" PRIu64 " block size %u\n", devname, max_lba, block_size);
+		else
+			printf("%s: failed to parse read capacity 16\n", devname);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const unsigned num_devs = argc - 1;
+	scsi_transport_t *t;
+	scsi_cmd_t *cmds;
+	unsigned char *bufs;
+	unsigned i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s /dev/sgX...\n", argv[0]);
+		return 1;
+	}
+
+	t = scsi_transport_sg_create(num_devs);
+	cmds = calloc(num_devs * CMDS_PER_DEV, sizeof(*cmds));
+	bufs = calloc(num_devs * CMDS_PER_DEV, BUF_LEN);
+	if (!t || !cmds || !bufs) {
+		fprintf(stderr, "Failed to allocate\n");
+		return 1;
+	}
+
+	for (i = 0; i < num_devs; i++) {
+		unsigned char cdb[16];
+		int cdb_len;
+		int dev = scsi_transport_open(t, argv[i+1]);
+
+		if (dev < 0) {
+			fprintf(stderr, "Error opening device '%s': %s\n", argv[i+1], strerror(-dev));
+			continue;
+		}
+
+		cdb_len = cdb_inquiry_simple(cdb, 96);
+		scsi_cmd_init(&cmds[i*CMDS_PER_DEV], dev, cdb, cdb_len, SCSI_DIR_FROM_DEV, bufs + i*CMDS_PER_DEV*BUF_LEN, BUF_LEN);
+		cdb_len = cdb_read_capacity_16(cdb, BUF_LEN);
+		scsi_cmd_init(&cmds[i*CMDS_PER_DEV+1], dev, cdb, cdb_len, SCSI_DIR_FROM_DEV, bufs + (i*CMDS_PER_DEV+1)*BUF_LEN, BUF_LEN);
+
+		cmds[i*CMDS_PER_DEV].priv = cmds[i*CMDS_PER_DEV+1].priv = argv[i+1];
+
+		if (scsi_transport_submit(t, &cmds[i*CMDS_PER_DEV]) < 0 || scsi_transport_submit(t, &cmds[i*CMDS_PER_DEV+1]) < 0)
+			fprintf(stderr, "Failed to submit to '%s'\n", argv[i+1]);
+	}
+
+	while (scsi_transport_in_flight(t) > 0) {
+		scsi_cmd_t *done[16];
+		unsigned num_done;
+		int ret = scsi_transport_poll(t, -1);
+
+		if (ret < 0) {
+			fprintf(stderr, "Failed to poll: %s\n", strerror(-ret));
+			break;
+		}
+
+		while ((num_done = scsi_transport_complete(t, done, 16)) > 0) {
+			for (i = 0; i < num_done; i++)
+				print_result(done[i]);
+		}
+	}
+
+	scsi_transport_destroy(t);
+	free(cmds);
+	free(bufs);
+	return 0;
+}
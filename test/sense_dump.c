@@ -1,5 +1,7 @@
 #include "sense_dump.h"
 #include "scsicmd.h"
+#include "sense_action.h"
+#include "parse_sense.h"
 #include <stdio.h>
 #include <inttypes.h>
 
@@ -15,94 +17,127 @@ void cdb_dump(unsigned char *cdb, int cdb_len)
 }
 
 void response_dump(unsigned char *buf, int buf_len)
+{
+	response_dump_file(stdout, buf, buf_len);
+}
+
+void response_dump_file(FILE *f, unsigned char *buf, int buf_len)
 {
 	int i;
 	for (i = 0; i < buf_len; i++) {
 		if (i % 16 == 0)
-			printf("\n%02x  ", i);
-		printf("%02x ", buf[i]);
+			fprintf(f, "\n%02x  ", i);
+		fprintf(f, "%02x ", buf[i]);
 	}
-	printf("\n");
+	fprintf(f, "\n");
 }
 
-static bool print_bool(const char *name, bool val)
+static bool print_bool(FILE *f, const char *name, bool val)
 {
-        printf("%s: %s\n", name, val ? "yes" : "no");
+        fprintf(f, "%s: %s\n", name, val ? "yes" : "no");
         return val;
 }
 
-static bool print_code(const char *name, bool val, const char *true_code, const char *false_code)
+static bool print_code(FILE *f, const char *name, bool val, const char *true_code, const char *false_code)
 {
-        printf("%s: %s\n", name, val ? true_code : false_code);
+        fprintf(f, "%s: %s\n", name, val ? true_code : false_code);
         return val;
 }
 
-static void sense_dump_sense_info(sense_info_t *si)
+static void sense_dump_sense_info(FILE *f, sense_info_t *si)
 {
-        print_code("Type", si->is_fixed, "Fixed", "Descriptor");
-        print_code("Time", si->is_current, "Current", "Deferred");
-        printf("Code: %x/%02x/%02x\n", si->sense_key, si->asc, si->ascq);
-        printf("Code: %s/%s\n", sense_key_to_name(si->sense_key), asc_num_to_name(si->asc, si->ascq));
-        printf("Vendor Unique: 0x%04x\n", si->vendor_unique_error);
+        print_code(f, "Type", si->is_fixed, "Fixed", "Descriptor");
+        print_code(f, "Time", si->is_current, "Current", "Deferred");
+        fprintf(f, "Code: %x/%02x/%02x\n", si->sense_key, si->asc, si->ascq);
+        fprintf(f, "Code: %s/%s\n", sense_key_to_name(si->sense_key), asc_num_to_name(si->asc, si->ascq));
+        sense_decision_t decision = sense_info_classify(si);
+        fprintf(f, "Action: %s (delay %u ms)\n", sense_action_name(decision.action), decision.delay_ms);
+        fprintf(f, "Vendor Unique: 0x%04x\n", si->vendor_unique_error);
         if (si->information_valid)
-                printf("Information: %"PRIx64"\n", si->information);
+                fprintf(f, "Information: %"PRIx64"\n", si->information);
         if (si->cmd_specific_valid)
-                printf("Command specific: %"PRIx64"\n", si->cmd_specific);
+                fprintf(f, "Command specific: %"PRIx64"\n", si->cmd_specific);
         if (si->sense_key_specific_valid) {
 
                 switch (si->sense_key) {
                         case SENSE_KEY_ILLEGAL_REQUEST:
-                                print_code("Illegal Request Type", si->sense_key_specific.illegal_request.command_error, "CDB", "Data");
+                                print_code(f, "Illegal Request Type", si->sense_key_specific.illegal_request.command_error, "CDB", "Data");
                                 if (si->sense_key_specific.illegal_request.bit_pointer_valid)
-                                        printf("Illegal Request Bit: %d\n", si->sense_key_specific.illegal_request.bit_pointer);
-                                printf("Illegal Request Field: %d\n", si->sense_key_specific.illegal_request.field_pointer);
+                                        fprintf(f, "Illegal Request Bit: %d\n", si->sense_key_specific.illegal_request.bit_pointer);
+                                fprintf(f, "Illegal Request Field: %d\n", si->sense_key_specific.illegal_request.field_pointer);
                                 break;
                         case SENSE_KEY_HARDWARE_ERROR:
                         case SENSE_KEY_MEDIUM_ERROR:
                         case SENSE_KEY_RECOVERED_ERROR:
-                                printf("Actual Retry Count: %d\n", si->sense_key_specific.hardware_medium_recovered_error.actual_retry_count);
+                                fprintf(f, "Actual Retry Count: %d\n", si->sense_key_specific.hardware_medium_recovered_error.actual_retry_count);
                                 break;
                         case SENSE_KEY_NOT_READY:
                         case SENSE_KEY_NO_SENSE:
-                                printf("Progress: %g%%\n", si->sense_key_specific.not_ready.progress);
+                                fprintf(f, "Progress: %g%%\n", si->sense_key_specific.not_ready.progress);
                                 break;
                         case SENSE_KEY_COPY_ABORTED:
-                                print_code("Copy Aborted Type", si->sense_key_specific.copy_aborted.segment_descriptor, "Segment", "Descriptor");
+                                print_code(f, "Copy Aborted Type", si->sense_key_specific.copy_aborted.segment_descriptor, "Segment", "Descriptor");
                                 if (si->sense_key_specific.copy_aborted.bit_pointer_valid)
-                                        printf("Copy Aborted Bit: %d\n", si->sense_key_specific.copy_aborted.bit_pointer);
-                                printf("Copy Aborted Field: %d\n", si->sense_key_specific.copy_aborted.field_pointer);
+                                        fprintf(f, "Copy Aborted Bit: %d\n", si->sense_key_specific.copy_aborted.bit_pointer);
+                                fprintf(f, "Copy Aborted Field: %d\n", si->sense_key_specific.copy_aborted.field_pointer);
                                 break;
                         case SENSE_KEY_UNIT_ATTENTION:
-                                print_bool("Unit Attention Overflow", si->sense_key_specific.unit_attention.overflow);
+                                print_bool(f, "Unit Attention Overflow", si->sense_key_specific.unit_attention.overflow);
                                 break;
                 }
         }
 
         if (si->fru_code_valid)
-                printf("FRU Code: %02x\n", si->fru_code);
+                fprintf(f, "FRU Code: %02x\n", si->fru_code);
 
         if (si->ata_status_valid) {
-                printf("ATA Status valid\n"); /*TODO: more details */
-                printf("ATA\n");
-                printf("    Extend: %02x\n", si->ata_status.extend);
-                printf("    Error: %02x\n", si->ata_status.error);
-                printf("    Device: %02x\n", si->ata_status.device);
-                printf("    Status: %02x\n", si->ata_status.status);
-                printf("    Sector Count: %u\n", si->ata_status.sector_count);
-                printf("    LBA: %"PRIu64" / %"PRIx64"\n", si->ata_status.lba, si->ata_status.lba);
+                fprintf(f, "ATA Status valid\n"); /*TODO: more details */
+                fprintf(f, "ATA\n");
+                fprintf(f, "    Extend: %02x\n", si->ata_status.extend);
+                fprintf(f, "    Error: %02x\n", si->ata_status.error);
+                fprintf(f, "    Device: %02x\n", si->ata_status.device);
+                fprintf(f, "    Status: %02x\n", si->ata_status.status);
+                fprintf(f, "    Sector Count: %u\n", si->ata_status.sector_count);
+                fprintf(f, "    LBA: %"PRIu64" / %"PRIx64"\n", si->ata_status.lba, si->ata_status.lba);
         }
 
-        print_bool("Incorrect Length Indicator", si->incorrect_len_indicator);
+        print_bool(f, "Incorrect Length Indicator", si->incorrect_len_indicator);
+}
+
+static void sense_dump_descriptors(FILE *f, unsigned char *sense, int sense_len)
+{
+        sense_view_t view;
+        unsigned char *desc;
+        sense_desc_progress_t progress;
+
+        if (!sense_view_init(&view, sense, sense_len) || view.is_fixed)
+                return;
+
+        for_all_sense_descriptors(&view, desc) {
+                fprintf(f, "Descriptor: type 0x%02x len %u\n", sense_desc_type(desc), sense_desc_len(desc));
+                if (sense_desc_type(desc) == SENSE_DESC_PROGRESS_INDICATION &&
+                    sense_desc_progress_indication(desc, &progress))
+                {
+                        fprintf(f, "    Progress of %x/%02x/%02x: %g%%\n", progress.sense_key, progress.asc, progress.ascq,
+                               progress.progress * 100.0 / 65536.0);
+                }
+        }
 }
 
 void sense_dump(unsigned char *sense, int sense_len)
 {
-        printf("Raw sense buffer:\n");
-        response_dump(sense, sense_len);
-        printf("\n");
+        sense_dump_file(stdout, sense, sense_len);
+}
+
+void sense_dump_file(FILE *f, unsigned char *sense, int sense_len)
+{
+        fprintf(f, "Raw sense buffer:\n");
+        response_dump_file(f, sense, sense_len);
+        fprintf(f, "\n");
 
         sense_info_t si;
         bool success = scsi_parse_sense(sense, sense_len, &si);
-        printf("Parsing succeeded: %s\n", success ? "yes" : "no");
-        sense_dump_sense_info(&si);
+        fprintf(f, "Parsing succeeded: %s\n", success ? "yes" : "no");
+        sense_dump_sense_info(f, &si);
+        sense_dump_descriptors(f, sense, sense_len);
 }
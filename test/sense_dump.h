@@ -1,8 +1,12 @@
 #ifndef _SENSE_DUMP_H
 #define _SENSE_DUMP_H
 
+#include <stdio.h>
+
 void sense_dump(unsigned char *sense, int sense_len);
 void response_dump(unsigned char *buf, int buf_len);
+void sense_dump_file(FILE *f, unsigned char *sense, int sense_len);
+void response_dump_file(FILE *f, unsigned char *buf, int buf_len);
 void cdb_dump(unsigned char *cdb, int cdb_len);
 
 #endif
@@ -0,0 +1,185 @@
+/* Copyright 2015 Baruch Even
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* Check the UNMAP parameter lists built by unmap_param_list_next(), the header lengths and the big endian LBA and
+ * block count of every descriptor are compared byte by byte against the expected ranges.
+ */
+
+#include "scsicmd.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define MAX_DESCS 8
+#define BUF_LEN (UNMAP_HEADER_LEN + MAX_DESCS * UNMAP_DESC_LEN)
+
+static unsigned long failures;
+
+static void fail(const char *check, const char *msg)
+{
+	failures++;
+	printf("%s: %s\n", check, msg);
+}
+
+/* Compare len bytes at buf against val in big endian, without going through the library getters */
+static bool match_be(const unsigned char *buf, uint64_t val, unsigned len)
+{
+	unsigned i;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != (uint8_t)(val >> (8 * (len - 1 - i))))
+			return false;
+	}
+	return true;
+}
+
+/* Pack the next list and check it holds exactly the expected ranges */
+static void check_list(const char *check, unmap_cursor_t *cursor, const unmap_limits_t *limits,
+		const unmap_extent_t *expected, unsigned num_expected)
+{
+	static const unsigned char zero[4];
+	unsigned char buf[BUF_LEN];
+	unsigned len;
+	unsigned i;
+
+	memset(buf, 0xAA, sizeof(buf));
+	len = unmap_param_list_next(cursor, limits, buf, sizeof(buf));
+	if (len != UNMAP_HEADER_LEN + num_expected * UNMAP_DESC_LEN) {
+		printf("%s: list length %u, expected %u descriptors\n", check, len, num_expected);
+		fail(check, "wrong parameter list length");
+		return;
+	}
+
+	if (!match_be(buf, len - 2, 2))
+		fail(check, "wrong unmap data length");
+	if (!match_be(buf + 2, num_expected * UNMAP_DESC_LEN, 2))
+		fail(check, "wrong block descriptor data length");
+	if (memcmp(buf + 4, zero, 4) != 0)
+		fail(check, "header reserved bytes are not zero");
+
+	for (i = 0; i < num_expected; i++) {
+		const unsigned char *desc = buf + UNMAP_HEADER_LEN + i * UNMAP_DESC_LEN;
+
+		if (!match_be(desc, expected[i].lba, 8) || !match_be(desc + 8, expected[i].num_blocks, 4)) {
+			printf("%s: descriptor %u expected lba %" PRIu64 " blocks %" PRIu64 "\n", check, i,
+			       expected[i].lba, expected[i].num_blocks);
+			fail(check, "wrong descriptor");
+		}
+		if (memcmp(desc + 12, zero, 4) != 0)
+			fail(check, "descriptor reserved bytes are not zero");
+	}
+}
+
+static void check_done(const char *check, unmap_cursor_t *cursor, const unmap_limits_t *limits)
+{
+	unsigned char buf[BUF_LEN];
+
+	if (unmap_param_list_next(cursor, limits, buf, sizeof(buf)) != 0)
+		fail(check, "extents left after the last list");
+}
+
+/* Several ranges that all fit in one list, with LBAs that need all eight bytes */
+static void check_multi_range(void)
+{
+	const unmap_extent_t extents[] = {
+		{ 0x10, 0x20 },
+		{ 0x123456789AULL, 0x01020304 },
+		{ 0x0102030405060708ULL, 0x8000 },
+		{ 0xFFFFFFFFFFFF0000ULL, 0xFFFF },
+	};
+	unmap_cursor_t cursor;
+
+	unmap_cursor_init(&cursor, extents, 4);
+	check_list("multi range", &cursor, NULL, extents, 4);
+	check_done("multi range", &cursor, NULL);
+}
+
+/* The descriptor count limit splits the ranges across lists */
+static void check_descriptor_limit(void)
+{
+	const unmap_extent_t extents[] = {
+		{ 100, 10 },
+		{ 200, 20 },
+		{ 300, 30 },
+	};
+	const unmap_limits_t limits = { 0, 2, 0, 0 };
+	unmap_cursor_t cursor;
+
+	unmap_cursor_init(&cursor, extents, 3);
+	check_list("descriptor limit", &cursor, &limits, extents, 2);
+	check_list("descriptor limit", &cursor, &limits, extents + 2, 1);
+	check_done("descriptor limit", &cursor, &limits);
+}
+
+/* The LBA count limit, rounded down to whole granules, splits a long range */
+static void check_lba_limit(void)
+{
+	const unmap_extent_t extents[] = {
+		{ 1000, 100 },
+		{ 2000, 8 },
+	};
+	const unmap_extent_t first[] = { { 1000, 32 } };
+	const unmap_extent_t second[] = { { 1032, 32 } };
+	const unmap_extent_t third[] = { { 1064, 32 } };
+	const unmap_extent_t fourth[] = { { 1096, 4 }, { 2000, 8 } };
+	const unmap_limits_t limits = { 36, 0, 8, 0 };
+	unmap_cursor_t cursor;
+
+	unmap_cursor_init(&cursor, extents, 2);
+	check_list("lba limit", &cursor, &limits, first, 1);
+	check_list("lba limit", &cursor, &limits, second, 1);
+	check_list("lba limit", &cursor, &limits, third, 1);
+	check_list("lba limit", &cursor, &limits, fourth, 2);
+	check_done("lba limit", &cursor, &limits);
+}
+
+/* A range longer than the 32-bit block count of a descriptor takes several descriptors of the same list */
+static void check_long_range(void)
+{
+	const unmap_extent_t extents[] = { { 0x100000000ULL, 0x180000000ULL } };
+	const unmap_extent_t expected[] = {
+		{ 0x100000000ULL, 0xFFFFFFFFULL },
+		{ 0x1FFFFFFFFULL, 0x80000001ULL },
+	};
+	unmap_cursor_t cursor;
+
+	unmap_cursor_init(&cursor, extents, 1);
+	check_list("long range", &cursor, NULL, expected, 2);
+	check_done("long range", &cursor, NULL);
+}
+
+/* The list length goes into the CDB as is */
+static void check_cdb(void)
+{
+	unsigned char cdb[10];
+
+	if (cdb_unmap(cdb, false, 3, UNMAP_HEADER_LEN + 3 * UNMAP_DESC_LEN) != 10 || cdb[0] != 0x42 || cdb[6] != 3 ||
+	    !match_be(cdb + 7, UNMAP_HEADER_LEN + 3 * UNMAP_DESC_LEN, 2))
+		fail("cdb", "wrong UNMAP CDB");
+}
+
+int main(void)
+{
+	check_multi_range();
+	check_descriptor_limit();
+	check_lba_limit();
+	check_long_range();
+	check_cdb();
+
+	printf("%lu failures\n", failures);
+	return failures ? 1 : 0;
+}